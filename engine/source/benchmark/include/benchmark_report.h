@@ -0,0 +1,49 @@
+#pragma once
+
+#include "runtime/core/profile/frame_stage_timer.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Piccolo
+{
+    /// per-frame timings of a benchmark run, summarized with percentiles
+    class BenchmarkReport
+    {
+    public:
+        struct Summary
+        {
+            double m_mean {0.0};
+            double m_min {0.0};
+            double m_p50 {0.0};
+            double m_p90 {0.0};
+            double m_p99 {0.0};
+            double m_max {0.0};
+        };
+
+        BenchmarkReport();
+
+        void setDescription(const std::string& key, const std::string& value);
+
+        /// @frame_time: total time of the frame in milliseconds
+        void addFrame(double frame_time, const FrameStageTimings::StageTimes& stage_times);
+
+        uint32_t getFrameCount() const { return static_cast<uint32_t>(m_frame_times.size()); }
+
+        static Summary summarize(std::vector<double> samples);
+
+        /// write json if the path ends with .json, csv otherwise
+        bool save(const std::string& output_path) const;
+
+        void writeJson(std::ostream& stream) const;
+        void writeCsv(std::ostream& stream) const;
+
+    private:
+        std::vector<std::pair<std::string, std::string>> m_descriptions;
+
+        std::vector<double>              m_frame_times;
+        std::vector<std::vector<double>> m_stage_times;
+    };
+} // namespace Piccolo
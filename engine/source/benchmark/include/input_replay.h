@@ -0,0 +1,40 @@
+#pragma once
+
+#include "runtime/core/math/math.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Piccolo
+{
+    /// game commands recorded per frame, replayed into the input system
+    ///
+    /// text format, one entry per line, '#' starts a comment:
+    ///     <frame> <command> [<yaw degrees> <pitch degrees>]
+    /// command is a GameCommand bit mask, either a number or names joined by '|', e.g. forward|sprint.
+    /// an entry holds until the next one, the cursor delta only applies to its own frame
+    class InputReplay
+    {
+    public:
+        bool load(const std::string& replay_file_path);
+
+        bool isEmpty() const { return m_entries.empty(); }
+
+        /// set the game command and cursor delta of the frame to the input system
+        void apply(uint32_t frame_index);
+
+    private:
+        struct Entry
+        {
+            uint32_t     m_frame_index {0};
+            unsigned int m_game_command {0};
+            float        m_yaw_degrees {0.f};
+            float        m_pitch_degrees {0.f};
+        };
+
+        std::vector<Entry> m_entries;
+        size_t             m_next_entry_index {0};
+        unsigned int       m_current_game_command {0};
+    };
+} // namespace Piccolo
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Piccolo
+{
+    /// microbenchmarks of the core/math kernels
+    ///
+    /// a kernel with a SIMD implementation is timed against its scalar reference, and their results over the same
+    /// random inputs must be the same bits
+    class MathBenchmark
+    {
+    public:
+        struct Result
+        {
+            std::string m_name;
+            double      m_time_ns {0.0}; // per operation
+            double      m_scalar_time_ns {0.0};
+            bool        m_has_scalar_reference {false};
+            bool        m_is_bit_exact {true};
+        };
+
+        void run(uint32_t input_count, uint32_t repeat_count);
+
+        /// false if a SIMD kernel differs from its scalar reference
+        bool isBitExact() const;
+
+        void writeCsv(std::ostream& stream) const;
+
+    private:
+        std::vector<Result> m_results;
+    };
+} // namespace Piccolo
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Piccolo
+{
+    class ObjectInstanceRes;
+
+    /// stress counts of a generated scene, objects are laid out on a grid around the origin
+    struct SyntheticSceneConfig
+    {
+        // static meshes with static rigidbodies
+        uint32_t m_static_prop_count {0};
+        // meshes with dynamic box rigidbodies, dropped from above the ground
+        uint32_t m_dynamic_prop_count {0};
+        // skinned and animated characters, only the level character is driven by input
+        uint32_t m_skinned_character_count {0};
+        // particle emitters
+        uint32_t m_particle_emitter_count {0};
+
+        float m_grid_spacing {4.f};
+
+        std::string m_prop_definition_url {"asset/objects/environment/wall/wall_block.object.json"};
+        std::string m_character_definition_url {"asset/objects/character/player/player.object.json"};
+        std::string m_emitter_definition_url {"asset/objects/environment/particle/particle.object.json"};
+
+        bool isEmpty() const
+        {
+            return m_static_prop_count + m_dynamic_prop_count + m_skinned_character_count + m_particle_emitter_count ==
+                   0;
+        }
+    };
+
+    /// generate the object instances of a synthetic scene, to be added to the active level
+    void generateSyntheticScene(const SyntheticSceneConfig& config, std::vector<ObjectInstanceRes>& out_objects);
+} // namespace Piccolo
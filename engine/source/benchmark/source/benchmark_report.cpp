@@ -0,0 +1,143 @@
+#include "benchmark/include/benchmark_report.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+
+namespace Piccolo
+{
+    namespace
+    {
+        // nearest-rank percentile of sorted samples
+        double getPercentile(const std::vector<double>& sorted_samples, double percentile)
+        {
+            const size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * sorted_samples.size()));
+            return sorted_samples[std::clamp<size_t>(rank, 1, sorted_samples.size()) - 1];
+        }
+
+        std::string escapeJson(const std::string& text)
+        {
+            std::string escaped;
+            escaped.reserve(text.size());
+            for (char character : text)
+            {
+                if (character == '"' || character == '\\')
+                {
+                    escaped.push_back('\\');
+                }
+                escaped.push_back(character);
+            }
+            return escaped;
+        }
+
+        void writeSummaryJson(std::ostream& stream, const BenchmarkReport::Summary& summary)
+        {
+            stream << "{\"mean_ms\": " << summary.m_mean << ", \"min_ms\": " << summary.m_min
+                   << ", \"p50_ms\": " << summary.m_p50 << ", \"p90_ms\": " << summary.m_p90
+                   << ", \"p99_ms\": " << summary.m_p99 << ", \"max_ms\": " << summary.m_max << "}";
+        }
+
+        void writeSummaryCsv(std::ostream& stream, const char* name, const BenchmarkReport::Summary& summary)
+        {
+            stream << name << ',' << summary.m_mean << ',' << summary.m_min << ',' << summary.m_p50 << ','
+                   << summary.m_p90 << ',' << summary.m_p99 << ',' << summary.m_max << '\n';
+        }
+    } // namespace
+
+    BenchmarkReport::BenchmarkReport() : m_stage_times(static_cast<size_t>(FrameStage::count)) {}
+
+    void BenchmarkReport::setDescription(const std::string& key, const std::string& value)
+    {
+        m_descriptions.emplace_back(key, value);
+    }
+
+    void BenchmarkReport::addFrame(double frame_time, const FrameStageTimings::StageTimes& stage_times)
+    {
+        m_frame_times.push_back(frame_time);
+        for (size_t stage_index = 0; stage_index < stage_times.size(); ++stage_index)
+        {
+            m_stage_times[stage_index].push_back(stage_times[stage_index]);
+        }
+    }
+
+    BenchmarkReport::Summary BenchmarkReport::summarize(std::vector<double> samples)
+    {
+        Summary summary;
+        if (samples.empty())
+        {
+            return summary;
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        summary.m_mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+        summary.m_min  = samples.front();
+        summary.m_p50  = getPercentile(samples, 50.0);
+        summary.m_p90  = getPercentile(samples, 90.0);
+        summary.m_p99  = getPercentile(samples, 99.0);
+        summary.m_max  = samples.back();
+        return summary;
+    }
+
+    bool BenchmarkReport::save(const std::string& output_path) const
+    {
+        std::ofstream output_file(output_path, std::ios::out | std::ios::trunc);
+        if (!output_file)
+        {
+            LOG_ERROR("open benchmark output {} failed", output_path);
+            return false;
+        }
+
+        const std::string json_extension = ".json";
+        const bool        is_json        = output_path.size() >= json_extension.size() &&
+                               output_path.compare(output_path.size() - json_extension.size(),
+                                                   json_extension.size(),
+                                                   json_extension) == 0;
+        if (is_json)
+        {
+            writeJson(output_file);
+        }
+        else
+        {
+            writeCsv(output_file);
+        }
+
+        return output_file.good();
+    }
+
+    void BenchmarkReport::writeJson(std::ostream& stream) const
+    {
+        stream << "{\n";
+        for (const auto& description : m_descriptions)
+        {
+            stream << "  \"" << escapeJson(description.first) << "\": \"" << escapeJson(description.second)
+                   << "\",\n";
+        }
+        stream << "  \"frame_count\": " << m_frame_times.size() << ",\n";
+        stream << "  \"frame\": ";
+        writeSummaryJson(stream, summarize(m_frame_times));
+        stream << ",\n  \"stages\": {\n";
+        for (size_t stage_index = 0; stage_index < m_stage_times.size(); ++stage_index)
+        {
+            stream << "    \"" << getFrameStageName(static_cast<FrameStage>(stage_index)) << "\": ";
+            writeSummaryJson(stream, summarize(m_stage_times[stage_index]));
+            stream << (stage_index + 1 < m_stage_times.size() ? ",\n" : "\n");
+        }
+        stream << "  }\n}\n";
+    }
+
+    void BenchmarkReport::writeCsv(std::ostream& stream) const
+    {
+        stream << "stage,mean_ms,min_ms,p50_ms,p90_ms,p99_ms,max_ms\n";
+        writeSummaryCsv(stream, "frame", summarize(m_frame_times));
+        for (size_t stage_index = 0; stage_index < m_stage_times.size(); ++stage_index)
+        {
+            writeSummaryCsv(stream,
+                            getFrameStageName(static_cast<FrameStage>(stage_index)),
+                            summarize(m_stage_times[stage_index]));
+        }
+    }
+} // namespace Piccolo
@@ -0,0 +1,141 @@
+#include "benchmark/include/input_replay.h"
+
+#include "runtime/core/base/macro.h"
+
+#include "runtime/function/global/global_context.h"
+#include "runtime/function/input/input_system.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+namespace Piccolo
+{
+    namespace
+    {
+        bool parseGameCommand(const std::string& text, unsigned int& out_game_command)
+        {
+            static const std::unordered_map<std::string, GameCommand> s_command_names = {
+                {"forward", GameCommand::forward},
+                {"backward", GameCommand::backward},
+                {"left", GameCommand::left},
+                {"right", GameCommand::right},
+                {"jump", GameCommand::jump},
+                {"squat", GameCommand::squat},
+                {"sprint", GameCommand::sprint},
+                {"fire", GameCommand::fire},
+                {"free_camera", GameCommand::free_carema}};
+
+            out_game_command = 0;
+            if (!text.empty() && std::isdigit(static_cast<unsigned char>(text[0])))
+            {
+                out_game_command = static_cast<unsigned int>(std::stoul(text, nullptr, 0));
+                return true;
+            }
+
+            std::stringstream name_stream(text);
+            std::string       name;
+            while (std::getline(name_stream, name, '|'))
+            {
+                if (name.empty() || name == "none")
+                {
+                    continue;
+                }
+
+                auto iter = s_command_names.find(name);
+                if (iter == s_command_names.end())
+                {
+                    return false;
+                }
+                out_game_command |= static_cast<unsigned int>(iter->second);
+            }
+            return true;
+        }
+    } // namespace
+
+    bool InputReplay::load(const std::string& replay_file_path)
+    {
+        m_entries.clear();
+        m_next_entry_index     = 0;
+        m_current_game_command = 0;
+
+        std::ifstream replay_file(replay_file_path);
+        if (!replay_file)
+        {
+            LOG_ERROR("open input replay {} failed", replay_file_path);
+            return false;
+        }
+
+        std::string line;
+        uint32_t    line_number = 0;
+        while (std::getline(replay_file, line))
+        {
+            ++line_number;
+
+            const size_t comment_begin = line.find('#');
+            if (comment_begin != std::string::npos)
+            {
+                line.erase(comment_begin);
+            }
+
+            std::stringstream line_stream(line);
+            Entry             entry;
+            std::string       command_text;
+            if (!(line_stream >> entry.m_frame_index))
+            {
+                continue;
+            }
+
+            try
+            {
+                if (!(line_stream >> command_text) || !parseGameCommand(command_text, entry.m_game_command))
+                {
+                    LOG_ERROR("invalid game command at {}:{}", replay_file_path, line_number);
+                    return false;
+                }
+            }
+            catch (const std::exception&)
+            {
+                LOG_ERROR("invalid game command at {}:{}", replay_file_path, line_number);
+                return false;
+            }
+
+            line_stream >> entry.m_yaw_degrees >> entry.m_pitch_degrees;
+
+            m_entries.push_back(entry);
+        }
+
+        std::stable_sort(m_entries.begin(), m_entries.end(), [](const Entry& lhs, const Entry& rhs) {
+            return lhs.m_frame_index < rhs.m_frame_index;
+        });
+
+        LOG_INFO("loaded {} input replay entries from {}", m_entries.size(), replay_file_path);
+        return true;
+    }
+
+    void InputReplay::apply(uint32_t frame_index)
+    {
+        std::shared_ptr<InputSystem> input_system = g_runtime_global_context.m_input_system;
+        ASSERT(input_system);
+
+        float yaw_degrees   = 0.f;
+        float pitch_degrees = 0.f;
+        while (m_next_entry_index < m_entries.size() && m_entries[m_next_entry_index].m_frame_index <= frame_index)
+        {
+            const Entry& entry     = m_entries[m_next_entry_index];
+            m_current_game_command = entry.m_game_command;
+            if (entry.m_frame_index == frame_index)
+            {
+                yaw_degrees   = entry.m_yaw_degrees;
+                pitch_degrees = entry.m_pitch_degrees;
+            }
+            ++m_next_entry_index;
+        }
+
+        input_system->setGameCommand(m_current_game_command);
+        input_system->m_cursor_delta_yaw   = Radian(Degree(yaw_degrees));
+        input_system->m_cursor_delta_pitch = Radian(Degree(pitch_degrees));
+    }
+} // namespace Piccolo
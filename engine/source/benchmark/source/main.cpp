@@ -0,0 +1,287 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "runtime/engine.h"
+
+#include "runtime/core/base/macro.h"
+#include "runtime/core/profile/frame_stage_timer.h"
+
+#include "runtime/function/framework/level/level.h"
+#include "runtime/function/framework/world/world_manager.h"
+#include "runtime/function/global/global_context.h"
+
+#include "runtime/resource/config_manager/config_manager.h"
+#include "runtime/resource/res_type/common/object.h"
+
+#include "benchmark/include/benchmark_report.h"
+#include "benchmark/include/input_replay.h"
+#include "benchmark/include/math_benchmark.h"
+#include "benchmark/include/synthetic_scene.h"
+
+namespace
+{
+    struct BenchmarkOptions
+    {
+        std::string m_config_file_path;
+        std::string m_world_url;
+        std::string m_level_url;
+        std::string m_replay_file_path;
+        std::string m_output_path;
+
+        uint32_t m_frame_count {1000};
+        uint32_t m_warmup_frame_count {30};
+        float    m_delta_time {1.f / 60.f};
+        bool     m_is_render_enabled {false};
+        bool     m_is_math_benchmark {false};
+
+        Piccolo::SyntheticSceneConfig m_synthetic_scene;
+    };
+
+    void printUsage()
+    {
+        std::cout
+            << "usage: PiccoloBenchmark [options]\n"
+               "  --config <ini>            engine config, PiccoloBenchmark.ini next to the executable by default\n"
+               "  --world <url>             world to load, the default world of the config if neither world nor level\n"
+               "  --level <url>             single level to load\n"
+               "  --frames <count>          measured frames, 1000 by default\n"
+               "  --warmup <count>          frames run before measuring, 30 by default\n"
+               "  --fps <rate>              fixed frame rate of the simulated time, 60 by default\n"
+               "  --replay <file>           recorded game commands, see InputReplay\n"
+               "  --output <file>           summary as .json, or csv for any other extension\n"
+               "  --render                  create window and GPU to time culling and pass recording\n"
+               "  --math                    only the core/math microbenchmarks, fails if SIMD and scalar math differ\n"
+               "  --static-props <count>    synthetic static props\n"
+               "  --dynamic-props <count>   synthetic dynamic rigidbodies\n"
+               "  --characters <count>      synthetic skinned characters\n"
+               "  --emitters <count>        synthetic particle emitters\n"
+            << std::endl;
+    }
+
+    bool parseOptions(int argc, char** argv, BenchmarkOptions& out_options)
+    {
+        for (int arg_index = 1; arg_index < argc; ++arg_index)
+        {
+            const std::string arg = argv[arg_index];
+            if (arg == "--render")
+            {
+                out_options.m_is_render_enabled = true;
+                continue;
+            }
+            if (arg == "--math")
+            {
+                out_options.m_is_math_benchmark = true;
+                continue;
+            }
+
+            if (arg_index + 1 >= argc)
+            {
+                return false;
+            }
+            const std::string value = argv[++arg_index];
+
+            try
+            {
+                if (arg == "--config")
+                    out_options.m_config_file_path = value;
+                else if (arg == "--world")
+                    out_options.m_world_url = value;
+                else if (arg == "--level")
+                    out_options.m_level_url = value;
+                else if (arg == "--replay")
+                    out_options.m_replay_file_path = value;
+                else if (arg == "--output")
+                    out_options.m_output_path = value;
+                else if (arg == "--frames")
+                    out_options.m_frame_count = static_cast<uint32_t>(std::stoul(value));
+                else if (arg == "--warmup")
+                    out_options.m_warmup_frame_count = static_cast<uint32_t>(std::stoul(value));
+                else if (arg == "--fps")
+                {
+                    const float fps = std::stof(value);
+                    if (fps <= 0.f)
+                        return false;
+                    out_options.m_delta_time = 1.f / fps;
+                }
+                else if (arg == "--static-props")
+                    out_options.m_synthetic_scene.m_static_prop_count = static_cast<uint32_t>(std::stoul(value));
+                else if (arg == "--dynamic-props")
+                    out_options.m_synthetic_scene.m_dynamic_prop_count = static_cast<uint32_t>(std::stoul(value));
+                else if (arg == "--characters")
+                    out_options.m_synthetic_scene.m_skinned_character_count = static_cast<uint32_t>(std::stoul(value));
+                else if (arg == "--emitters")
+                    out_options.m_synthetic_scene.m_particle_emitter_count = static_cast<uint32_t>(std::stoul(value));
+                else
+                    return false;
+            }
+            catch (const std::exception&)
+            {
+                return false;
+            }
+        }
+
+        return out_options.m_frame_count > 0 && (out_options.m_world_url.empty() || out_options.m_level_url.empty());
+    }
+
+    bool loadBenchmarkWorld(const BenchmarkOptions& options)
+    {
+        using namespace Piccolo;
+
+        std::shared_ptr<WorldManager> world_manager = g_runtime_global_context.m_world_manager;
+        if (!options.m_level_url.empty())
+        {
+            WorldRes world_res;
+            world_res.m_name              = "Benchmark";
+            world_res.m_level_urls        = {options.m_level_url};
+            world_res.m_default_level_url = options.m_level_url;
+            return world_manager->loadWorld(world_res);
+        }
+
+        const std::string& world_url = options.m_world_url.empty() ?
+                                           g_runtime_global_context.m_config_manager->getDefaultWorldUrl() :
+                                           options.m_world_url;
+        return world_manager->loadWorld(world_url);
+    }
+
+    // the math kernels need none of the engine systems
+    int runMathBenchmark(const BenchmarkOptions& options)
+    {
+        using namespace Piccolo;
+
+        MathBenchmark math_benchmark;
+        math_benchmark.run(4096, 1000);
+        math_benchmark.writeCsv(std::cout);
+
+        if (!options.m_output_path.empty())
+        {
+            std::ofstream output_file(options.m_output_path, std::ios::out | std::ios::trunc);
+            math_benchmark.writeCsv(output_file);
+            if (!output_file.good())
+            {
+                std::cerr << "failed to write " << options.m_output_path << std::endl;
+                return 1;
+            }
+        }
+
+        if (!math_benchmark.isBitExact())
+        {
+            std::cerr << "SIMD math differs from the scalar reference" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    using namespace Piccolo;
+
+    BenchmarkOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    if (options.m_is_math_benchmark)
+    {
+        return runMathBenchmark(options);
+    }
+
+    if (options.m_config_file_path.empty())
+    {
+        std::filesystem::path executable_path(argv[0]);
+        options.m_config_file_path = (executable_path.parent_path() / "PiccoloBenchmark.ini").generic_string();
+    }
+
+    // without --render only the logic systems run, culling and pass recording are reported as zero
+    g_is_headless_mode = !options.m_is_render_enabled;
+
+    PiccoloEngine* engine = new PiccoloEngine();
+    engine->startEngine(options.m_config_file_path);
+    engine->initialize();
+
+    int exit_code = 0;
+    if (!loadBenchmarkWorld(options))
+    {
+        LOG_ERROR("benchmark failed to load the world");
+        exit_code = 1;
+    }
+
+    std::shared_ptr<Level> level = g_runtime_global_context.m_world_manager->getCurrentActiveLevel().lock();
+    if (exit_code == 0 && !options.m_synthetic_scene.isEmpty())
+    {
+        std::vector<ObjectInstanceRes> synthetic_objects;
+        generateSyntheticScene(options.m_synthetic_scene, synthetic_objects);
+        level->createObjects(synthetic_objects);
+        LOG_INFO("benchmark added {} synthetic objects", synthetic_objects.size());
+    }
+
+    InputReplay input_replay;
+    if (exit_code == 0 && !options.m_replay_file_path.empty() && !input_replay.load(options.m_replay_file_path))
+    {
+        exit_code = 1;
+    }
+
+    if (exit_code == 0)
+    {
+        BenchmarkReport report;
+        report.setDescription("world", options.m_level_url.empty() ? options.m_world_url : options.m_level_url);
+        report.setDescription("replay", options.m_replay_file_path);
+        report.setDescription("delta_time", std::to_string(options.m_delta_time));
+        report.setDescription("mode", options.m_is_render_enabled ? "render" : "headless");
+        report.setDescription("synthetic_objects",
+                              std::to_string(options.m_synthetic_scene.m_static_prop_count) + " static, " +
+                                  std::to_string(options.m_synthetic_scene.m_dynamic_prop_count) + " dynamic, " +
+                                  std::to_string(options.m_synthetic_scene.m_skinned_character_count) +
+                                  " characters, " +
+                                  std::to_string(options.m_synthetic_scene.m_particle_emitter_count) + " emitters");
+
+        FrameStageTimings::setEnabled(true);
+
+        // replay frames count from the first warmup frame, so the recording does not depend on the warmup
+        const uint32_t total_frame_count = options.m_warmup_frame_count + options.m_frame_count;
+        for (uint32_t frame_index = 0; frame_index < total_frame_count && !engine->isQuit(); ++frame_index)
+        {
+            if (!input_replay.isEmpty())
+            {
+                input_replay.apply(frame_index);
+            }
+
+            FrameStageTimings::reset();
+
+            const std::chrono::steady_clock::time_point frame_begin = std::chrono::steady_clock::now();
+            const bool is_running                                   = engine->tickOneFrame(options.m_delta_time);
+            const std::chrono::duration<double, std::milli> frame_time =
+                std::chrono::steady_clock::now() - frame_begin;
+
+            if (frame_index >= options.m_warmup_frame_count)
+            {
+                report.addFrame(frame_time.count(), FrameStageTimings::getStageTimes());
+            }
+
+            if (!is_running)
+            {
+                break;
+            }
+        }
+
+        FrameStageTimings::setEnabled(false);
+
+        report.writeCsv(std::cout);
+        if (!options.m_output_path.empty() && !report.save(options.m_output_path))
+        {
+            exit_code = 1;
+        }
+    }
+
+    level.reset();
+
+    engine->clear();
+    engine->shutdownEngine();
+
+    return exit_code;
+}
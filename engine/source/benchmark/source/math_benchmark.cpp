@@ -0,0 +1,364 @@
+#include "benchmark/include/math_benchmark.h"
+
+#include "runtime/core/math/math_batch.h"
+#include "runtime/core/math/math_simd.h"
+#include "runtime/core/math/matrix4.h"
+#include "runtime/core/math/quaternion.h"
+#include "runtime/core/math/vector3.h"
+#include "runtime/core/math/vector4.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace Piccolo
+{
+    namespace
+    {
+        const char* getMathSIMDName()
+        {
+#if defined(PICCOLO_MATH_AVX2)
+            return "avx2";
+#elif defined(PICCOLO_MATH_SSE4)
+            return "sse4";
+#else
+            return "none";
+#endif
+        }
+
+        template<typename T>
+        bool isSameBits(const std::vector<T>& lhs, const std::vector<T>& rhs)
+        {
+            return lhs.size() == rhs.size() && std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(T)) == 0;
+        }
+
+        // nanoseconds per input, a pass runs the kernel over all inputs
+        template<typename Pass>
+        double measurePass(Pass&& pass, uint32_t input_count, uint32_t repeat_count)
+        {
+            using namespace std::chrono;
+
+            pass(); // warm up the caches
+
+            const steady_clock::time_point begin_time = steady_clock::now();
+            for (uint32_t repeat_index = 0; repeat_index < repeat_count; ++repeat_index)
+            {
+                pass();
+            }
+            const duration<double, std::nano> time = steady_clock::now() - begin_time;
+
+            return time.count() / (static_cast<double>(input_count) * repeat_count);
+        }
+
+        template<typename T, typename Kernel>
+        MathBenchmark::Result
+        measureKernel(const char* name, uint32_t input_count, uint32_t repeat_count, Kernel&& kernel)
+        {
+            std::vector<T> outputs(input_count);
+
+            MathBenchmark::Result result;
+            result.m_name    = name;
+            result.m_time_ns = measurePass(
+                [&]() {
+                    for (uint32_t input_index = 0; input_index < input_count; ++input_index)
+                    {
+                        outputs[input_index] = kernel(input_index);
+                    }
+                },
+                input_count,
+                repeat_count);
+            return result;
+        }
+
+        template<typename T, typename Kernel, typename ScalarKernel>
+        MathBenchmark::Result measureKernel(const char*    name,
+                                            uint32_t       input_count,
+                                            uint32_t       repeat_count,
+                                            Kernel&&       kernel,
+                                            ScalarKernel&& scalar_kernel)
+        {
+            std::vector<T> outputs(input_count);
+            std::vector<T> scalar_outputs(input_count);
+
+            MathBenchmark::Result result;
+            result.m_name    = name;
+            result.m_time_ns = measurePass(
+                [&]() {
+                    for (uint32_t input_index = 0; input_index < input_count; ++input_index)
+                    {
+                        outputs[input_index] = kernel(input_index);
+                    }
+                },
+                input_count,
+                repeat_count);
+            result.m_scalar_time_ns = measurePass(
+                [&]() {
+                    for (uint32_t input_index = 0; input_index < input_count; ++input_index)
+                    {
+                        scalar_outputs[input_index] = scalar_kernel(input_index);
+                    }
+                },
+                input_count,
+                repeat_count);
+            result.m_has_scalar_reference = true;
+            result.m_is_bit_exact         = isSameBits(outputs, scalar_outputs);
+            return result;
+        }
+
+        // a batch kernel fills all outputs in one call, its scalar reference is called per input
+        template<typename T, typename BatchKernel, typename ScalarKernel>
+        MathBenchmark::Result measureBatchKernel(const char*    name,
+                                                 uint32_t       input_count,
+                                                 uint32_t       repeat_count,
+                                                 BatchKernel&&  batch_kernel,
+                                                 ScalarKernel&& scalar_kernel)
+        {
+            std::vector<T> outputs(input_count);
+            std::vector<T> scalar_outputs(input_count);
+
+            MathBenchmark::Result result;
+            result.m_name           = name;
+            result.m_time_ns        = measurePass([&]() { batch_kernel(outputs.data()); }, input_count, repeat_count);
+            result.m_scalar_time_ns = measurePass(
+                [&]() {
+                    for (uint32_t input_index = 0; input_index < input_count; ++input_index)
+                    {
+                        scalar_outputs[input_index] = scalar_kernel(input_index);
+                    }
+                },
+                input_count,
+                repeat_count);
+            result.m_has_scalar_reference = true;
+            result.m_is_bit_exact         = isSameBits(outputs, scalar_outputs);
+            return result;
+        }
+
+        struct Bounds
+        {
+            Vector3 min_corner {Vector3::ZERO};
+            Vector3 max_corner {Vector3::ZERO};
+        };
+
+        struct Decomposition
+        {
+            Vector3    position;
+            Vector3    scale;
+            Quaternion orientation;
+        };
+    } // namespace
+
+    void MathBenchmark::run(uint32_t input_count, uint32_t repeat_count)
+    {
+        m_results.clear();
+
+        // fixed seed, every run measures the same inputs
+        std::mt19937                          random_engine(5489u);
+        std::uniform_real_distribution<float> distribution(-10.f, 10.f);
+
+        auto randomFloat      = [&]() { return distribution(random_engine); };
+        auto randomQuaternion = [&]() {
+            Quaternion quaternion(randomFloat(), randomFloat(), randomFloat(), randomFloat());
+            quaternion.normalise();
+            return quaternion;
+        };
+
+        // transforms as the scene has them, and general matrices with projective rows
+        std::vector<Matrix4x4>  transforms(input_count);
+        std::vector<Matrix4x4>  matrices(input_count);
+        std::vector<Quaternion> lhs_quaternions(input_count);
+        std::vector<Quaternion> rhs_quaternions(input_count);
+        std::vector<Vector3>    points(input_count);
+        std::vector<Vector4>    vectors(input_count);
+        for (uint32_t input_index = 0; input_index < input_count; ++input_index)
+        {
+            const Vector3 position(randomFloat(), randomFloat(), randomFloat());
+            const Vector3 scale(std::abs(randomFloat()) + 0.1f, std::abs(randomFloat()) + 0.1f, 1.0f);
+            transforms[input_index].makeTransform(position, scale, randomQuaternion());
+
+            for (uint32_t element_index = 0; element_index < 16; ++element_index)
+            {
+                matrices[input_index].m_mat[element_index / 4][element_index % 4] = randomFloat();
+            }
+
+            lhs_quaternions[input_index] = randomQuaternion();
+            rhs_quaternions[input_index] = randomQuaternion();
+            points[input_index]          = Vector3(randomFloat(), randomFloat(), randomFloat());
+            vectors[input_index]         = Vector4(randomFloat(), randomFloat(), randomFloat(), 1.0f);
+        }
+
+        m_results.push_back(measureKernel<Matrix4x4>(
+            "matrix_multiply",
+            input_count,
+            repeat_count,
+            [&](uint32_t index) { return transforms[index] * matrices[index]; },
+            [&](uint32_t index) { return transforms[index].concatenateScalar(matrices[index]); }));
+
+        m_results.push_back(measureKernel<Matrix4x4>(
+            "matrix_inverse",
+            input_count,
+            repeat_count,
+            [&](uint32_t index) { return matrices[index].inverse(); },
+            [&](uint32_t index) { return matrices[index].inverseScalar(); }));
+
+        m_results.push_back(measureKernel<Vector4>(
+            "matrix_vector4",
+            input_count,
+            repeat_count,
+            [&](uint32_t index) { return matrices[index] * vectors[index]; },
+            [&](uint32_t index) { return matrices[index].transformScalar(vectors[index]); }));
+
+        // the point array of a mesh or of bounding box corners through one transform
+        const Matrix4x4& point_transform = transforms[0];
+        m_results.push_back(measureKernel<Vector3>(
+            "transform_points",
+            input_count,
+            repeat_count,
+            [&](uint32_t index) { return point_transform * points[index]; },
+            [&](uint32_t index) { return point_transform.transformScalar(points[index]); }));
+
+        m_results.push_back(measureKernel<Quaternion>(
+            "quaternion_multiply",
+            input_count,
+            repeat_count,
+            [&](uint32_t index) { return lhs_quaternions[index] * rhs_quaternions[index]; },
+            [&](uint32_t index) { return lhs_quaternions[index].concatenateScalar(rhs_quaternions[index]); }));
+
+        m_results.push_back(measureBatchKernel<Vector3>(
+            "batch_transform_points",
+            input_count,
+            repeat_count,
+            [&](Vector3* outputs) { MathBatch::transformPoints(point_transform, points.data(), outputs, input_count); },
+            [&](uint32_t index) { return point_transform.transformScalar(points[index]); }));
+
+        m_results.push_back(measureBatchKernel<Vector4>(
+            "batch_transform_vectors",
+            input_count,
+            repeat_count,
+            [&](Vector4* outputs) { MathBatch::transformVectors(transforms[0], vectors.data(), outputs, input_count); },
+            [&](uint32_t index) { return transforms[0].transformScalar(vectors[index]); }));
+
+        m_results.push_back(measureBatchKernel<Matrix4x4>(
+            "batch_matrix_multiply",
+            input_count,
+            repeat_count,
+            [&](Matrix4x4* outputs) {
+                MathBatch::multiplyMatrices(transforms.data(), matrices.data(), outputs, input_count);
+            },
+            [&](uint32_t index) { return transforms[index].concatenateScalar(matrices[index]); }));
+
+        // the scaled quaternions are copied before they are normalised in place
+        std::vector<Quaternion> scaled_quaternions(input_count);
+        for (uint32_t input_index = 0; input_index < input_count; ++input_index)
+        {
+            scaled_quaternions[input_index] = lhs_quaternions[input_index] * randomFloat();
+        }
+        m_results.push_back(measureBatchKernel<Quaternion>(
+            "batch_quaternion_normalise",
+            input_count,
+            repeat_count,
+            [&](Quaternion* outputs) {
+                std::copy(scaled_quaternions.begin(), scaled_quaternions.end(), outputs);
+                MathBatch::normaliseQuaternions(outputs, input_count);
+            },
+            [&](uint32_t index) {
+                Quaternion quaternion = scaled_quaternions[index];
+                quaternion.normalise();
+                return quaternion;
+            }));
+
+        m_results.push_back(measureBatchKernel<Quaternion>(
+            "batch_quaternion_nlerp",
+            input_count,
+            repeat_count,
+            [&](Quaternion* outputs) {
+                MathBatch::nLerpQuaternions(
+                    0.3f, lhs_quaternions.data(), rhs_quaternions.data(), outputs, input_count, true);
+            },
+            [&](uint32_t index) {
+                return Quaternion::nLerp(0.3f, lhs_quaternions[index], rhs_quaternions[index], true);
+            }));
+
+        m_results.push_back(measureBatchKernel<Quaternion>(
+            "batch_quaternion_slerp",
+            input_count,
+            repeat_count,
+            [&](Quaternion* outputs) {
+                MathBatch::sLerpQuaternions(
+                    0.3f, lhs_quaternions.data(), rhs_quaternions.data(), outputs, input_count, true);
+            },
+            [&](uint32_t index) {
+                return Quaternion::sLerp(0.3f, lhs_quaternions[index], rhs_quaternions[index], true);
+            }));
+
+        // one box over all points, per point merges against one computeBounds call
+        {
+            Bounds bounds;
+            Bounds scalar_bounds;
+
+            Result result;
+            result.m_name    = "batch_bounds";
+            result.m_time_ns = measurePass(
+                [&]() {
+                    bounds = Bounds {points[0], points[0]};
+                    MathBatch::computeBounds(points.data(), input_count, bounds.min_corner, bounds.max_corner);
+                },
+                input_count,
+                repeat_count);
+            result.m_scalar_time_ns = measurePass(
+                [&]() {
+                    scalar_bounds = Bounds {points[0], points[0]};
+                    for (const Vector3& point : points)
+                    {
+                        scalar_bounds.min_corner.makeFloor(point);
+                        scalar_bounds.max_corner.makeCeil(point);
+                    }
+                },
+                input_count,
+                repeat_count);
+            result.m_has_scalar_reference = true;
+            result.m_is_bit_exact         = std::memcmp(&bounds, &scalar_bounds, sizeof(Bounds)) == 0;
+            m_results.push_back(result);
+        }
+
+        // scalar only, it is dominated by the Matrix3x3 QDU decomposition
+        m_results.push_back(
+            measureKernel<Decomposition>("matrix_decomposition", input_count, repeat_count, [&](uint32_t index) {
+                Decomposition decomposition;
+                transforms[index].decomposition(
+                    decomposition.position, decomposition.scale, decomposition.orientation);
+                return decomposition;
+            }));
+    }
+
+    bool MathBenchmark::isBitExact() const
+    {
+        for (const Result& result : m_results)
+        {
+            if (!result.m_is_bit_exact)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void MathBenchmark::writeCsv(std::ostream& stream) const
+    {
+        stream << "kernel,simd,ns,scalar_ns,speedup,bit_exact\n";
+        for (const Result& result : m_results)
+        {
+            stream << result.m_name << ',' << getMathSIMDName() << ',' << result.m_time_ns << ',';
+            if (result.m_has_scalar_reference)
+            {
+                stream << result.m_scalar_time_ns << ',' << result.m_scalar_time_ns / result.m_time_ns << ','
+                       << (result.m_is_bit_exact ? "yes" : "no") << '\n';
+            }
+            else
+            {
+                stream << ",,\n";
+            }
+        }
+    }
+} // namespace Piccolo
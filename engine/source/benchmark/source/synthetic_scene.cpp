@@ -0,0 +1,118 @@
+#include "benchmark/include/synthetic_scene.h"
+
+#include "runtime/core/math/vector3.h"
+#include "runtime/core/meta/serializer/serializer.h"
+
+#include "runtime/resource/res_type/common/object.h"
+
+#include "_generated/serializer/all_serializer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Piccolo
+{
+    namespace
+    {
+        Json makeVector3(const Vector3& value)
+        {
+            return Json::object {{"x", value.x}, {"y", value.y}, {"z", value.z}};
+        }
+
+        Json makeTransformComponent(const Vector3& position)
+        {
+            const Json transform = Json::object {{"position", makeVector3(position)},
+                                                 {"rotation", Json::object {{"w", 1}, {"x", 0}, {"y", 0}, {"z", 0}}},
+                                                 {"scale", makeVector3(Vector3::UNIT_SCALE)}};
+            return Json::object {{"$typeName", "TransformComponent"},
+                                 {"$context", Json::object {{"transform", transform}}}};
+        }
+
+        Json makeDynamicBoxRigidBodyComponent(const Vector3& half_extents)
+        {
+            const Json box   = Json::object {{"$typeName", "Box"},
+                                             {"$context", Json::object {{"half_extents", makeVector3(half_extents)}}}};
+            const Json shape = Json::object {
+                {"geometry", box},
+                {"local_transform",
+                 Json::object {{"position", makeVector3(Vector3(0.f, 0.f, half_extents.z))},
+                               {"rotation", Json::object {{"w", 1}, {"x", 0}, {"y", 0}, {"z", 0}}},
+                               {"scale", makeVector3(Vector3::UNIT_SCALE)}}}};
+            const Json rigidbody_res =
+                Json::object {{"actor_type", 2}, {"inverse_mass", 1}, {"shapes", Json::array {shape}}};
+            return Json::object {{"$typeName", "RigidBodyComponent"},
+                                 {"$context", Json::object {{"rigidbody_res", rigidbody_res}}}};
+        }
+
+        class GridLayout
+        {
+        public:
+            GridLayout(uint32_t object_count, float spacing) : m_spacing(spacing)
+            {
+                const float side_count = std::ceil(std::sqrt(static_cast<float>(object_count)));
+                m_side_count           = std::max(1u, static_cast<uint32_t>(side_count));
+            }
+
+            Vector3 getPosition(uint32_t object_index) const
+            {
+                const float half_side = 0.5f * static_cast<float>(m_side_count - 1) * m_spacing;
+                return Vector3(static_cast<float>(object_index % m_side_count) * m_spacing - half_side,
+                               static_cast<float>(object_index / m_side_count) * m_spacing - half_side,
+                               0.f);
+            }
+
+        private:
+            uint32_t m_side_count {1};
+            float    m_spacing {1.f};
+        };
+    } // namespace
+
+    void generateSyntheticScene(const SyntheticSceneConfig& config, std::vector<ObjectInstanceRes>& out_objects)
+    {
+        const uint32_t object_count = config.m_static_prop_count + config.m_dynamic_prop_count +
+                                      config.m_skinned_character_count + config.m_particle_emitter_count;
+
+        // all kinds share one grid, so they are spread over the same area
+        const GridLayout layout(object_count, config.m_grid_spacing);
+
+        out_objects.reserve(out_objects.size() + object_count);
+
+        uint32_t object_index = 0;
+        auto add_objects = [&](uint32_t           count,
+                               const char*        name_prefix,
+                               const std::string& definition_url,
+                               bool               is_dynamic) {
+            for (uint32_t index = 0; index < count; ++index, ++object_index)
+            {
+                Vector3 position = layout.getPosition(object_index);
+
+                if (is_dynamic)
+                {
+                    position.z = 2.f;
+                }
+
+                // the rigidbody is created from the transform when it is loaded, so the transform comes first
+                Json::array components;
+                components.push_back(makeTransformComponent(position));
+                if (is_dynamic)
+                {
+                    components.push_back(makeDynamicBoxRigidBodyComponent(Vector3(0.5f, 0.5f, 0.5f)));
+                }
+
+                const Json object_json =
+                    Json::object {{"name", std::string(name_prefix) + std::to_string(index)},
+                                  {"definition", definition_url},
+                                  {"instanced_components", components}};
+
+                out_objects.emplace_back();
+                Serializer::read(object_json, out_objects.back());
+            }
+        };
+
+        add_objects(config.m_static_prop_count, "SyntheticStaticProp_", config.m_prop_definition_url, false);
+        add_objects(config.m_dynamic_prop_count, "SyntheticDynamicProp_", config.m_prop_definition_url, true);
+        add_objects(
+            config.m_skinned_character_count, "SyntheticCharacter_", config.m_character_definition_url, false);
+        add_objects(config.m_particle_emitter_count, "SyntheticEmitter_", config.m_emitter_definition_url, false);
+    }
+} // namespace Piccolo
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "runtime/platform/file_service/file_watcher.h"
+
+#include <cstddef>
+#include <filesystem>
 #include <memory>
 #include <string>
 #include <vector>
@@ -24,16 +28,21 @@ namespace Piccolo
 
     class EditorFileService
     {
-        EditorFileNodeArray m_file_node_array;
-        EditorFileNode      m_root_node{ "asset", "Folder", "asset", -1 };
+        std::filesystem::path           m_asset_folder;
+        std::shared_ptr<EditorFileNode> m_root_node;
+        size_t                          m_file_change_subscription {0};
 
     private:
-        EditorFileNode* getParentNodePtr(EditorFileNode* file_node);
-        bool            checkFileArray(EditorFileNode* file_node);
+        void onFileChanged(const FileChangeEvent& event);
+        void addFileNode(const std::filesystem::path& file_path);
+        void removeFileNode(const std::filesystem::path& file_path);
 
     public:
-        EditorFileNode* getEditorRootNode() { return m_file_node_array.empty() ? nullptr : m_file_node_array[0].get(); }
+        ~EditorFileService();
+
+        EditorFileNode* getEditorRootNode() { return m_root_node.get(); }
 
+        /// build the tree of the asset folder, the changes of the files update it from then on
         void buildEngineFileTree();
     };
 } // namespace Piccolo
@@ -9,7 +9,6 @@
 
 #include "editor/include/editor_file_service.h"
 
-#include <chrono>
 #include <map>
 #include <vector>
 
@@ -38,6 +37,9 @@ namespace Piccolo
         void showEditorFileContentWindow(bool* p_open);
         void showEditorGameWindow(bool* p_open);
         void showEditorDetailWindow(bool* p_open);
+#ifdef ENABLE_PROFILER
+        void showEditorProfilerWindow(bool* p_open);
+#endif
 
         void setUIColorStyle();
 
@@ -49,7 +51,6 @@ namespace Piccolo
         std::unordered_map<std::string, std::function<void(std::string, void*)>> m_editor_ui_creator;
         std::unordered_map<std::string, unsigned int>                            m_new_object_index_map;
         EditorFileService                                                        m_editor_file_service;
-        std::chrono::time_point<std::chrono::steady_clock>                       m_last_file_tree_update;
 
         bool m_editor_menu_window_open       = true;
         bool m_asset_window_open             = true;
@@ -58,5 +59,8 @@ namespace Piccolo
         bool m_detail_window_open            = true;
         bool m_scene_lights_window_open      = true;
         bool m_scene_lights_data_window_open = true;
+        bool m_profiler_window_open          = false;
+
+        std::string m_last_profile_trace_path;
     };
 } // namespace Piccolo
@@ -8,6 +8,8 @@
 
 #include "runtime/function/global/global_context.h"
 
+#include <algorithm>
+
 namespace Piccolo
 {
     /// helper function: split the input string with separator, and filter the substring
@@ -43,100 +45,155 @@ namespace Piccolo
         return output_string;
     }
 
-    void EditorFileService::buildEngineFileTree()
+    namespace
     {
-        std::string                              asset_folder = g_runtime_global_context.m_config_manager->getAssetFolder().generic_string();
-        const std::vector<std::filesystem::path> file_paths = g_runtime_global_context.m_file_system->getFiles(asset_folder);
-        std::vector<std::vector<std::string>>    all_file_segments;
-        for (const auto& path : file_paths)
+        std::shared_ptr<EditorFileNode>* findChildNode(EditorFileNode* node, const std::string& name)
         {
-            const std::filesystem::path& relative_path = Path::getRelativePath(asset_folder, path);
-            all_file_segments.emplace_back(Path::getPathSegments(relative_path));
+            for (std::shared_ptr<EditorFileNode>& child_node : node->m_child_nodes)
+            {
+                if (child_node->m_file_name == name)
+                {
+                    return &child_node;
+                }
+            }
+            return nullptr;
         }
 
-        std::vector<std::shared_ptr<EditorFileNode>> node_array;
-
-        m_file_node_array.clear();
-        auto root_node = std::make_shared<EditorFileNode>();
-        *root_node     = m_root_node;
-        m_file_node_array.push_back(root_node);
-
-        int all_file_segments_count = all_file_segments.size();
-        for (int file_index = 0; file_index < all_file_segments_count; file_index++)
+        /// the type shown in the editor, e.g. png, or object for .object.json, empty for files without extension
+        std::string getFileType(const std::filesystem::path& file_path)
         {
-            int depth = 0;
-            node_array.clear();
-            node_array.push_back(root_node);
-            int file_segment_count = all_file_segments[file_index].size();
-            for (int file_segment_index = 0; file_segment_index < file_segment_count; file_segment_index++)
+            const auto& extensions = Path::getFileExtensions(file_path);
+            std::string file_type  = std::get<0>(extensions);
+            if (file_type == ".json" && !std::get<1>(extensions).empty())
             {
-                auto file_node         = std::make_shared<EditorFileNode>();
-                file_node->m_file_name = all_file_segments[file_index][file_segment_index];
-                if (depth < file_segment_count - 1)
-                {
-                    file_node->m_file_type = "Folder";
-                }
-                else
+                file_type = std::get<1>(extensions);
+                if (file_type == ".component")
                 {
-                    const auto& extensions = Path::getFileExtensions(file_paths[file_index]);
-                    file_node->m_file_type = std::get<0>(extensions);
-                    if (file_node->m_file_type.size() == 0)
-                        continue;
-
-                    if (file_node->m_file_type.compare(".json") == 0)
-                    {
-                        file_node->m_file_type = std::get<1>(extensions);
-                        if (file_node->m_file_type.compare(".component") == 0)
-                        {
-                            file_node->m_file_type = std::get<2>(extensions) + std::get<1>(extensions);
-                        }
-                    }
-                    file_node->m_file_type = file_node->m_file_type.substr(1);
-                    file_node->m_file_path = file_paths[file_index].generic_string();
+                    file_type = std::get<2>(extensions) + std::get<1>(extensions);
                 }
-                file_node->m_node_depth = depth;
-                node_array.push_back(file_node);
+            }
+            return file_type.empty() ? file_type : file_type.substr(1);
+        }
+    } // namespace
 
-                bool node_exists = checkFileArray(file_node.get());
-                if (node_exists == false)
-                {
-                    m_file_node_array.push_back(file_node);
-                }
-                EditorFileNode* parent_node_ptr = getParentNodePtr(node_array[depth].get());
-                if (parent_node_ptr != nullptr && node_exists == false)
+    EditorFileService::~EditorFileService()
+    {
+        // the editor is destroyed after the runtime systems
+        if (m_file_change_subscription != 0 && g_runtime_global_context.m_file_system)
+        {
+            g_runtime_global_context.m_file_system->unsubscribe(m_file_change_subscription);
+        }
+    }
+
+    void EditorFileService::buildEngineFileTree()
+    {
+        // the same form as the paths of the file changes
+        m_asset_folder =
+            std::filesystem::absolute(g_runtime_global_context.m_config_manager->getAssetFolder()).lexically_normal();
+
+        m_root_node = std::make_shared<EditorFileNode>("asset", "Folder", "asset", -1);
+        for (const std::filesystem::path& file_path : g_runtime_global_context.m_file_system->getFiles(m_asset_folder))
+        {
+            addFileNode(file_path);
+        }
+
+        if (m_file_change_subscription == 0)
+        {
+            m_file_change_subscription = g_runtime_global_context.m_file_system->subscribe(
+                [this](const FileChangeEvent& event) { onFileChanged(event); });
+        }
+    }
+
+    void EditorFileService::onFileChanged(const FileChangeEvent& event)
+    {
+        if (!m_root_node)
+        {
+            return;
+        }
+
+        switch (event.m_type)
+        {
+            case FileChangeType::added:
+                // a folder shows up with its first file, the files of a new folder are reported one by one
+                if (!event.m_is_directory)
                 {
-                    parent_node_ptr->m_child_nodes.push_back(file_node);
+                    addFileNode(event.m_path);
                 }
-                depth++;
-            }
+                break;
+            case FileChangeType::removed:
+                removeFileNode(event.m_path);
+                break;
+            case FileChangeType::modified:
+                // the tree holds no file content
+                break;
         }
     }
 
-    bool EditorFileService::checkFileArray(EditorFileNode* file_node)
+    void EditorFileService::addFileNode(const std::filesystem::path& file_path)
     {
-        int editor_node_count = m_file_node_array.size();
-        for (int file_node_index = 0; file_node_index < editor_node_count; file_node_index++)
+        const std::vector<std::string> file_segments =
+            Path::getPathSegments(Path::getRelativePath(m_asset_folder, file_path));
+        const std::string file_type = getFileType(file_path);
+        if (file_segments.empty() || file_segments[0] == ".." || file_type.empty())
         {
-            if (m_file_node_array[file_node_index]->m_file_name == file_node->m_file_name &&
-                m_file_node_array[file_node_index]->m_node_depth == file_node->m_node_depth)
+            return;
+        }
+
+        EditorFileNode* parent_node = m_root_node.get();
+        for (size_t segment_index = 0; segment_index + 1 < file_segments.size(); ++segment_index)
+        {
+            std::shared_ptr<EditorFileNode>* folder_node = findChildNode(parent_node, file_segments[segment_index]);
+            if (folder_node == nullptr)
             {
-                return true;
+                parent_node->m_child_nodes.push_back(std::make_shared<EditorFileNode>(
+                    file_segments[segment_index], "Folder", "", static_cast<int>(segment_index)));
+                folder_node = &parent_node->m_child_nodes.back();
             }
+            parent_node = folder_node->get();
+        }
+
+        // a file written again is still in the tree
+        if (findChildNode(parent_node, file_segments.back()) == nullptr)
+        {
+            const int file_depth = static_cast<int>(file_segments.size()) - 1;
+            parent_node->m_child_nodes.push_back(std::make_shared<EditorFileNode>(
+                file_segments.back(), file_type, file_path.generic_string(), file_depth));
         }
-        return false;
     }
 
-    EditorFileNode* EditorFileService::getParentNodePtr(EditorFileNode* file_node)
+    void EditorFileService::removeFileNode(const std::filesystem::path& file_path)
     {
-        int editor_node_count = m_file_node_array.size();
-        for (int file_node_index = 0; file_node_index < editor_node_count; file_node_index++)
+        const std::vector<std::string> file_segments =
+            Path::getPathSegments(Path::getRelativePath(m_asset_folder, file_path));
+        if (file_segments.empty() || file_segments[0] == "..")
+        {
+            return;
+        }
+
+        std::vector<EditorFileNode*> node_path {m_root_node.get()};
+        for (const std::string& file_segment : file_segments)
+        {
+            std::shared_ptr<EditorFileNode>* child_node = findChildNode(node_path.back(), file_segment);
+            if (child_node == nullptr)
+            {
+                return;
+            }
+            node_path.push_back(child_node->get());
+        }
+
+        // remove the node with its subtree, and the folders left without files
+        for (size_t node_index = node_path.size() - 1; node_index > 0; --node_index)
         {
-            if (m_file_node_array[file_node_index]->m_file_name == file_node->m_file_name &&
-                m_file_node_array[file_node_index]->m_node_depth == file_node->m_node_depth)
+            EditorFileNodeArray& sibling_nodes = node_path[node_index - 1]->m_child_nodes;
+            sibling_nodes.erase(std::find_if(sibling_nodes.begin(),
+                                             sibling_nodes.end(),
+                                             [removed_node = node_path[node_index]](const auto& sibling_node) {
+                                                 return sibling_node.get() == removed_node;
+                                             }));
+            if (!sibling_nodes.empty())
             {
-                return m_file_node_array[file_node_index].get();
+                break;
             }
         }
-        return nullptr;
     }
 } // namespace Piccolo
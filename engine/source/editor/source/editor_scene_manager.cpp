@@ -290,10 +290,8 @@ namespace Piccolo
             if (current_active_level == nullptr)
                 return;
 
+            // the level also removes the render entities of the object
             current_active_level->deleteGObjectByID(m_selected_gobject_id);
-
-            RenderSwapContext& swap_context = g_editor_global_context.m_render_system->getSwapContext();
-            swap_context.getLogicSwapData().addDeleteGameObject(GameObjectDesc {selected_object->getID(), {}});
         }
         onGObjectSelected(k_invalid_gobject_id);
     }
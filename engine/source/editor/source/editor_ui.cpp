@@ -6,6 +6,7 @@
 
 #include "runtime/core/base/macro.h"
 #include "runtime/core/meta/reflection/reflection.h"
+#include "runtime/core/profile/profiler.h"
 
 #include "runtime/platform/path/path.h"
 
@@ -20,10 +21,12 @@
 #include "runtime/function/framework/world/world_manager.h"
 #include "runtime/function/global/global_context.h"
 #include "runtime/function/input/input_system.h"
+#include "runtime/function/render/interface/rhi.h"
 #include "runtime/function/render/render_camera.h"
 #include "runtime/function/render/render_system.h"
 #include "runtime/function/render/window_system.h"
 #include "runtime/function/render/render_debug_config.h"
+#include "runtime/function/script/lua_script_manager.h"
 
 #include <imgui.h>
 #include <imgui_internal.h>
@@ -272,6 +275,9 @@ namespace Piccolo
         showEditorGameWindow(&m_game_engine_window_open);
         showEditorFileContentWindow(&m_file_content_window_open);
         showEditorDetailWindow(&m_detail_window_open);
+#ifdef ENABLE_PROFILER
+        showEditorProfilerWindow(&m_profiler_window_open);
+#endif
     }
 
     void EditorUI::showEditorMenu(bool* p_open)
@@ -382,6 +388,9 @@ namespace Piccolo
                 ImGui::MenuItem("Game", nullptr, &m_game_engine_window_open);
                 ImGui::MenuItem("File Content", nullptr, &m_file_content_window_open);
                 ImGui::MenuItem("Detail", nullptr, &m_detail_window_open);
+#ifdef ENABLE_PROFILER
+                ImGui::MenuItem("Profiler", nullptr, &m_profiler_window_open);
+#endif
                 ImGui::EndMenu();
             }
             ImGui::EndMenuBar();
@@ -452,12 +461,8 @@ namespace Piccolo
 
     void EditorUI::createLeafNodeUI(Reflection::ReflectionInstance& instance)
     {
-        Reflection::FieldAccessor* fields;
-        int                        fields_count = instance.m_meta.getFieldsList(fields);
-
-        for (size_t index = 0; index < fields_count; index++)
+        for (const Reflection::FieldAccessor& field : instance.m_meta.getFields())
         {
-            auto field = fields[index];
             if (field.isArrayType())
             {
                 Reflection::ArrayAccessor array_accessor;
@@ -476,8 +481,7 @@ namespace Piccolo
                         {
                             m_editor_ui_creator["TreeNodePush"]("[" + std::to_string(index) + "]", nullptr);
                             auto object_instance = Reflection::ReflectionInstance(
-                                Piccolo::Reflection::TypeMeta::newMetaFromName(item_type_meta_item.getTypeName().c_str()),
-                                array_accessor.get(index, field_instance));
+                                item_type_meta_item, array_accessor.get(index, field_instance));
                             createClassUI(object_instance);
                             m_editor_ui_creator["TreeNodePop"]("[" + std::to_string(index) + "]", nullptr);
                         }
@@ -523,7 +527,6 @@ namespace Piccolo
                                                                      field.get(instance.m_instance));
             }
         }
-        delete[] fields;
     }
 
     void EditorUI::showEditorDetailWindow(bool* p_open)
@@ -596,13 +599,11 @@ namespace Piccolo
             ImGui::TableSetupColumn("Type", ImGuiTableColumnFlags_WidthFixed);
             ImGui::TableHeadersRow();
 
-            auto current_time = std::chrono::steady_clock::now();
-            if (current_time - m_last_file_tree_update > std::chrono::seconds(1))
+            // built once, the file changes keep it up to date
+            if (m_editor_file_service.getEditorRootNode() == nullptr)
             {
                 m_editor_file_service.buildEngineFileTree();
-                m_last_file_tree_update = current_time;
             }
-            m_last_file_tree_update = current_time;
 
             EditorFileNode* editor_root_node = m_editor_file_service.getEditorRootNode();
             buildEditorFileAssetsUITree(editor_root_node);
@@ -766,6 +767,132 @@ namespace Piccolo
         ImGui::End();
     }
 
+#ifdef ENABLE_PROFILER
+    void EditorUI::showEditorProfilerWindow(bool* p_open)
+    {
+        if (!*p_open)
+            return;
+
+        if (!ImGui::Begin("Profiler", p_open, ImGuiWindowFlags_None))
+        {
+            ImGui::End();
+            return;
+        }
+
+        const float last_frame_time = Profiler::getLastFrameTime();
+        ImGui::Text("frame %.2f ms (%.0f fps)", last_frame_time, last_frame_time > 0.f ? 1000.f / last_frame_time : 0.f);
+        ImGui::PlotLines("##frame_times",
+                         Profiler::getFrameTimeHistory(),
+                         Profiler::s_frame_time_history_size,
+                         Profiler::getFrameTimeHistoryOffset(),
+                         nullptr,
+                         0.f,
+                         FLT_MAX,
+                         ImVec2(ImGui::GetContentRegionAvail().x, 60.f));
+
+        if (Profiler::isCapturing())
+        {
+            if (ImGui::Button("Stop Capture"))
+            {
+                const std::filesystem::path trace_path =
+                    g_runtime_global_context.m_config_manager->getRootFolder() / "piccolo_trace.json";
+                m_last_profile_trace_path = trace_path.generic_string();
+                if (!Profiler::endCapture(m_last_profile_trace_path))
+                {
+                    LOG_ERROR("failed to write profile trace {}", m_last_profile_trace_path);
+                    m_last_profile_trace_path.clear();
+                }
+            }
+        }
+        else if (ImGui::Button("Start Capture"))
+        {
+            Profiler::beginCapture();
+        }
+        if (!m_last_profile_trace_path.empty())
+        {
+            ImGui::SameLine();
+            ImGui::TextUnformatted(m_last_profile_trace_path.c_str());
+        }
+
+        // device memory per heap, usage against the budget the driver grants the process
+        std::vector<RHIMemoryHeapBudget> memory_budgets;
+        g_runtime_global_context.m_render_system->getRHI()->getMemoryBudgets(memory_budgets);
+        if (ImGui::CollapsingHeader("GPU Memory"))
+        {
+            for (size_t heap_index = 0; heap_index < memory_budgets.size(); ++heap_index)
+            {
+                const RHIMemoryHeapBudget& budget = memory_budgets[heap_index];
+                if (budget.budget == 0)
+                    continue;
+
+                constexpr double mib = 1024.0 * 1024.0;
+                ImGui::Text("heap %zu (%s): %.1f / %.1f MiB, %u allocations in %u blocks",
+                            heap_index,
+                            budget.is_device_local ? "device" : "host",
+                            budget.usage / mib,
+                            budget.budget / mib,
+                            budget.allocation_count,
+                            budget.block_count);
+                ImGui::ProgressBar(static_cast<float>(static_cast<double>(budget.usage) / budget.budget));
+            }
+        }
+
+        // the scripts with the longest last tick
+        if (ImGui::CollapsingHeader("Scripts") &&
+            ImGui::BeginTable("scripts", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+        {
+            std::vector<const LuaScriptStats*> slowest_scripts;
+            g_runtime_global_context.m_lua_script_manager->getSlowestScripts(16, slowest_scripts);
+
+            ImGui::TableSetupColumn("script", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("ms", ImGuiTableColumnFlags_WidthFixed, 60.f);
+            ImGui::TableSetupColumn("max ms", ImGuiTableColumnFlags_WidthFixed, 60.f);
+            ImGui::TableSetupColumn("instructions", ImGuiTableColumnFlags_WidthFixed, 90.f);
+            ImGui::TableHeadersRow();
+            for (const LuaScriptStats* stats : slowest_scripts)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(stats->m_name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", stats->m_last_time_ms);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", stats->m_max_time_ms);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(stats->m_last_instruction_count));
+            }
+            ImGui::EndTable();
+        }
+
+        // zones of the last frame, children are indented below their parents
+        for (const ProfileThreadFrame& thread_frame : Profiler::getLastFrame())
+        {
+            if (thread_frame.m_zones.empty())
+                continue;
+
+            ImGui::PushID(static_cast<int>(thread_frame.m_thread_index));
+            if (ImGui::CollapsingHeader(thread_frame.m_thread_name.c_str(), ImGuiTreeNodeFlags_DefaultOpen) &&
+                ImGui::BeginTable("zones", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+            {
+                ImGui::TableSetupColumn("zone", ImGuiTableColumnFlags_WidthStretch);
+                ImGui::TableSetupColumn("ms", ImGuiTableColumnFlags_WidthFixed, 60.f);
+                for (const ProfileZoneRecord& zone : thread_frame.m_zones)
+                {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%*s%s", static_cast<int>(zone.m_depth * 2), "", zone.m_name);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", static_cast<double>(zone.m_end_time - zone.m_begin_time) * 1e-6);
+                }
+                ImGui::EndTable();
+            }
+            ImGui::PopID();
+        }
+
+        ImGui::End();
+    }
+#endif
+
     void EditorUI::drawAxisToggleButton(const char* string_id, bool check_state, int axis_mode)
     {
         if (check_state)
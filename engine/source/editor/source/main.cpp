@@ -1,3 +1,4 @@
+#include <csignal>
 #include <filesystem>
 #include <iostream>
 #include <string>
@@ -12,13 +13,106 @@
 #define PICCOLO_XSTR(s) PICCOLO_STR(s)
 #define PICCOLO_STR(s) #s
 
+namespace
+{
+    Piccolo::PiccoloEngine* g_headless_engine = nullptr;
+
+    void onHeadlessQuitSignal(int) { g_headless_engine->requestQuit(); }
+
+    void printHeadlessUsage()
+    {
+        std::cout << "usage: PiccoloEditor --headless [--fps <frames per second>] [--fast] [--frames <count>] "
+                     "[--timing <csv file or - for stdout>]"
+                  << std::endl;
+    }
+
+    // parse the headless options, returns false on invalid arguments
+    bool parseHeadlessArguments(int argc, char** argv, bool& out_is_headless, Piccolo::HeadlessRunConfig& out_config)
+    {
+        out_is_headless = false;
+        for (int arg_index = 1; arg_index < argc; ++arg_index)
+        {
+            const std::string arg      = argv[arg_index];
+            const bool        has_next = arg_index + 1 < argc;
+            try
+            {
+                if (arg == "--headless")
+                {
+                    out_is_headless = true;
+                }
+                else if (arg == "--fast")
+                {
+                    out_config.m_is_real_time = false;
+                }
+                else if (arg == "--fps" && has_next)
+                {
+                    const float fps = std::stof(argv[++arg_index]);
+                    if (fps <= 0.f)
+                    {
+                        return false;
+                    }
+                    out_config.m_fixed_delta_time = 1.f / fps;
+                }
+                else if (arg == "--frames" && has_next)
+                {
+                    out_config.m_max_frame_count = static_cast<uint32_t>(std::stoul(argv[++arg_index]));
+                }
+                else if (arg == "--timing" && has_next)
+                {
+                    out_config.m_timing_output_path = argv[++arg_index];
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            catch (const std::exception&)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace
+
 int main(int argc, char** argv)
 {
     std::filesystem::path executable_path(argv[0]);
     std::filesystem::path config_file_path = executable_path.parent_path() / "PiccoloEditor.ini";
 
+    bool                       is_headless = false;
+    Piccolo::HeadlessRunConfig headless_config;
+    if (!parseHeadlessArguments(argc, argv, is_headless, headless_config))
+    {
+        printHeadlessUsage();
+        return 1;
+    }
+
     Piccolo::PiccoloEngine* engine = new Piccolo::PiccoloEngine();
 
+    if (is_headless)
+    {
+        // run the game logic of the default world without window, GPU or editor
+        Piccolo::g_is_headless_mode = true;
+
+        engine->startEngine(config_file_path.generic_string());
+        engine->initialize();
+
+        g_headless_engine = engine;
+        std::signal(SIGINT, onHeadlessQuitSignal);
+        std::signal(SIGTERM, onHeadlessQuitSignal);
+
+        engine->runHeadless(headless_config);
+
+        engine->clear();
+        engine->shutdownEngine();
+
+        return 0;
+    }
+
+    // assets edited while the editor runs are reloaded
+    Piccolo::g_is_asset_hot_reload_enabled = true;
+
     engine->startEngine(config_file_path.generic_string());
     engine->initialize();
 
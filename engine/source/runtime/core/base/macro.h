@@ -7,18 +7,61 @@
 #include <chrono>
 #include <thread>
 
-#define LOG_HELPER(LOG_LEVEL, ...) \
-    g_runtime_global_context.m_logger_system->log(LOG_LEVEL, "[" + std::string(__FUNCTION__) + "] " + __VA_ARGS__);
+// logs below PICCOLO_LOG_MIN_LEVEL (0 debug, 1 info, 2 warn, 3 error) are compiled out, their arguments are not
+// evaluated, logs of enabled levels are filtered at runtime by the level of their category before formatting
+#ifndef PICCOLO_LOG_MIN_LEVEL
+#define PICCOLO_LOG_MIN_LEVEL 0
+#endif
+
+#define LOG_HELPER(LOG_CATEGORY, LOG_LEVEL, ...) \
+    do \
+    { \
+        if (g_runtime_global_context.m_logger_system->isEnabled(LOG_CATEGORY, LOG_LEVEL)) \
+            g_runtime_global_context.m_logger_system->log( \
+                LOG_CATEGORY, LOG_LEVEL, "[" + std::string(__FUNCTION__) + "] " + __VA_ARGS__); \
+    } while (0)
+
+#if PICCOLO_LOG_MIN_LEVEL <= 0
+#define LOG_DEBUG_CATEGORY(CATEGORY, ...) \
+    LOG_HELPER(LogSystem::LogCategory::CATEGORY, LogSystem::LogLevel::debug, __VA_ARGS__);
+#else
+#define LOG_DEBUG_CATEGORY(CATEGORY, ...)
+#endif
+
+#if PICCOLO_LOG_MIN_LEVEL <= 1
+#define LOG_INFO_CATEGORY(CATEGORY, ...) \
+    LOG_HELPER(LogSystem::LogCategory::CATEGORY, LogSystem::LogLevel::info, __VA_ARGS__);
+#else
+#define LOG_INFO_CATEGORY(CATEGORY, ...)
+#endif
+
+#if PICCOLO_LOG_MIN_LEVEL <= 2
+#define LOG_WARN_CATEGORY(CATEGORY, ...) \
+    LOG_HELPER(LogSystem::LogCategory::CATEGORY, LogSystem::LogLevel::warn, __VA_ARGS__);
+#else
+#define LOG_WARN_CATEGORY(CATEGORY, ...)
+#endif
+
+#if PICCOLO_LOG_MIN_LEVEL <= 3
+#define LOG_ERROR_CATEGORY(CATEGORY, ...) \
+    LOG_HELPER(LogSystem::LogCategory::CATEGORY, LogSystem::LogLevel::error, __VA_ARGS__);
+#else
+#define LOG_ERROR_CATEGORY(CATEGORY, ...)
+#endif
+
+// fatal logs throw and are never compiled out
+#define LOG_FATAL_CATEGORY(CATEGORY, ...) \
+    LOG_HELPER(LogSystem::LogCategory::CATEGORY, LogSystem::LogLevel::fatal, __VA_ARGS__);
 
-#define LOG_DEBUG(...) LOG_HELPER(LogSystem::LogLevel::debug, __VA_ARGS__);
+#define LOG_DEBUG(...) LOG_DEBUG_CATEGORY(general, __VA_ARGS__)
 
-#define LOG_INFO(...) LOG_HELPER(LogSystem::LogLevel::info, __VA_ARGS__);
+#define LOG_INFO(...) LOG_INFO_CATEGORY(general, __VA_ARGS__)
 
-#define LOG_WARN(...) LOG_HELPER(LogSystem::LogLevel::warn, __VA_ARGS__);
+#define LOG_WARN(...) LOG_WARN_CATEGORY(general, __VA_ARGS__)
 
-#define LOG_ERROR(...) LOG_HELPER(LogSystem::LogLevel::error, __VA_ARGS__);
+#define LOG_ERROR(...) LOG_ERROR_CATEGORY(general, __VA_ARGS__)
 
-#define LOG_FATAL(...) LOG_HELPER(LogSystem::LogLevel::fatal, __VA_ARGS__);
+#define LOG_FATAL(...) LOG_FATAL_CATEGORY(general, __VA_ARGS__)
 
 #define PolitSleep(_ms) std::this_thread::sleep_for(std::chrono::milliseconds(_ms));
 
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace Piccolo
+{
+    /// names a value of a SlotMap, stays invalid after the value is erased even if its slot is reused
+    struct SlotMapHandle
+    {
+        static constexpr uint32_t k_invalid_index = std::numeric_limits<uint32_t>::max();
+
+        uint32_t m_index {k_invalid_index};
+        uint32_t m_generation {0};
+
+        bool isValid() const { return m_index != k_invalid_index; }
+        bool operator==(const SlotMapHandle& rhs) const
+        {
+            return m_index == rhs.m_index && m_generation == rhs.m_generation;
+        }
+        bool operator!=(const SlotMapHandle& rhs) const { return !(*this == rhs); }
+    };
+
+    /// values addressed by generational handles, with insert, lookup and erase in constant time
+    ///
+    /// the values are kept packed in one array, so iterating them touches no holes. erase moves the last value into
+    /// the hole, the order of the values is therefore not stable but the handles are. a slot freed by erase is
+    /// reused by the next insert with its generation bumped, the handles of the erased value no longer resolve
+    template<typename T>
+    class SlotMap
+    {
+    public:
+        SlotMapHandle insert(T value)
+        {
+            uint32_t slot_index;
+            if (m_free_slot_index != SlotMapHandle::k_invalid_index)
+            {
+                slot_index        = m_free_slot_index;
+                m_free_slot_index = m_slots[slot_index].m_value_index;
+            }
+            else
+            {
+                slot_index = static_cast<uint32_t>(m_slots.size());
+                m_slots.push_back({});
+            }
+
+            Slot& slot         = m_slots[slot_index];
+            slot.m_value_index = static_cast<uint32_t>(m_values.size());
+            m_values.push_back(std::move(value));
+            m_value_slot_indices.push_back(slot_index);
+
+            return {slot_index, slot.m_generation};
+        }
+
+        bool erase(SlotMapHandle handle)
+        {
+            if (!contains(handle))
+            {
+                return false;
+            }
+
+            Slot&          slot             = m_slots[handle.m_index];
+            const uint32_t value_index      = slot.m_value_index;
+            const uint32_t last_value_index = static_cast<uint32_t>(m_values.size()) - 1;
+            if (value_index != last_value_index)
+            {
+                const uint32_t moved_slot_index = m_value_slot_indices[last_value_index];
+
+                m_values[value_index]                   = std::move(m_values[last_value_index]);
+                m_value_slot_indices[value_index]       = moved_slot_index;
+                m_slots[moved_slot_index].m_value_index = value_index;
+            }
+            m_values.pop_back();
+            m_value_slot_indices.pop_back();
+
+            ++slot.m_generation;
+            slot.m_value_index = m_free_slot_index;
+            m_free_slot_index  = handle.m_index;
+            return true;
+        }
+
+        // a slot is bumped when it is freed, so a free slot never has the generation of a handle
+        bool contains(SlotMapHandle handle) const
+        {
+            return handle.m_index < m_slots.size() && m_slots[handle.m_index].m_generation == handle.m_generation;
+        }
+
+        /// nullptr if the value of the handle was erased
+        T* get(SlotMapHandle handle)
+        {
+            return contains(handle) ? &m_values[m_slots[handle.m_index].m_value_index] : nullptr;
+        }
+        const T* get(SlotMapHandle handle) const
+        {
+            return contains(handle) ? &m_values[m_slots[handle.m_index].m_value_index] : nullptr;
+        }
+
+        void clear()
+        {
+            // bump every slot, so no handle given out before resolves to a value inserted after
+            m_free_slot_index = SlotMapHandle::k_invalid_index;
+            for (uint32_t slot_index = static_cast<uint32_t>(m_slots.size()); slot_index > 0; --slot_index)
+            {
+                Slot& slot = m_slots[slot_index - 1];
+                ++slot.m_generation;
+                slot.m_value_index = m_free_slot_index;
+                m_free_slot_index  = slot_index - 1;
+            }
+            m_values.clear();
+            m_value_slot_indices.clear();
+        }
+
+        size_t size() const { return m_values.size(); }
+        bool   empty() const { return m_values.empty(); }
+
+        typename std::vector<T>::iterator       begin() { return m_values.begin(); }
+        typename std::vector<T>::iterator       end() { return m_values.end(); }
+        typename std::vector<T>::const_iterator begin() const { return m_values.begin(); }
+        typename std::vector<T>::const_iterator end() const { return m_values.end(); }
+
+    private:
+        struct Slot
+        {
+            // index in m_values while the slot is used, the next free slot while it is free
+            uint32_t m_value_index {SlotMapHandle::k_invalid_index};
+            uint32_t m_generation {0};
+        };
+
+        std::vector<T>        m_values;
+        std::vector<uint32_t> m_value_slot_indices; // the slot of every value
+        std::vector<Slot>     m_slots;
+        uint32_t              m_free_slot_index {SlotMapHandle::k_invalid_index};
+    };
+} // namespace Piccolo
@@ -0,0 +1,113 @@
+#include "runtime/core/base/thread_pool.h"
+
+#include "runtime/core/profile/profiler.h"
+
+namespace Piccolo
+{
+    ThreadPool::ThreadPool(uint32_t thread_count)
+    {
+        uint32_t worker_count = thread_count > 1 ? thread_count - 1 : 0;
+        m_workers.reserve(worker_count);
+        for (uint32_t worker_index = 0; worker_index < worker_count; ++worker_index)
+        {
+            m_workers.emplace_back(&ThreadPool::workerMain, this, worker_index + 1);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_is_running = false;
+        }
+        m_work_condition.notify_all();
+
+        for (std::thread& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::parallelFor(uint32_t count, const Task& task)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        if (m_workers.empty() || count == 1)
+        {
+            for (uint32_t index = 0; index < count; ++index)
+            {
+                task(index, 0);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_task           = &task;
+            m_count          = count;
+            m_next_index     = 0;
+            m_finished_count = 0;
+            ++m_generation;
+        }
+        m_work_condition.notify_all();
+
+        runTasks(0);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done_condition.wait(lock, [this] { return m_finished_count == m_count && m_busy_worker_count == 0; });
+        m_task = nullptr;
+    }
+
+    void ThreadPool::workerMain(uint32_t thread_index)
+    {
+        PROFILE_THREAD("worker");
+
+        uint64_t seen_generation = 0;
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_work_condition.wait(lock, [&] { return !m_is_running || m_generation != seen_generation; });
+            if (!m_is_running)
+            {
+                return;
+            }
+
+            seen_generation = m_generation;
+            ++m_busy_worker_count;
+            lock.unlock();
+
+            runTasks(thread_index);
+
+            lock.lock();
+            --m_busy_worker_count;
+            if (m_finished_count == m_count && m_busy_worker_count == 0)
+            {
+                m_done_condition.notify_one();
+            }
+        }
+    }
+
+    void ThreadPool::runTasks(uint32_t thread_index)
+    {
+        while (true)
+        {
+            uint32_t index;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_next_index >= m_count)
+                {
+                    return;
+                }
+                index = m_next_index++;
+            }
+
+            (*m_task)(index, thread_index);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_finished_count;
+        }
+    }
+} // namespace Piccolo
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Piccolo
+{
+    /// fixed set of worker threads which run the iterations of a parallel for
+    ///
+    /// the calling thread joins the work as thread 0, so a task always knows which of the getThreadCount() slots
+    /// it runs on and can use per-thread state without locking. parallelFor blocks until every iteration is done
+    /// and must not be called from inside a task
+    class ThreadPool
+    {
+    public:
+        using Task = std::function<void(uint32_t index, uint32_t thread_index)>;
+
+        explicit ThreadPool(uint32_t thread_count);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        uint32_t getThreadCount() const { return static_cast<uint32_t>(m_workers.size()) + 1; }
+
+        void parallelFor(uint32_t count, const Task& task);
+
+    private:
+        void workerMain(uint32_t thread_index);
+        void runTasks(uint32_t thread_index);
+
+        std::vector<std::thread> m_workers;
+
+        std::mutex              m_mutex;
+        std::condition_variable m_work_condition;
+        std::condition_variable m_done_condition;
+        bool                    m_is_running {true};
+
+        // the job of the current parallelFor, the generation tells the workers a new one was posted
+        const Task* m_task {nullptr};
+        uint64_t    m_generation {0};
+        uint32_t    m_count {0};
+        uint32_t    m_next_index {0};
+        uint32_t    m_finished_count {0};
+        uint32_t    m_busy_worker_count {0};
+    };
+} // namespace Piccolo
@@ -1,13 +1,116 @@
 #include "runtime/core/log/log_system.h"
 
-#include <spdlog/async.h>
+#include "runtime/core/profile/profiler.h"
+
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <chrono>
+
 namespace Piccolo
 {
-    LogSystem::LogSystem()
+    namespace
+    {
+        // the flusher thread sleeps this long when the queue is empty, producers never wake it up themselves
+        constexpr std::chrono::milliseconds s_flush_thread_idle_time {5};
+
+        spdlog::level::level_enum toSpdlogLevel(LogSystem::LogLevel level)
+        {
+            switch (level)
+            {
+                case LogSystem::LogLevel::debug:
+                    return spdlog::level::debug;
+                case LogSystem::LogLevel::info:
+                    return spdlog::level::info;
+                case LogSystem::LogLevel::warn:
+                    return spdlog::level::warn;
+                case LogSystem::LogLevel::error:
+                    return spdlog::level::err;
+                case LogSystem::LogLevel::fatal:
+                    return spdlog::level::critical;
+                default:
+                    return spdlog::level::off;
+            }
+        }
+    } // namespace
+
+    LogSystem::MessageQueue::MessageQueue(uint32_t capacity)
+    {
+        uint64_t cell_count = 2;
+        while (cell_count < capacity)
+        {
+            cell_count <<= 1;
+        }
+
+        m_cells = std::make_unique<Cell[]>(cell_count);
+        m_mask  = cell_count - 1;
+        for (uint64_t cell_index = 0; cell_index < cell_count; ++cell_index)
+        {
+            m_cells[cell_index].m_sequence.store(cell_index, std::memory_order_relaxed);
+        }
+    }
+
+    bool LogSystem::MessageQueue::tryPush(LogMessage&& message)
+    {
+        // a cell is writable when its sequence equals the position, and readable when it is one ahead
+        Cell*    cell     = nullptr;
+        uint64_t position = m_enqueue_position.load(std::memory_order_relaxed);
+        while (true)
+        {
+            cell                    = &m_cells[position & m_mask];
+            const uint64_t sequence = cell->m_sequence.load(std::memory_order_acquire);
+            const int64_t  distance = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+            if (distance == 0)
+            {
+                if (m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (distance < 0)
+            {
+                return false; // full
+            }
+            else
+            {
+                position = m_enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->m_message = std::move(message);
+        cell->m_sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool LogSystem::MessageQueue::tryPop(LogMessage& out_message)
+    {
+        Cell*    cell     = nullptr;
+        uint64_t position = m_dequeue_position.load(std::memory_order_relaxed);
+        while (true)
+        {
+            cell                    = &m_cells[position & m_mask];
+            const uint64_t sequence = cell->m_sequence.load(std::memory_order_acquire);
+            const int64_t  distance = static_cast<int64_t>(sequence) - static_cast<int64_t>(position + 1);
+            if (distance == 0)
+            {
+                if (m_dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (distance < 0)
+            {
+                return false; // empty
+            }
+            else
+            {
+                position = m_dequeue_position.load(std::memory_order_relaxed);
+            }
+        }
+
+        out_message = std::move(cell->m_message);
+        cell->m_sequence.store(position + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    LogSystem::LogSystem(const LogSystemInitInfo& init_info)
     {
         auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
         console_sink->set_level(spdlog::level::trace);
@@ -15,22 +118,201 @@ namespace Piccolo
 
         const spdlog::sinks_init_list sink_list = {console_sink};
 
-        spdlog::init_thread_pool(8192, 1);
-
-        m_logger = std::make_shared<spdlog::async_logger>("muggle_logger",
-                                                          sink_list.begin(),
-                                                          sink_list.end(),
-                                                          spdlog::thread_pool(),
-                                                          spdlog::async_overflow_policy::block);
+        // the sinks are only written by the flusher thread in async mode, or by the logging threads otherwise
+        m_logger = std::make_shared<spdlog::logger>("muggle_logger", sink_list.begin(), sink_list.end());
         m_logger->set_level(spdlog::level::trace);
+        m_logger->flush_on(spdlog::level::err);
 
         spdlog::register_logger(m_logger);
+
+        setLevel(init_info.m_level);
+        for (const auto& category_level : init_info.m_category_levels)
+        {
+            setLevel(category_level.first, category_level.second);
+        }
+
+        if (init_info.m_is_async)
+        {
+            m_queue           = std::make_unique<MessageQueue>(init_info.m_queue_capacity);
+            m_overflow_policy = init_info.m_overflow_policy;
+
+            m_is_flush_thread_running = true;
+            m_flush_thread            = std::thread(&LogSystem::flushThreadMain, this);
+        }
     }
 
     LogSystem::~LogSystem()
     {
+        if (m_flush_thread.joinable())
+        {
+            // the flusher thread drains the queue before it exits
+            m_is_flush_thread_running = false;
+            m_wake_condition.notify_one();
+            m_flush_thread.join();
+        }
+
         m_logger->flush();
         spdlog::drop_all();
     }
 
+    void LogSystem::setLevel(LogCategory category, LogLevel level)
+    {
+        m_category_levels[static_cast<size_t>(category)].store(level, std::memory_order_relaxed);
+    }
+
+    void LogSystem::setLevel(LogLevel level)
+    {
+        for (std::atomic<LogLevel>& category_level : m_category_levels)
+        {
+            category_level.store(level, std::memory_order_relaxed);
+        }
+    }
+
+    void LogSystem::submit(LogCategory category, LogLevel level, std::string&& message)
+    {
+        LogMessage log_message {category, level, std::move(message)};
+
+        if (!m_queue)
+        {
+            write(log_message);
+            return;
+        }
+
+        if (m_overflow_policy == OverflowPolicy::discard)
+        {
+            if (!m_queue->tryPush(std::move(log_message)))
+            {
+                m_dropped_count.fetch_add(1, std::memory_order_relaxed);
+            }
+            return;
+        }
+
+        // tryPush only moves the message away when it succeeds
+        while (!m_queue->tryPush(std::move(log_message)))
+        {
+            m_wake_condition.notify_one();
+            std::this_thread::yield();
+        }
+    }
+
+    void LogSystem::write(const LogMessage& message)
+    {
+        if (message.m_category == LogCategory::general)
+        {
+            m_logger->log(toSpdlogLevel(message.m_level), spdlog::string_view_t(message.m_message));
+        }
+        else
+        {
+            m_logger->log(toSpdlogLevel(message.m_level),
+                          "[{}] {}",
+                          getCategoryName(message.m_category),
+                          message.m_message);
+        }
+    }
+
+    void LogSystem::flush()
+    {
+        if (m_queue)
+        {
+            const uint64_t target_count = m_queue->getPushCount();
+            while (m_written_count.load(std::memory_order_acquire) < target_count)
+            {
+                m_wake_condition.notify_one();
+                std::this_thread::yield();
+            }
+        }
+
+        m_logger->flush();
+    }
+
+    void LogSystem::flushThreadMain()
+    {
+        PROFILE_THREAD("log");
+
+        LogMessage message;
+        while (true)
+        {
+            const bool is_running = m_is_flush_thread_running.load(std::memory_order_acquire);
+
+            while (m_queue->tryPop(message))
+            {
+                write(message);
+                m_written_count.fetch_add(1, std::memory_order_release);
+            }
+
+            const uint64_t dropped_count = m_dropped_count.exchange(0, std::memory_order_relaxed);
+            if (dropped_count > 0)
+            {
+                m_logger->warn(
+                    "[{}] {} log messages dropped, the async log queue was full", __FUNCTION__, dropped_count);
+            }
+
+            if (!is_running)
+                break;
+
+            std::unique_lock<std::mutex> lock(m_wake_mutex);
+            m_wake_condition.wait_for(lock, s_flush_thread_idle_time);
+        }
+    }
+
+    void LogSystem::fatalCallback(LogCategory category, std::string&& message)
+    {
+        submit(category, LogLevel::fatal, std::string(message));
+        flush();
+        throw std::runtime_error(message);
+    }
+
+    bool LogSystem::parseLevel(const std::string& name, LogLevel& out_level)
+    {
+        static const std::pair<const char*, LogLevel> s_level_names[] = {{"debug", LogLevel::debug},
+                                                                         {"info", LogLevel::info},
+                                                                         {"warn", LogLevel::warn},
+                                                                         {"error", LogLevel::error},
+                                                                         {"fatal", LogLevel::fatal}};
+        for (const auto& level_name : s_level_names)
+        {
+            if (name == level_name.first)
+            {
+                out_level = level_name.second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool LogSystem::parseCategory(const std::string& name, LogCategory& out_category)
+    {
+        for (uint8_t category_index = 0; category_index < static_cast<uint8_t>(LogCategory::count); ++category_index)
+        {
+            const LogCategory category = static_cast<LogCategory>(category_index);
+            if (name == getCategoryName(category))
+            {
+                out_category = category;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const char* LogSystem::getCategoryName(LogCategory category)
+    {
+        switch (category)
+        {
+            case LogCategory::general:
+                return "general";
+            case LogCategory::physics:
+                return "physics";
+            case LogCategory::render:
+                return "render";
+            case LogCategory::script:
+                return "script";
+            case LogCategory::resource:
+                return "resource";
+            case LogCategory::animation:
+                return "animation";
+            default:
+                return "invalid";
+        }
+    }
+
 } // namespace Piccolo
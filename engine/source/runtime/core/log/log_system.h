@@ -2,11 +2,20 @@
 
 #include <spdlog/spdlog.h>
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace Piccolo
 {
+    struct LogSystemInitInfo;
 
     class LogSystem final
     {
@@ -20,45 +29,128 @@ namespace Piccolo
             fatal
         };
 
+        /// every category has its own runtime level, LOG_* macros log to general
+        enum class LogCategory : uint8_t
+        {
+            general,
+            physics,
+            render,
+            script,
+            resource,
+            animation,
+            count
+        };
+
+        /// what a thread does when the async queue is full
+        enum class OverflowPolicy : uint8_t
+        {
+            block,  // wait until the flusher thread makes room, nothing is lost
+            discard // drop the message, the number of dropped messages is reported later
+        };
+
     public:
-        LogSystem();
+        explicit LogSystem(const LogSystemInitInfo& init_info);
         ~LogSystem();
 
+        bool isEnabled(LogCategory category, LogLevel level) const
+        {
+            return level >= m_category_levels[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+        }
+
+        void setLevel(LogCategory category, LogLevel level);
+        void setLevel(LogLevel level);
+
         template<typename... TARGS>
         void log(LogLevel level, TARGS&&... args)
         {
-            switch (level)
-            {
-                case LogLevel::debug:
-                    m_logger->debug(std::forward<TARGS>(args)...);
-                    break;
-                case LogLevel::info:
-                    m_logger->info(std::forward<TARGS>(args)...);
-                    break;
-                case LogLevel::warn:
-                    m_logger->warn(std::forward<TARGS>(args)...);
-                    break;
-                case LogLevel::error:
-                    m_logger->error(std::forward<TARGS>(args)...);
-                    break;
-                case LogLevel::fatal:
-                    m_logger->critical(std::forward<TARGS>(args)...);
-                    fatalCallback(std::forward<TARGS>(args)...);
-                    break;
-                default:
-                    break;
-            }
+            log(LogCategory::general, level, std::forward<TARGS>(args)...);
         }
 
         template<typename... TARGS>
-        void fatalCallback(TARGS&&... args)
+        void log(LogCategory category, LogLevel level, TARGS&&... args)
         {
-            const std::string format_str = fmt::format(std::forward<TARGS>(args)...);
-            throw std::runtime_error(format_str);
+            if (!isEnabled(category, level))
+                return;
+
+            // formatting happens on the calling thread, only the finished message is queued
+            std::string message = fmt::format(std::forward<TARGS>(args)...);
+            if (level == LogLevel::fatal)
+            {
+                fatalCallback(category, std::move(message));
+            }
+            submit(category, level, std::move(message));
         }
 
+        /// block until every message logged so far is written
+        void flush();
+
+        static bool        parseLevel(const std::string& name, LogLevel& out_level);
+        static bool        parseCategory(const std::string& name, LogCategory& out_category);
+        static const char* getCategoryName(LogCategory category);
+
     private:
+        struct LogMessage
+        {
+            LogCategory m_category {LogCategory::general};
+            LogLevel    m_level {LogLevel::info};
+            std::string m_message;
+        };
+
+        /// bounded multi-producer queue after Dmitry Vyukov, pushing and popping never lock
+        class MessageQueue
+        {
+        public:
+            explicit MessageQueue(uint32_t capacity);
+
+            bool tryPush(LogMessage&& message);
+            bool tryPop(LogMessage& out_message);
+
+            uint64_t getPushCount() const { return m_enqueue_position.load(std::memory_order_acquire); }
+
+        private:
+            struct Cell
+            {
+                std::atomic<uint64_t> m_sequence {0};
+                LogMessage            m_message;
+            };
+
+            std::unique_ptr<Cell[]> m_cells;
+            uint64_t                m_mask {0};
+
+            alignas(64) std::atomic<uint64_t> m_enqueue_position {0};
+            alignas(64) std::atomic<uint64_t> m_dequeue_position {0};
+        };
+
+        [[noreturn]] void fatalCallback(LogCategory category, std::string&& message);
+
+        void submit(LogCategory category, LogLevel level, std::string&& message);
+        void write(const LogMessage& message);
+        void flushThreadMain();
+
         std::shared_ptr<spdlog::logger> m_logger;
+
+        std::array<std::atomic<LogLevel>, static_cast<size_t>(LogCategory::count)> m_category_levels;
+
+        // async mode only
+        std::unique_ptr<MessageQueue> m_queue;
+        OverflowPolicy                m_overflow_policy {OverflowPolicy::block};
+        std::thread                   m_flush_thread;
+        std::atomic<bool>             m_is_flush_thread_running {false};
+        std::atomic<uint64_t>         m_written_count {0};
+        std::atomic<uint64_t>         m_dropped_count {0};
+        std::mutex                    m_wake_mutex;
+        std::condition_variable       m_wake_condition;
+    };
+
+    struct LogSystemInitInfo
+    {
+        /// log on a background thread, otherwise every log call writes to the sinks directly
+        bool                      m_is_async {true};
+        uint32_t                  m_queue_capacity {8192}; // rounded up to a power of two
+        LogSystem::OverflowPolicy m_overflow_policy {LogSystem::OverflowPolicy::block};
+
+        LogSystem::LogLevel                                                 m_level {LogSystem::LogLevel::debug};
+        std::vector<std::pair<LogSystem::LogCategory, LogSystem::LogLevel>> m_category_levels;
     };
 
-} // namespace Piccolo
\ No newline at end of file
+} // namespace Piccolo
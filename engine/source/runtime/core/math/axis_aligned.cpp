@@ -1,4 +1,5 @@
 #include "runtime/core/math/axis_aligned.h"
+#include "runtime/core/math/math_batch.h"
 
 namespace Piccolo
 {
@@ -13,6 +14,19 @@ namespace Piccolo
         m_half_extent = m_center - m_min_corner;
     }
 
+    void AxisAlignedBox::merge(const float* positions, size_t stride, size_t count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        MathBatch::computeBounds(positions, stride, count, m_min_corner, m_max_corner);
+
+        m_center      = 0.5f * (m_min_corner + m_max_corner);
+        m_half_extent = m_center - m_min_corner;
+    }
+
     void AxisAlignedBox::update(const Vector3& center, const Vector3& half_extent)
     {
         m_center      = center;
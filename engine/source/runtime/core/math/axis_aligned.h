@@ -15,6 +15,8 @@ namespace Piccolo
         AxisAlignedBox(const Vector3& center, const Vector3& half_extent);
 
         void merge(const Vector3& new_point);
+        /// merges count positions which are stride bytes apart, the center and extent are updated once
+        void merge(const float* positions, size_t stride, size_t count);
         void update(const Vector3& center, const Vector3& half_extent);
 
         const Vector3& getCenter() const { return m_center; }
@@ -0,0 +1,450 @@
+#include "runtime/core/math/math_batch.h"
+
+#include "runtime/core/math/math_simd.h"
+
+#include <cstdint>
+
+namespace Piccolo
+{
+    namespace MathBatch
+    {
+        namespace
+        {
+#ifdef PICCOLO_MATH_SIMD
+            // four elements, a register per component
+            struct Vector3x4
+            {
+                __m128 x, y, z;
+            };
+
+            struct Quaternionx4
+            {
+                __m128 w, x, y, z;
+            };
+
+            // every element of the matrix in all four lanes
+            struct BroadcastMatrix4x4
+            {
+                explicit BroadcastMatrix4x4(const Matrix4x4& matrix)
+                {
+                    for (int row_index = 0; row_index < 4; ++row_index)
+                    {
+                        for (int column_index = 0; column_index < 4; ++column_index)
+                        {
+                            m_elements[row_index][column_index] = _mm_set1_ps(matrix.m_mat[row_index][column_index]);
+                        }
+                    }
+                }
+
+                // m[i][0] * x + m[i][1] * y + m[i][2] * z + m[i][3], the order of the scalar code
+                __m128 transformRow(int row_index, const Vector3x4& points) const
+                {
+                    const __m128* row = m_elements[row_index];
+
+                    __m128 result = _mm_mul_ps(row[0], points.x);
+                    result        = _mm_add_ps(result, _mm_mul_ps(row[1], points.y));
+                    result        = _mm_add_ps(result, _mm_mul_ps(row[2], points.z));
+                    return _mm_add_ps(result, row[3]);
+                }
+
+                __m128 m_elements[4][4];
+            };
+
+            // the four positions at base, base + stride, ..., stride is at least the size of a position
+            Vector3x4 loadPositions(const float* base, size_t stride)
+            {
+                const char* bytes = reinterpret_cast<const char*>(base);
+
+                __m128 position0 = _mm_loadu_ps(reinterpret_cast<const float*>(bytes));
+                __m128 position1 = _mm_loadu_ps(reinterpret_cast<const float*>(bytes + stride));
+                __m128 position2 = _mm_loadu_ps(reinterpret_cast<const float*>(bytes + 2 * stride));
+                // the last one is loaded from the float before it, so nothing behind the array is read
+                __m128 position3 = _mm_loadu_ps(reinterpret_cast<const float*>(bytes + 3 * stride) - 1);
+                position3        = _mm_shuffle_ps(position3, position3, _MM_SHUFFLE(3, 3, 2, 1));
+
+                _MM_TRANSPOSE4_PS(position0, position1, position2, position3);
+                return {position0, position1, position2};
+            }
+
+            void storePoints(const Vector3x4& points, Vector3* out_points)
+            {
+                alignas(16) float xs[4];
+                alignas(16) float ys[4];
+                alignas(16) float zs[4];
+                _mm_store_ps(xs, points.x);
+                _mm_store_ps(ys, points.y);
+                _mm_store_ps(zs, points.z);
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    out_points[lane] = Vector3(xs[lane], ys[lane], zs[lane]);
+                }
+            }
+
+            Vector3x4 transformPointsx4(const BroadcastMatrix4x4& matrix, const Vector3x4& points)
+            {
+                const __m128 inv_w = _mm_div_ps(_mm_set1_ps(1.0f), matrix.transformRow(3, points));
+                return {_mm_mul_ps(matrix.transformRow(0, points), inv_w),
+                        _mm_mul_ps(matrix.transformRow(1, points), inv_w),
+                        _mm_mul_ps(matrix.transformRow(2, points), inv_w)};
+            }
+
+            Quaternionx4 loadQuaternions(const Quaternion* quaternions)
+            {
+                __m128 quaternion0 = _mm_loadu_ps(quaternions[0].ptr());
+                __m128 quaternion1 = _mm_loadu_ps(quaternions[1].ptr());
+                __m128 quaternion2 = _mm_loadu_ps(quaternions[2].ptr());
+                __m128 quaternion3 = _mm_loadu_ps(quaternions[3].ptr());
+                _MM_TRANSPOSE4_PS(quaternion0, quaternion1, quaternion2, quaternion3);
+                return {quaternion0, quaternion1, quaternion2, quaternion3};
+            }
+
+            void storeQuaternions(Quaternionx4 quaternions, Quaternion* out_quaternions)
+            {
+                _MM_TRANSPOSE4_PS(quaternions.w, quaternions.x, quaternions.y, quaternions.z);
+                _mm_storeu_ps(out_quaternions[0].ptr(), quaternions.w);
+                _mm_storeu_ps(out_quaternions[1].ptr(), quaternions.x);
+                _mm_storeu_ps(out_quaternions[2].ptr(), quaternions.y);
+                _mm_storeu_ps(out_quaternions[3].ptr(), quaternions.z);
+            }
+
+            __m128 dotQuaternions(const Quaternionx4& lhs, const Quaternionx4& rhs)
+            {
+                __m128 result = _mm_mul_ps(lhs.w, rhs.w);
+                result        = _mm_add_ps(result, _mm_mul_ps(lhs.x, rhs.x));
+                result        = _mm_add_ps(result, _mm_mul_ps(lhs.y, rhs.y));
+                return _mm_add_ps(result, _mm_mul_ps(lhs.z, rhs.z));
+            }
+
+            Quaternionx4 scaleQuaternions(const Quaternionx4& quaternions, __m128 factor)
+            {
+                return {_mm_mul_ps(quaternions.w, factor),
+                        _mm_mul_ps(quaternions.x, factor),
+                        _mm_mul_ps(quaternions.y, factor),
+                        _mm_mul_ps(quaternions.z, factor)};
+            }
+
+            Quaternionx4 addQuaternions(const Quaternionx4& lhs, const Quaternionx4& rhs)
+            {
+                return {_mm_add_ps(lhs.w, rhs.w),
+                        _mm_add_ps(lhs.x, rhs.x),
+                        _mm_add_ps(lhs.y, rhs.y),
+                        _mm_add_ps(lhs.z, rhs.z)};
+            }
+
+            // the lanes with the sign bit set in sign are negated
+            Quaternionx4 flipQuaternions(const Quaternionx4& quaternions, __m128 sign)
+            {
+                return {_mm_xor_ps(quaternions.w, sign),
+                        _mm_xor_ps(quaternions.x, sign),
+                        _mm_xor_ps(quaternions.y, sign),
+                        _mm_xor_ps(quaternions.z, sign)};
+            }
+
+            // Quaternion::normalise, the length is the square root of the dot product in the same order
+            Quaternionx4 normaliseQuaternionsx4(const Quaternionx4& quaternions)
+            {
+                const __m128 length = _mm_sqrt_ps(dotQuaternions(quaternions, quaternions));
+                return scaleQuaternions(quaternions, _mm_div_ps(_mm_set1_ps(1.0f), length));
+            }
+
+            // the negated lanes of a shortest path interpolation, -0 where the dot product is negative
+            __m128 computeShortestPathSign(__m128 cos_values)
+            {
+                return _mm_and_ps(_mm_cmplt_ps(cos_values, _mm_setzero_ps()), _mm_set1_ps(-0.0f));
+            }
+
+            // the weights of Quaternion::sLerp, returns true if it falls back to a normalised linear interpolation
+            bool computeSLerpCoefficients(float t, float cos_v, float& coeff0, float& coeff1)
+            {
+                if (Math::abs(cos_v) < 1 - Quaternion::k_epsilon)
+                {
+                    float  sin_v   = Math::sqrt(1 - Math::sqr(cos_v));
+                    Radian angle   = Math::atan2(sin_v, cos_v);
+                    float  inv_sin = 1.0f / sin_v;
+                    coeff0         = Math::sin((1.0f - t) * angle) * inv_sin;
+                    coeff1         = Math::sin(t * angle) * inv_sin;
+                    return false;
+                }
+
+                coeff0 = 1.0f - t;
+                coeff1 = t;
+                return true;
+            }
+#endif
+        } // namespace
+
+        void transformPoints(const Matrix4x4& matrix, const Vector3* points, Vector3* out_points, size_t count)
+        {
+            size_t index = 0;
+#ifdef PICCOLO_MATH_SIMD
+            const BroadcastMatrix4x4 broadcast_matrix(matrix);
+            for (; index + 4 <= count; index += 4)
+            {
+                const Vector3x4 quad = loadPositions(points[index].ptr(), sizeof(Vector3));
+                storePoints(transformPointsx4(broadcast_matrix, quad), out_points + index);
+            }
+#endif
+            for (; index < count; ++index)
+            {
+                out_points[index] = matrix * points[index];
+            }
+        }
+
+        void transformPoints(const Matrix4x4& matrix,
+                             const float*     xs,
+                             const float*     ys,
+                             const float*     zs,
+                             float*           out_xs,
+                             float*           out_ys,
+                             float*           out_zs,
+                             size_t           count)
+        {
+            size_t index = 0;
+#ifdef PICCOLO_MATH_SIMD
+            const BroadcastMatrix4x4 broadcast_matrix(matrix);
+            for (; index + 4 <= count; index += 4)
+            {
+                const Vector3x4 quad {_mm_loadu_ps(xs + index), _mm_loadu_ps(ys + index), _mm_loadu_ps(zs + index)};
+                const Vector3x4 result = transformPointsx4(broadcast_matrix, quad);
+                _mm_storeu_ps(out_xs + index, result.x);
+                _mm_storeu_ps(out_ys + index, result.y);
+                _mm_storeu_ps(out_zs + index, result.z);
+            }
+#endif
+            for (; index < count; ++index)
+            {
+                const Vector3 result = matrix * Vector3(xs[index], ys[index], zs[index]);
+                out_xs[index]        = result.x;
+                out_ys[index]        = result.y;
+                out_zs[index]        = result.z;
+            }
+        }
+
+        void transformVectors(const Matrix4x4& matrix, const Vector4* vectors, Vector4* out_vectors, size_t count)
+        {
+#ifdef PICCOLO_MATH_SIMD
+            // MathSIMD::transformVector4 with the transpose done once for all vectors
+            __m128 column0 = _mm_loadu_ps(matrix.m_mat[0]);
+            __m128 column1 = _mm_loadu_ps(matrix.m_mat[1]);
+            __m128 column2 = _mm_loadu_ps(matrix.m_mat[2]);
+            __m128 column3 = _mm_loadu_ps(matrix.m_mat[3]);
+            _MM_TRANSPOSE4_PS(column0, column1, column2, column3);
+
+            for (size_t index = 0; index < count; ++index)
+            {
+                const __m128 vector = _mm_loadu_ps(vectors[index].ptr());
+                const __m128 x      = _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(0, 0, 0, 0));
+                const __m128 y      = _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(1, 1, 1, 1));
+                const __m128 z      = _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(2, 2, 2, 2));
+                const __m128 w      = _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(3, 3, 3, 3));
+
+                __m128 result = _mm_mul_ps(column0, x);
+                result        = _mm_add_ps(result, _mm_mul_ps(column1, y));
+                result        = _mm_add_ps(result, _mm_mul_ps(column2, z));
+                result        = _mm_add_ps(result, _mm_mul_ps(column3, w));
+                _mm_storeu_ps(out_vectors[index].ptr(), result);
+            }
+#else
+            for (size_t index = 0; index < count; ++index)
+            {
+                out_vectors[index] = matrix * vectors[index];
+            }
+#endif
+        }
+
+        void computeBounds(
+            const float* positions, size_t stride, size_t count, Vector3& min_corner, Vector3& max_corner)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+
+            const char* bytes = reinterpret_cast<const char*>(positions);
+#ifdef PICCOLO_MATH_SIMD
+            // min(point, corner) keeps the corner unless the point is smaller, which is what makeFloor does
+            __m128 min_lanes = _mm_setr_ps(min_corner.x, min_corner.y, min_corner.z, 0.0f);
+            __m128 max_lanes = _mm_setr_ps(max_corner.x, max_corner.y, max_corner.z, 0.0f);
+            for (size_t index = 0; index + 1 < count; ++index)
+            {
+                const __m128 point = _mm_loadu_ps(reinterpret_cast<const float*>(bytes + index * stride));
+                min_lanes          = _mm_min_ps(point, min_lanes);
+                max_lanes          = _mm_max_ps(point, max_lanes);
+            }
+
+            // the last position is loaded without reading behind it
+            const float* last_position = reinterpret_cast<const float*>(bytes + (count - 1) * stride);
+            const __m128 last_point    = _mm_setr_ps(last_position[0], last_position[1], last_position[2], 0.0f);
+            min_lanes                  = _mm_min_ps(last_point, min_lanes);
+            max_lanes                  = _mm_max_ps(last_point, max_lanes);
+
+            alignas(16) float min_values[4];
+            alignas(16) float max_values[4];
+            _mm_store_ps(min_values, min_lanes);
+            _mm_store_ps(max_values, max_lanes);
+            min_corner = Vector3(min_values[0], min_values[1], min_values[2]);
+            max_corner = Vector3(max_values[0], max_values[1], max_values[2]);
+#else
+            for (size_t index = 0; index < count; ++index)
+            {
+                const float*  position = reinterpret_cast<const float*>(bytes + index * stride);
+                const Vector3 point(position[0], position[1], position[2]);
+                min_corner.makeFloor(point);
+                max_corner.makeCeil(point);
+            }
+#endif
+        }
+
+        void computeBounds(const float* xs,
+                           const float* ys,
+                           const float* zs,
+                           size_t       count,
+                           Vector3&     min_corner,
+                           Vector3&     max_corner)
+        {
+            size_t index = 0;
+#ifdef PICCOLO_MATH_SIMD
+            if (count >= 4)
+            {
+                Vector3x4 min_quad {_mm_set1_ps(min_corner.x), _mm_set1_ps(min_corner.y), _mm_set1_ps(min_corner.z)};
+                Vector3x4 max_quad {_mm_set1_ps(max_corner.x), _mm_set1_ps(max_corner.y), _mm_set1_ps(max_corner.z)};
+                for (; index + 4 <= count; index += 4)
+                {
+                    const __m128 x = _mm_loadu_ps(xs + index);
+                    const __m128 y = _mm_loadu_ps(ys + index);
+                    const __m128 z = _mm_loadu_ps(zs + index);
+                    min_quad       = {_mm_min_ps(x, min_quad.x), _mm_min_ps(y, min_quad.y), _mm_min_ps(z, min_quad.z)};
+                    max_quad       = {_mm_max_ps(x, max_quad.x), _mm_max_ps(y, max_quad.y), _mm_max_ps(z, max_quad.z)};
+                }
+
+                alignas(16) float min_values[3][4];
+                alignas(16) float max_values[3][4];
+                _mm_store_ps(min_values[0], min_quad.x);
+                _mm_store_ps(min_values[1], min_quad.y);
+                _mm_store_ps(min_values[2], min_quad.z);
+                _mm_store_ps(max_values[0], max_quad.x);
+                _mm_store_ps(max_values[1], max_quad.y);
+                _mm_store_ps(max_values[2], max_quad.z);
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    min_corner.makeFloor(Vector3(min_values[0][lane], min_values[1][lane], min_values[2][lane]));
+                    max_corner.makeCeil(Vector3(max_values[0][lane], max_values[1][lane], max_values[2][lane]));
+                }
+            }
+#endif
+            for (; index < count; ++index)
+            {
+                const Vector3 point(xs[index], ys[index], zs[index]);
+                min_corner.makeFloor(point);
+                max_corner.makeCeil(point);
+            }
+        }
+
+        void multiplyMatrices(const Matrix4x4* lhs, const Matrix4x4* rhs, Matrix4x4* out, size_t count)
+        {
+            for (size_t index = 0; index < count; ++index)
+            {
+#ifdef PICCOLO_MATH_SIMD
+                // straight into the output, without the temporary of operator*
+                MathSIMD::multiplyMatrix4x4(lhs[index].m_mat, rhs[index].m_mat, out[index].m_mat);
+#else
+                out[index] = lhs[index] * rhs[index];
+#endif
+            }
+        }
+
+        void normaliseQuaternions(Quaternion* quaternions, size_t count)
+        {
+            size_t index = 0;
+#ifdef PICCOLO_MATH_SIMD
+            for (; index + 4 <= count; index += 4)
+            {
+                storeQuaternions(normaliseQuaternionsx4(loadQuaternions(quaternions + index)), quaternions + index);
+            }
+#endif
+            for (; index < count; ++index)
+            {
+                quaternions[index].normalise();
+            }
+        }
+
+        void nLerpQuaternions(
+            float t, const Quaternion* from, const Quaternion* to, Quaternion* out, size_t count, bool shortest_path)
+        {
+            size_t index = 0;
+#ifdef PICCOLO_MATH_SIMD
+            const __m128 t_lanes = _mm_set1_ps(t);
+            for (; index + 4 <= count; index += 4)
+            {
+                const Quaternionx4 kp = loadQuaternions(from + index);
+                Quaternionx4       kq = loadQuaternions(to + index);
+                if (shortest_path)
+                {
+                    kq = flipQuaternions(kq, computeShortestPathSign(dotQuaternions(kp, kq)));
+                }
+
+                // kp + t * (kq - kp)
+                const Quaternionx4 difference {_mm_sub_ps(kq.w, kp.w),
+                                               _mm_sub_ps(kq.x, kp.x),
+                                               _mm_sub_ps(kq.y, kp.y),
+                                               _mm_sub_ps(kq.z, kp.z)};
+                const Quaternionx4 result = addQuaternions(kp, scaleQuaternions(difference, t_lanes));
+                storeQuaternions(normaliseQuaternionsx4(result), out + index);
+            }
+#endif
+            for (; index < count; ++index)
+            {
+                out[index] = Quaternion::nLerp(t, from[index], to[index], shortest_path);
+            }
+        }
+
+        void sLerpQuaternions(
+            float t, const Quaternion* from, const Quaternion* to, Quaternion* out, size_t count, bool shortest_path)
+        {
+            size_t index = 0;
+#ifdef PICCOLO_MATH_SIMD
+            for (; index + 4 <= count; index += 4)
+            {
+                const Quaternionx4 kp        = loadQuaternions(from + index);
+                Quaternionx4       kt        = loadQuaternions(to + index);
+                __m128             cos_lanes = dotQuaternions(kp, kt);
+                if (shortest_path)
+                {
+                    const __m128 sign = computeShortestPathSign(cos_lanes);
+                    kt                = flipQuaternions(kt, sign);
+                    cos_lanes         = _mm_xor_ps(cos_lanes, sign);
+                }
+
+                alignas(16) float   cos_values[4];
+                alignas(16) float   coeff0_values[4];
+                alignas(16) float   coeff1_values[4];
+                alignas(16) int32_t is_linear[4];
+                _mm_store_ps(cos_values, cos_lanes);
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    const bool is_lane_linear =
+                        computeSLerpCoefficients(t, cos_values[lane], coeff0_values[lane], coeff1_values[lane]);
+                    is_linear[lane] = is_lane_linear ? -1 : 0;
+                }
+
+                // coeff0 * kp + coeff1 * kt, the linear lanes are normalised afterwards
+                const Quaternionx4 result      = addQuaternions(scaleQuaternions(kp, _mm_load_ps(coeff0_values)),
+                                                           scaleQuaternions(kt, _mm_load_ps(coeff1_values)));
+                const Quaternionx4 normalised  = normaliseQuaternionsx4(result);
+                const __m128i      linear_bits = _mm_load_si128(reinterpret_cast<const __m128i*>(is_linear));
+                const __m128       linear_mask = _mm_castsi128_ps(linear_bits);
+
+                const Quaternionx4 blended {_mm_blendv_ps(result.w, normalised.w, linear_mask),
+                                            _mm_blendv_ps(result.x, normalised.x, linear_mask),
+                                            _mm_blendv_ps(result.y, normalised.y, linear_mask),
+                                            _mm_blendv_ps(result.z, normalised.z, linear_mask)};
+                storeQuaternions(blended, out + index);
+            }
+#endif
+            for (; index < count; ++index)
+            {
+                out[index] = Quaternion::sLerp(t, from[index], to[index], shortest_path);
+            }
+        }
+    } // namespace MathBatch
+} // namespace Piccolo
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "runtime/core/math/matrix4.h"
+#include "runtime/core/math/quaternion.h"
+#include "runtime/core/math/vector3.h"
+#include "runtime/core/math/vector4.h"
+
+#include <cstddef>
+
+namespace Piccolo
+{
+    /// kernels over arrays of math values
+    ///
+    /// every kernel gives the same bits as the scalar operation applied to each element in turn. the SIMD builds load
+    /// four elements at once, transpose them to one register per component and do the component math four lanes
+    /// wide, the elements left over are done one by one. an output array may be the input array, but must not
+    /// partially overlap it
+    namespace MathBatch
+    {
+        /// out_points[i] = matrix * points[i], divided by w like Matrix4x4 * Vector3
+        void transformPoints(const Matrix4x4& matrix, const Vector3* points, Vector3* out_points, size_t count);
+
+        /// the same over separate x, y and z arrays
+        void transformPoints(const Matrix4x4& matrix,
+                             const float*     xs,
+                             const float*     ys,
+                             const float*     zs,
+                             float*           out_xs,
+                             float*           out_ys,
+                             float*           out_zs,
+                             size_t           count);
+
+        /// out_vectors[i] = matrix * vectors[i]
+        void transformVectors(const Matrix4x4& matrix, const Vector4* vectors, Vector4* out_vectors, size_t count);
+
+        /// grows min_corner and max_corner to contain the points, as makeFloor and makeCeil would
+        ///
+        /// the positions are stride bytes apart, so the positions of interleaved vertices are read in place
+        void computeBounds(
+            const float* positions, size_t stride, size_t count, Vector3& min_corner, Vector3& max_corner);
+
+        inline void computeBounds(const Vector3* points, size_t count, Vector3& min_corner, Vector3& max_corner)
+        {
+            computeBounds(points->ptr(), sizeof(Vector3), count, min_corner, max_corner);
+        }
+
+        /// the same over separate x, y and z arrays, equal zeros of different sign may be picked in another order
+        void computeBounds(const float* xs,
+                           const float* ys,
+                           const float* zs,
+                           size_t       count,
+                           Vector3&     min_corner,
+                           Vector3&     max_corner);
+
+        /// out[i] = lhs[i] * rhs[i]
+        void multiplyMatrices(const Matrix4x4* lhs, const Matrix4x4* rhs, Matrix4x4* out, size_t count);
+
+        void normaliseQuaternions(Quaternion* quaternions, size_t count);
+
+        /// out[i] = Quaternion::nLerp(t, from[i], to[i], shortest_path)
+        void nLerpQuaternions(
+            float t, const Quaternion* from, const Quaternion* to, Quaternion* out, size_t count, bool shortest_path);
+
+        /// out[i] = Quaternion::sLerp(t, from[i], to[i], shortest_path)
+        ///
+        /// the angles and their sines are taken per element with the scalar functions, only the dot products and
+        /// the weighted sums run four lanes wide
+        void sLerpQuaternions(
+            float t, const Quaternion* from, const Quaternion* to, Quaternion* out, size_t count, bool shortest_path);
+    } // namespace MathBatch
+} // namespace Piccolo
@@ -0,0 +1,186 @@
+#pragma once
+
+// the instruction set is chosen at configure time with MATH_SIMD, PICCOLO_MATH_SSE4 or PICCOLO_MATH_AVX2 is defined
+// for the whole engine. without either, the math classes use their scalar implementations only
+#if defined(PICCOLO_MATH_SSE4) || defined(PICCOLO_MATH_AVX2)
+#define PICCOLO_MATH_SIMD
+#endif
+
+#ifdef PICCOLO_MATH_SIMD
+
+#include <immintrin.h>
+
+namespace Piccolo
+{
+    /// SSE / AVX2 kernels of the math classes
+    ///
+    /// every kernel does the same float operations in the same order as the scalar implementation it replaces, only
+    /// several of them at once, so the results are the same bits. fused multiply add would round differently, so it
+    /// is never used, and the engine is not built with FMA code generation
+    namespace MathSIMD
+    {
+#define PICCOLO_SIMD_SHUFFLE(v, x, y, z, w) _mm_shuffle_ps((v), (v), _MM_SHUFFLE((w), (z), (y), (x)))
+
+        /// out = lhs * rhs for row major 4x4 matrices, out may alias lhs or rhs
+        inline void multiplyMatrix4x4(const float lhs[4][4], const float rhs[4][4], float out[4][4])
+        {
+#ifdef PICCOLO_MATH_AVX2
+            // two rows of the result at once, each 128 bit lane is a row
+            const __m256 rhs_row0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs[0]));
+            const __m256 rhs_row1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs[1]));
+            const __m256 rhs_row2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs[2]));
+            const __m256 rhs_row3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs[3]));
+
+            __m256 result[2];
+            for (int row_index = 0; row_index < 2; ++row_index)
+            {
+                const __m256 lhs_rows = _mm256_loadu_ps(lhs[row_index * 2]);
+                const __m256 lhs_x    = _mm256_shuffle_ps(lhs_rows, lhs_rows, _MM_SHUFFLE(0, 0, 0, 0));
+                const __m256 lhs_y    = _mm256_shuffle_ps(lhs_rows, lhs_rows, _MM_SHUFFLE(1, 1, 1, 1));
+                const __m256 lhs_z    = _mm256_shuffle_ps(lhs_rows, lhs_rows, _MM_SHUFFLE(2, 2, 2, 2));
+                const __m256 lhs_w    = _mm256_shuffle_ps(lhs_rows, lhs_rows, _MM_SHUFFLE(3, 3, 3, 3));
+
+                __m256 row = _mm256_mul_ps(lhs_x, rhs_row0);
+                row        = _mm256_add_ps(row, _mm256_mul_ps(lhs_y, rhs_row1));
+                row        = _mm256_add_ps(row, _mm256_mul_ps(lhs_z, rhs_row2));
+                row        = _mm256_add_ps(row, _mm256_mul_ps(lhs_w, rhs_row3));
+                result[row_index] = row;
+            }
+            _mm256_storeu_ps(out[0], result[0]);
+            _mm256_storeu_ps(out[2], result[1]);
+#else
+            const __m128 rhs_row0 = _mm_loadu_ps(rhs[0]);
+            const __m128 rhs_row1 = _mm_loadu_ps(rhs[1]);
+            const __m128 rhs_row2 = _mm_loadu_ps(rhs[2]);
+            const __m128 rhs_row3 = _mm_loadu_ps(rhs[3]);
+
+            __m128 result[4];
+            for (int row_index = 0; row_index < 4; ++row_index)
+            {
+                const __m128 lhs_row = _mm_loadu_ps(lhs[row_index]);
+
+                __m128 row = _mm_mul_ps(PICCOLO_SIMD_SHUFFLE(lhs_row, 0, 0, 0, 0), rhs_row0);
+                row        = _mm_add_ps(row, _mm_mul_ps(PICCOLO_SIMD_SHUFFLE(lhs_row, 1, 1, 1, 1), rhs_row1));
+                row        = _mm_add_ps(row, _mm_mul_ps(PICCOLO_SIMD_SHUFFLE(lhs_row, 2, 2, 2, 2), rhs_row2));
+                row        = _mm_add_ps(row, _mm_mul_ps(PICCOLO_SIMD_SHUFFLE(lhs_row, 3, 3, 3, 3), rhs_row3));
+                result[row_index] = row;
+            }
+            _mm_storeu_ps(out[0], result[0]);
+            _mm_storeu_ps(out[1], result[1]);
+            _mm_storeu_ps(out[2], result[2]);
+            _mm_storeu_ps(out[3], result[3]);
+#endif
+        }
+
+        /// matrix * (x, y, z, w), the sum over the columns keeps the order of the row dot products
+        inline __m128 transformVector4(const float matrix[4][4], __m128 v)
+        {
+            __m128 column0 = _mm_loadu_ps(matrix[0]);
+            __m128 column1 = _mm_loadu_ps(matrix[1]);
+            __m128 column2 = _mm_loadu_ps(matrix[2]);
+            __m128 column3 = _mm_loadu_ps(matrix[3]);
+            _MM_TRANSPOSE4_PS(column0, column1, column2, column3);
+
+            __m128 result = _mm_mul_ps(column0, PICCOLO_SIMD_SHUFFLE(v, 0, 0, 0, 0));
+            result        = _mm_add_ps(result, _mm_mul_ps(column1, PICCOLO_SIMD_SHUFFLE(v, 1, 1, 1, 1)));
+            result        = _mm_add_ps(result, _mm_mul_ps(column2, PICCOLO_SIMD_SHUFFLE(v, 2, 2, 2, 2)));
+            result        = _mm_add_ps(result, _mm_mul_ps(column3, PICCOLO_SIMD_SHUFFLE(v, 3, 3, 3, 3)));
+            return result;
+        }
+
+        /// matrix * (x, y, z, 1) divided by w, the scalar code adds m[i][3] where this multiplies it by 1
+        inline void transformPoint(const float matrix[4][4], const float point[3], float out[3])
+        {
+            const __m128 result = transformVector4(matrix, _mm_setr_ps(point[0], point[1], point[2], 1.0f));
+            const __m128 inv_w  = _mm_div_ps(_mm_set1_ps(1.0f), PICCOLO_SIMD_SHUFFLE(result, 3, 3, 3, 3));
+
+            alignas(16) float projected[4];
+            _mm_store_ps(projected, _mm_mul_ps(result, inv_w));
+            out[0] = projected[0];
+            out[1] = projected[1];
+            out[2] = projected[2];
+        }
+
+        /// cofactor inverse of Matrix4x4::inverseScalar, a column of the result per vector
+        inline void inverseMatrix4x4(const float matrix[4][4], float out[4][4])
+        {
+            const __m128 row0 = _mm_loadu_ps(matrix[0]);
+            const __m128 row1 = _mm_loadu_ps(matrix[1]);
+            const __m128 row2 = _mm_loadu_ps(matrix[2]);
+            const __m128 row3 = _mm_loadu_ps(matrix[3]);
+
+            // the 2x2 determinants v0..v5 of two rows p and q, v0 = p0 q1 - p1 q0 ... v5 = p2 q3 - p3 q2, arranged
+            // as a = (v5, v5, v4, v3), b = (v4, v2, v2, v1) and c = (v3, v1, v0, v0), the factors of the 3x3 minors
+            struct Determinants
+            {
+                __m128 a, b, c;
+            };
+            auto computeDeterminants = [](__m128 p, __m128 q) {
+                const __m128 p1 = PICCOLO_SIMD_SHUFFLE(p, 1, 0, 0, 0);
+                const __m128 p2 = PICCOLO_SIMD_SHUFFLE(p, 2, 2, 1, 1);
+                const __m128 p3 = PICCOLO_SIMD_SHUFFLE(p, 3, 3, 3, 2);
+                const __m128 q1 = PICCOLO_SIMD_SHUFFLE(q, 1, 0, 0, 0);
+                const __m128 q2 = PICCOLO_SIMD_SHUFFLE(q, 2, 2, 1, 1);
+                const __m128 q3 = PICCOLO_SIMD_SHUFFLE(q, 3, 3, 3, 2);
+                return Determinants {_mm_sub_ps(_mm_mul_ps(p2, q3), _mm_mul_ps(p3, q2)),
+                                     _mm_sub_ps(_mm_mul_ps(p1, q3), _mm_mul_ps(p3, q1)),
+                                     _mm_sub_ps(_mm_mul_ps(p1, q2), _mm_mul_ps(p2, q1))};
+            };
+            // a * (r1, r0, r0, r0) - b * (r2, r2, r1, r1) + c * (r3, r3, r3, r2)
+            auto computeMinors = [](const Determinants& determinants, __m128 r) {
+                const __m128 minors = _mm_sub_ps(_mm_mul_ps(determinants.a, PICCOLO_SIMD_SHUFFLE(r, 1, 0, 0, 0)),
+                                                 _mm_mul_ps(determinants.b, PICCOLO_SIMD_SHUFFLE(r, 2, 2, 1, 1)));
+                return _mm_add_ps(minors, _mm_mul_ps(determinants.c, PICCOLO_SIMD_SHUFFLE(r, 3, 3, 3, 2)));
+            };
+
+            const __m128 sign_pnpn = _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f);
+            const __m128 sign_npnp = _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+
+            const Determinants determinants23 = computeDeterminants(row2, row3);
+            const Determinants determinants13 = computeDeterminants(row1, row3);
+            const Determinants determinants12 = computeDeterminants(row1, row2);
+
+            const __m128 t = _mm_xor_ps(computeMinors(determinants23, row1), sign_pnpn);
+
+            alignas(16) float det_terms[4];
+            _mm_store_ps(det_terms, _mm_mul_ps(t, row0));
+            const __m128 inv_det = _mm_set1_ps(1.0f / (det_terms[0] + det_terms[1] + det_terms[2] + det_terms[3]));
+
+            __m128 column0 = _mm_mul_ps(t, inv_det);
+            __m128 column1 = _mm_mul_ps(_mm_xor_ps(computeMinors(determinants23, row0), sign_npnp), inv_det);
+            __m128 column2 = _mm_mul_ps(_mm_xor_ps(computeMinors(determinants13, row0), sign_pnpn), inv_det);
+            __m128 column3 = _mm_mul_ps(_mm_xor_ps(computeMinors(determinants12, row0), sign_npnp), inv_det);
+            _MM_TRANSPOSE4_PS(column0, column1, column2, column3);
+
+            _mm_storeu_ps(out[0], column0);
+            _mm_storeu_ps(out[1], column1);
+            _mm_storeu_ps(out[2], column2);
+            _mm_storeu_ps(out[3], column3);
+        }
+
+        /// hamilton product of (w, x, y, z) quaternions, a - b is computed as a + (-b) which rounds the same
+        inline void multiplyQuaternion(const float lhs[4], const float rhs[4], float out[4])
+        {
+            const __m128 l = _mm_loadu_ps(lhs);
+            const __m128 r = _mm_loadu_ps(rhs);
+
+            const __m128 sign_nppp = _mm_setr_ps(-0.0f, 0.0f, 0.0f, 0.0f);
+            const __m128 sign_nnnn = _mm_set1_ps(-0.0f);
+
+            // w = w rw - x rx - y ry - z rz, x = w rx + x rw + y rz - z ry ...
+            const __m128 term0 = _mm_mul_ps(PICCOLO_SIMD_SHUFFLE(l, 0, 0, 0, 0), r);
+            const __m128 term1 = _mm_mul_ps(PICCOLO_SIMD_SHUFFLE(l, 1, 1, 2, 3), PICCOLO_SIMD_SHUFFLE(r, 1, 0, 0, 0));
+            const __m128 term2 = _mm_mul_ps(PICCOLO_SIMD_SHUFFLE(l, 2, 2, 3, 1), PICCOLO_SIMD_SHUFFLE(r, 2, 3, 1, 2));
+            const __m128 term3 = _mm_mul_ps(PICCOLO_SIMD_SHUFFLE(l, 3, 3, 1, 2), PICCOLO_SIMD_SHUFFLE(r, 3, 2, 3, 1));
+
+            __m128 result = _mm_add_ps(term0, _mm_xor_ps(term1, sign_nppp));
+            result        = _mm_add_ps(result, _mm_xor_ps(term2, sign_nppp));
+            result        = _mm_add_ps(result, _mm_xor_ps(term3, sign_nnnn));
+            _mm_storeu_ps(out, result);
+        }
+
+#undef PICCOLO_SIMD_SHUFFLE
+    } // namespace MathSIMD
+} // namespace Piccolo
+
+#endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "runtime/core/math/math.h"
+#include "runtime/core/math/math_simd.h"
 #include "runtime/core/math/matrix3.h"
 #include "runtime/core/math/quaternion.h"
 #include "runtime/core/math/vector3.h"
@@ -288,6 +289,18 @@ namespace Piccolo
 
         Matrix4x4 concatenate(const Matrix4x4& m2) const
         {
+#ifdef PICCOLO_MATH_SIMD
+            Matrix4x4 r;
+            MathSIMD::multiplyMatrix4x4(m_mat, m2.m_mat, r.m_mat);
+            return r;
+#else
+            return concatenateScalar(m2);
+#endif
+        }
+
+        /// the scalar implementations are the reference of the SIMD ones, which give the same bits
+        Matrix4x4 concatenateScalar(const Matrix4x4& m2) const
+        {
             Matrix4x4 r;
             r.m_mat[0][0] = m_mat[0][0] * m2.m_mat[0][0] + m_mat[0][1] * m2.m_mat[1][0] + m_mat[0][2] * m2.m_mat[2][0] +
                             m_mat[0][3] * m2.m_mat[3][0];
@@ -343,6 +356,17 @@ namespace Piccolo
         */
         Vector3 operator*(const Vector3& v) const
         {
+#ifdef PICCOLO_MATH_SIMD
+            Vector3 r;
+            MathSIMD::transformPoint(m_mat, v.ptr(), r.ptr());
+            return r;
+#else
+            return transformScalar(v);
+#endif
+        }
+
+        Vector3 transformScalar(const Vector3& v) const
+        {
             Vector3 r;
 
             float inv_w = 1.0f / (m_mat[3][0] * v.x + m_mat[3][1] * v.y + m_mat[3][2] * v.z + m_mat[3][3]);
@@ -356,6 +380,17 @@ namespace Piccolo
 
         Vector4 operator*(const Vector4& v) const
         {
+#ifdef PICCOLO_MATH_SIMD
+            Vector4 r;
+            _mm_storeu_ps(r.ptr(), MathSIMD::transformVector4(m_mat, _mm_loadu_ps(v.ptr())));
+            return r;
+#else
+            return transformScalar(v);
+#endif
+        }
+
+        Vector4 transformScalar(const Vector4& v) const
+        {
             return Vector4(m_mat[0][0] * v.x + m_mat[0][1] * v.y + m_mat[0][2] * v.z + m_mat[0][3] * v.w,
                            m_mat[1][0] * v.x + m_mat[1][1] * v.y + m_mat[1][2] * v.z + m_mat[1][3] * v.w,
                            m_mat[2][0] * v.x + m_mat[2][1] * v.y + m_mat[2][2] * v.z + m_mat[2][3] * v.w,
@@ -893,6 +928,17 @@ namespace Piccolo
 
         Matrix4x4 inverse() const
         {
+#ifdef PICCOLO_MATH_SIMD
+            Matrix4x4 r;
+            MathSIMD::inverseMatrix4x4(m_mat, r.m_mat);
+            return r;
+#else
+            return inverseScalar();
+#endif
+        }
+
+        Matrix4x4 inverseScalar() const
+        {
             float m00 = m_mat[0][0], m01 = m_mat[0][1], m02 = m_mat[0][2], m03 = m_mat[0][3];
             float m10 = m_mat[1][0], m11 = m_mat[1][1], m12 = m_mat[1][2], m13 = m_mat[1][3];
             float m20 = m_mat[2][0], m21 = m_mat[2][1], m22 = m_mat[2][2], m23 = m_mat[2][3];
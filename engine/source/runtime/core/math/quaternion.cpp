@@ -1,4 +1,5 @@
 #include "runtime/core/math/quaternion.h"
+#include "runtime/core/math/math_simd.h"
 #include "runtime/core/math/matrix3.h"
 #include "runtime/core/math/matrix4.h"
 #include "runtime/core/math/vector3.h"
@@ -11,6 +12,17 @@ namespace Piccolo
     const float Quaternion::k_epsilon = 1e-03;
 
     Quaternion Quaternion::operator*(const Quaternion& rhs) const
+    {
+#ifdef PICCOLO_MATH_SIMD
+        Quaternion result;
+        MathSIMD::multiplyQuaternion(ptr(), rhs.ptr(), result.ptr());
+        return result;
+#else
+        return concatenateScalar(rhs);
+#endif
+    }
+
+    Quaternion Quaternion::concatenateScalar(const Quaternion& rhs) const
     {
         return Quaternion(w * rhs.w - x * rhs.x - y * rhs.y - z * rhs.z,
                           w * rhs.x + x * rhs.w + y * rhs.z - z * rhs.y,
@@ -87,6 +87,9 @@ namespace Piccolo
         Quaternion mul(const Quaternion& rhs) const { return (*this) * rhs; }
         Quaternion operator*(const Quaternion& rhs) const;
 
+        /// scalar reference of the SIMD product, both give the same bits
+        Quaternion concatenateScalar(const Quaternion& rhs) const;
+
         Quaternion operator*(float scalar) const { return Quaternion(w * scalar, x * scalar, y * scalar, z * scalar); }
 
         //// rotation of a vector by a quaternion
@@ -51,12 +51,9 @@ namespace Piccolo
         LOG_INFO(test2_context.c_str());
 
         // reflection
-        auto                       meta = TypeMetaDef(Test2, &test2_out);
-        Reflection::FieldAccessor* fields;
-        int                        fields_count = meta.m_meta.getFieldsList(fields);
-        for (int i = 0; i < fields_count; ++i)
+        auto meta = TypeMetaDef(Test2, &test2_out);
+        for (const Reflection::FieldAccessor& filed_accesser : meta.m_meta.getFields())
         {
-            auto filed_accesser = fields[i];
             std::cout << filed_accesser.getFieldTypeName() << " " << filed_accesser.getFieldName() << " "
                       << (char*)filed_accesser.get(meta.m_instance) << std::endl;
             if (filed_accesser.isArrayType())
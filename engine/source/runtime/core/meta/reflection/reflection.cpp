@@ -1,6 +1,7 @@
 #include "reflection.h"
-#include <cstring>
-#include <map>
+
+#include <deque>
+#include <mutex>
 
 namespace Piccolo
 {
@@ -9,24 +10,87 @@ namespace Piccolo
         const char* k_unknown_type = "UnknownType";
         const char* k_unknown      = "Unknown";
 
-        static std::map<std::string, ClassFunctionTuple*>       m_class_map;
-        static std::multimap<std::string, FieldFunctionTuple*>  m_field_map;
-        static std::multimap<std::string, MethodFunctionTuple*> m_method_map;
-        static std::map<std::string, ArrayFunctionTuple*>       m_array_map;
+        struct TypeMetaData
+        {
+            std::string                 type_name;
+            std::vector<FieldAccessor>  fields;
+            std::vector<MethodAccessor> methods;
+            ClassFunctionTuple*         class_functions {nullptr};
+
+            // the names are string literals of the generated code, they outlive the tables
+            std::unordered_map<std::string_view, uint32_t> field_indices;
+            std::unordered_map<std::string_view, uint32_t> method_indices;
+        };
+
+        namespace
+        {
+            // the keys view the names owned by the data, a deque never moves its elements
+            struct TypeMetaTable
+            {
+                std::deque<TypeMetaData>                                  types;
+                std::unordered_map<std::string_view, TypeMetaData*>       type_indices;
+                std::unordered_map<std::string_view, ArrayFunctionTuple*> arrays;
+            };
+
+            // filled while the types register and read only afterwards, so lookups take no lock
+            TypeMetaTable g_registry;
+
+            // names that were never registered, e.g. of builtin field types, are interned on first use
+            TypeMetaTable g_unregistered_types;
+            std::mutex    g_unregistered_types_mutex;
+
+            const TypeMetaData g_unknown_type_data {k_unknown_type};
+
+            TypeMetaData& internType(TypeMetaTable& table, std::string_view type_name)
+            {
+                auto iter = table.type_indices.find(type_name);
+                if (iter != table.type_indices.end())
+                {
+                    return *iter->second;
+                }
+
+                TypeMetaData& data = table.types.emplace_back();
+                data.type_name     = type_name;
+                table.type_indices.emplace(data.type_name, &data);
+                return data;
+            }
+
+            const TypeMetaData* findType(std::string_view type_name)
+            {
+                auto iter = g_registry.type_indices.find(type_name);
+                if (iter != g_registry.type_indices.end())
+                {
+                    return iter->second;
+                }
+
+                std::lock_guard<std::mutex> lock(g_unregistered_types_mutex);
+                return &internType(g_unregistered_types, type_name);
+            }
+        } // namespace
 
         void TypeMetaRegisterinterface::registerToFieldMap(const char* name, FieldFunctionTuple* value)
         {
-            m_field_map.insert(std::make_pair(name, value));
+            TypeMetaData& data = internType(g_registry, name);
+            FieldAccessor field(value);
+            data.field_indices.emplace(field.getFieldName(), static_cast<uint32_t>(data.fields.size()));
+            data.fields.push_back(field);
+
+            // intern the field type as well, so resolving it later does not fall back to the locked table
+            internType(g_registry, field.getFieldTypeName());
         }
         void TypeMetaRegisterinterface::registerToMethodMap(const char* name, MethodFunctionTuple* value)
         {
-            m_method_map.insert(std::make_pair(name, value));
+            TypeMetaData&  data = internType(g_registry, name);
+            MethodAccessor method(value);
+            data.method_indices.emplace(method.getMethodName(), static_cast<uint32_t>(data.methods.size()));
+            data.methods.push_back(method);
         }
         void TypeMetaRegisterinterface::registerToArrayMap(const char* name, ArrayFunctionTuple* value)
         {
-            if (m_array_map.find(name) == m_array_map.end())
+            if (g_registry.arrays.find(name) == g_registry.arrays.end())
             {
-                m_array_map.insert(std::make_pair(name, value));
+                g_registry.arrays.emplace(name, value);
+                internType(g_registry, std::get<4>(*value)());
             }
             else
             {
@@ -36,9 +100,10 @@ namespace Piccolo
 
         void TypeMetaRegisterinterface::registerToClassMap(const char* name, ClassFunctionTuple* value)
         {
-            if (m_class_map.find(name) == m_class_map.end())
+            TypeMetaData& data = internType(g_registry, name);
+            if (data.class_functions == nullptr)
             {
-                m_class_map.insert(std::make_pair(name, value));
+                data.class_functions = value;
             }
             else
             {
@@ -48,63 +113,42 @@ namespace Piccolo
 
         void TypeMetaRegisterinterface::unregisterAll()
         {
-            for (const auto& itr : m_field_map)
+            for (TypeMetaData& data : g_registry.types)
             {
-                delete itr.second;
-            }
-            m_field_map.clear();
-            for (const auto& itr : m_class_map)
-            {
-                delete itr.second;
+                for (FieldAccessor& field : data.fields)
+                {
+                    delete field.m_functions;
+                }
+                for (MethodAccessor& method : data.methods)
+                {
+                    delete method.m_functions;
+                }
+                delete data.class_functions;
             }
-            m_class_map.clear();
-            for (const auto& itr : m_array_map)
+            for (const auto& itr : g_registry.arrays)
             {
                 delete itr.second;
             }
-            m_array_map.clear();
-        }
-
-        TypeMeta::TypeMeta(std::string type_name) : m_type_name(type_name)
-        {
-            m_is_valid = false;
-            m_fields.clear();
-            m_methods.clear();
-
-            auto fileds_iter = m_field_map.equal_range(type_name);
-            while (fileds_iter.first != fileds_iter.second)
-            {
-                FieldAccessor f_field(fileds_iter.first->second);
-                m_fields.emplace_back(f_field);
-                m_is_valid = true;
-
-                ++fileds_iter.first;
-            }
-
-            auto methods_iter = m_method_map.equal_range(type_name);
-            while (methods_iter.first != methods_iter.second)
-            {
-                MethodAccessor f_method(methods_iter.first->second);
-                m_methods.emplace_back(f_method);
-                m_is_valid = true;
+            g_registry.type_indices.clear();
+            g_registry.arrays.clear();
+            g_registry.types.clear();
 
-                ++methods_iter.first;
-            }
+            std::lock_guard<std::mutex> lock(g_unregistered_types_mutex);
+            g_unregistered_types.type_indices.clear();
+            g_unregistered_types.types.clear();
         }
 
-        TypeMeta::TypeMeta() : m_type_name(k_unknown_type), m_is_valid(false) { m_fields.clear(); m_methods.clear(); }
+        TypeMeta::TypeMeta(const TypeMetaData* data) : m_data(data) {}
 
-        TypeMeta TypeMeta::newMetaFromName(std::string type_name)
-        {
-            TypeMeta f_type(type_name);
-            return f_type;
-        }
+        TypeMeta::TypeMeta() : m_data(&g_unknown_type_data) {}
+
+        TypeMeta TypeMeta::newMetaFromName(std::string_view type_name) { return TypeMeta(findType(type_name)); }
 
-        bool TypeMeta::newArrayAccessorFromName(std::string array_type_name, ArrayAccessor& accessor)
+        bool TypeMeta::newArrayAccessorFromName(std::string_view array_type_name, ArrayAccessor& accessor)
         {
-            auto iter = m_array_map.find(array_type_name);
+            auto iter = g_registry.arrays.find(array_type_name);
 
-            if (iter != m_array_map.end())
+            if (iter != g_registry.arrays.end())
             {
                 ArrayAccessor new_accessor(iter->second);
                 accessor = new_accessor;
@@ -114,100 +158,83 @@ namespace Piccolo
             return false;
         }
 
-        ReflectionInstance TypeMeta::newFromNameAndJson(std::string type_name, const Json& json_context)
+        ReflectionInstance TypeMeta::newFromNameAndJson(std::string_view type_name, const Json& json_context)
         {
-            auto iter = m_class_map.find(type_name);
+            const TypeMetaData* data = findType(type_name);
 
-            if (iter != m_class_map.end())
+            if (data->class_functions != nullptr)
             {
-                return ReflectionInstance(TypeMeta(type_name), (std::get<1>(*iter->second)(json_context)));
+                return ReflectionInstance(TypeMeta(data), (std::get<1>(*data->class_functions)(json_context)));
             }
             return ReflectionInstance();
         }
 
-        Json TypeMeta::writeByName(std::string type_name, void* instance)
+        Json TypeMeta::writeByName(std::string_view type_name, void* instance)
         {
-            auto iter = m_class_map.find(type_name);
+            const TypeMetaData* data = findType(type_name);
 
-            if (iter != m_class_map.end())
+            if (data->class_functions != nullptr)
             {
-                return std::get<2>(*iter->second)(instance);
+                return std::get<2>(*data->class_functions)(instance);
             }
             return Json();
         }
 
-        std::string TypeMeta::getTypeName() { return m_type_name; }
+        const std::string& TypeMeta::getTypeName() const { return m_data->type_name; }
 
-        int TypeMeta::getFieldsList(FieldAccessor*& out_list)
+        ReflectionSpan<FieldAccessor> TypeMeta::getFields() const
         {
-            int count = m_fields.size();
-            out_list  = new FieldAccessor[count];
-            for (int i = 0; i < count; ++i)
-            {
-                out_list[i] = m_fields[i];
-            }
-            return count;
+            return ReflectionSpan<FieldAccessor>(m_data->fields.data(), m_data->fields.size());
         }
 
-        int TypeMeta::getMethodsList(MethodAccessor*& out_list)
+        ReflectionSpan<MethodAccessor> TypeMeta::getMethods() const
         {
-            int count = m_methods.size();
-            out_list  = new MethodAccessor[count];
-            for (int i = 0; i < count; ++i)
-            {
-                out_list[i] = m_methods[i];
-            }
-            return count;
+            return ReflectionSpan<MethodAccessor>(m_data->methods.data(), m_data->methods.size());
         }
 
         int TypeMeta::getBaseClassReflectionInstanceList(ReflectionInstance*& out_list, void* instance)
         {
-            auto iter = m_class_map.find(m_type_name);
-
-            if (iter != m_class_map.end())
+            if (m_data->class_functions != nullptr)
             {
-                return (std::get<0>(*iter->second))(out_list, instance);
+                return (std::get<0>(*m_data->class_functions))(out_list, instance);
             }
 
             return 0;
         }
 
+        const FieldAccessor* TypeMeta::findField(std::string_view name) const
+        {
+            auto iter = m_data->field_indices.find(name);
+            return iter != m_data->field_indices.end() ? &m_data->fields[iter->second] : nullptr;
+        }
+
+        const MethodAccessor* TypeMeta::findMethod(std::string_view name) const
+        {
+            auto iter = m_data->method_indices.find(name);
+            return iter != m_data->method_indices.end() ? &m_data->methods[iter->second] : nullptr;
+        }
+
         FieldAccessor TypeMeta::getFieldByName(const char* name)
         {
-            const auto it = std::find_if(m_fields.begin(), m_fields.end(), [&](const auto& i) {
-                return std::strcmp(i.getFieldName(), name) == 0;
-            });
-            if (it != m_fields.end())
-                return *it;
+            const FieldAccessor* field = findField(name);
+            if (field)
+                return *field;
             return FieldAccessor(nullptr);
         }
 
         MethodAccessor TypeMeta::getMethodByName(const char* name)
         {
-            const auto it = std::find_if(m_methods.begin(), m_methods.end(), [&](const auto& i) {
-                return std::strcmp(i.getMethodName(), name) == 0;
-            });
-            if (it != m_methods.end())
-                return *it;
+            const MethodAccessor* method = findMethod(name);
+            if (method)
+                return *method;
             return MethodAccessor(nullptr);
         }
 
+        bool TypeMeta::isValid() const { return !m_data->fields.empty() || !m_data->methods.empty(); }
+
         TypeMeta& TypeMeta::operator=(const TypeMeta& dest)
         {
-            if (this == &dest)
-            {
-                return *this;
-            }
-            m_fields.clear();
-            m_fields = dest.m_fields;
-
-            
-            m_methods.clear();
-            m_methods = dest.m_methods;
-
-            m_type_name = dest.m_type_name;
-            m_is_valid  = dest.m_is_valid;
-
+            m_data = dest.m_data;
             return *this;
         }
         FieldAccessor::FieldAccessor()
@@ -230,36 +257,34 @@ namespace Piccolo
             m_field_name      = (std::get<3>(*m_functions))();
         }
 
-        void* FieldAccessor::get(void* instance)
+        void* FieldAccessor::get(void* instance) const
         {
             // todo: should check validation
             return static_cast<void*>((std::get<1>(*m_functions))(instance));
         }
 
-        void FieldAccessor::set(void* instance, void* value)
+        void FieldAccessor::set(void* instance, void* value) const
         {
             // todo: should check validation
             (std::get<0>(*m_functions))(instance, value);
         }
 
-        TypeMeta FieldAccessor::getOwnerTypeMeta()
+        TypeMeta FieldAccessor::getOwnerTypeMeta() const
         {
             // todo: should check validation
-            TypeMeta f_type((std::get<2>(*m_functions))());
-            return f_type;
+            return TypeMeta::newMetaFromName((std::get<2>(*m_functions))());
         }
 
-        bool FieldAccessor::getTypeMeta(TypeMeta& field_type)
+        bool FieldAccessor::getTypeMeta(TypeMeta& field_type) const
         {
-            TypeMeta f_type(m_field_type_name);
-            field_type = f_type;
-            return f_type.m_is_valid;
+            field_type = TypeMeta::newMetaFromName(m_field_type_name);
+            return field_type.isValid();
         }
 
         const char* FieldAccessor::getFieldName() const { return m_field_name; }
-        const char* FieldAccessor::getFieldTypeName() { return m_field_type_name; }
+        const char* FieldAccessor::getFieldTypeName() const { return m_field_type_name; }
 
-        bool FieldAccessor::isArrayType()
+        bool FieldAccessor::isArrayType() const
         {
             // todo: should check validation
             return (std::get<5>(*m_functions))();
@@ -306,7 +331,7 @@ namespace Piccolo
             m_method_name      = dest.m_method_name;
             return *this;
         }
-        void MethodAccessor::invoke(void* instance) { (std::get<1>(*m_functions))(instance); }
+        void MethodAccessor::invoke(void* instance) const { (std::get<1>(*m_functions))(instance); }
         ArrayAccessor::ArrayAccessor() :
             m_func(nullptr), m_array_type_name("UnKnownType"), m_element_type_name("UnKnownType")
         {}
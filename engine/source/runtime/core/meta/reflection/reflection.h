@@ -1,8 +1,10 @@
 #pragma once
 #include "runtime/core/meta/json.h"
 
+#include <cstddef>
 #include <functional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -70,6 +72,7 @@ namespace Piccolo
 
     namespace Reflection
     {
+        struct TypeMetaData;
         class TypeMeta;
         class FieldAccessor;
         class MethodAccessor;
@@ -108,6 +111,30 @@ namespace Piccolo
 
             static void unregisterAll();
         };
+        /// read only view of the contiguous accessor tables of a type
+        template<typename T>
+        class ReflectionSpan
+        {
+        public:
+            ReflectionSpan() = default;
+            ReflectionSpan(const T* data, size_t size) : m_data(data), m_size(size) {}
+
+            const T* begin() const { return m_data; }
+            const T* end() const { return m_data + m_size; }
+            size_t   size() const { return m_size; }
+            bool     empty() const { return m_size == 0; }
+
+            const T& operator[](size_t index) const { return m_data[index]; }
+
+        private:
+            const T* m_data {nullptr};
+            size_t   m_size {0};
+        };
+
+        /// handle to the interned meta data of a type
+        ///
+        /// the data of every type is built once while the types register and never changes afterwards, so a
+        /// TypeMeta is a pointer copy and looking one up by name is a hash probe without allocation
         class TypeMeta
         {
             friend class FieldAccessor;
@@ -117,50 +144,50 @@ namespace Piccolo
         public:
             TypeMeta();
 
-            // static void Register();
+            static TypeMeta newMetaFromName(std::string_view type_name);
 
-            static TypeMeta newMetaFromName(std::string type_name);
+            static bool               newArrayAccessorFromName(std::string_view array_type_name,
+                                                               ArrayAccessor&   accessor);
+            static ReflectionInstance newFromNameAndJson(std::string_view type_name, const Json& json_context);
+            static Json               writeByName(std::string_view type_name, void* instance);
 
-            static bool               newArrayAccessorFromName(std::string array_type_name, ArrayAccessor& accessor);
-            static ReflectionInstance newFromNameAndJson(std::string type_name, const Json& json_context);
-            static Json               writeByName(std::string type_name, void* instance);
+            const std::string& getTypeName() const;
 
-            std::string getTypeName();
-
-            int getFieldsList(FieldAccessor*& out_list);
-            int getMethodsList(MethodAccessor*& out_list);
+            ReflectionSpan<FieldAccessor>  getFields() const;
+            ReflectionSpan<MethodAccessor> getMethods() const;
 
             int getBaseClassReflectionInstanceList(ReflectionInstance*& out_list, void* instance);
 
-            FieldAccessor getFieldByName(const char* name);
+            /// nullptr when the type has no such field or method
+            const FieldAccessor*  findField(std::string_view name) const;
+            const MethodAccessor* findMethod(std::string_view name) const;
+
+            FieldAccessor  getFieldByName(const char* name);
             MethodAccessor getMethodByName(const char* name);
 
-            bool isValid() { return m_is_valid; }
+            bool isValid() const;
 
             TypeMeta& operator=(const TypeMeta& dest);
 
         private:
-            TypeMeta(std::string type_name);
+            explicit TypeMeta(const TypeMetaData* data);
 
         private:
-            std::vector<FieldAccessor, std::allocator<FieldAccessor>>   m_fields;
-            std::vector<MethodAccessor, std::allocator<MethodAccessor>> m_methods;
-            std::string                                                 m_type_name;
-
-            bool m_is_valid;
+            const TypeMetaData* m_data;
         };
 
         class FieldAccessor
         {
             friend class TypeMeta;
+            friend class TypeMetaRegisterinterface;
 
         public:
             FieldAccessor();
 
-            void* get(void* instance);
-            void  set(void* instance, void* value);
+            void* get(void* instance) const;
+            void  set(void* instance, void* value) const;
 
-            TypeMeta getOwnerTypeMeta();
+            TypeMeta getOwnerTypeMeta() const;
 
             /**
              * param: TypeMeta out_type
@@ -170,10 +197,10 @@ namespace Piccolo
              *        true: it's a reflection type
              *        false: it's not a reflection type
              */
-            bool        getTypeMeta(TypeMeta& field_type);
+            bool        getTypeMeta(TypeMeta& field_type) const;
             const char* getFieldName() const;
-            const char* getFieldTypeName();
-            bool        isArrayType();
+            const char* getFieldTypeName() const;
+            bool        isArrayType() const;
 
             FieldAccessor& operator=(const FieldAccessor& dest);
 
@@ -188,11 +215,12 @@ namespace Piccolo
         class MethodAccessor
         {
             friend class TypeMeta;
+            friend class TypeMetaRegisterinterface;
 
         public:
             MethodAccessor();
 
-            void invoke(void* instance);
+            void invoke(void* instance) const;
 
             const char* getMethodName() const;
 
@@ -0,0 +1,32 @@
+#include "runtime/core/profile/frame_stage_timer.h"
+
+namespace Piccolo
+{
+    bool                          FrameStageTimings::s_is_enabled {false};
+    FrameStageTimings::StageTimes FrameStageTimings::s_stage_times {};
+
+    const char* getFrameStageName(FrameStage stage)
+    {
+        switch (stage)
+        {
+            case FrameStage::world_tick:
+                return "world_tick";
+            case FrameStage::transform:
+                return "transform";
+            case FrameStage::physics:
+                return "physics";
+            case FrameStage::animation:
+                return "animation";
+            case FrameStage::script:
+                return "script";
+            case FrameStage::swap:
+                return "swap";
+            case FrameStage::culling:
+                return "culling";
+            case FrameStage::pass_recording:
+                return "pass_recording";
+            default:
+                return "invalid";
+        }
+    }
+} // namespace Piccolo
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace Piccolo
+{
+    /// coarse stages of a frame, timed for benchmarks and regression tracking
+    enum class FrameStage : uint8_t
+    {
+        world_tick,
+        transform,
+        physics,
+        animation,
+        script,
+        swap,
+        culling,
+        pass_recording,
+        count
+    };
+
+    const char* getFrameStageName(FrameStage stage);
+
+    /// accumulated time of each frame stage in the current frame, collected on the main thread only
+    class FrameStageTimings
+    {
+    public:
+        using StageTimes = std::array<double, static_cast<size_t>(FrameStage::count)>;
+
+        static void setEnabled(bool is_enabled) { s_is_enabled = is_enabled; }
+        static bool isEnabled() { return s_is_enabled; }
+
+        static void addStageTime(FrameStage stage, double milliseconds)
+        {
+            s_stage_times[static_cast<size_t>(stage)] += milliseconds;
+        }
+
+        /// times in milliseconds since the last reset, a stage entered several times in a frame is summed up
+        static const StageTimes& getStageTimes() { return s_stage_times; }
+
+        static void reset() { s_stage_times.fill(0.0); }
+
+    private:
+        static bool       s_is_enabled;
+        static StageTimes s_stage_times;
+    };
+
+    /// add the time spent in a scope to a frame stage, nothing is measured while the timings are disabled
+    class ScopedFrameStageTimer
+    {
+    public:
+        explicit ScopedFrameStageTimer(FrameStage stage) : m_stage(stage), m_is_enabled(FrameStageTimings::isEnabled())
+        {
+            if (m_is_enabled)
+            {
+                m_begin_time_point = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~ScopedFrameStageTimer()
+        {
+            if (m_is_enabled)
+            {
+                const std::chrono::duration<double, std::milli> duration =
+                    std::chrono::steady_clock::now() - m_begin_time_point;
+                FrameStageTimings::addStageTime(m_stage, duration.count());
+            }
+        }
+
+        ScopedFrameStageTimer(const ScopedFrameStageTimer&) = delete;
+        ScopedFrameStageTimer& operator=(const ScopedFrameStageTimer&) = delete;
+
+    private:
+        FrameStage                            m_stage;
+        bool                                  m_is_enabled;
+        std::chrono::steady_clock::time_point m_begin_time_point;
+    };
+} // namespace Piccolo
@@ -0,0 +1,296 @@
+#include "runtime/core/profile/profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace Piccolo
+{
+    namespace
+    {
+        constexpr uint32_t s_thread_buffer_capacity {16384};
+
+        // collect at most half a ring per frame, older records are mostly overwritten already
+        constexpr uint32_t s_max_collected_record_count {s_thread_buffer_capacity / 2};
+
+        // a capture is stopped when it holds this many zones, about 128 MB
+        constexpr size_t s_max_captured_record_count {4 * 1024 * 1024};
+
+        // a ring slot, written by the owning thread while the main thread may read it
+        //
+        // the sequence is odd while the slot is written and 2 * (record index + 1) once it holds that record, a
+        // reader keeps the record only if it saw the same even sequence before and after copying it
+        struct RecordSlot
+        {
+            std::atomic<uint64_t>    m_sequence {0};
+            std::atomic<const char*> m_name {nullptr};
+            std::atomic<int64_t>     m_begin_time {0};
+            std::atomic<int64_t>     m_end_time {0};
+            std::atomic<uint32_t>    m_depth {0};
+        };
+
+        struct ThreadBuffer
+        {
+            uint32_t    m_thread_index {0};
+            std::string m_thread_name; // guarded by the registry mutex
+
+            // owning thread only
+            uint32_t m_depth {0};
+
+            std::array<RecordSlot, s_thread_buffer_capacity> m_slots;
+            std::atomic<uint64_t>                           m_write_count {0};
+
+            // main thread only
+            uint64_t m_read_count {0};
+        };
+
+        struct CapturedRecord
+        {
+            uint32_t          m_thread_index;
+            ProfileZoneRecord m_record;
+        };
+
+        struct ProfilerState
+        {
+            const std::chrono::steady_clock::time_point m_start_time_point {std::chrono::steady_clock::now()};
+
+            // buffers are never freed, so a thread may exit at any time without synchronizing with the collection
+            std::mutex                                 m_registry_mutex;
+            std::vector<std::unique_ptr<ThreadBuffer>> m_thread_buffers;
+
+            // main thread only
+            std::vector<ProfileThreadFrame>                        m_last_frame;
+            int64_t                                                m_last_frame_begin_time {0};
+            float                                                  m_last_frame_time {0.f};
+            std::array<float, Profiler::s_frame_time_history_size> m_frame_time_history {};
+            uint32_t                                               m_frame_time_history_offset {0};
+            bool                                                   m_is_capturing {false};
+            std::vector<CapturedRecord>                            m_captured_records;
+        };
+
+        ProfilerState& getState()
+        {
+            static ProfilerState state;
+            return state;
+        }
+
+        thread_local ThreadBuffer* t_thread_buffer = nullptr;
+
+        ThreadBuffer& getThreadBuffer()
+        {
+            if (t_thread_buffer == nullptr)
+            {
+                ProfilerState&              state = getState();
+                std::lock_guard<std::mutex> lock(state.m_registry_mutex);
+
+                std::unique_ptr<ThreadBuffer> thread_buffer = std::make_unique<ThreadBuffer>();
+                thread_buffer->m_thread_index = static_cast<uint32_t>(state.m_thread_buffers.size());
+                thread_buffer->m_thread_name  = "thread " + std::to_string(thread_buffer->m_thread_index);
+
+                t_thread_buffer = thread_buffer.get();
+                state.m_thread_buffers.push_back(std::move(thread_buffer));
+            }
+            return *t_thread_buffer;
+        }
+
+        void writeJsonString(std::ostream& stream, const char* string)
+        {
+            stream << '"';
+            for (const char* c = string; *c != '\0'; ++c)
+            {
+                if (*c == '"' || *c == '\\')
+                    stream << '\\';
+                stream << *c;
+            }
+            stream << '"';
+        }
+    } // namespace
+
+    void Profiler::setThreadName(const char* thread_name)
+    {
+        ThreadBuffer&               thread_buffer = getThreadBuffer();
+        std::lock_guard<std::mutex> lock(getState().m_registry_mutex);
+        thread_buffer.m_thread_name = thread_name;
+    }
+
+    int64_t Profiler::getTime()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                    getState().m_start_time_point)
+            .count();
+    }
+
+    uint32_t Profiler::enterZone() { return getThreadBuffer().m_depth++; }
+
+    void Profiler::leaveZone(const char* name, int64_t begin_time, uint32_t depth)
+    {
+        const int64_t end_time = getTime();
+
+        ThreadBuffer& thread_buffer = getThreadBuffer();
+        thread_buffer.m_depth       = depth;
+
+        // only the owning thread writes, the odd sequence marks the slot as being written until the record is done
+        const uint64_t write_count = thread_buffer.m_write_count.load(std::memory_order_relaxed);
+        RecordSlot&    slot        = thread_buffer.m_slots[write_count % s_thread_buffer_capacity];
+        slot.m_sequence.store(2 * write_count + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.m_name.store(name, std::memory_order_relaxed);
+        slot.m_begin_time.store(begin_time, std::memory_order_relaxed);
+        slot.m_end_time.store(end_time, std::memory_order_relaxed);
+        slot.m_depth.store(depth, std::memory_order_relaxed);
+        slot.m_sequence.store(2 * (write_count + 1), std::memory_order_release);
+        thread_buffer.m_write_count.store(write_count + 1, std::memory_order_release);
+    }
+
+    void Profiler::beginFrame()
+    {
+        ProfilerState& state = getState();
+
+        const int64_t frame_begin_time = getTime();
+        if (state.m_last_frame_begin_time != 0)
+        {
+            state.m_last_frame_time = static_cast<float>(frame_begin_time - state.m_last_frame_begin_time) * 1e-6f;
+            state.m_frame_time_history[state.m_frame_time_history_offset] = state.m_last_frame_time;
+            state.m_frame_time_history_offset = (state.m_frame_time_history_offset + 1) % s_frame_time_history_size;
+        }
+        state.m_last_frame_begin_time = frame_begin_time;
+
+        std::lock_guard<std::mutex> lock(state.m_registry_mutex);
+
+        state.m_last_frame.resize(state.m_thread_buffers.size());
+        for (size_t buffer_index = 0; buffer_index < state.m_thread_buffers.size(); ++buffer_index)
+        {
+            ThreadBuffer&       thread_buffer = *state.m_thread_buffers[buffer_index];
+            ProfileThreadFrame& thread_frame  = state.m_last_frame[buffer_index];
+
+            thread_frame.m_thread_index = thread_buffer.m_thread_index;
+            thread_frame.m_thread_name  = thread_buffer.m_thread_name;
+            thread_frame.m_zones.clear();
+
+            const uint64_t write_count = thread_buffer.m_write_count.load(std::memory_order_acquire);
+            const uint64_t read_count =
+                std::max(thread_buffer.m_read_count,
+                         write_count > s_max_collected_record_count ? write_count - s_max_collected_record_count : 0);
+            for (uint64_t record_index = read_count; record_index < write_count; ++record_index)
+            {
+                // the owning thread keeps writing, a slot it has wrapped around to since is skipped
+                const RecordSlot& slot     = thread_buffer.m_slots[record_index % s_thread_buffer_capacity];
+                const uint64_t    sequence = 2 * (record_index + 1);
+                if (slot.m_sequence.load(std::memory_order_acquire) != sequence)
+                {
+                    continue;
+                }
+
+                ProfileZoneRecord record;
+                record.m_name       = slot.m_name.load(std::memory_order_relaxed);
+                record.m_begin_time = slot.m_begin_time.load(std::memory_order_relaxed);
+                record.m_end_time   = slot.m_end_time.load(std::memory_order_relaxed);
+                record.m_depth      = slot.m_depth.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.m_sequence.load(std::memory_order_relaxed) != sequence)
+                {
+                    continue;
+                }
+
+                thread_frame.m_zones.push_back(record);
+            }
+            thread_buffer.m_read_count = write_count;
+
+            // zones are recorded when they end, so children come before their parents
+            std::sort(thread_frame.m_zones.begin(),
+                      thread_frame.m_zones.end(),
+                      [](const ProfileZoneRecord& lhs, const ProfileZoneRecord& rhs) {
+                          return lhs.m_begin_time != rhs.m_begin_time ? lhs.m_begin_time < rhs.m_begin_time :
+                                                                        lhs.m_depth < rhs.m_depth;
+                      });
+
+            if (state.m_is_capturing)
+            {
+                for (const ProfileZoneRecord& record : thread_frame.m_zones)
+                {
+                    state.m_captured_records.push_back({thread_frame.m_thread_index, record});
+                }
+            }
+        }
+
+        if (state.m_is_capturing && state.m_captured_records.size() >= s_max_captured_record_count)
+        {
+            state.m_is_capturing = false;
+        }
+    }
+
+    const std::vector<ProfileThreadFrame>& Profiler::getLastFrame() { return getState().m_last_frame; }
+
+    float Profiler::getLastFrameTime() { return getState().m_last_frame_time; }
+
+    const float* Profiler::getFrameTimeHistory() { return getState().m_frame_time_history.data(); }
+
+    uint32_t Profiler::getFrameTimeHistoryOffset() { return getState().m_frame_time_history_offset; }
+
+    void Profiler::beginCapture()
+    {
+        ProfilerState& state = getState();
+        state.m_captured_records.clear();
+        state.m_is_capturing = true;
+    }
+
+    bool Profiler::isCapturing() { return getState().m_is_capturing; }
+
+    bool Profiler::endCapture(const std::string& trace_file_path)
+    {
+        ProfilerState& state = getState();
+        state.m_is_capturing = false;
+
+        std::ofstream trace_file(trace_file_path, std::ios::out | std::ios::trunc);
+        if (!trace_file.is_open())
+        {
+            state.m_captured_records.clear();
+            return false;
+        }
+
+        // chrome trace event format, loadable by chrome://tracing and ui.perfetto.dev, times are in microseconds
+        trace_file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        bool is_first_event = true;
+        {
+            std::lock_guard<std::mutex> lock(state.m_registry_mutex);
+            for (const std::unique_ptr<ThreadBuffer>& thread_buffer : state.m_thread_buffers)
+            {
+                trace_file << (is_first_event ? "\n" : ",\n");
+                trace_file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":"
+                           << thread_buffer->m_thread_index << ",\"args\":{\"name\":";
+                writeJsonString(trace_file, thread_buffer->m_thread_name.c_str());
+                trace_file << "}}";
+                is_first_event = false;
+            }
+        }
+
+        trace_file.setf(std::ios::fixed);
+        trace_file.precision(3);
+        for (const CapturedRecord& captured_record : state.m_captured_records)
+        {
+            const ProfileZoneRecord& record = captured_record.m_record;
+            trace_file << (is_first_event ? "\n" : ",\n") << "{\"name\":";
+            writeJsonString(trace_file, record.m_name);
+            trace_file << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":" << captured_record.m_thread_index
+                       << ",\"ts\":" << static_cast<double>(record.m_begin_time) * 1e-3
+                       << ",\"dur\":" << static_cast<double>(record.m_end_time - record.m_begin_time) * 1e-3 << "}";
+            is_first_event = false;
+        }
+
+        trace_file << "\n]}\n";
+
+        state.m_captured_records.clear();
+        state.m_captured_records.shrink_to_fit();
+
+        return trace_file.good();
+    }
+} // namespace Piccolo
+
+#endif
@@ -0,0 +1,107 @@
+#pragma once
+
+#ifdef ENABLE_PROFILER
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Piccolo
+{
+    /// a finished zone, times are in nanoseconds since the profiler started
+    struct ProfileZoneRecord
+    {
+        const char* m_name {nullptr}; // string literal, only the pointer is recorded
+        int64_t     m_begin_time {0};
+        int64_t     m_end_time {0};
+        uint32_t    m_depth {0};
+    };
+
+    /// zones finished by one thread during the last frame, sorted by begin time so parents precede their children
+    struct ProfileThreadFrame
+    {
+        uint32_t                       m_thread_index {0};
+        std::string                    m_thread_name;
+        std::vector<ProfileZoneRecord> m_zones;
+    };
+
+    /// hierarchical cpu profiler of scoped zones
+    ///
+    /// every thread records its zones into its own ring buffer without locking, the main thread collects all
+    /// buffers once per frame in beginFrame, for the overlay and, while capturing, for a chrome trace
+    class Profiler
+    {
+    public:
+        static constexpr uint32_t s_frame_time_history_size {128};
+
+        /// name the calling thread in the overlay and in traces
+        static void setThreadName(const char* thread_name);
+
+        /// mark the frame boundary, main thread only
+        static void beginFrame();
+
+        /// the following are main thread only, and valid until the next beginFrame
+
+        static const std::vector<ProfileThreadFrame>& getLastFrame();
+
+        /// milliseconds between the last two frame boundaries
+        static float getLastFrameTime();
+
+        /// ring of frame times in milliseconds, the oldest one is at getFrameTimeHistoryOffset
+        static const float* getFrameTimeHistory();
+        static uint32_t     getFrameTimeHistoryOffset();
+
+        /// keep every zone from now on, until endCapture writes them as chrome trace / perfetto json
+        static void beginCapture();
+        static bool endCapture(const std::string& trace_file_path);
+        static bool isCapturing();
+
+        static int64_t  getTime();
+        static uint32_t enterZone();
+        static void     leaveZone(const char* name, int64_t begin_time, uint32_t depth);
+    };
+
+    /// records the time spent in its scope, use PROFILE_ZONE instead of creating it directly
+    class ProfileZone
+    {
+    public:
+        explicit ProfileZone(const char* name) :
+            m_name(name), m_depth(Profiler::enterZone()), m_begin_time(Profiler::getTime())
+        {}
+
+        ~ProfileZone() { Profiler::leaveZone(m_name, m_begin_time, m_depth); }
+
+        ProfileZone(const ProfileZone&) = delete;
+        ProfileZone& operator=(const ProfileZone&) = delete;
+
+    private:
+        const char* m_name;
+        uint32_t    m_depth;
+        int64_t     m_begin_time;
+    };
+} // namespace Piccolo
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#define PROFILE_ZONE(name) ::Piccolo::ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+
+#define PROFILE_FUNCTION() PROFILE_ZONE(__FUNCTION__)
+
+#define PROFILE_FRAME() ::Piccolo::Profiler::beginFrame()
+
+#define PROFILE_THREAD(name) ::Piccolo::Profiler::setThreadName(name)
+
+#else
+
+// shipping builds are configured without ENABLE_PROFILER, and no profiling code is compiled
+
+#define PROFILE_ZONE(name)
+
+#define PROFILE_FUNCTION()
+
+#define PROFILE_FRAME()
+
+#define PROFILE_THREAD(name)
+
+#endif
@@ -2,6 +2,10 @@
 
 #include "runtime/core/base/macro.h"
 #include "runtime/core/meta/reflection/reflection_register.h"
+#include "runtime/core/profile/frame_stage_timer.h"
+#include "runtime/core/profile/profiler.h"
+
+#include "runtime/platform/file_service/file_service.h"
 
 #include "runtime/function/framework/world/world_manager.h"
 #include "runtime/function/global/global_context.h"
@@ -12,13 +16,22 @@
 #include "runtime/function/render/window_system.h"
 #include "runtime/function/render/debugdraw/debug_draw_manager.h"
 
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
 namespace Piccolo
 {
     bool                            g_is_editor_mode {false};
     std::unordered_set<std::string> g_editor_tick_component_types {};
+    bool                            g_is_headless_mode {false};
+    bool                            g_is_asset_hot_reload_enabled {false};
 
     void PiccoloEngine::startEngine(const std::string& config_file_path)
     {
+        PROFILE_THREAD("main");
+
         Reflection::TypeMetaRegister::metaRegister();
 
         g_runtime_global_context.startSystems(config_file_path);
@@ -50,6 +63,106 @@ namespace Piccolo
         }
     }
 
+    void PiccoloEngine::runHeadless(const HeadlessRunConfig& config)
+    {
+        ASSERT(g_is_headless_mode);
+
+        using namespace std::chrono;
+
+        std::ofstream timing_file;
+        std::ostream* timing_stream = nullptr;
+        if (config.m_timing_output_path == "-")
+        {
+            timing_stream = &std::cout;
+        }
+        else if (!config.m_timing_output_path.empty())
+        {
+            timing_file.open(config.m_timing_output_path, std::ios::out | std::ios::trunc);
+            if (timing_file.is_open())
+            {
+                timing_stream = &timing_file;
+            }
+            else
+            {
+                LOG_ERROR("failed to open timing output {}", config.m_timing_output_path);
+            }
+        }
+
+        if (timing_stream)
+        {
+            *timing_stream << "frame,delta_time_ms,logic_ms,frame_ms\n";
+        }
+
+        const duration<float>        frame_duration(config.m_fixed_delta_time);
+        steady_clock::time_point     next_frame_time_point = steady_clock::now();
+        uint32_t                     frame_index           = 0;
+        duration<double, std::milli> total_frame_time {0};
+        duration<double, std::milli> max_frame_time {0};
+
+        LOG_INFO("headless run: {} s per frame, {}, {} frames",
+                 config.m_fixed_delta_time,
+                 config.m_is_real_time ? "real time" : "as fast as possible",
+                 config.m_max_frame_count);
+
+        while (!m_is_quit && (config.m_max_frame_count == 0 || frame_index < config.m_max_frame_count))
+        {
+            PROFILE_FRAME();
+
+            const steady_clock::time_point frame_begin = steady_clock::now();
+
+            logicalTick(config.m_fixed_delta_time);
+            const steady_clock::time_point logic_end = steady_clock::now();
+
+            calculateFPS(config.m_fixed_delta_time);
+
+            // the render system drops the swap data, so the logic side keeps running as with a renderer
+            {
+                ScopedFrameStageTimer swap_timer(FrameStage::swap);
+                g_runtime_global_context.m_render_system->swapLogicRenderData();
+            }
+            rendererTick(config.m_fixed_delta_time);
+
+            const steady_clock::time_point frame_end = steady_clock::now();
+
+            const duration<double, std::milli> logic_time = logic_end - frame_begin;
+            const duration<double, std::milli> frame_time = frame_end - frame_begin;
+            total_frame_time += frame_time;
+            max_frame_time = std::max(max_frame_time, frame_time);
+
+            if (timing_stream)
+            {
+                *timing_stream << frame_index << ',' << config.m_fixed_delta_time * 1000.f << ','
+                               << logic_time.count() << ',' << frame_time.count() << '\n';
+            }
+
+            ++frame_index;
+
+            if (config.m_is_real_time)
+            {
+                next_frame_time_point += duration_cast<steady_clock::duration>(frame_duration);
+                // fell behind by more than a frame, do not try to catch up with a burst of frames
+                if (next_frame_time_point < frame_end - duration_cast<steady_clock::duration>(frame_duration))
+                {
+                    next_frame_time_point = frame_end;
+                }
+                std::this_thread::sleep_until(next_frame_time_point);
+            }
+        }
+
+        if (timing_stream)
+        {
+            timing_stream->flush();
+        }
+
+        if (frame_index > 0)
+        {
+            LOG_INFO("headless run finished: {} frames, average {} ms, max {} ms",
+                     frame_index,
+                     total_frame_time.count() / frame_index,
+                     max_frame_time.count());
+        }
+    }
+
     float PiccoloEngine::calculateDeltaTime()
     {
         float delta_time;
@@ -67,15 +180,27 @@ namespace Piccolo
 
     bool PiccoloEngine::tickOneFrame(float delta_time)
     {
+        PROFILE_FRAME();
+        PROFILE_ZONE("PiccoloEngine::tickOneFrame");
+
         logicalTick(delta_time);
         calculateFPS(delta_time);
 
         // single thread
         // exchange data between logic and render contexts
-        g_runtime_global_context.m_render_system->swapLogicRenderData();
+        {
+            PROFILE_ZONE("RenderSystem::swapLogicRenderData");
+            ScopedFrameStageTimer swap_timer(FrameStage::swap);
+            g_runtime_global_context.m_render_system->swapLogicRenderData();
+        }
 
         rendererTick(delta_time);
 
+        if (g_is_headless_mode)
+        {
+            return !m_is_quit;
+        }
+
 #ifdef ENABLE_PHYSICS_DEBUG_RENDERER
         g_runtime_global_context.m_physics_manager->renderPhysicsWorld(delta_time);
 #endif
@@ -92,12 +217,17 @@ namespace Piccolo
 
     void PiccoloEngine::logicalTick(float delta_time)
     {
+        PROFILE_ZONE("PiccoloEngine::logicalTick");
+
+        g_runtime_global_context.m_file_system->tick();
         g_runtime_global_context.m_world_manager->tick(delta_time);
         g_runtime_global_context.m_input_system->tick();
     }
 
     bool PiccoloEngine::rendererTick(float delta_time)
     {
+        PROFILE_ZONE("PiccoloEngine::rendererTick");
+
         g_runtime_global_context.m_render_system->tick(delta_time);
         return true;
     }
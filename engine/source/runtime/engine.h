@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <string>
 #include <unordered_set>
@@ -11,6 +12,24 @@ namespace Piccolo
     extern bool                            g_is_editor_mode;
     extern std::unordered_set<std::string> g_editor_tick_component_types;
 
+    // no window and no GPU, only the logic systems are started, set before startEngine
+    extern bool g_is_headless_mode;
+
+    // watch the asset folder and reload changed assets while running, only the editor sets it, before startEngine
+    extern bool g_is_asset_hot_reload_enabled;
+
+    struct HeadlessRunConfig
+    {
+        // simulated time of one frame
+        float m_fixed_delta_time {1.f / 60.f};
+        // true: sleep to keep the frame rate in real time, false: tick as fast as possible
+        bool m_is_real_time {true};
+        // 0 for no limit, run until quit is requested
+        uint32_t m_max_frame_count {0};
+        // per-frame timings in csv, "-" for stdout, empty for none
+        std::string m_timing_output_path;
+    };
+
     class PiccoloEngine
     {
         friend class PiccoloEditor;
@@ -25,9 +44,13 @@ namespace Piccolo
         void clear();
 
         bool isQuit() const { return m_is_quit; }
+        void requestQuit() { m_is_quit = true; }
         void run();
         bool tickOneFrame(float delta_time);
 
+        /// run the logic systems without window and render, see g_is_headless_mode
+        void runHeadless(const HeadlessRunConfig& config);
+
         int getFPS() const { return m_fps; }
 
     protected:
@@ -42,7 +65,7 @@ namespace Piccolo
         float calculateDeltaTime();
 
     protected:
-        bool m_is_quit {false};
+        std::atomic<bool> m_is_quit {false};
 
         std::chrono::steady_clock::time_point m_last_tick_time_point {std::chrono::steady_clock::now()};
 
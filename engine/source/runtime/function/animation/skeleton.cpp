@@ -1,6 +1,7 @@
 #include "runtime/function/animation/skeleton.h"
 
 #include "runtime/core/math/math.h"
+#include "runtime/core/math/math_batch.h"
 
 #include "runtime/function/animation/utilities.h"
 
@@ -53,6 +54,17 @@ namespace Piccolo
             int   current_frame_low  = floor(exact_frame);
             int   current_frame_high = ceil(exact_frame);
             float lerp_ratio         = exact_frame - current_frame_low;
+
+            // the keys are gathered first, so the rotations of all channels are interpolated in one batch
+            struct ChannelPose
+            {
+                Bone*   bone;
+                Vector3 position;
+                Vector3 scaling;
+            };
+            std::vector<ChannelPose> channel_poses;
+            std::vector<Quaternion>  rotations_low;
+            std::vector<Quaternion>  rotations_high;
             // for (size_t node_index = 0; node_index < 0; node_index++)
             for (size_t node_index = 0;
                  node_index < animation_clip.node_count && node_index < anim_skel_map.convert.size();
@@ -89,19 +101,24 @@ namespace Piccolo
                     channel.position_keys[current_frame_low], channel.position_keys[current_frame_high], lerp_ratio);
                 Vector3 scaling = Vector3::lerp(
                     channel.scaling_keys[current_frame_low], channel.scaling_keys[current_frame_high], lerp_ratio);
-                Quaternion rotation = Quaternion::nLerp(lerp_ratio,
-                                                        channel.rotation_keys[current_frame_low],
-                                                        channel.rotation_keys[current_frame_high],
-                                                        true);
+                channel_poses.push_back({bone, position, scaling});
+                rotations_low.push_back(channel.rotation_keys[current_frame_low]);
+                rotations_high.push_back(channel.rotation_keys[current_frame_high]);
+            }
 
-                {
-                    bone->rotate(rotation);
-                    bone->scale(scaling);
-                    bone->translate(position);
+            std::vector<Quaternion> rotations(channel_poses.size());
+            MathBatch::nLerpQuaternions(
+                lerp_ratio, rotations_low.data(), rotations_high.data(), rotations.data(), rotations.size(), true);
 
-                    // bone->rotate({ {},0.01,0,0,1 });
-                    // bone->scale({ {},0.9,0.9,0.9 });
-                }
+            for (size_t channel_index = 0; channel_index < channel_poses.size(); ++channel_index)
+            {
+                const ChannelPose& channel_pose = channel_poses[channel_index];
+                channel_pose.bone->rotate(rotations[channel_index]);
+                channel_pose.bone->scale(channel_pose.scaling);
+                channel_pose.bone->translate(channel_pose.position);
+
+                // bone->rotate({ {},0.01,0,0,1 });
+                // bone->scale({ {},0.9,0.9,0.9 });
             }
         }
         // bones[77].rotate(Quaternion{ {},1,0,0,1 });
@@ -118,19 +135,14 @@ namespace Piccolo
 
     AnimationResult Skeleton::outputAnimationResult()
     {
-        AnimationResult animation_result;
+        // the object matrices of all bones are concatenated with their inverse T-poses in one batch
+        std::vector<Matrix4x4> joint_matrices(m_bone_count);
+        std::vector<Matrix4x4> inverse_tposes(m_bone_count);
         for (size_t i = 0; i < m_bone_count; i++)
         {
-            std::shared_ptr<AnimationResultElement> animation_result_element =
-                std::make_shared<AnimationResultElement>();
-            Bone* bone                      = &m_bones[i];
-            animation_result_element->index = bone->getID() + 1;
-            Vector3 temp_translation        = bone->_getDerivedPosition();
+            Bone* bone = &m_bones[i];
 
             // TODO: the unit of the joint matrices is wrong
-            Vector3 temp_scale = bone->_getDerivedScale();
-
-            Quaternion temp_rotation = bone->_getDerivedOrientation();
 
             // auto scale = bone->_getDerivedTScale();
             // scale.x = 1.f / scale.x;
@@ -142,15 +154,22 @@ namespace Piccolo
             //	scale,
             //	conjugate( bone->_getDerivedTOrientation())
             //);
-            auto objMat =
+            joint_matrices[i] =
                 Transform(bone->_getDerivedPosition(), bone->_getDerivedOrientation(), bone->_getDerivedScale())
                     .getMatrix();
+            inverse_tposes[i] = bone->_getInverseTpose();
+        }
+        MathBatch::multiplyMatrices(joint_matrices.data(), inverse_tposes.data(), joint_matrices.data(), m_bone_count);
 
-            auto resMat = objMat * bone->_getInverseTpose();
-
-            animation_result_element->transform = resMat.toMatrix4x4_();
+        AnimationResult animation_result;
+        animation_result.node.reserve(m_bone_count);
+        for (size_t i = 0; i < m_bone_count; i++)
+        {
+            AnimationResultElement animation_result_element;
+            animation_result_element.index     = m_bones[i].getID() + 1;
+            animation_result_element.transform = joint_matrices[i].toMatrix4x4_();
 
-            animation_result.node.push_back(*animation_result_element);
+            animation_result.node.push_back(animation_result_element);
         }
         return animation_result;
     }
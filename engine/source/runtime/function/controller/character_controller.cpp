@@ -7,9 +7,27 @@
 #include "runtime/function/global/global_context.h"
 #include "runtime/function/physics/physics_scene.h"
 
+#include <algorithm>
+
 namespace Piccolo
 {
-    CharacterController::CharacterController(const Capsule& capsule) : m_capsule(capsule)
+    namespace
+    {
+        constexpr uint32_t s_max_sweep_hit_count {16};
+
+        // displacements shorter than this are considered done
+        constexpr float s_min_move_distance {1e-4f};
+
+        // hits whose penetration axis is (nearly) perpendicular to the motion are only touching, e.g. the floor while
+        // walking, and do not block
+        constexpr float s_min_blocking_dot {1e-3f};
+    } // namespace
+
+    CharacterController::CharacterController(const PhysicsControllerConfig& config) :
+        m_capsule(config.m_capsule_shape), m_step_height(std::max(config.m_step_height, 0.f)),
+        m_ground_snap_distance(std::max(config.m_ground_snap_distance, 0.f)),
+        m_contact_offset(std::max(config.m_contact_offset, 0.f)),
+        m_max_slide_iterations(std::max(config.m_max_slide_iterations, 1))
     {
         m_rigidbody_shape                                    = RigidBodyShape();
         m_rigidbody_shape.m_geometry                         = PICCOLO_REFLECTION_NEW(Capsule);
@@ -21,7 +39,9 @@ namespace Piccolo
         orientation.fromAngleAxis(Radian(Degree(90.f)), Vector3::UNIT_X);
 
         m_rigidbody_shape.m_local_transform =
-            Transform(Vector3(0, 0, capsule.m_half_height + capsule.m_radius), orientation, Vector3::UNIT_SCALE);
+            Transform(Vector3(0, 0, m_capsule.m_half_height + m_capsule.m_radius), orientation, Vector3::UNIT_SCALE);
+
+        m_min_walkable_normal_z = Math::cos(Radian(Degree(config.m_max_slope_angle)));
     }
 
     Vector3 CharacterController::move(const Vector3& current_position, const Vector3& displacement)
@@ -30,15 +50,143 @@ namespace Piccolo
             g_runtime_global_context.m_world_manager->getCurrentActivePhysicsScene().lock();
         ASSERT(physics_scene);
 
-        Vector3 final_position = current_position + displacement;
+        m_last_move_stats = ControllerMoveStats();
+
+        const Vector3 horizontal_displacement(displacement.x, displacement.y, 0.f);
+        const float   vertical_displacement = displacement.z;
+        const bool    has_horizontal_move   = horizontal_displacement.squaredLength() > 0.f;
+
+        Vector3 position = current_position;
 
-        Transform final_transform = Transform(final_position, Quaternion::IDENTITY, Vector3::UNIT_SCALE);
+        // up pass: lift by the step height so the side pass can walk over small obstacles, ceilings stop the lift
+        const float step_up   = (m_is_touch_ground && has_horizontal_move) ? m_step_height : 0.f;
+        const float up_length = step_up + std::max(vertical_displacement, 0.f);
+        float       lifted    = 0.f;
+        if (up_length > s_min_move_distance)
+        {
+            const Vector3 lifted_position = slide(*physics_scene, position, Vector3::UNIT_Z * up_length, SWEEP_PASS_UP);
+            lifted                        = lifted_position.z - position.z;
+            position                      = lifted_position;
+        }
 
-        if (physics_scene->isOverlap(m_rigidbody_shape, final_transform.getMatrix()))
+        // side pass: slide along walls
+        if (has_horizontal_move)
         {
-            final_position = current_position;
+            position = slide(*physics_scene, position, horizontal_displacement, SWEEP_PASS_SIDE);
+        }
+
+        // down pass: undo the step, apply the fall and snap onto the ground below
+        const float step_undo   = std::min(lifted, step_up);
+        const float fall_length = std::max(-vertical_displacement, 0.f);
+        const float snap_length = vertical_displacement <= 0.f ? m_ground_snap_distance : 0.f;
+        const float down_length = step_undo + fall_length + snap_length;
+
+        m_is_touch_ground = false;
+        if (down_length > s_min_move_distance)
+        {
+            float   hit_distance = 0.f;
+            Vector3 hit_normal;
+            if (sweepBlocking(*physics_scene,
+                              position,
+                              Vector3::NEGATIVE_UNIT_Z,
+                              down_length + m_contact_offset,
+                              hit_distance,
+                              hit_normal))
+            {
+                position.z -= std::max(hit_distance - m_contact_offset, 0.f);
+                m_is_touch_ground = isWalkable(hit_normal);
+                if (!m_is_touch_ground)
+                {
+                    // resting on a steep slope: let the character slide off it
+                    const float remaining = std::max(down_length - hit_distance, 0.f);
+                    position = slide(*physics_scene, position, Vector3::NEGATIVE_UNIT_Z * remaining, SWEEP_PASS_DOWN);
+                }
+            }
+            else
+            {
+                // nothing to snap onto, only the real fall is applied
+                position.z -= step_undo + fall_length;
+            }
+        }
+
+        return position;
+    }
+
+    bool CharacterController::sweepBlocking(PhysicsScene&  physics_scene,
+                                            const Vector3& position,
+                                            const Vector3& direction,
+                                            float          distance,
+                                            float&         out_hit_distance,
+                                            Vector3&       out_hit_normal)
+    {
+        ++m_last_move_stats.sweep_count;
+
+        const Transform shape_transform(position, Quaternion::IDENTITY, Vector3::UNIT_SCALE);
+
+        PhysicsHitInfo hits[s_max_sweep_hit_count];
+        const uint32_t hit_count = physics_scene.sweep(
+            m_rigidbody_shape, shape_transform.getMatrix(), direction, distance, hits, s_max_sweep_hit_count);
+
+        // hits are sorted by distance, the first one pushing against the motion blocks it
+        for (uint32_t hit_index = 0; hit_index < hit_count; ++hit_index)
+        {
+            const PhysicsHitInfo& hit = hits[hit_index];
+            if (hit.hit_normal.dotProduct(direction) <= s_min_blocking_dot)
+                continue;
+
+            out_hit_distance = hit.hit_distance;
+            out_hit_normal   = -hit.hit_normal;
+            return true;
+        }
+
+        return false;
+    }
+
+    Vector3 CharacterController::slide(PhysicsScene&  physics_scene,
+                                       const Vector3& position,
+                                       const Vector3& displacement,
+                                       SweepPass      pass)
+    {
+        Vector3 current_position = position;
+        Vector3 remaining        = displacement;
+
+        for (int iteration = 0; iteration < m_max_slide_iterations; ++iteration)
+        {
+            const float distance = remaining.length();
+            if (distance < s_min_move_distance)
+                break;
+
+            ++m_last_move_stats.slide_iteration_count;
+
+            const Vector3 direction = remaining / distance;
+
+            float   hit_distance = 0.f;
+            Vector3 hit_normal;
+            if (!sweepBlocking(
+                    physics_scene, current_position, direction, distance + m_contact_offset, hit_distance, hit_normal))
+            {
+                current_position += remaining;
+                break;
+            }
+
+            // stop short of the surface by the contact offset so the next sweep does not start in contact
+            const float move_distance = std::clamp(hit_distance - m_contact_offset, 0.f, distance);
+            current_position += direction * move_distance;
+            remaining = direction * (distance - move_distance);
+
+            // walking into a steep surface slides along it horizontally, so it can not be climbed
+            if (pass == SWEEP_PASS_SIDE && !isWalkable(hit_normal))
+            {
+                hit_normal.z = 0.f;
+                if (hit_normal.squaredLength() < s_min_move_distance)
+                    break;
+                hit_normal.normalise();
+            }
+
+            // project the rest of the motion onto the blocking plane
+            remaining -= hit_normal * remaining.dotProduct(hit_normal);
         }
 
-        return final_position;
+        return current_position;
     }
 } // namespace Piccolo
@@ -1,11 +1,16 @@
 #pragma once
 
 #include "runtime/core/math/vector3.h"
+#include "runtime/resource/res_type/components/motor.h"
 #include "runtime/resource/res_type/components/rigid_body.h"
 #include "runtime/resource/res_type/data/basic_shape.h"
 
+#include <cstdint>
+
 namespace Piccolo
 {
+    class PhysicsScene;
+
     enum SweepPass
     {
         SWEEP_PASS_UP,
@@ -14,24 +19,61 @@ namespace Piccolo
         SWEEP_PASS_SENSOR
     };
 
+    /// scene query cost of the last move, used to budget controllers across characters
+    struct ControllerMoveStats
+    {
+        uint32_t sweep_count {0};
+        uint32_t slide_iteration_count {0};
+    };
+
     class Controller
     {
     public:
         virtual ~Controller() = default;
 
         virtual Vector3 move(const Vector3& current_position, const Vector3& displacement) = 0;
+
+        virtual bool isTouchGround() const { return false; }
     };
 
     class CharacterController : public Controller
     {
     public:
-        CharacterController(const Capsule& capsule);
+        CharacterController(const PhysicsControllerConfig& config);
         ~CharacterController() = default;
 
+        /// collide and slide the capsule along the displacement, stepping over small obstacles and snapping to ground
         Vector3 move(const Vector3& current_position, const Vector3& displacement) override;
 
+        bool isTouchGround() const override { return m_is_touch_ground; }
+
+        const ControllerMoveStats& getLastMoveStats() const { return m_last_move_stats; }
+
     private:
+        /// sweep the capsule and find the first hit that blocks the motion
+        /// @return: true if blocked, out_hit_distance and out_hit_normal describe the blocking surface
+        bool sweepBlocking(PhysicsScene&  physics_scene,
+                           const Vector3& position,
+                           const Vector3& direction,
+                           float          distance,
+                           float&         out_hit_distance,
+                           Vector3&       out_hit_normal);
+
+        Vector3 slide(PhysicsScene& physics_scene, const Vector3& position, const Vector3& displacement, SweepPass pass);
+
+        bool isWalkable(const Vector3& surface_normal) const { return surface_normal.z >= m_min_walkable_normal_z; }
+
         Capsule        m_capsule;
         RigidBodyShape m_rigidbody_shape;
+
+        float m_step_height {0.f};
+        float m_min_walkable_normal_z {0.f};
+        float m_ground_snap_distance {0.f};
+        float m_contact_offset {0.f};
+        int   m_max_slide_iterations {1};
+
+        bool m_is_touch_ground {false};
+
+        ControllerMoveStats m_last_move_stats;
     };
 } // namespace Piccolo
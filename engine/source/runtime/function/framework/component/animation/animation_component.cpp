@@ -1,5 +1,8 @@
 #include "runtime/function/framework/component/animation/animation_component.h"
 
+#include "runtime/core/profile/frame_stage_timer.h"
+#include "runtime/core/profile/profiler.h"
+
 #include "runtime/function/animation/animation_system.h"
 #include "runtime/function/framework/object/object.h"
 
@@ -16,6 +19,10 @@ namespace Piccolo
 
     void AnimationComponent::tick(float delta_time)
     {
+        PROFILE_ZONE("AnimationComponent::tick");
+
+        ScopedFrameStageTimer animation_timer(FrameStage::animation);
+
         m_animation_res.blend_state.blend_ratio[0] +=
             (delta_time / m_animation_res.blend_state.blend_clip_file_length[0]);
         m_animation_res.blend_state.blend_ratio[0] -= floor(m_animation_res.blend_state.blend_ratio[0]);
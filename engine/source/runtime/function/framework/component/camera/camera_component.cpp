@@ -2,6 +2,7 @@
 
 #include "runtime/core/base/macro.h"
 #include "runtime/core/math/math_headers.h"
+#include "runtime/core/profile/profiler.h"
 
 #include "runtime/function/character/character.h"
 #include "runtime/function/framework/component/transform/transform_component.h"
@@ -47,6 +48,8 @@ namespace Piccolo
 
     void CameraComponent::tick(float delta_time)
     {
+        PROFILE_ZONE("CameraComponent::tick");
+
         if (!m_parent_object.lock())
             return;
 
@@ -1,62 +1,109 @@
 #include "runtime/function/framework/component/lua/lua_component.h"
 #include "runtime/core/base/macro.h"
 #include "runtime/function/framework/object/object.h"
+#include "runtime/function/global/global_context.h"
 namespace Piccolo
 {
+    LuaComponent::~LuaComponent()
+    {
+        // components loaded with an asset but never instanced have no script
+        if (m_script_id != k_invalid_lua_script_id && g_runtime_global_context.m_lua_script_manager)
+        {
+            g_runtime_global_context.m_lua_script_manager->destroyScript(m_script_id);
+        }
+    }
 
-    bool find_component_field(std::weak_ptr<GObject>     game_object,
-                              const char*                field_name,
-                              Reflection::FieldAccessor& field_accessor,
-                              void*&                     target_instance)
+    bool LuaComponent::isParentObject(const std::weak_ptr<GObject>& game_object) const
     {
-        auto components = game_object.lock()->getComponents();
+        return !game_object.owner_before(m_parent_object) && !m_parent_object.owner_before(game_object);
+    }
+
+    bool LuaComponent::resolveField(const std::weak_ptr<GObject>& game_object,
+                                    const char*                   name,
+                                    LuaFieldBinding&              out_binding)
+    {
+        const bool is_parent_object = isParentObject(game_object);
+        if (is_parent_object)
+        {
+            auto binding_iter = m_field_bindings.find(std::string_view(name));
+            if (binding_iter != m_field_bindings.end())
+            {
+                out_binding = binding_iter->second;
+                return true;
+            }
+        }
+
+        LOG_DEBUG_CATEGORY(script, name);
 
-        std::istringstream iss(field_name);
-        std::string        current_name;
-        std::getline(iss, current_name, '.');
-        auto component_iter = std::find_if(
-            components.begin(), components.end(), [current_name](auto c) { return c.getTypeName() == current_name; });
-        if (component_iter != components.end())
+        std::shared_ptr<GObject> object = game_object.lock();
+        if (!object || !LuaFieldBinding::resolve(*object, name, out_binding))
         {
-            auto  meta           = Reflection::TypeMeta::newMetaFromName(current_name);
-            void* field_instance = component_iter->getPtr();
+            return false;
+        }
 
-            // find target field
-            while (std::getline(iss, current_name, '.'))
+        if (is_parent_object)
+        {
+            m_field_bindings.emplace(name, out_binding);
+        }
+        return true;
+    }
+
+    bool LuaComponent::resolveMethod(const std::weak_ptr<GObject>& game_object,
+                                     const char*                   name,
+                                     LuaMethodBinding&             out_binding)
+    {
+        const bool is_parent_object = isParentObject(game_object);
+        if (is_parent_object)
+        {
+            auto binding_iter = m_method_bindings.find(std::string_view(name));
+            if (binding_iter != m_method_bindings.end())
             {
-                Reflection::FieldAccessor* fields;
-                int                        fields_count = meta.getFieldsList(fields);
-                auto                       field_iter   = std::find_if(
-                    fields, fields + fields_count, [current_name](auto f) { return f.getFieldName() == current_name; });
-                if (field_iter == fields + fields_count) // not found
-                {
-                    delete[] fields;
-                    return false;
-                }
-
-                field_accessor = *field_iter;
-                delete[] fields;
-
-                target_instance = field_instance;
-
-                // for next iteration
-                field_instance = field_accessor.get(target_instance);
-                field_accessor.getTypeMeta(meta);
+                out_binding = binding_iter->second;
+                return true;
             }
-            return true;
         }
-        return false;
+
+        LOG_DEBUG_CATEGORY(script, name);
+
+        std::string_view target_name(name);
+        size_t           pos = target_name.find_last_of('.');
+        if (pos == std::string_view::npos)
+        {
+            LOG_ERROR("Cand find method");
+            return false;
+        }
+        std::string_view method_name = target_name.substr(pos + 1);
+        target_name                  = target_name.substr(0, pos);
+
+        // get target instance and meta, the target is a component or a field of one
+        std::shared_ptr<GObject> object = game_object.lock();
+        if (!object || !LuaFieldBinding::resolve(*object, target_name, out_binding.target))
+        {
+            LOG_ERROR("Can't find target field.");
+            return false;
+        }
+
+        out_binding.method = out_binding.target.getTypeMeta().findMethod(method_name);
+        if (out_binding.method == nullptr)
+        {
+            LOG_ERROR("Cand find method");
+            return false;
+        }
+
+        if (is_parent_object)
+        {
+            m_method_bindings.emplace(name, out_binding);
+        }
+        return true;
     }
 
     template<typename T>
     void LuaComponent::set(std::weak_ptr<GObject> game_object, const char* name, T value)
     {
-        LOG_INFO(name);
-        Reflection::FieldAccessor field_accessor;
-        void*                     target_instance;
-        if (find_component_field(game_object, name, field_accessor, target_instance))
+        LuaFieldBinding binding;
+        if (resolveField(game_object, name, binding))
         {
-            field_accessor.set(target_instance, &value);
+            binding.set<T>(value);
         }
         else
         {
@@ -67,98 +114,70 @@ namespace Piccolo
     template<typename T>
     T LuaComponent::get(std::weak_ptr<GObject> game_object, const char* name)
     {
-
-        LOG_INFO(name);
-
-        Reflection::FieldAccessor field_accessor;
-        void*                     target_instance;
-        if (find_component_field(game_object, name, field_accessor, target_instance))
+        LuaFieldBinding binding;
+        if (resolveField(game_object, name, binding))
         {
-            return *(T*)field_accessor.get(target_instance);
+            return binding.get<T>();
         }
         else
         {
             LOG_ERROR("Can't find target field.");
+            return T {};
         }
     }
 
     void LuaComponent::invoke(std::weak_ptr<GObject> game_object, const char* name)
     {
-        LOG_INFO(name);
-
-        Reflection::TypeMeta meta;
-        void*                target_instance = nullptr;
-        std::string          method_name;
-
-        // get target instance and meta
-        std::string target_name(name);
-        size_t      pos = target_name.find_last_of('.');
-        method_name     = target_name.substr(pos + 1, target_name.size());
-        target_name     = target_name.substr(0, pos);
-
-        if (target_name.find_first_of('.') == target_name.npos)
+        LuaMethodBinding binding;
+        if (resolveMethod(game_object, name, binding))
         {
-            // target is a component
-            auto components = game_object.lock()->getComponents();
-
-            auto component_iter = std::find_if(
-                components.begin(), components.end(), [target_name](auto c) { return c.getTypeName() == target_name; });
-            if (component_iter != components.end())
-            {
-                meta            = Reflection::TypeMeta::newMetaFromName(target_name);
-                target_instance = component_iter->getPtr();
-            }
-            else
-            {
-                LOG_ERROR("Cand find component");
-                return;
-            }
-        }
-        else
-        {
-            Reflection::FieldAccessor field_accessor;
-            if (find_component_field(game_object, name, field_accessor, target_instance))
-            {
-                target_instance = field_accessor.get(target_instance);
-                field_accessor.getTypeMeta(meta);
-            }
-            else
-            {
-                LOG_ERROR("Can't find target field.");
-                return;
-            }
+            binding.method->invoke(binding.target.getAddress());
         }
+    }
 
-        // invoke function
-        Reflection::MethodAccessor* methods;
-        size_t                      method_count = meta.getMethodsList(methods);
-        auto                        method_iter  = std::find_if(
-            methods, methods + method_count, [method_name](auto m) { return m.getMethodName() == method_name; });
-        if (method_iter != methods + method_count)
+    LuaFieldBinding LuaComponent::bindField(std::weak_ptr<GObject> game_object, const char* name)
+    {
+        // the script keeps the binding, which would dangle once another object is deleted
+        LuaFieldBinding binding;
+        if (!isParentObject(game_object))
         {
-            method_iter->invoke(target_instance);
+            LOG_ERROR("bind_field only binds the fields of the script's own game object, not {}", name);
         }
-        else
+        else if (!resolveField(game_object, name, binding))
         {
-            LOG_ERROR("Cand find method");
+            LOG_ERROR("Can't find target field.");
         }
-        delete[] methods;
+        return binding;
     }
 
     void LuaComponent::postLoadResource(std::weak_ptr<GObject> parent_object)
     {
         m_parent_object = parent_object;
-        m_lua_state.open_libraries(sol::lib::base);
-        m_lua_state.set_function("set_float", &LuaComponent::set<float>);
-        m_lua_state.set_function("get_bool", &LuaComponent::get<bool>);
-        m_lua_state.set_function("invoke", &LuaComponent::invoke);
-        m_lua_state["GameObject"] = m_parent_object;
+        m_field_bindings.clear();
+        m_method_bindings.clear();
+
+        std::shared_ptr<LuaScriptManager> script_manager = g_runtime_global_context.m_lua_script_manager;
+        ASSERT(script_manager);
+
+        script_manager->destroyScript(m_script_id);
+        m_script_id = script_manager->createScript(parent_object.lock()->getName(), m_lua_script);
+        if (m_script_id == k_invalid_lua_script_id)
+        {
+            return;
+        }
+
+        sol::environment& environment = script_manager->getScriptEnvironment(m_script_id);
+        environment.set_function("set_float", &LuaComponent::set<float>, this);
+        environment.set_function("get_bool", &LuaComponent::get<bool>, this);
+        environment.set_function("invoke", &LuaComponent::invoke, this);
+        environment.set_function("bind_field", &LuaComponent::bindField, this);
+        environment["GameObject"] = m_parent_object;
     }
 
     void LuaComponent::tick(float delta_time)
     {
-        // LOG_INFO(m_lua_script);
-        m_lua_state.script(m_lua_script);
+        // the scripts run together after the objects ticked, see LuaScriptManager::tick
+        g_runtime_global_context.m_lua_script_manager->scheduleScript(m_script_id);
     }
 
 } // namespace Piccolo
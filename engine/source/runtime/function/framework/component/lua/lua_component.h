@@ -1,6 +1,11 @@
 #pragma once
 #include "sol/sol.hpp"
 #include "runtime/function/framework/component/component.h"
+#include "runtime/function/framework/component/lua/lua_field_binding.h"
+#include "runtime/function/script/lua_script_manager.h"
+
+#include <map>
+#include <string>
 
 namespace Piccolo
 {
@@ -11,21 +16,41 @@ namespace Piccolo
 
     public:
         LuaComponent() = default;
+        ~LuaComponent() override;
+
+        LuaComponent(const LuaComponent&) = delete;
+        LuaComponent& operator=(const LuaComponent&) = delete;
 
         void postLoadResource(std::weak_ptr<GObject> parent_object) override;
 
         void tick(float delta_time) override;
 
         template<typename T>
-        static void set(std::weak_ptr<GObject> game_object, const char* name, T value);
+        void set(std::weak_ptr<GObject> game_object, const char* name, T value);
 
         template<typename T>
-        static T get(std::weak_ptr<GObject> game_object, const char* name);
+        T get(std::weak_ptr<GObject> game_object, const char* name);
+
+        void invoke(std::weak_ptr<GObject> game_object, const char* name);
+
+        /// lets a script keep the resolved field, e.g. "local jump = bind_field(GameObject, path) jump:set_float(10)".
+        /// only fields of the parent object can be bound, the binding is invalid for any other object
+        LuaFieldBinding bindField(std::weak_ptr<GObject> game_object, const char* name);
 
-        static void invoke(std::weak_ptr<GObject> game_object, const char* name);
     protected:
-        sol::state m_lua_state;
+        bool resolveField(const std::weak_ptr<GObject>& game_object, const char* name, LuaFieldBinding& out_binding);
+        bool resolveMethod(const std::weak_ptr<GObject>& game_object, const char* name, LuaMethodBinding& out_binding);
+
+        bool isParentObject(const std::weak_ptr<GObject>& game_object) const;
+
         META(Enable)
         std::string m_lua_script;
+
+        // the script runs in the shared state of the LuaScriptManager
+        LuaScriptID m_script_id {k_invalid_lua_script_id};
+
+        // paths of the parent object resolved so far, the script asks for the same ones every tick
+        std::map<std::string, LuaFieldBinding, std::less<>>  m_field_bindings;
+        std::map<std::string, LuaMethodBinding, std::less<>> m_method_bindings;
     };
 } // namespace Piccolo
@@ -0,0 +1,77 @@
+#include "runtime/function/framework/component/lua/lua_field_binding.h"
+
+#include "runtime/core/base/macro.h"
+
+#include "runtime/function/framework/object/object.h"
+
+#include <cstring>
+
+namespace Piccolo
+{
+    bool LuaFieldBinding::resolve(GObject& game_object, std::string_view path, LuaFieldBinding& out_binding)
+    {
+        out_binding = LuaFieldBinding();
+
+        size_t           separator      = path.find('.');
+        std::string_view component_name = path.substr(0, separator);
+
+        void* component = nullptr;
+        for (const Reflection::ReflectionPtr<Component>& component_ptr : game_object.getComponents())
+        {
+            if (component_ptr.getTypeName() == component_name)
+            {
+                component = component_ptr.getPtr();
+                break;
+            }
+        }
+        if (component == nullptr)
+        {
+            return false;
+        }
+
+        // the generated accessors return the address of the member, the difference to the owner is the offset
+        // and it is the same for every instance of the owner type
+        Reflection::TypeMeta meta            = Reflection::TypeMeta::newMetaFromName(component_name);
+        void*                field_instance  = component;
+        const char*          field_type_name = nullptr;
+        while (separator != std::string_view::npos)
+        {
+            size_t           next_separator = path.find('.', separator + 1);
+            std::string_view field_name     = path.substr(separator + 1, next_separator - separator - 1);
+
+            const Reflection::FieldAccessor* field = meta.findField(field_name);
+            if (field == nullptr)
+            {
+                return false;
+            }
+
+            field_instance  = field->get(field_instance);
+            field_type_name = field->getFieldTypeName();
+            field->getTypeMeta(meta);
+            separator = next_separator;
+        }
+
+        out_binding.m_component = component;
+        out_binding.m_offset    = static_cast<uint8_t*>(field_instance) - static_cast<uint8_t*>(component);
+        out_binding.m_type_meta       = meta;
+        out_binding.m_field_type_name = field_type_name;
+        return true;
+    }
+
+    bool LuaFieldBinding::isFieldType(const char* type_name) const
+    {
+        if (!isValid())
+        {
+            return false;
+        }
+        if (m_field_type_name == nullptr || std::strcmp(m_field_type_name, type_name) != 0)
+        {
+            LOG_ERROR_CATEGORY(script,
+                               "cannot access a field of type {} as {}",
+                               m_field_type_name ? m_field_type_name : m_type_meta.getTypeName(),
+                               type_name);
+            return false;
+        }
+        return true;
+    }
+} // namespace Piccolo
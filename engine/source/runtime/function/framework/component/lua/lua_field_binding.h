@@ -0,0 +1,84 @@
+#pragma once
+
+#include "runtime/core/meta/reflection/reflection.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Piccolo
+{
+    class Component;
+    class GObject;
+
+    /// the reflected type name of the builtin types scripts can read and write
+    template<typename T>
+    struct LuaFieldTypeName;
+    template<>
+    struct LuaFieldTypeName<bool>
+    {
+        static constexpr const char* value = "bool";
+    };
+    template<>
+    struct LuaFieldTypeName<int>
+    {
+        static constexpr const char* value = "int";
+    };
+    template<>
+    struct LuaFieldTypeName<float>
+    {
+        static constexpr const char* value = "float";
+    };
+
+    /// a dotted path like "TransformComponent.m_transform.m_position.x" resolved once to its component and the byte
+    /// offset of the field inside it, so scripts read and write the field without walking the reflection data again
+    ///
+    /// the binding points into the component and must not outlive it, a script only keeps bindings of the fields of
+    /// its own game object
+    class LuaFieldBinding
+    {
+    public:
+        /// the path may end at a nested object, e.g. the target of a method call
+        static bool resolve(GObject& game_object, std::string_view path, LuaFieldBinding& out_binding);
+
+        bool isValid() const { return m_component != nullptr; }
+
+        void* getAddress() const { return static_cast<uint8_t*>(m_component) + m_offset; }
+
+        /// meta of the bound object, not valid for fields of builtin types
+        const Reflection::TypeMeta& getTypeMeta() const { return m_type_meta; }
+
+        /// get and set only touch a field of exactly the builtin type T, anything else is logged and ignored
+        template<typename T>
+        T get() const
+        {
+            return isFieldType(LuaFieldTypeName<T>::value) ? *static_cast<const T*>(getAddress()) : T {};
+        }
+
+        template<typename T>
+        void set(T value) const
+        {
+            if (isFieldType(LuaFieldTypeName<T>::value))
+            {
+                *static_cast<T*>(getAddress()) = value;
+            }
+        }
+
+    private:
+        bool isFieldType(const char* type_name) const;
+
+        void*                m_component {nullptr};
+        size_t               m_offset {0};
+        Reflection::TypeMeta m_type_meta;
+
+        // the reflected type of the field the path ends at, nullptr if it ends at the component
+        const char* m_field_type_name {nullptr};
+    };
+
+    /// a dotted path ending with a method name, e.g. "MotorComponent.getOffStuckDead"
+    struct LuaMethodBinding
+    {
+        LuaFieldBinding                   target;
+        const Reflection::MethodAccessor* method {nullptr};
+    };
+} // namespace Piccolo
@@ -1,5 +1,7 @@
 #include "runtime/function/framework/component/mesh/mesh_component.h"
 
+#include "runtime/core/profile/profiler.h"
+
 #include "runtime/resource/asset_manager/asset_manager.h"
 #include "runtime/resource/res_type/data/material.h"
 
@@ -13,6 +15,14 @@
 
 namespace Piccolo
 {
+    MeshComponent::~MeshComponent()
+    {
+        for (RenderEntityHandle render_entity_handle : m_render_entity_handles)
+        {
+            RenderEntityHandleAllocator::free(render_entity_handle);
+        }
+    }
+
     void MeshComponent::postLoadResource(std::weak_ptr<GObject> parent_object)
     {
         m_parent_object = parent_object;
@@ -33,31 +43,67 @@ namespace Piccolo
 
             if (meshComponent.m_material_desc.m_with_texture)
             {
-                MaterialRes material_res;
-                asset_manager->loadAsset(sub_mesh.m_material, material_res);
-
-                meshComponent.m_material_desc.m_base_color_texture_file =
-                    asset_manager->getFullPath(material_res.m_base_colour_texture_file).generic_string();
-                meshComponent.m_material_desc.m_metallic_roughness_texture_file =
-                    asset_manager->getFullPath(material_res.m_metallic_roughness_texture_file).generic_string();
-                meshComponent.m_material_desc.m_normal_texture_file =
-                    asset_manager->getFullPath(material_res.m_normal_texture_file).generic_string();
-                meshComponent.m_material_desc.m_occlusion_texture_file =
-                    asset_manager->getFullPath(material_res.m_occlusion_texture_file).generic_string();
-                meshComponent.m_material_desc.m_emissive_texture_file =
-                    asset_manager->getFullPath(material_res.m_emissive_texture_file).generic_string();
+                loadMaterialDesc(sub_mesh.m_material, meshComponent.m_material_desc);
             }
 
             auto object_space_transform = sub_mesh.m_transform.getMatrix();
 
             meshComponent.m_transform_desc.m_transform_matrix = object_space_transform;
 
+            if (raw_mesh_count >= m_render_entity_handles.size())
+            {
+                m_render_entity_handles.push_back(RenderEntityHandleAllocator::alloc());
+            }
+            meshComponent.m_render_entity_handle = m_render_entity_handles[raw_mesh_count];
+
             ++raw_mesh_count;
         }
+
+        m_is_render_desc_dirty = true;
+    }
+
+    void MeshComponent::onMaterialFileChanged(const std::filesystem::path& material_file)
+    {
+        std::shared_ptr<AssetManager> asset_manager = g_runtime_global_context.m_asset_manager;
+        ASSERT(asset_manager);
+
+        for (size_t part_index = 0; part_index < m_mesh_res.m_sub_meshes.size(); ++part_index)
+        {
+            const std::string& material_url = m_mesh_res.m_sub_meshes[part_index].m_material;
+            if (material_url.empty() || asset_manager->getFullPath(material_url).lexically_normal() != material_file)
+            {
+                continue;
+            }
+
+            loadMaterialDesc(material_url, m_raw_meshes[part_index].m_material_desc);
+            m_is_render_desc_dirty = true;
+        }
+    }
+
+    void MeshComponent::loadMaterialDesc(const std::string& material_url, GameObjectMaterialDesc& out_material_desc)
+    {
+        std::shared_ptr<AssetManager> asset_manager = g_runtime_global_context.m_asset_manager;
+        ASSERT(asset_manager);
+
+        MaterialRes material_res;
+        asset_manager->loadAsset(material_url, material_res);
+
+        out_material_desc.m_base_color_texture_file =
+            asset_manager->getFullPath(material_res.m_base_colour_texture_file).generic_string();
+        out_material_desc.m_metallic_roughness_texture_file =
+            asset_manager->getFullPath(material_res.m_metallic_roughness_texture_file).generic_string();
+        out_material_desc.m_normal_texture_file =
+            asset_manager->getFullPath(material_res.m_normal_texture_file).generic_string();
+        out_material_desc.m_occlusion_texture_file =
+            asset_manager->getFullPath(material_res.m_occlusion_texture_file).generic_string();
+        out_material_desc.m_emissive_texture_file =
+            asset_manager->getFullPath(material_res.m_emissive_texture_file).generic_string();
     }
 
     void MeshComponent::tick(float delta_time)
     {
+        PROFILE_ZONE("MeshComponent::tick");
+
         if (!m_parent_object.lock())
             return;
 
@@ -65,17 +111,32 @@ namespace Piccolo
         const AnimationComponent* animation_component =
             m_parent_object.lock()->tryGetComponentConst(AnimationComponent);
 
-        if (transform_component->isDirty())
+        if (!transform_component->isDirty() && !m_is_render_desc_dirty)
+        {
+            return;
+        }
+
+        RenderSwapContext& render_swap_context = g_runtime_global_context.m_render_system->getSwapContext();
+        RenderSwapData&    logic_swap_data     = render_swap_context.getLogicSwapData();
+
+        m_joint_matrices.clear();
+        if (animation_component != nullptr)
+        {
+            m_joint_matrices.push_back(Matrix4x4::IDENTITY);
+            for (auto& node : animation_component->getResult().node)
+            {
+                m_joint_matrices.push_back(Matrix4x4(node.transform));
+            }
+        }
+
+        if (m_is_render_desc_dirty)
         {
             std::vector<GameObjectPartDesc> dirty_mesh_parts;
             SkeletonAnimationResult         animation_result;
             animation_result.m_transforms.push_back({Matrix4x4::IDENTITY});
-            if (animation_component != nullptr)
+            for (size_t joint_index = 1; joint_index < m_joint_matrices.size(); ++joint_index)
             {
-                for (auto& node : animation_component->getResult().node)
-                {
-                    animation_result.m_transforms.push_back({Matrix4x4(node.transform)});
-                }
+                animation_result.m_transforms.push_back({m_joint_matrices[joint_index]});
             }
             for (GameObjectPartDesc& mesh_part : m_raw_meshes)
             {
@@ -94,12 +155,23 @@ namespace Piccolo
                 mesh_part.m_transform_desc.m_transform_matrix = object_transform_matrix;
             }
 
-            RenderSwapContext& render_swap_context = g_runtime_global_context.m_render_system->getSwapContext();
-            RenderSwapData&    logic_swap_data     = render_swap_context.getLogicSwapData();
-
             logic_swap_data.addDirtyGameObject(GameObjectDesc {m_parent_object.lock()->getID(), dirty_mesh_parts});
 
-            transform_component->setDirtyFlag(false);
+            m_is_render_desc_dirty = false;
         }
+        else
+        {
+            m_model_matrices.resize(m_raw_meshes.size());
+            for (size_t part_index = 0; part_index < m_raw_meshes.size(); ++part_index)
+            {
+                m_model_matrices[part_index] =
+                    transform_component->getMatrix() * m_raw_meshes[part_index].m_transform_desc.m_transform_matrix;
+            }
+
+            logic_swap_data.updateRenderEntityTransforms(
+                m_render_entity_handles.data(), m_model_matrices.data(), m_model_matrices.size(), m_joint_matrices);
+        }
+
+        transform_component->setDirtyFlag(false);
     }
 } // namespace Piccolo
@@ -6,6 +6,8 @@
 
 #include "runtime/function/render/render_object.h"
 
+#include <filesystem>
+#include <string>
 #include <vector>
 
 namespace Piccolo
@@ -18,17 +20,33 @@ namespace Piccolo
         REFLECTION_BODY(MeshComponent)
     public:
         MeshComponent() {};
+        ~MeshComponent() override;
 
         void postLoadResource(std::weak_ptr<GObject> parent_object) override;
 
         const std::vector<GameObjectPartDesc>& getRawMeshes() const { return m_raw_meshes; }
 
+        /// reread the parts using the material file, the next tick sends their whole descriptions again
+        /// @material_file: absolute and lexically normal, as reported by the file system
+        void onMaterialFileChanged(const std::filesystem::path& material_file);
+
         void tick(float delta_time) override;
 
     private:
+        void loadMaterialDesc(const std::string& material_url, GameObjectMaterialDesc& out_material_desc);
+
         META(Enable)
         MeshComponentRes m_mesh_res;
 
         std::vector<GameObjectPartDesc> m_raw_meshes;
+
+        // one per part, the updates sent to the render system name the render entities by them
+        std::vector<RenderEntityHandle> m_render_entity_handles;
+        // the whole part descriptions are sent on creation and when a mesh or material changes, else only transforms
+        bool m_is_render_desc_dirty {true};
+
+        // scratch buffers of the transform updates
+        std::vector<Matrix4x4> m_model_matrices;
+        std::vector<Matrix4x4> m_joint_matrices;
     };
 } // namespace Piccolo
@@ -1,6 +1,7 @@
 #include "runtime/function/framework/component/motor/motor_component.h"
 
 #include "runtime/core/base/macro.h"
+#include "runtime/core/profile/profiler.h"
 
 #include "runtime/function/character/character.h"
 #include "runtime/function/controller/character_controller.h"
@@ -25,7 +26,7 @@ namespace Piccolo
             m_controller_type = ControllerType::physics;
             PhysicsControllerConfig* controller_config =
                 static_cast<PhysicsControllerConfig*>(m_motor_res.m_controller_config);
-            m_controller = new CharacterController(controller_config->m_capsule_shape);
+            m_controller = new CharacterController(*controller_config);
         }
         else if (m_motor_res.m_controller_config != nullptr)
         {
@@ -48,7 +49,12 @@ namespace Piccolo
         }
     }
 
-    void MotorComponent::tick(float delta_time) { tickPlayerMotor(delta_time); }
+    void MotorComponent::tick(float delta_time)
+    {
+        PROFILE_ZONE("MotorComponent::tick");
+
+        tickPlayerMotor(delta_time);
+    }
 
     void MotorComponent::tickPlayerMotor(float delta_time)
     {
@@ -213,6 +219,12 @@ namespace Piccolo
                 break;
         }
 
+        if (m_jump_state == JumpState::falling && m_controller_type == ControllerType::physics &&
+            m_controller->isTouchGround())
+        {
+            m_jump_state = JumpState::idle;
+        }
+
         // Piccolo-hack: motor level simulating jump, character always above z-plane
         if (m_jump_state == JumpState::falling && final_position.z + m_desired_displacement.z <= 0.f)
         {
@@ -5,6 +5,7 @@
 #include "runtime/function/particle/particle_manager.h"
 
 #include "runtime/core/base/macro.h"
+#include "runtime/core/profile/profiler.h"
 #include "runtime/function/global/global_context.h"
 #include "runtime/function/render/render_swap_context.h"
 #include "runtime/function/render/render_system.h"
@@ -43,6 +44,8 @@ namespace Piccolo
 
     void ParticleComponent::tick(float delta_time)
     {
+        PROFILE_ZONE("ParticleComponent::tick");
+
         RenderSwapContext& swap_context = g_runtime_global_context.m_render_system->getSwapContext();
 
         RenderSwapData& logic_swap_data = swap_context.getLogicSwapData();
@@ -27,7 +27,8 @@ namespace Piccolo
             g_runtime_global_context.m_world_manager->getCurrentActivePhysicsScene().lock();
         ASSERT(physics_scene);
 
-        m_rigidbody_id = physics_scene->createRigidBody(parent_transform->getTransformConst(), m_rigidbody_res);
+        m_rigidbody_id = physics_scene->createRigidBody(
+            parent_transform->getTransformConst(), m_rigidbody_res, m_parent_object.lock()->getID());
     }
 
     RigidBodyComponent::~RigidBodyComponent()
@@ -45,7 +46,7 @@ namespace Piccolo
             g_runtime_global_context.m_world_manager->getCurrentActivePhysicsScene().lock();
         ASSERT(physics_scene);
 
-        m_rigidbody_id = physics_scene->createRigidBody(global_transform, m_rigidbody_res);
+        m_rigidbody_id = physics_scene->createRigidBody(global_transform, m_rigidbody_res, m_parent_object.lock()->getID());
     }
 
     void RigidBodyComponent::removeRigidBody()
@@ -71,7 +72,14 @@ namespace Piccolo
                 g_runtime_global_context.m_world_manager->getCurrentActivePhysicsScene().lock();
             ASSERT(physics_scene);
 
-            physics_scene->updateRigidBodyGlobalTransform(m_rigidbody_id, transform);
+            if (m_rigidbody_res.getActorType() == RigidBodyActorType::kinematic_actor)
+            {
+                physics_scene->moveKinematicRigidBody(m_rigidbody_id, transform);
+            }
+            else
+            {
+                physics_scene->updateRigidBodyGlobalTransform(m_rigidbody_id, transform);
+            }
         }
     }
 
@@ -1,16 +1,30 @@
 #include "runtime/function/framework/component/transform/transform_component.h"
 
+#include "runtime/core/profile/profiler.h"
 #include "runtime/engine.h"
 #include "runtime/function/framework/component/rigidbody/rigidbody_component.h"
 
 namespace Piccolo
 {
+    namespace
+    {
+        // the world scale decomposed from the matrices of a moving parent jitters by rounding, smaller changes do not
+        // rebuild the rigidbody shape
+        constexpr float k_scale_change_tolerance = 1e-4f;
+
+        bool isSameTransform(const Transform& lhs, const Transform& rhs)
+        {
+            return lhs.m_position == rhs.m_position && lhs.m_rotation == rhs.m_rotation && lhs.m_scale == rhs.m_scale;
+        }
+    } // namespace
+
     void TransformComponent::postLoadResource(std::weak_ptr<GObject> parent_gobject)
     {
         m_parent_object       = parent_gobject;
         m_transform_buffer[0] = m_transform;
         m_transform_buffer[1] = m_transform;
         m_is_dirty            = true;
+        m_is_local_dirty      = true;
     }
 
     void TransformComponent::setPosition(const Vector3& new_translation)
@@ -18,6 +32,8 @@ namespace Piccolo
         m_transform_buffer[m_next_index].m_position = new_translation;
         m_transform.m_position                      = new_translation;
         m_is_dirty                                  = true;
+        m_is_updated_by_physics                     = false;
+        m_is_local_dirty                            = true;
     }
 
     void TransformComponent::setScale(const Vector3& new_scale)
@@ -26,6 +42,8 @@ namespace Piccolo
         m_transform.m_scale                      = new_scale;
         m_is_dirty                               = true;
         m_is_scale_dirty                         = true;
+        m_is_updated_by_physics                  = false;
+        m_is_local_dirty                         = true;
     }
 
     void TransformComponent::setRotation(const Quaternion& new_rotation)
@@ -33,24 +51,75 @@ namespace Piccolo
         m_transform_buffer[m_next_index].m_rotation = new_rotation;
         m_transform.m_rotation                      = new_rotation;
         m_is_dirty                                  = true;
+        m_is_updated_by_physics                     = false;
+        m_is_local_dirty                            = true;
+    }
+
+    void TransformComponent::setTransformFromPhysics(const Vector3& new_translation, const Quaternion& new_rotation)
+    {
+        m_transform_buffer[m_next_index].m_position = new_translation;
+        m_transform_buffer[m_next_index].m_rotation = new_rotation;
+        m_transform.m_position                      = new_translation;
+        m_transform.m_rotation                      = new_rotation;
+        m_is_dirty                                  = true;
+        m_is_updated_by_physics                     = true;
+        m_is_local_dirty                            = true;
     }
 
     void TransformComponent::tick(float delta_time)
     {
+        PROFILE_ZONE("TransformComponent::tick");
+
         std::swap(m_current_index, m_next_index);
 
-        if (m_is_dirty)
+        if (m_is_dirty && !m_is_updated_by_physics)
         {
             // update transform component, dirty flag will be reset in mesh component
             tryUpdateRigidBodyComponent();
         }
+        m_is_updated_by_physics = false;
 
         if (g_is_editor_mode)
         {
+            // the editor may write the reflected transform directly, the setters keep the current buffer equal to it
+            if (!isSameTransform(m_transform, m_transform_buffer[m_current_index]))
+            {
+                m_transform_buffer[m_current_index] = m_transform;
+                m_is_local_dirty                    = true;
+            }
             m_transform_buffer[m_next_index] = m_transform;
         }
     }
 
+    bool TransformComponent::consumeLocalDirty()
+    {
+        const bool is_local_dirty = m_is_local_dirty;
+        m_is_local_dirty          = false;
+        return is_local_dirty;
+    }
+
+    void TransformComponent::setWorldMatrix(const Matrix4x4& world_matrix, bool has_parent)
+    {
+        const Vector3 previous_world_scale = getWorldTransform().m_scale;
+
+        m_world_matrix = world_matrix;
+        m_has_parent   = has_parent;
+        if (has_parent)
+        {
+            // a parent moving changes the world transform of the rigidbody too
+            m_world_matrix.decomposition(
+                m_world_transform.m_position, m_world_transform.m_scale, m_world_transform.m_rotation);
+        }
+
+        // the rigidbody is only rebuilt for a new scale, not when the parent just moves or turns
+        if (getWorldTransform().m_scale.squaredDistance(previous_world_scale) >
+            k_scale_change_tolerance * k_scale_change_tolerance)
+        {
+            m_is_scale_dirty = true;
+        }
+        m_is_dirty = true;
+    }
+
     void TransformComponent::tryUpdateRigidBodyComponent()
     {
         if (!m_parent_object.lock())
@@ -59,7 +128,7 @@ namespace Piccolo
         RigidBodyComponent* rigid_body_component = m_parent_object.lock()->tryGetComponent(RigidBodyComponent);
         if (rigid_body_component)
         {
-            rigid_body_component->updateGlobalTransform(m_transform_buffer[m_current_index], m_is_scale_dirty);
+            rigid_body_component->updateGlobalTransform(getWorldTransform(), m_is_scale_dirty);
             m_is_scale_dirty = false;
         }
     }
@@ -6,6 +6,8 @@
 #include "runtime/function/framework/component/component.h"
 #include "runtime/function/framework/object/object.h"
 
+#include <string>
+
 namespace Piccolo
 {
     REFLECTION_TYPE(TransformComponent)
@@ -28,10 +30,29 @@ namespace Piccolo
 
         void setRotation(const Quaternion& new_rotation);
 
+        // write back the simulated transform of a dynamic rigidbody, which is not pushed into physics again
+        void setTransformFromPhysics(const Vector3& new_translation, const Quaternion& new_rotation);
+
         const Transform& getTransformConst() const { return m_transform_buffer[m_current_index]; }
         Transform&       getTransform() { return m_transform_buffer[m_next_index]; }
 
-        Matrix4x4 getMatrix() const { return m_transform_buffer[m_current_index].getMatrix(); }
+        /// local to world, cached by the transform hierarchy of the level
+        const Matrix4x4& getMatrix() const { return m_world_matrix; }
+        /// local to parent, the latest value set
+        Matrix4x4 getLocalMatrix() const { return m_transform.getMatrix(); }
+        /// the world matrix decomposed for a child, the local transform for a root
+        const Transform& getWorldTransform() const
+        {
+            return m_has_parent ? m_world_transform : m_transform_buffer[m_current_index];
+        }
+
+        const std::string& getParentName() const { return m_parent_name; }
+        bool               hasParent() const { return m_has_parent; }
+
+        // called by the transform hierarchy, true if the local transform changed since the last call
+        bool consumeLocalDirty();
+        // called by the transform hierarchy with the new world matrix
+        void setWorldMatrix(const Matrix4x4& world_matrix, bool has_parent);
 
         void tick(float delta_time) override;
 
@@ -41,8 +62,19 @@ namespace Piccolo
         META(Enable)
         Transform m_transform;
 
+        // the name of the object this one is attached to, empty for a root
+        META(Enable)
+        std::string m_parent_name;
+
         Transform m_transform_buffer[2];
         size_t    m_current_index {0};
         size_t    m_next_index {1};
+
+        Matrix4x4 m_world_matrix {Matrix4x4::IDENTITY};
+        Transform m_world_transform;
+        bool      m_has_parent {false};
+
+        bool m_is_updated_by_physics {false};
+        bool m_is_local_dirty {true};
     };
 } // namespace Piccolo
@@ -1,29 +1,81 @@
 #include "runtime/function/framework/level/level.h"
 
 #include "runtime/core/base/macro.h"
+#include "runtime/core/profile/frame_stage_timer.h"
+#include "runtime/core/profile/profiler.h"
 
 #include "runtime/resource/asset_manager/asset_manager.h"
 #include "runtime/resource/res_type/common/level.h"
 
 #include "runtime/engine.h"
 #include "runtime/function/character/character.h"
+#include "runtime/function/framework/component/transform/transform_component.h"
+#include "runtime/function/framework/level/level_streamer.h"
 #include "runtime/function/framework/object/object.h"
+#include "runtime/function/framework/world/world_manager.h"
 #include "runtime/function/particle/particle_manager.h"
 #include "runtime/function/physics/physics_manager.h"
 #include "runtime/function/physics/physics_scene.h"
+#include "runtime/function/render/render_camera.h"
+#include "runtime/function/render/render_swap_context.h"
+#include "runtime/function/render/render_system.h"
+#include "runtime/function/script/lua_script_manager.h"
+#include <algorithm>
 #include <limits>
 
 namespace Piccolo
 {
+    Level::Level() = default;
+
+    Level::~Level() {}
+
     void Level::clear()
     {
+        // stop reading cells before the objects go
+        m_streamer.reset();
+
         m_current_active_character.reset();
+        m_transform_hierarchy.clear();
         m_gobjects.clear();
+        m_body_ids.clear();
+        m_body_transform_components.clear();
 
         ASSERT(g_runtime_global_context.m_physics_manager);
         g_runtime_global_context.m_physics_manager->deletePhysicsScene(m_physics_scene);
     }
 
+    namespace
+    {
+        PhysicsConfig makePhysicsConfig(const Vector3& gravity, const LevelPhysicsRes& physics_res)
+        {
+            PhysicsConfig config;
+            config.m_gravity = gravity;
+
+            const PhysicsConfig default_config;
+            auto to_count = [](int value, uint32_t default_value) {
+                return value > 0 ? static_cast<uint32_t>(value) : default_value;
+            };
+            config.m_max_body_count           = to_count(physics_res.m_max_body_count, default_config.m_max_body_count);
+            config.m_max_body_pairs           = to_count(physics_res.m_max_body_pairs, default_config.m_max_body_pairs);
+            config.m_max_contact_constraints  = to_count(physics_res.m_max_contact_constraints,
+                                                        default_config.m_max_contact_constraints);
+            config.m_max_concurrent_job_count = to_count(physics_res.m_max_concurrent_job_count,
+                                                         default_config.m_max_concurrent_job_count);
+            config.m_optimize_broad_phase_body_count = static_cast<uint32_t>(
+                std::max(physics_res.m_optimize_broad_phase_body_count, 0));
+
+            config.m_broad_phase_layers = physics_res.m_broad_phase_layers;
+            config.m_object_layers.reserve(physics_res.m_object_layers.size());
+            for (const PhysicsObjectLayerRes& layer_res : physics_res.m_object_layers)
+            {
+                config.m_object_layers.push_back(
+                    {layer_res.m_name, layer_res.m_broad_phase_layer, layer_res.m_collide_with});
+            }
+
+            return config;
+        }
+    } // namespace
+
     GObjectID Level::createObject(const ObjectInstanceRes& object_instance_res)
     {
         GObjectID object_id = ObjectIDAllocator::alloc();
@@ -43,6 +95,12 @@ namespace Piccolo
         if (is_loaded)
         {
             m_gobjects.emplace(object_id, gobject);
+
+            TransformComponent* transform_component = gobject->tryGetComponent(TransformComponent);
+            if (transform_component)
+            {
+                m_transform_hierarchy.addObject(object_id, transform_component);
+            }
         }
         else
         {
@@ -66,13 +124,11 @@ namespace Piccolo
         }
 
         ASSERT(g_runtime_global_context.m_physics_manager);
-        m_physics_scene = g_runtime_global_context.m_physics_manager->createPhysicsScene(level_res.m_gravity);
+        m_physics_scene = g_runtime_global_context.m_physics_manager->createPhysicsScene(
+            makePhysicsConfig(level_res.m_gravity, level_res.m_physics));
         ParticleEmitterIDAllocator::reset();
 
-        for (const ObjectInstanceRes& object_instance_res : level_res.m_objects)
-        {
-            createObject(object_instance_res);
-        }
+        createObjects(level_res.m_objects);
 
         // create active character
         for (const auto& object_pair : m_gobjects)
@@ -88,6 +144,12 @@ namespace Piccolo
             }
         }
 
+        // the cells are loaded from the first tick on, around the character
+        if (!level_res.m_streaming.m_cells.empty())
+        {
+            m_streamer = std::make_unique<LevelStreamer>(*this, level_res.m_streaming);
+        }
+
         m_is_loaded = true;
 
         LOG_INFO("level load succeed");
@@ -104,21 +166,30 @@ namespace Piccolo
     bool Level::save()
     {
         LOG_INFO("saving level: {}", m_level_res_url);
+
+        // start from the level asset, so the settings not owned by objects (gravity, physics...) are kept
         LevelRes output_level_res;
+        g_runtime_global_context.m_asset_manager->loadAsset(m_level_res_url, output_level_res);
 
         const size_t                    object_cout    = m_gobjects.size();
         std::vector<ObjectInstanceRes>& output_objects = output_level_res.m_objects;
         output_objects.resize(object_cout);
 
+        // the objects of the streaming cells belong to the cell files, which are kept as they are
         size_t object_index = 0;
         for (const auto& id_object_pair : m_gobjects)
         {
+            if (m_streamer && m_streamer->isStreamedObject(id_object_pair.first))
+            {
+                continue;
+            }
             if (id_object_pair.second)
             {
                 id_object_pair.second->save(output_objects[object_index]);
                 ++object_index;
             }
         }
+        output_objects.resize(object_index);
 
         const bool is_save_success =
             g_runtime_global_context.m_asset_manager->saveAsset(output_level_res, m_level_res_url);
@@ -137,11 +208,21 @@ namespace Piccolo
 
     void Level::tick(float delta_time)
     {
+        PROFILE_ZONE("Level::tick");
+
         if (!m_is_loaded)
         {
             return;
         }
 
+        if (m_streamer)
+        {
+            m_streamer->tick(getStreamingFocusPosition());
+        }
+
+        // world matrices first, so the components see this frame's parents and last frame's edits
+        m_transform_hierarchy.update(g_runtime_global_context.m_world_manager->getThreadPool());
+
         for (const auto& id_object_pair : m_gobjects)
         {
             assert(id_object_pair.second);
@@ -150,15 +231,146 @@ namespace Piccolo
                 id_object_pair.second->tick(delta_time);
             }
         }
+
+        // the scripts scheduled by the lua components of the objects
+        g_runtime_global_context.m_lua_script_manager->tick(delta_time);
+
         if (m_current_active_character && g_is_editor_mode == false)
         {
             m_current_active_character->tick(delta_time);
         }
 
+        // the editor moves the objects, the simulation only runs while playing so the bodies stay where they are
+        std::shared_ptr<PhysicsScene> physics_scene = m_physics_scene.lock();
+        if (physics_scene && g_is_editor_mode)
+        {
+            physics_scene->tickWithoutSimulation();
+        }
+        else if (physics_scene)
+        {
+            {
+                ScopedFrameStageTimer physics_timer(FrameStage::physics);
+                physics_scene->tick(delta_time);
+            }
+
+            syncPhysicsTransforms(*physics_scene);
+        }
+    }
+
+    Vector3 Level::getStreamingFocusPosition() const
+    {
+        if (m_current_active_character && m_current_active_character->getObjectID() != k_invalid_gobject_id &&
+            g_is_editor_mode == false)
+        {
+            return m_current_active_character->getPosition();
+        }
+
+        std::shared_ptr<RenderCamera> render_camera = g_runtime_global_context.m_render_system->getRenderCamera();
+        return render_camera ? render_camera->position() : Vector3::ZERO;
+    }
+
+    void Level::syncPhysicsTransforms(const PhysicsScene& physics_scene)
+    {
+        for (const PhysicsBodyTransform& body_transform : physics_scene.getMovedBodyTransforms())
+        {
+            // the index part of the id, the sequence part tells a reused index from the body seen before
+            const uint32_t body_index = body_transform.body_id & s_rigidbody_index_mask;
+            if (body_index >= m_body_ids.size())
+            {
+                m_body_ids.resize(body_index + 1, s_invalid_rigidbody_id);
+                m_body_transform_components.resize(body_index + 1, nullptr);
+            }
+
+            // a body is looked up once, when it moves for the first time
+            if (m_body_ids[body_index] != body_transform.body_id)
+            {
+                auto iter = m_gobjects.find(static_cast<GObjectID>(body_transform.user_data));
+                if (iter == m_gobjects.end())
+                {
+                    continue;
+                }
+                m_body_ids[body_index]                  = body_transform.body_id;
+                m_body_transform_components[body_index] = iter->second->tryGetComponent(TransformComponent);
+            }
+
+            // the local transform of a child is relative to its parent, the simulated world transform is not written
+            TransformComponent* transform_component = m_body_transform_components[body_index];
+            if (transform_component && !transform_component->hasParent())
+            {
+                transform_component->setTransformFromPhysics(body_transform.position, body_transform.rotation);
+            }
+        }
+    }
+
+    void Level::createObjects(const std::vector<ObjectInstanceRes>& object_instance_reses,
+                              std::vector<GObjectID>*               out_object_ids)
+    {
+        // insert the rigidbodies of all objects into the broadphase in one batch
         std::shared_ptr<PhysicsScene> physics_scene = m_physics_scene.lock();
-        if (physics_scene)
+        ASSERT(physics_scene);
+        physics_scene->beginBodyBatch();
+
+        std::vector<GObjectID> created_object_ids;
+        created_object_ids.reserve(object_instance_reses.size());
+        for (const ObjectInstanceRes& object_instance_res : object_instance_reses)
+        {
+            const GObjectID object_id = createObject(object_instance_res);
+            if (object_id != k_invalid_gobject_id)
+            {
+                created_object_ids.push_back(object_id);
+            }
+        }
+        if (out_object_ids != nullptr)
+        {
+            out_object_ids->insert(out_object_ids->end(), created_object_ids.begin(), created_object_ids.end());
+        }
+
+        physics_scene->endBodyBatch();
+
+        resolveParents(created_object_ids);
+    }
+
+    void Level::resolveParents(const std::vector<GObjectID>& go_ids)
+    {
+        // parents are referenced by name and may be created after their children, or by an earlier batch
+        std::unordered_map<std::string, GObjectID> object_ids_by_name;
+        for (const auto& id_object_pair : m_gobjects)
+        {
+            object_ids_by_name.emplace(id_object_pair.second->getName(), id_object_pair.first);
+        }
+
+        for (GObjectID go_id : go_ids)
+        {
+            const TransformComponent* transform_component =
+                m_gobjects[go_id]->tryGetComponentConst(TransformComponent);
+            if (transform_component == nullptr || transform_component->getParentName().empty())
+            {
+                continue;
+            }
+
+            auto parent_iter = object_ids_by_name.find(transform_component->getParentName());
+            if (parent_iter == object_ids_by_name.end())
+            {
+                LOG_ERROR("parent {} of object {} is not found", transform_component->getParentName(), go_id);
+                continue;
+            }
+            m_transform_hierarchy.setParent(go_id, parent_iter->second);
+        }
+    }
+
+    bool Level::setObjectParent(GObjectID go_id, GObjectID parent_id)
+    {
+        return m_transform_hierarchy.setParent(go_id, parent_id);
+    }
+
+    void Level::deleteGObjects(const std::vector<GObjectID>& go_ids)
+    {
+        // the hierarchy compacts its nodes once for the batch, rigidbodies of the deleted objects are removed from
+        // the broadphase together at the next physics tick
+        m_transform_hierarchy.removeObjects(go_ids);
+        for (GObjectID go_id : go_ids)
         {
-            physics_scene->tick(delta_time);
+            eraseGObject(go_id);
         }
     }
 
@@ -174,6 +386,12 @@ namespace Piccolo
     }
 
     void Level::deleteGObjectByID(GObjectID go_id)
+    {
+        m_transform_hierarchy.removeObject(go_id);
+        eraseGObject(go_id);
+    }
+
+    void Level::eraseGObject(GObjectID go_id)
     {
         auto iter = m_gobjects.find(go_id);
         if (iter != m_gobjects.end())
@@ -185,6 +403,9 @@ namespace Piccolo
                 {
                     m_current_active_character->setObject(nullptr);
                 }
+
+                RenderSwapContext& swap_context = g_runtime_global_context.m_render_system->getSwapContext();
+                swap_context.getLogicSwapData().addDeleteGameObject(GameObjectDesc {go_id, {}});
             }
         }
 
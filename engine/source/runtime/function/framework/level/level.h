@@ -1,17 +1,23 @@
 #pragma once
 
+#include "runtime/core/math/vector3.h"
+
+#include "runtime/function/framework/level/transform_hierarchy.h"
 #include "runtime/function/framework/object/object_id_allocator.h"
 
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace Piccolo
 {
     class Character;
     class GObject;
+    class LevelStreamer;
     class ObjectInstanceRes;
     class PhysicsScene;
+    class TransformComponent;
 
     using LevelObjectsMap = std::unordered_map<GObjectID, std::shared_ptr<GObject>>;
 
@@ -19,7 +25,8 @@ namespace Piccolo
     class Level
     {
     public:
-        virtual ~Level(){};
+        Level();
+        virtual ~Level();
 
         bool load(const std::string& level_res_url);
         void unload();
@@ -38,11 +45,34 @@ namespace Piccolo
         GObjectID createObject(const ObjectInstanceRes& object_instance_res);
         void      deleteGObjectByID(GObjectID go_id);
 
+        /// create the objects of a level or a streamed region, their rigidbodies are added to physics in one batch
+        /// @out_object_ids: optional, ids of the created objects are appended
+        void createObjects(const std::vector<ObjectInstanceRes>& object_instance_reses,
+                           std::vector<GObjectID>*               out_object_ids = nullptr);
+        /// delete the objects of a streamed region, their rigidbodies are removed from physics in one batch
+        void deleteGObjects(const std::vector<GObjectID>& go_ids);
+
+        /// attach an object to a parent, k_invalid_gobject_id detaches it. the world matrices follow at the next tick
+        bool setObjectParent(GObjectID go_id, GObjectID parent_id);
+
         std::weak_ptr<PhysicsScene> getPhysicsScene() const { return m_physics_scene; }
 
+        /// nullptr if the level has no streaming cells
+        const LevelStreamer* getStreamer() const { return m_streamer.get(); }
+
     protected:
         void clear();
 
+        // write the simulated transforms of dynamic rigidbodies back to their objects in one pass
+        void syncPhysicsTransforms(const PhysicsScene& physics_scene);
+        // everything deleting an object does but removing it from the transform hierarchy
+        void eraseGObject(GObjectID go_id);
+        // attach the given objects to the objects named by their transform components
+        void resolveParents(const std::vector<GObjectID>& go_ids);
+
+        // the character if there is one, else the camera
+        Vector3 getStreamingFocusPosition() const;
+
         bool        m_is_loaded {false};
         std::string m_level_res_url;
 
@@ -52,5 +82,15 @@ namespace Piccolo
         std::shared_ptr<Character> m_current_active_character;
 
         std::weak_ptr<PhysicsScene> m_physics_scene;
+
+        // indexed by the index part of a rigidbody id, the full id and the transform component of its object. the
+        // body of a deleted object is removed before the next step, so a stale entry is never reported as moved
+        std::vector<uint32_t>            m_body_ids;
+        std::vector<TransformComponent*> m_body_transform_components;
+
+        // parents and cached world matrices of the objects with a transform component
+        TransformHierarchy m_transform_hierarchy;
+
+        std::unique_ptr<LevelStreamer> m_streamer;
     };
 } // namespace Piccolo
@@ -16,7 +16,7 @@ namespace Piccolo
 {
     void LevelDebugger::tick(std::shared_ptr<Level> level) const
     {
-        if (g_is_editor_mode)
+        if (g_is_editor_mode || g_runtime_global_context.m_render_debug_config == nullptr)
         {
             return;
         }
@@ -102,10 +102,7 @@ namespace Piccolo
         DebugDrawGroup* debug_draw_group =
             g_runtime_global_context.m_debugdraw_manager->tryGetOrCreateDebugDrawGroup("bone");
 
-        Matrix4x4 object_matrix = Transform(transform_component->getPosition(),
-                                            transform_component->getRotation(),
-                                            transform_component->getScale())
-                                      .getMatrix();
+        const Matrix4x4& object_matrix = transform_component->getMatrix();
 
         const Skeleton& skeleton    = animation_component->getSkeleton();
         const Bone*     bones       = skeleton.getBones();
@@ -159,10 +156,7 @@ namespace Piccolo
         DebugDrawGroup* debug_draw_group =
             g_runtime_global_context.m_debugdraw_manager->tryGetOrCreateDebugDrawGroup("bone name");
 
-        Matrix4x4 object_matrix = Transform(transform_component->getPosition(),
-                                            transform_component->getRotation(),
-                                            transform_component->getScale())
-                                      .getMatrix();
+        const Matrix4x4& object_matrix = transform_component->getMatrix();
 
         const Skeleton& skeleton    = animation_component->getSkeleton();
         const Bone*     bones       = skeleton.getBones();
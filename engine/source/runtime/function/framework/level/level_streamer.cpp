@@ -0,0 +1,237 @@
+#include "runtime/function/framework/level/level_streamer.h"
+
+#include "runtime/core/base/macro.h"
+#include "runtime/core/profile/profiler.h"
+
+#include "runtime/resource/asset_manager/asset_manager.h"
+
+#include "runtime/function/framework/level/level.h"
+#include "runtime/function/global/global_context.h"
+
+#include <algorithm>
+
+namespace Piccolo
+{
+    namespace
+    {
+        float distanceToCell(const Vector3& position, const LevelStreamingCellRes& cell_res)
+        {
+            const Vector3 closest_position(std::clamp(position.x, cell_res.m_min_corner.x, cell_res.m_max_corner.x),
+                                           std::clamp(position.y, cell_res.m_min_corner.y, cell_res.m_max_corner.y),
+                                           std::clamp(position.z, cell_res.m_min_corner.z, cell_res.m_max_corner.z));
+            return position.distance(closest_position);
+        }
+    } // namespace
+
+    LevelStreamer::LevelStreamer(Level& level, const LevelStreamingRes& streaming_res) :
+        m_level(level), m_asset_manager(g_runtime_global_context.m_asset_manager)
+    {
+        ASSERT(m_asset_manager);
+
+        m_load_distance   = std::max(streaming_res.m_load_distance, 0.f);
+        m_unload_distance = streaming_res.m_unload_distance;
+        if (m_unload_distance < m_load_distance)
+        {
+            LOG_WARN("streaming unload distance {} is below the load distance {}, using the load distance",
+                     m_unload_distance,
+                     m_load_distance);
+            m_unload_distance = m_load_distance;
+        }
+        m_max_loaded_cell_count = streaming_res.m_max_loaded_cell_count > 0 ?
+                                      static_cast<size_t>(streaming_res.m_max_loaded_cell_count) :
+                                      streaming_res.m_cells.size();
+        m_max_cell_instantiations_per_tick =
+            static_cast<size_t>(std::max(streaming_res.m_max_cell_instantiations_per_tick, 1));
+
+        m_cells.resize(streaming_res.m_cells.size());
+        for (size_t cell_index = 0; cell_index < m_cells.size(); ++cell_index)
+        {
+            LevelStreamingCellRes& cell_res = m_cells[cell_index].m_res;
+            cell_res                        = streaming_res.m_cells[cell_index];
+            // tolerate corners given in any order
+            const Vector3 min_corner = cell_res.m_min_corner;
+            cell_res.m_min_corner.makeFloor(cell_res.m_max_corner);
+            cell_res.m_max_corner.makeCeil(min_corner);
+        }
+
+        m_worker = std::thread(&LevelStreamer::workerLoop, this);
+    }
+
+    LevelStreamer::~LevelStreamer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_is_stopping = true;
+        }
+        m_condition.notify_all();
+        if (m_worker.joinable())
+        {
+            m_worker.join();
+        }
+    }
+
+    void LevelStreamer::workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_condition.wait(lock, [this] { return m_is_stopping || !m_load_requests.empty(); });
+            if (m_is_stopping)
+            {
+                return;
+            }
+
+            CellLoadRequest request = std::move(m_load_requests.front());
+            m_load_requests.pop_front();
+            lock.unlock();
+
+            CellLoadResult result;
+            result.m_cell_index = request.m_cell_index;
+            result.m_is_loaded  = m_asset_manager->loadAsset(request.m_cell_url, result.m_cell_res);
+
+            lock.lock();
+            m_load_results.push_back(std::move(result));
+        }
+    }
+
+    void LevelStreamer::tick(const Vector3& focus_position)
+    {
+        PROFILE_ZONE("LevelStreamer::tick");
+
+        for (Cell& cell : m_cells)
+        {
+            cell.m_distance = distanceToCell(focus_position, cell.m_res);
+        }
+
+        instantiateLoadedCells();
+
+        for (Cell& cell : m_cells)
+        {
+            if (cell.m_state == CellState::loaded && cell.m_distance > m_unload_distance)
+            {
+                unloadCell(cell);
+            }
+        }
+
+        requestCells();
+    }
+
+    void LevelStreamer::instantiateLoadedCells()
+    {
+        size_t instantiated_cell_count = 0;
+        while (instantiated_cell_count < m_max_cell_instantiations_per_tick)
+        {
+            CellLoadResult result;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_load_results.empty())
+                {
+                    break;
+                }
+                result = std::move(m_load_results.front());
+                m_load_results.pop_front();
+            }
+
+            Cell& cell = m_cells[result.m_cell_index];
+            ASSERT(cell.m_state == CellState::loading);
+            if (!result.m_is_loaded)
+            {
+                // not retried, the file is broken or missing until the level is loaded again
+                LOG_ERROR("loading streaming cell {} failed", cell.m_res.m_cell_url);
+                cell.m_state = CellState::failed;
+                --m_loaded_cell_count;
+                continue;
+            }
+
+            // the focus moved away while the cell was read
+            if (cell.m_distance > m_unload_distance)
+            {
+                cell.m_state = CellState::unloaded;
+                --m_loaded_cell_count;
+                continue;
+            }
+
+            m_level.createObjects(result.m_cell_res.m_objects, &cell.m_object_ids);
+            m_streamed_object_ids.insert(cell.m_object_ids.begin(), cell.m_object_ids.end());
+            cell.m_state = CellState::loaded;
+            ++instantiated_cell_count;
+        }
+    }
+
+    void LevelStreamer::requestCells()
+    {
+        m_candidate_cell_indices.clear();
+        m_evictable_cell_indices.clear();
+        for (size_t cell_index = 0; cell_index < m_cells.size(); ++cell_index)
+        {
+            const Cell& cell = m_cells[cell_index];
+            if (cell.m_state == CellState::unloaded && cell.m_distance <= m_load_distance)
+            {
+                m_candidate_cell_indices.push_back(cell_index);
+            }
+            else if (cell.m_state == CellState::loaded && cell.m_distance > m_load_distance)
+            {
+                m_evictable_cell_indices.push_back(cell_index);
+            }
+        }
+        if (m_candidate_cell_indices.empty())
+        {
+            return;
+        }
+
+        // the cells kept between the load and the unload distance give their budget to the cells in load distance,
+        // the farthest first
+        if (m_loaded_cell_count + m_candidate_cell_indices.size() > m_max_loaded_cell_count &&
+            !m_evictable_cell_indices.empty())
+        {
+            const size_t missing_count =
+                m_loaded_cell_count + m_candidate_cell_indices.size() - m_max_loaded_cell_count;
+            const size_t evict_count = std::min(missing_count, m_evictable_cell_indices.size());
+            std::partial_sort(
+                m_evictable_cell_indices.begin(),
+                m_evictable_cell_indices.begin() + evict_count,
+                m_evictable_cell_indices.end(),
+                [this](size_t lhs, size_t rhs) { return m_cells[lhs].m_distance > m_cells[rhs].m_distance; });
+            for (size_t evict_index = 0; evict_index < evict_count; ++evict_index)
+            {
+                unloadCell(m_cells[m_evictable_cell_indices[evict_index]]);
+            }
+        }
+        if (m_loaded_cell_count >= m_max_loaded_cell_count)
+        {
+            return;
+        }
+
+        // the nearest cells first, the budget may not cover all of them
+        std::sort(m_candidate_cell_indices.begin(),
+                  m_candidate_cell_indices.end(),
+                  [this](size_t lhs, size_t rhs) { return m_cells[lhs].m_distance < m_cells[rhs].m_distance; });
+
+        const size_t request_count =
+            std::min(m_candidate_cell_indices.size(), m_max_loaded_cell_count - m_loaded_cell_count);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (size_t request_index = 0; request_index < request_count; ++request_index)
+            {
+                const size_t cell_index     = m_candidate_cell_indices[request_index];
+                m_cells[cell_index].m_state = CellState::loading;
+                m_load_requests.push_back({cell_index, m_cells[cell_index].m_res.m_cell_url});
+            }
+        }
+        m_loaded_cell_count += request_count;
+        m_condition.notify_one();
+    }
+
+    void LevelStreamer::unloadCell(Cell& cell)
+    {
+        for (GObjectID go_id : cell.m_object_ids)
+        {
+            m_streamed_object_ids.erase(go_id);
+        }
+        m_level.deleteGObjects(cell.m_object_ids);
+
+        cell.m_object_ids.clear();
+        cell.m_state = CellState::unloaded;
+        --m_loaded_cell_count;
+    }
+} // namespace Piccolo
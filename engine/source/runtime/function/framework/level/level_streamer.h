@@ -0,0 +1,106 @@
+#pragma once
+
+#include "runtime/core/math/vector3.h"
+
+#include "runtime/resource/res_type/common/level.h"
+
+#include "runtime/function/framework/object/object_id_allocator.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace Piccolo
+{
+    class AssetManager;
+    class Level;
+
+    /// loads and unloads the streaming cells of a level around a focus position
+    ///
+    /// the cell files are read and deserialized on a worker thread. tick turns the finished cells into objects on the
+    /// logic thread, a few cells per tick and each cell as one batch of physics bodies, and deletes the objects of
+    /// the cells left behind. when the loaded cell budget is full, the loaded cells beyond the load distance are
+    /// unloaded, farthest first, to make room for the unloaded cells within it
+    class LevelStreamer
+    {
+    public:
+        LevelStreamer(Level& level, const LevelStreamingRes& streaming_res);
+        ~LevelStreamer();
+
+        LevelStreamer(const LevelStreamer&) = delete;
+        LevelStreamer& operator=(const LevelStreamer&) = delete;
+
+        void tick(const Vector3& focus_position);
+
+        /// true for the objects of the loaded cells, which are saved with their cells and not with the level
+        bool isStreamedObject(GObjectID go_id) const { return m_streamed_object_ids.count(go_id) != 0; }
+
+        size_t getCellCount() const { return m_cells.size(); }
+        size_t getLoadedCellCount() const { return m_loaded_cell_count; }
+
+    private:
+        enum class CellState : uint8_t
+        {
+            unloaded,
+            loading,
+            loaded,
+            failed
+        };
+
+        struct Cell
+        {
+            LevelStreamingCellRes  m_res;
+            CellState              m_state {CellState::unloaded};
+            float                  m_distance {0.f};
+            std::vector<GObjectID> m_object_ids;
+        };
+
+        struct CellLoadRequest
+        {
+            size_t      m_cell_index {0};
+            std::string m_cell_url;
+        };
+
+        struct CellLoadResult
+        {
+            size_t       m_cell_index {0};
+            bool         m_is_loaded {false};
+            LevelCellRes m_cell_res;
+        };
+
+        void workerLoop();
+
+        void instantiateLoadedCells();
+        void requestCells();
+        void unloadCell(Cell& cell);
+
+        Level&                        m_level;
+        std::shared_ptr<AssetManager> m_asset_manager;
+
+        float  m_load_distance {0.f};
+        float  m_unload_distance {0.f};
+        size_t m_max_loaded_cell_count {0};
+        size_t m_max_cell_instantiations_per_tick {1};
+
+        std::vector<Cell>             m_cells;
+        size_t                        m_loaded_cell_count {0}; // loaded or loading
+        std::unordered_set<GObjectID> m_streamed_object_ids;
+        std::vector<size_t>           m_candidate_cell_indices;
+        std::vector<size_t>           m_evictable_cell_indices;
+
+        // shared with the worker thread
+        std::mutex                  m_mutex;
+        std::condition_variable     m_condition;
+        std::deque<CellLoadRequest> m_load_requests;
+        std::deque<CellLoadResult>  m_load_results;
+        bool                        m_is_stopping {false};
+
+        std::thread m_worker;
+    };
+} // namespace Piccolo
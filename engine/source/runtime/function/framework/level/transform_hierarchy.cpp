@@ -0,0 +1,342 @@
+#include "runtime/function/framework/level/transform_hierarchy.h"
+
+#include "runtime/core/base/macro.h"
+#include "runtime/core/base/thread_pool.h"
+#include "runtime/core/profile/frame_stage_timer.h"
+#include "runtime/core/profile/profiler.h"
+
+#include "runtime/function/framework/component/transform/transform_component.h"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace Piccolo
+{
+    namespace
+    {
+        // below that many nodes the walk is cheaper than waking the workers
+        constexpr uint32_t k_parallel_node_count = 4096;
+    } // namespace
+
+    void TransformHierarchy::clear()
+    {
+        m_object_ids.clear();
+        m_transform_components.clear();
+        m_parent_indices.clear();
+        m_subtree_sizes.clear();
+        m_world_matrices.clear();
+        m_is_reparented.clear();
+        m_is_changed.clear();
+        m_node_indices.clear();
+        m_chunk_begin_indices.clear();
+    }
+
+    void TransformHierarchy::addObject(GObjectID object_id, TransformComponent* transform_component)
+    {
+        ASSERT(transform_component);
+        if (hasObject(object_id))
+        {
+            LOG_WARN("object {} is already in the transform hierarchy", object_id);
+            return;
+        }
+
+        const Matrix4x4 world_matrix = transform_component->getLocalMatrix();
+
+        m_node_indices.emplace(object_id, static_cast<uint32_t>(m_object_ids.size()));
+        m_object_ids.push_back(object_id);
+        m_transform_components.push_back(transform_component);
+        m_parent_indices.push_back(k_invalid_node_index);
+        m_subtree_sizes.push_back(1);
+        m_world_matrices.push_back(world_matrix);
+        m_is_reparented.push_back(0);
+        m_is_changed.push_back(0);
+
+        transform_component->setWorldMatrix(world_matrix, false);
+    }
+
+    void TransformHierarchy::removeObject(GObjectID object_id) { removeObjects({object_id}); }
+
+    void TransformHierarchy::removeObjects(const std::vector<GObjectID>& object_ids)
+    {
+        const uint32_t node_count = static_cast<uint32_t>(m_object_ids.size());
+
+        std::vector<uint8_t> is_removed(node_count, 0);
+        uint32_t             removed_count = 0;
+        for (GObjectID object_id : object_ids)
+        {
+            auto node_iter = m_node_indices.find(object_id);
+            if (node_iter != m_node_indices.end() && is_removed[node_iter->second] == 0)
+            {
+                is_removed[node_iter->second] = 1;
+                ++removed_count;
+            }
+        }
+        if (removed_count == 0)
+        {
+            return;
+        }
+
+        // the children of a removed node become roots, every kept node then belongs to the tree of the kept root
+        // above it. parents come before their children, so that root is known when the node is reached
+        std::vector<uint32_t> root_indices(node_count, k_invalid_node_index);
+        std::vector<uint32_t> tree_node_counts(node_count, 0);
+        for (uint32_t node_index = 0; node_index < node_count; ++node_index)
+        {
+            if (is_removed[node_index] != 0)
+            {
+                m_node_indices.erase(m_object_ids[node_index]);
+                continue;
+            }
+
+            uint32_t& parent_index = m_parent_indices[node_index];
+            if (parent_index != k_invalid_node_index && is_removed[parent_index] != 0)
+            {
+                parent_index                = k_invalid_node_index;
+                m_is_reparented[node_index] = 1;
+            }
+
+            const uint32_t root_index =
+                parent_index == k_invalid_node_index ? node_index : root_indices[parent_index];
+            root_indices[node_index] = root_index;
+            ++tree_node_counts[root_index];
+        }
+
+        // each tree in one piece, in the order of the roots. the nodes keep their relative order, which is still
+        // depth first within a tree
+        std::vector<uint32_t> tree_begin_indices(node_count, 0);
+        uint32_t              tree_begin_index = 0;
+        for (uint32_t node_index = 0; node_index < node_count; ++node_index)
+        {
+            tree_begin_indices[node_index] = tree_begin_index;
+            tree_begin_index += tree_node_counts[node_index];
+        }
+
+        std::vector<uint32_t> new_order(node_count - removed_count);
+        for (uint32_t node_index = 0; node_index < node_count; ++node_index)
+        {
+            if (is_removed[node_index] == 0)
+            {
+                new_order[tree_begin_indices[root_indices[node_index]]++] = node_index;
+            }
+        }
+
+        applyOrder(new_order);
+
+        const uint32_t new_node_count = static_cast<uint32_t>(m_object_ids.size());
+        std::fill(m_subtree_sizes.begin(), m_subtree_sizes.end(), 1);
+        for (uint32_t node_index = new_node_count; node_index-- > 0;)
+        {
+            const uint32_t parent_index = m_parent_indices[node_index];
+            if (parent_index != k_invalid_node_index)
+            {
+                m_subtree_sizes[parent_index] += m_subtree_sizes[node_index];
+            }
+        }
+    }
+
+    bool TransformHierarchy::setParent(GObjectID object_id, GObjectID parent_id)
+    {
+        auto node_iter = m_node_indices.find(object_id);
+        if (node_iter == m_node_indices.end())
+        {
+            LOG_ERROR("object {} is not in the transform hierarchy", object_id);
+            return false;
+        }
+        const uint32_t node_index = node_iter->second;
+
+        uint32_t parent_index = k_invalid_node_index;
+        if (parent_id != k_invalid_gobject_id)
+        {
+            auto parent_iter = m_node_indices.find(parent_id);
+            if (parent_iter == m_node_indices.end())
+            {
+                LOG_ERROR("parent {} of object {} is not in the transform hierarchy", parent_id, object_id);
+                return false;
+            }
+            parent_index = parent_iter->second;
+
+            if (parent_index >= node_index && parent_index < node_index + m_subtree_sizes[node_index])
+            {
+                LOG_ERROR("cannot attach object {} to {}, which is in its own subtree", object_id, parent_id);
+                return false;
+            }
+        }
+
+        if (m_parent_indices[node_index] != parent_index)
+        {
+            moveSubtree(node_index, parent_index);
+        }
+        return true;
+    }
+
+    GObjectID TransformHierarchy::getParent(GObjectID object_id) const
+    {
+        auto node_iter = m_node_indices.find(object_id);
+        if (node_iter == m_node_indices.end())
+        {
+            return k_invalid_gobject_id;
+        }
+
+        const uint32_t parent_index = m_parent_indices[node_iter->second];
+        return parent_index == k_invalid_node_index ? k_invalid_gobject_id : m_object_ids[parent_index];
+    }
+
+    void TransformHierarchy::moveSubtree(uint32_t node_index, uint32_t parent_index)
+    {
+        const uint32_t node_count   = static_cast<uint32_t>(m_object_ids.size());
+        const uint32_t subtree_size = m_subtree_sizes[node_index];
+        const uint32_t subtree_end  = node_index + subtree_size;
+
+        // the end of the subtree of the parent, taken before the sizes change. if the parent is an ancestor, the
+        // moved subtree is still inside this range
+        const uint32_t destination_index =
+            parent_index == k_invalid_node_index ? node_count : parent_index + m_subtree_sizes[parent_index];
+
+        uint32_t ancestor_index = m_parent_indices[node_index];
+        while (ancestor_index != k_invalid_node_index)
+        {
+            m_subtree_sizes[ancestor_index] -= subtree_size;
+            ancestor_index = m_parent_indices[ancestor_index];
+        }
+        ancestor_index = parent_index;
+        while (ancestor_index != k_invalid_node_index)
+        {
+            m_subtree_sizes[ancestor_index] += subtree_size;
+            ancestor_index = m_parent_indices[ancestor_index];
+        }
+        m_parent_indices[node_index] = parent_index;
+        m_is_reparented[node_index]  = 1;
+
+        std::vector<uint32_t> new_order;
+        new_order.reserve(node_count);
+        auto appendRange = [&new_order](uint32_t begin_index, uint32_t end_index) {
+            for (uint32_t index = begin_index; index < end_index; ++index)
+            {
+                new_order.push_back(index);
+            }
+        };
+
+        if (destination_index >= subtree_end)
+        {
+            appendRange(0, node_index);
+            appendRange(subtree_end, destination_index);
+            appendRange(node_index, subtree_end);
+            appendRange(destination_index, node_count);
+        }
+        else
+        {
+            appendRange(0, destination_index);
+            appendRange(node_index, subtree_end);
+            appendRange(destination_index, node_index);
+            appendRange(subtree_end, node_count);
+        }
+
+        applyOrder(new_order);
+    }
+
+    void TransformHierarchy::applyOrder(const std::vector<uint32_t>& new_order)
+    {
+        const uint32_t node_count = static_cast<uint32_t>(new_order.size());
+
+        std::vector<uint32_t> new_indices(m_object_ids.size(), k_invalid_node_index);
+        for (uint32_t new_index = 0; new_index < node_count; ++new_index)
+        {
+            new_indices[new_order[new_index]] = new_index;
+        }
+
+        auto reorder = [&new_order](auto& values) {
+            std::remove_reference_t<decltype(values)> reordered_values;
+            reordered_values.reserve(values.size());
+            for (uint32_t old_index : new_order)
+            {
+                reordered_values.push_back(values[old_index]);
+            }
+            values.swap(reordered_values);
+        };
+        reorder(m_object_ids);
+        reorder(m_transform_components);
+        reorder(m_parent_indices);
+        reorder(m_subtree_sizes);
+        reorder(m_world_matrices);
+        reorder(m_is_reparented);
+        reorder(m_is_changed);
+
+        for (uint32_t node_index = 0; node_index < node_count; ++node_index)
+        {
+            uint32_t& parent_index = m_parent_indices[node_index];
+            if (parent_index != k_invalid_node_index)
+            {
+                parent_index = new_indices[parent_index];
+            }
+            m_node_indices[m_object_ids[node_index]] = node_index;
+        }
+    }
+
+    void TransformHierarchy::update(ThreadPool* thread_pool)
+    {
+        PROFILE_ZONE("TransformHierarchy::update");
+        ScopedFrameStageTimer transform_timer(FrameStage::transform);
+
+        const uint32_t node_count = static_cast<uint32_t>(m_object_ids.size());
+        const uint32_t chunk_target_count =
+            (thread_pool != nullptr && node_count >= k_parallel_node_count) ? thread_pool->getThreadCount() : 1;
+        if (chunk_target_count <= 1)
+        {
+            updateNodes(0, node_count);
+            return;
+        }
+
+        // ranges of whole root subtrees with about the same number of nodes, no parent is in another range
+        const uint32_t chunk_node_count = (node_count + chunk_target_count - 1) / chunk_target_count;
+
+        m_chunk_begin_indices.clear();
+        uint32_t chunk_begin_index = 0;
+        for (uint32_t root_index = 0; root_index < node_count; root_index += m_subtree_sizes[root_index])
+        {
+            if (root_index - chunk_begin_index >= chunk_node_count)
+            {
+                m_chunk_begin_indices.push_back(chunk_begin_index);
+                chunk_begin_index = root_index;
+            }
+        }
+        m_chunk_begin_indices.push_back(chunk_begin_index);
+        m_chunk_begin_indices.push_back(node_count);
+
+        const uint32_t chunk_count = static_cast<uint32_t>(m_chunk_begin_indices.size()) - 1;
+        thread_pool->parallelFor(chunk_count, [this](uint32_t chunk_index, uint32_t thread_index) {
+            updateNodes(m_chunk_begin_indices[chunk_index], m_chunk_begin_indices[chunk_index + 1]);
+        });
+    }
+
+    void TransformHierarchy::updateNodes(uint32_t begin_index, uint32_t end_index)
+    {
+        for (uint32_t node_index = begin_index; node_index < end_index; ++node_index)
+        {
+            TransformComponent* transform_component = m_transform_components[node_index];
+            const uint32_t      parent_index        = m_parent_indices[node_index];
+
+            // the local dirty flag is consumed on every node, changed or not
+            const bool is_local_dirty = transform_component->consumeLocalDirty();
+            const bool is_changed     = is_local_dirty || m_is_reparented[node_index] != 0 ||
+                                    (parent_index != k_invalid_node_index && m_is_changed[parent_index] != 0);
+
+            m_is_changed[node_index] = is_changed ? 1 : 0;
+            if (!is_changed)
+            {
+                continue;
+            }
+            m_is_reparented[node_index] = 0;
+
+            Matrix4x4& world_matrix = m_world_matrices[node_index];
+            if (parent_index == k_invalid_node_index)
+            {
+                world_matrix = transform_component->getLocalMatrix();
+            }
+            else
+            {
+                world_matrix = m_world_matrices[parent_index] * transform_component->getLocalMatrix();
+            }
+            transform_component->setWorldMatrix(world_matrix, parent_index != k_invalid_node_index);
+        }
+    }
+} // namespace Piccolo
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "runtime/core/math/matrix4.h"
+
+#include "runtime/function/framework/object/object_id_allocator.h"
+
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace Piccolo
+{
+    class ThreadPool;
+    class TransformComponent;
+
+    /// parent child relations of the transforms of a level and their cached local to world matrices
+    ///
+    /// the nodes are stored in depth first order: a node is followed by its whole subtree, so a parent always comes
+    /// before its children and the subtrees of two roots never interleave. update walks the nodes in that order and
+    /// recomputes a world matrix only when the local transform of the node or the world matrix of its parent has
+    /// changed. the subtrees of different roots are independent, large levels update them in parallel
+    class TransformHierarchy
+    {
+    public:
+        void clear();
+
+        /// the object starts as a root, its world matrix is its local transform
+        void addObject(GObjectID object_id, TransformComponent* transform_component);
+        /// the children of the object become roots, keeping their local transforms
+        void removeObject(GObjectID object_id);
+        /// as removeObject for every object, the node arrays are compacted once for the whole batch
+        void removeObjects(const std::vector<GObjectID>& object_ids);
+
+        /// attach the object with its subtree to a parent, k_invalid_gobject_id makes it a root
+        ///
+        /// the local transform of the object is kept and is relative to the parent from now on. returns false if the
+        /// parent is the object itself or one of its descendants, or if one of them is not in the hierarchy
+        bool setParent(GObjectID object_id, GObjectID parent_id);
+
+        /// k_invalid_gobject_id for roots and unknown objects
+        GObjectID getParent(GObjectID object_id) const;
+
+        bool   hasObject(GObjectID object_id) const { return m_node_indices.count(object_id) != 0; }
+        size_t getNodeCount() const { return m_object_ids.size(); }
+
+        /// recompute the world matrices of the changed subtrees and push them to their transform components
+        /// @thread_pool: optional, used when the hierarchy is large enough to pay for the dispatch
+        void update(ThreadPool* thread_pool);
+
+    private:
+        static constexpr uint32_t k_invalid_node_index = std::numeric_limits<uint32_t>::max();
+
+        // move the subtree of the node below the parent node, k_invalid_node_index moves it to the end as a root
+        void moveSubtree(uint32_t node_index, uint32_t parent_index);
+        // reorder all node arrays, new_order[i] is the old index of the node which goes to index i. the nodes missing
+        // from new_order are dropped, none of the kept nodes may have them as parent
+        void applyOrder(const std::vector<uint32_t>& new_order);
+
+        void updateNodes(uint32_t begin_index, uint32_t end_index);
+
+        // one entry per node, in depth first order
+        std::vector<GObjectID>           m_object_ids;
+        std::vector<TransformComponent*> m_transform_components;
+        std::vector<uint32_t>            m_parent_indices;
+        std::vector<uint32_t>            m_subtree_sizes; // the node and all its descendants
+        std::vector<Matrix4x4>           m_world_matrices;
+        std::vector<uint8_t>             m_is_reparented; // the world matrix is stale though the local is not
+        std::vector<uint8_t>             m_is_changed;    // written by update for the children to read
+
+        std::unordered_map<GObjectID, uint32_t> m_node_indices;
+
+        // the ranges of whole root subtrees which update runs in parallel, rebuilt every update
+        std::vector<uint32_t> m_chunk_begin_indices;
+    };
+} // namespace Piccolo
@@ -33,7 +33,7 @@ namespace Piccolo
 
         bool hasComponent(const std::string& compenent_type_name) const;
 
-        std::vector<Reflection::ReflectionPtr<Component>> getComponents() { return m_components; }
+        const std::vector<Reflection::ReflectionPtr<Component>>& getComponents() const { return m_components; }
 
         template<typename TComponent>
         TComponent* tryGetComponent(const std::string& compenent_type_name)
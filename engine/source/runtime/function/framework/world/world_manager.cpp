@@ -1,16 +1,26 @@
 #include "runtime/function/framework/world/world_manager.h"
 
 #include "runtime/core/base/macro.h"
+#include "runtime/core/base/thread_pool.h"
+#include "runtime/core/profile/frame_stage_timer.h"
+
+#include "runtime/engine.h"
+
+#include "runtime/platform/file_service/file_service.h"
+#include "runtime/platform/path/path.h"
 
 #include "runtime/resource/asset_manager/asset_manager.h"
 #include "runtime/resource/config_manager/config_manager.h"
 
+#include "runtime/function/framework/component/mesh/mesh_component.h"
 #include "runtime/function/framework/level/level.h"
 #include "runtime/function/global/global_context.h"
 #include "runtime/function/framework/level/level_debugger.h"
 
 #include "_generated/serializer/all_serializer.h"
 
+#include <algorithm>
+
 namespace Piccolo
 {
     WorldManager::~WorldManager() { clear(); }
@@ -22,10 +32,24 @@ namespace Piccolo
 
         //debugger
         m_level_debugger = std::make_shared<LevelDebugger>();
+
+        m_thread_pool = std::make_shared<ThreadPool>(std::max(std::thread::hardware_concurrency(), 1U));
+
+        if (g_is_asset_hot_reload_enabled)
+        {
+            m_file_change_subscription = g_runtime_global_context.m_file_system->subscribe(
+                [this](const FileChangeEvent& event) { onFileChanged(event); });
+        }
     }
 
     void WorldManager::clear()
     {
+        if (m_file_change_subscription != 0)
+        {
+            g_runtime_global_context.m_file_system->unsubscribe(m_file_change_subscription);
+            m_file_change_subscription = 0;
+        }
+
         // unload all loaded levels
         for (auto level_pair : m_loaded_levels)
         {
@@ -42,10 +66,14 @@ namespace Piccolo
 
         //clear debugger
         m_level_debugger.reset();
+
+        m_thread_pool.reset();
     }
 
     void WorldManager::tick(float delta_time)
     {
+        ScopedFrameStageTimer world_tick_timer(FrameStage::world_tick);
+
         if (!m_is_world_loaded)
         {
             loadWorld(m_current_world_url);
@@ -60,6 +88,32 @@ namespace Piccolo
         }
     }
 
+    void WorldManager::onFileChanged(const FileChangeEvent& event)
+    {
+        // meshes and textures are reloaded by the render system, the objects only resolve their materials
+        if (event.m_type == FileChangeType::removed || event.m_is_directory)
+        {
+            return;
+        }
+        const auto& extensions = Path::getFileExtensions(event.m_path);
+        if (std::get<0>(extensions) != ".json" || std::get<1>(extensions) != ".material")
+        {
+            return;
+        }
+
+        for (const auto& level_pair : m_loaded_levels)
+        {
+            for (const auto& id_object_pair : level_pair.second->getAllGObjects())
+            {
+                MeshComponent* mesh_component = id_object_pair.second->tryGetComponent(MeshComponent);
+                if (mesh_component != nullptr)
+                {
+                    mesh_component->onMaterialFileChanged(event.m_path);
+                }
+            }
+        }
+    }
+
     std::weak_ptr<PhysicsScene> WorldManager::getCurrentActivePhysicsScene() const
     {
         std::shared_ptr<Level> active_level = m_current_active_level.lock();
@@ -81,6 +135,12 @@ namespace Piccolo
             return false;
         }
 
+        m_current_world_url = world_url;
+        return loadWorld(world_res);
+    }
+
+    bool WorldManager::loadWorld(const WorldRes& world_res)
+    {
         m_current_world_resource = std::make_shared<WorldRes>(world_res);
 
         const bool is_level_load_success = loadLevel(world_res.m_default_level_url);
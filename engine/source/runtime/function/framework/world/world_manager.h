@@ -1,5 +1,7 @@
 #pragma once
 
+#include "runtime/platform/file_service/file_watcher.h"
+
 #include "runtime/resource/res_type/common/world.h"
 
 #include <filesystem>
@@ -10,6 +12,7 @@ namespace Piccolo
     class Level;
     class LevelDebugger;
     class PhysicsScene;
+    class ThreadPool;
 
     /// Manage all game worlds, it should be support multiple worlds, including game world and editor world.
     /// Currently, the implement just supports one active world and one active level
@@ -29,10 +32,18 @@ namespace Piccolo
 
         std::weak_ptr<PhysicsScene> getCurrentActivePhysicsScene() const;
 
-    private:
+        /// workers for the per frame jobs of the levels
+        ThreadPool* getThreadPool() const { return m_thread_pool.get(); }
+
+        /// load a world now instead of the default world at the first tick
         bool loadWorld(const std::string& world_url);
+        bool loadWorld(const WorldRes& world_res);
+
+    private:
         bool loadLevel(const std::string& level_url);
 
+        void onFileChanged(const FileChangeEvent& event);
+
         bool                      m_is_world_loaded {false};
         std::string               m_current_world_url;
         std::shared_ptr<WorldRes> m_current_world_resource;
@@ -44,5 +55,9 @@ namespace Piccolo
 
         //debug level
         std::shared_ptr<LevelDebugger> m_level_debugger;
+
+        std::shared_ptr<ThreadPool> m_thread_pool;
+
+        size_t m_file_change_subscription {0};
     };
 } // namespace Piccolo
@@ -18,6 +18,7 @@
 #include "runtime/function/render/render_debug_config.h"
 #include "runtime/function/render/render_system.h"
 #include "runtime/function/render/window_system.h"
+#include "runtime/function/script/lua_script_manager.h"
 
 namespace Piccolo
 {
@@ -30,19 +31,33 @@ namespace Piccolo
 
         m_file_system = std::make_shared<FileSystem>();
 
-        m_logger_system = std::make_shared<LogSystem>();
+        m_logger_system = std::make_shared<LogSystem>(m_config_manager->getLogSystemInitInfo());
+
+        // changed assets are reloaded while running, see the subscribers of the file system
+        if (g_is_asset_hot_reload_enabled)
+        {
+            m_file_system->watchDirectory(m_config_manager->getAssetFolder());
+        }
 
         m_asset_manager = std::make_shared<AssetManager>();
 
         m_physics_manager = std::make_shared<PhysicsManager>();
         m_physics_manager->initialize();
 
+        // the scripts of the components live in the lua state, it is created before and destroyed after the world
+        m_lua_script_manager = std::make_shared<LuaScriptManager>();
+        m_lua_script_manager->initialize();
+
         m_world_manager = std::make_shared<WorldManager>();
         m_world_manager->initialize();
 
-        m_window_system = std::make_shared<WindowSystem>();
-        WindowCreateInfo window_create_info;
-        m_window_system->initialize(window_create_info);
+        // headless mode runs without window, GPU and debug draw
+        if (!g_is_headless_mode)
+        {
+            m_window_system = std::make_shared<WindowSystem>();
+            WindowCreateInfo window_create_info;
+            m_window_system->initialize(window_create_info);
+        }
 
         m_input_system = std::make_shared<InputSystem>();
         m_input_system->initialize();
@@ -53,12 +68,16 @@ namespace Piccolo
         m_render_system = std::make_shared<RenderSystem>();
         RenderSystemInitInfo render_init_info;
         render_init_info.window_system = m_window_system;
+        render_init_info.is_headless   = g_is_headless_mode;
         m_render_system->initialize(render_init_info);
 
-        m_debugdraw_manager = std::make_shared<DebugDrawManager>();
-        m_debugdraw_manager->initialize();
+        if (!g_is_headless_mode)
+        {
+            m_debugdraw_manager = std::make_shared<DebugDrawManager>();
+            m_debugdraw_manager->initialize();
 
-        m_render_debug_config = std::make_shared<RenderDebugConfig>();
+            m_render_debug_config = std::make_shared<RenderDebugConfig>();
+        }
     }
 
     void RuntimeGlobalContext::shutdownSystems()
@@ -75,6 +94,9 @@ namespace Piccolo
         m_world_manager->clear();
         m_world_manager.reset();
 
+        m_lua_script_manager->clear();
+        m_lua_script_manager.reset();
+
         m_physics_manager->clear();
         m_physics_manager.reset();
 
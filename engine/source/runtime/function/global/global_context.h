@@ -17,6 +17,7 @@ namespace Piccolo
     class ParticleManager;
     class DebugDrawManager;
     class RenderDebugConfig;
+    class LuaScriptManager;
 
     struct EngineInitParams;
 
@@ -42,6 +43,7 @@ namespace Piccolo
         std::shared_ptr<ParticleManager>   m_particle_manager;
         std::shared_ptr<DebugDrawManager>  m_debugdraw_manager;
         std::shared_ptr<RenderDebugConfig> m_render_debug_config;
+        std::shared_ptr<LuaScriptManager>  m_lua_script_manager;
     };
 
     extern RuntimeGlobalContext g_runtime_global_context;
@@ -140,7 +140,11 @@ namespace Piccolo
     void InputSystem::initialize()
     {
         std::shared_ptr<WindowSystem> window_system = g_runtime_global_context.m_window_system;
-        ASSERT(window_system);
+        if (window_system == nullptr)
+        {
+            // headless, game commands are only set by code
+            return;
+        }
 
         window_system->registerOnKeyFunc(std::bind(&InputSystem::onKey,
                                                    this,
@@ -154,10 +158,18 @@ namespace Piccolo
 
     void InputSystem::tick()
     {
+        std::shared_ptr<WindowSystem> window_system = g_runtime_global_context.m_window_system;
+        if (window_system == nullptr)
+        {
+            m_cursor_delta_yaw   = Radian(0);
+            m_cursor_delta_pitch = Radian(0);
+            clear();
+            return;
+        }
+
         calculateCursorDeltaAngles();
         clear();
 
-        std::shared_ptr<WindowSystem> window_system = g_runtime_global_context.m_window_system;
         if (window_system->getFocusMode())
         {
             m_game_command &= (k_complement_control_command ^ (unsigned int)GameCommand::invalid);
@@ -39,6 +39,8 @@ namespace Piccolo
 
         void         resetGameCommand() { m_game_command = 0; }
         unsigned int getGameCommand() const { return m_game_command; }
+        // used to replay recorded commands, e.g. by the benchmark
+        void setGameCommand(unsigned int game_command) { m_game_command = game_command; }
 
     private:
         void onKeyInGameMode(int key, int scancode, int action, int mods);
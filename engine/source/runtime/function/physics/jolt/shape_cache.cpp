@@ -0,0 +1,129 @@
+#include "runtime/function/physics/jolt/shape_cache.h"
+
+#include "runtime/core/base/hash.h"
+#include "runtime/core/base/macro.h"
+
+#include "Jolt/Physics/Collision/Shape/BoxShape.h"
+#include "Jolt/Physics/Collision/Shape/CapsuleShape.h"
+#include "Jolt/Physics/Collision/Shape/SphereShape.h"
+
+namespace Piccolo
+{
+    size_t ShapeCache::ShapeKeyHash::operator()(const ShapeKey& key) const
+    {
+        size_t seed = 0;
+        hash_combine(seed, static_cast<unsigned char>(key.m_type));
+        hash_combine(seed, key.m_params[0]);
+        hash_combine(seed, key.m_params[1]);
+        hash_combine(seed, key.m_params[2]);
+        return seed;
+    }
+
+    JPH::RefConst<JPH::Shape> ShapeCache::getShape(const RigidBodyShape& shape, const Vector3& scale)
+    {
+        ShapeKey key;
+        if (!makeShapeKey(shape, scale, key))
+        {
+            return nullptr;
+        }
+
+        auto iter = m_shapes.find(key);
+        if (iter != m_shapes.end())
+        {
+            return iter->second;
+        }
+
+        JPH::RefConst<JPH::Shape> jph_shape = createShape(key);
+        m_shapes.emplace(key, jph_shape);
+
+        return jph_shape;
+    }
+
+    void ShapeCache::collectGarbage()
+    {
+        for (auto iter = m_shapes.begin(); iter != m_shapes.end();)
+        {
+            // the cache holds the only reference
+            if (iter->second->GetRefCount() == 1)
+            {
+                iter = m_shapes.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+    }
+
+    bool ShapeCache::makeShapeKey(const RigidBodyShape& shape, const Vector3& scale, ShapeKey& out_key)
+    {
+        RigidBodyShapeType shape_type = shape.m_type;
+
+        // shapes loaded by the serializer only carry the type name of the geometry
+        if (shape_type == RigidBodyShapeType::invalid)
+        {
+            const std::string& shape_type_str = shape.m_geometry.getTypeName();
+            if (shape_type_str == "Box")
+            {
+                shape_type = RigidBodyShapeType::box;
+            }
+            else if (shape_type_str == "Sphere")
+            {
+                shape_type = RigidBodyShapeType::sphere;
+            }
+            else if (shape_type_str == "Capsule")
+            {
+                shape_type = RigidBodyShapeType::capsule;
+            }
+        }
+
+        if (shape.m_geometry.getPtr() == nullptr)
+        {
+            return false;
+        }
+
+        out_key.m_type = shape_type;
+        switch (shape_type)
+        {
+            case RigidBodyShapeType::box:
+            {
+                const Box* box_geometry = static_cast<const Box*>(shape.m_geometry.getPtr());
+                out_key.m_params[0]     = scale.x * box_geometry->m_half_extents.x;
+                out_key.m_params[1]     = scale.y * box_geometry->m_half_extents.y;
+                out_key.m_params[2]     = scale.z * box_geometry->m_half_extents.z;
+                return true;
+            }
+            case RigidBodyShapeType::sphere:
+            {
+                const Sphere* sphere_geometry = static_cast<const Sphere*>(shape.m_geometry.getPtr());
+                out_key.m_params[0]           = (scale.x + scale.y + scale.z) / 3 * sphere_geometry->m_radius;
+                return true;
+            }
+            case RigidBodyShapeType::capsule:
+            {
+                const Capsule* capsule_geometry = static_cast<const Capsule*>(shape.m_geometry.getPtr());
+                out_key.m_params[0]             = scale.z * capsule_geometry->m_half_height;
+                out_key.m_params[1]             = (scale.x + scale.y) / 2 * capsule_geometry->m_radius;
+                return true;
+            }
+            default:
+                LOG_ERROR("Unsupported Shape")
+                return false;
+        }
+    }
+
+    JPH::Shape* ShapeCache::createShape(const ShapeKey& key)
+    {
+        switch (key.m_type)
+        {
+            case RigidBodyShapeType::box:
+                return new JPH::BoxShape(JPH::Vec3(key.m_params[0], key.m_params[1], key.m_params[2]), 0.f);
+            case RigidBodyShapeType::sphere:
+                return new JPH::SphereShape(key.m_params[0]);
+            case RigidBodyShapeType::capsule:
+                return new JPH::CapsuleShape(key.m_params[0], key.m_params[1]);
+            default:
+                return nullptr;
+        }
+    }
+} // namespace Piccolo
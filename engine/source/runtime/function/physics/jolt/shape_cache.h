@@ -0,0 +1,58 @@
+#pragma once
+
+#include "runtime/core/math/vector3.h"
+
+#include "runtime/resource/res_type/components/rigid_body.h"
+
+#include "Jolt/Jolt.h"
+
+#include "Jolt/Core/Reference.h"
+#include "Jolt/Physics/Collision/Shape/Shape.h"
+
+#include <cstddef>
+#include <unordered_map>
+
+namespace Piccolo
+{
+    /// Cache of the jolt shapes used by bodies and scene queries.
+    /// Shapes are keyed by their geometry after scaling and shared by reference counting,
+    /// so a query with the same shape never allocates after the first time.
+    class ShapeCache
+    {
+    public:
+        /// get the jolt shape of the rigidbody shape scaled by the given scale, create it on first use
+        /// @return: nullptr if the geometry is not supported
+        JPH::RefConst<JPH::Shape> getShape(const RigidBodyShape& shape, const Vector3& scale);
+
+        /// release the shapes that are no longer referenced by any body, called once per physics tick
+        void collectGarbage();
+
+        void clear() { m_shapes.clear(); }
+
+        size_t getShapeCount() const { return m_shapes.size(); }
+
+    private:
+        struct ShapeKey
+        {
+            RigidBodyShapeType m_type {RigidBodyShapeType::invalid};
+            // box: half extents; sphere: radius; capsule: half height and radius
+            float m_params[3] {0.f, 0.f, 0.f};
+
+            bool operator==(const ShapeKey& rhs) const
+            {
+                return m_type == rhs.m_type && m_params[0] == rhs.m_params[0] && m_params[1] == rhs.m_params[1] &&
+                       m_params[2] == rhs.m_params[2];
+            }
+        };
+
+        struct ShapeKeyHash
+        {
+            size_t operator()(const ShapeKey& key) const;
+        };
+
+        static bool makeShapeKey(const RigidBodyShape& shape, const Vector3& scale, ShapeKey& out_key);
+        static JPH::Shape* createShape(const ShapeKey& key);
+
+        std::unordered_map<ShapeKey, JPH::RefConst<JPH::Shape>, ShapeKeyHash> m_shapes;
+    };
+} // namespace Piccolo
@@ -1,93 +1,167 @@
 #include "runtime/function/physics/jolt/utils.h"
 
-#include "runtime/resource/res_type/components/rigid_body.h"
-
-#include "Jolt/Physics/Collision/Shape/BoxShape.h"
-#include "Jolt/Physics/Collision/Shape/CapsuleShape.h"
-#include "Jolt/Physics/Collision/Shape/SphereShape.h"
-#include "Jolt/Physics/Collision/Shape/StaticCompoundShape.h"
+#include <algorithm>
+#include <iterator>
 
 namespace Piccolo
 {
-    BPLayerInterfaceImpl::BPLayerInterfaceImpl()
+    namespace
+    {
+        // collision masks of the active layer table, see PhysicsLayerTable::activate
+        uint32_t g_object_layer_count {0};
+        uint32_t g_object_collision_masks[PhysicsLayerTable::s_max_object_layer_count] {};
+        uint32_t g_broad_phase_collision_masks[PhysicsLayerTable::s_max_object_layer_count] {};
+
+        PhysicsConfig makeDefaultLayerConfig()
+        {
+            PhysicsConfig config;
+            config.m_broad_phase_layers = {"non_moving", "moving", "debris", "sensor"};
+            config.m_object_layers      = {
+                {"non_moving", "non_moving", {"moving", "debris"}},
+                {"moving", "moving", {"non_moving", "moving", "sensor"}},
+                {"debris", "debris", {"non_moving"}}, // Example: Debris collides only with non_moving
+                {"sensor", "sensor", {"moving"}}      // Sensors only collide with moving objects
+            };
+            return config;
+        }
+    } // namespace
+
+    PhysicsLayerTable::PhysicsLayerTable(const PhysicsConfig& config)
     {
-        // Create a mapping table from object to broad phase layer
-        m_object_to_broad_phase[Layers::UNUSED1]    = BroadPhaseLayers::UNUSED;
-        m_object_to_broad_phase[Layers::UNUSED2]    = BroadPhaseLayers::UNUSED;
-        m_object_to_broad_phase[Layers::UNUSED3]    = BroadPhaseLayers::UNUSED;
-        m_object_to_broad_phase[Layers::UNUSED4]    = BroadPhaseLayers::UNUSED;
-        m_object_to_broad_phase[Layers::NON_MOVING] = BroadPhaseLayers::NON_MOVING;
-        m_object_to_broad_phase[Layers::MOVING]     = BroadPhaseLayers::MOVING;
-        m_object_to_broad_phase[Layers::DEBRIS]     = BroadPhaseLayers::DEBRIS;
-        m_object_to_broad_phase[Layers::SENSOR]     = BroadPhaseLayers::SENSOR;
+        const PhysicsConfig& layer_config = config.m_object_layers.empty() ? makeDefaultLayerConfig() : config;
+
+        for (const std::string& broad_phase_layer : layer_config.m_broad_phase_layers)
+        {
+            addBroadPhaseLayer(broad_phase_layer);
+        }
+
+        // names first, so layers can refer to the layers declared after them
+        std::vector<const PhysicsObjectLayerConfig*> object_layers;
+        for (const PhysicsObjectLayerConfig& object_layer : layer_config.m_object_layers)
+        {
+            if (m_object_layer_names.size() == s_max_object_layer_count)
+            {
+                LOG_ERROR("too many physics object layers, at most {} are supported", s_max_object_layer_count);
+                break;
+            }
+            // a second layer of the same name would never be found, and never get a broadphase layer
+            if (findObjectLayer(object_layer.m_name) != s_invalid_object_layer)
+            {
+                LOG_ERROR("physics object layer {} is declared twice, the second one is ignored", object_layer.m_name);
+                continue;
+            }
+            m_object_layer_names.push_back(object_layer.m_name);
+            object_layers.push_back(&object_layer);
+        }
+
+        for (const PhysicsObjectLayerConfig* object_layer : object_layers)
+        {
+            addObjectLayer(*object_layer);
+        }
+
+        // a layer collides with every layer in its broadphase layers
+        for (uint32_t layer = 0; layer < m_object_layer_names.size(); ++layer)
+        {
+            for (uint32_t other_layer = 0; other_layer < m_object_layer_names.size(); ++other_layer)
+            {
+                if (m_object_collision_masks[layer] & (1u << other_layer))
+                {
+                    m_broad_phase_collision_masks[layer] |=
+                        1u << static_cast<JPH::BroadPhaseLayer::Type>(m_object_to_broad_phase[other_layer]);
+                }
+            }
+        }
     }
 
-#if defined(JPH_EXTERNAL_PROFILE) || defined(JPH_PROFILE_ENABLED)
-    const char* BPLayerInterfaceImpl::GetBroadPhaseLayerName(JPH::BroadPhaseLayer inLayer) const
+    void PhysicsLayerTable::addBroadPhaseLayer(const std::string& name)
     {
-        switch ((JPH::BroadPhaseLayer::Type)inLayer)
+        if (m_broad_phase_layer_names.size() == s_max_broad_phase_layer_count)
         {
-            case (JPH::BroadPhaseLayer::Type)BroadPhaseLayers::NON_MOVING:
-                return "NON_MOVING";
-            case (JPH::BroadPhaseLayer::Type)BroadPhaseLayers::MOVING:
-                return "MOVING";
-            case (JPH::BroadPhaseLayer::Type)BroadPhaseLayers::DEBRIS:
-                return "DEBRIS";
-            case (JPH::BroadPhaseLayer::Type)BroadPhaseLayers::SENSOR:
-                return "SENSOR";
-            case (JPH::BroadPhaseLayer::Type)BroadPhaseLayers::UNUSED:
-                return "UNUSED";
-            default:
-                ASSERT(false);
-                return "INVALID";
+            LOG_ERROR("too many physics broadphase layers, at most {} are supported", s_max_broad_phase_layer_count);
+            return;
         }
+        m_broad_phase_layer_names.push_back(name);
     }
-#endif // JPH_EXTERNAL_PROFILE || JPH_PROFILE_ENABLED
 
-    bool ObjectCanCollide(JPH::ObjectLayer inObject1, JPH::ObjectLayer inObject2)
+    void PhysicsLayerTable::addObjectLayer(const PhysicsObjectLayerConfig& layer_config)
     {
-        switch (inObject1)
+        const JPH::ObjectLayer layer = findObjectLayer(layer_config.m_name);
+
+        auto broad_phase_iter = std::find(
+            m_broad_phase_layer_names.begin(), m_broad_phase_layer_names.end(), layer_config.m_broad_phase_layer);
+        if (broad_phase_iter == m_broad_phase_layer_names.end())
         {
-            case Layers::UNUSED1:
-            case Layers::UNUSED2:
-            case Layers::UNUSED3:
-            case Layers::UNUSED4:
-                return false;
-            case Layers::NON_MOVING:
-                return inObject2 == Layers::MOVING || inObject2 == Layers::DEBRIS;
-            case Layers::MOVING:
-                return inObject2 == Layers::NON_MOVING || inObject2 == Layers::MOVING || inObject2 == Layers::SENSOR;
-            case Layers::DEBRIS:
-                return inObject2 == Layers::NON_MOVING;
-            case Layers::SENSOR:
-                return inObject2 == Layers::MOVING;
-            default:
-                ASSERT(false);
-                return false;
+            LOG_ERROR("physics object layer {} refers to unknown broadphase layer {}",
+                      layer_config.m_name,
+                      layer_config.m_broad_phase_layer);
+
+            // an object layer must belong to a broadphase layer, put it into a fallback one
+            if (m_broad_phase_layer_names.empty())
+            {
+                addBroadPhaseLayer("default");
+            }
+            broad_phase_iter = m_broad_phase_layer_names.begin();
+        }
+        m_object_to_broad_phase[layer] = JPH::BroadPhaseLayer(
+            static_cast<JPH::BroadPhaseLayer::Type>(broad_phase_iter - m_broad_phase_layer_names.begin()));
+
+        for (const std::string& other_name : layer_config.m_collide_with)
+        {
+            const JPH::ObjectLayer other_layer = findObjectLayer(other_name);
+            if (other_layer == s_invalid_object_layer)
+            {
+                LOG_ERROR("physics object layer {} collides with unknown layer {}", layer_config.m_name, other_name);
+                continue;
+            }
+
+            m_object_collision_masks[layer] |= 1u << other_layer;
+            m_object_collision_masks[other_layer] |= 1u << layer;
         }
     }
 
-    bool BroadPhaseCanCollide(JPH::ObjectLayer inLayer1, JPH::BroadPhaseLayer inLayer2)
+    JPH::ObjectLayer PhysicsLayerTable::findObjectLayer(const std::string& name) const
     {
-        switch (inLayer1)
+        auto iter = std::find(m_object_layer_names.begin(), m_object_layer_names.end(), name);
+        if (iter == m_object_layer_names.end())
         {
-            case Layers::NON_MOVING:
-                return inLayer2 == BroadPhaseLayers::MOVING;
-            case Layers::MOVING:
-                return inLayer2 == BroadPhaseLayers::NON_MOVING || inLayer2 == BroadPhaseLayers::MOVING ||
-                       inLayer2 == BroadPhaseLayers::SENSOR;
-            case Layers::DEBRIS:
-                return inLayer2 == BroadPhaseLayers::NON_MOVING;
-            case Layers::SENSOR:
-                return inLayer2 == BroadPhaseLayers::MOVING;
-            case Layers::UNUSED1:
-            case Layers::UNUSED2:
-            case Layers::UNUSED3:
-                return false;
-            default:
-                ASSERT(false);
-                return false;
+            return s_invalid_object_layer;
         }
+        return static_cast<JPH::ObjectLayer>(iter - m_object_layer_names.begin());
+    }
+
+    void PhysicsLayerTable::activate() const
+    {
+        g_object_layer_count = static_cast<uint32_t>(m_object_layer_names.size());
+        std::copy(std::begin(m_object_collision_masks), std::end(m_object_collision_masks), g_object_collision_masks);
+        std::copy(std::begin(m_broad_phase_collision_masks),
+                  std::end(m_broad_phase_collision_masks),
+                  g_broad_phase_collision_masks);
+    }
+
+#if defined(JPH_EXTERNAL_PROFILE) || defined(JPH_PROFILE_ENABLED)
+    const char* PhysicsLayerTable::GetBroadPhaseLayerName(JPH::BroadPhaseLayer inLayer) const
+    {
+        const JPH::BroadPhaseLayer::Type layer_index = static_cast<JPH::BroadPhaseLayer::Type>(inLayer);
+        if (layer_index >= m_broad_phase_layer_names.size())
+        {
+            ASSERT(false);
+            return "INVALID";
+        }
+        return m_broad_phase_layer_names[layer_index].c_str();
+    }
+#endif // JPH_EXTERNAL_PROFILE || JPH_PROFILE_ENABLED
+
+    bool ObjectCanCollide(JPH::ObjectLayer inObject1, JPH::ObjectLayer inObject2)
+    {
+        ASSERT(inObject1 < g_object_layer_count && inObject2 < g_object_layer_count);
+        return (g_object_collision_masks[inObject1] & (1u << inObject2)) != 0;
+    }
+
+    bool BroadPhaseCanCollide(JPH::ObjectLayer inLayer1, JPH::BroadPhaseLayer inLayer2)
+    {
+        ASSERT(inLayer1 < g_object_layer_count);
+        return (g_broad_phase_collision_masks[inLayer1] &
+                (1u << static_cast<JPH::BroadPhaseLayer::Type>(inLayer2))) != 0;
     }
 
     JPH::Mat44 toMat44(const Matrix4x4& m)
@@ -112,46 +186,4 @@ namespace Piccolo
         return Matrix4x4(cols[0], cols[1], cols[2], cols[3]).transpose();
     }
 
-    JPH::Shape* toShape(const RigidBodyShape& shape, const Vector3& scale)
-    {
-        JPH::Shape* jph_shape = nullptr;
-
-        const std::string shape_type_str = shape.m_geometry.getTypeName();
-        if (shape_type_str == "Box")
-        {
-            const Box* box_geometry = static_cast<const Box*>(shape.m_geometry.getPtr());
-            if (box_geometry)
-            {
-                JPH::Vec3 jph_box(scale.x * box_geometry->m_half_extents.x,
-                                  scale.y * box_geometry->m_half_extents.y,
-                                  scale.z * box_geometry->m_half_extents.z);
-                jph_shape = new JPH::BoxShape(jph_box, 0.f);
-            }
-        }
-        else if (shape_type_str == "Sphere")
-        {
-            const Sphere* sphere_geometry = static_cast<const Sphere*>(shape.m_geometry.getPtr());
-            if (sphere_geometry)
-            {
-                jph_shape = new JPH::SphereShape((scale.x + scale.y + scale.z) / 3 *
-                                                 sphere_geometry->m_radius);
-            }
-        }
-        else if (shape_type_str == "Capsule")
-        {
-            const Capsule* capsule_geometry = static_cast<const Capsule*>(shape.m_geometry.getPtr());
-            if (capsule_geometry)
-            {
-                jph_shape = new JPH::CapsuleShape(scale.z * capsule_geometry->m_half_height,
-                                                  (scale.x + scale.y) / 2 * capsule_geometry->m_radius);
-            }
-        }
-        else
-        {
-            LOG_ERROR("Unsupported Shape")
-        }
-
-        return jph_shape;
-    }
-
 } // namespace Piccolo
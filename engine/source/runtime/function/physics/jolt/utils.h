@@ -5,55 +5,36 @@
 #include "core/math/quaternion.h"
 #include "core/math/vector3.h"
 
+#include "runtime/function/physics/physics_config.h"
+
 #include "Jolt/Jolt.h"
 
 #include "Jolt/Physics/Collision/BroadPhase/BroadPhaseLayer.h"
+#include "Jolt/Physics/Collision/ObjectLayer.h"
 
-namespace JPH
-{
-    class Shape;
-}
+#include <string>
+#include <vector>
 
 namespace Piccolo
 {
-    class RigidBodyShape;
-
-    namespace Layers
-    {
-        static constexpr uint8_t UNUSED1 = 0; // 4 unused values so that broadphase layers values don't match with
-                                              // object layer values (for testing purposes)
-        static constexpr uint8_t UNUSED2    = 1;
-        static constexpr uint8_t UNUSED3    = 2;
-        static constexpr uint8_t UNUSED4    = 3;
-        static constexpr uint8_t NON_MOVING = 4;
-        static constexpr uint8_t MOVING     = 5;
-        static constexpr uint8_t DEBRIS     = 6; // Example: Debris collides only with NON_MOVING
-        static constexpr uint8_t SENSOR     = 7; // Sensors only collide with MOVING objects
-        static constexpr uint8_t NUM_LAYERS = 8;
-    }; // namespace Layers
-
-    /// Broadphase layers
-    namespace BroadPhaseLayers
-    {
-        static constexpr JPH::BroadPhaseLayer NON_MOVING(0);
-        static constexpr JPH::BroadPhaseLayer MOVING(1);
-        static constexpr JPH::BroadPhaseLayer DEBRIS(2);
-        static constexpr JPH::BroadPhaseLayer SENSOR(3);
-        static constexpr JPH::BroadPhaseLayer UNUSED(4);
-        static constexpr uint32_t             NUM_LAYERS(5);
-    }; // namespace BroadPhaseLayers
-
-    /// BroadPhaseLayerInterface implementation
-    class BPLayerInterfaceImpl final : public JPH::BroadPhaseLayerInterface
+    /// object and broadphase layers of a physics scene, built from the layers of its PhysicsConfig
+    class PhysicsLayerTable final : public JPH::BroadPhaseLayerInterface
     {
     public:
-        BPLayerInterfaceImpl();
+        static constexpr uint32_t         s_max_object_layer_count {32};
+        static constexpr uint32_t         s_max_broad_phase_layer_count {32};
+        static constexpr JPH::ObjectLayer s_invalid_object_layer {0xffff};
+
+        explicit PhysicsLayerTable(const PhysicsConfig& config);
 
-        uint32_t GetNumBroadPhaseLayers() const override { return BroadPhaseLayers::NUM_LAYERS; }
+        uint32_t GetNumBroadPhaseLayers() const override
+        {
+            return static_cast<uint32_t>(m_broad_phase_layer_names.size());
+        }
 
         JPH::BroadPhaseLayer GetBroadPhaseLayer(JPH::ObjectLayer inLayer) const override
         {
-            ASSERT(inLayer < Layers::NUM_LAYERS);
+            ASSERT(inLayer < m_object_layer_names.size());
             return m_object_to_broad_phase[inLayer];
         }
 
@@ -61,8 +42,26 @@ namespace Piccolo
         const char* GetBroadPhaseLayerName(JPH::BroadPhaseLayer inLayer) const override;
 #endif // JPH_EXTERNAL_PROFILE || JPH_PROFILE_ENABLED
 
+        /// @return: s_invalid_object_layer if there is no object layer with the name
+        JPH::ObjectLayer findObjectLayer(const std::string& name) const;
+
+        /// make ObjectCanCollide and BroadPhaseCanCollide use the collision masks of this table,
+        /// jolt takes the layer filters as plain functions, so the masks are shared by all scenes
+        void activate() const;
+
     private:
-        JPH::BroadPhaseLayer m_object_to_broad_phase[Layers::NUM_LAYERS];
+        void addBroadPhaseLayer(const std::string& name);
+        void addObjectLayer(const PhysicsObjectLayerConfig& layer_config);
+
+        std::vector<std::string> m_broad_phase_layer_names;
+        std::vector<std::string> m_object_layer_names;
+
+        JPH::BroadPhaseLayer m_object_to_broad_phase[s_max_object_layer_count];
+
+        // bit i is set if the object layer collides with object layer i
+        uint32_t m_object_collision_masks[s_max_object_layer_count] {};
+        // bit i is set if the object layer collides with any object layer in broadphase layer i
+        uint32_t m_broad_phase_collision_masks[s_max_object_layer_count] {};
     };
 
     /// Function that determines if two object layers can collide
@@ -84,6 +83,4 @@ namespace Piccolo
 
     Matrix4x4 toMat44(const JPH::Mat44& m);
 
-    JPH::Shape* toShape(const RigidBodyShape& shape, const Vector3& scale);
-
 } // namespace Piccolo
\ No newline at end of file
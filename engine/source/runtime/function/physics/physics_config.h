@@ -1,11 +1,29 @@
 #pragma once
 
 #include <cstdint>
+#include <string>
+#include <vector>
 
 #include "core/math/vector3.h"
 
 namespace Piccolo
 {
+    /// how body transforms are presented between two fixed physics steps
+    enum class PhysicsInterpolationMode : uint8_t
+    {
+        none,        // present the latest simulated state
+        interpolate, // blend the last two simulated states, one step of latency
+        extrapolate  // predict from the latest state and velocities, no latency
+    };
+
+    struct PhysicsObjectLayerConfig
+    {
+        std::string m_name;
+        std::string m_broad_phase_layer;
+        // names of the object layers this layer collides with, collision is symmetric
+        std::vector<std::string> m_collide_with;
+    };
+
     class PhysicsConfig
     {
     public:
@@ -15,6 +33,13 @@ namespace Piccolo
         uint32_t m_max_body_pairs {65536};
         uint32_t m_max_contact_constraints {10240};
 
+        // a body batch inserting at least this many bodies rebuilds the broadphase tree afterwards
+        uint32_t m_optimize_broad_phase_body_count {256};
+
+        // collision layers, the default non_moving / moving / debris / sensor layers are used if empty
+        std::vector<std::string>              m_broad_phase_layers;
+        std::vector<PhysicsObjectLayerConfig> m_object_layers;
+
         // job setting
         uint32_t m_max_job_count {1024};
         uint32_t m_max_barrier_count {8};
@@ -22,6 +47,11 @@ namespace Piccolo
 
         Vector3 m_gravity {0.f, 0.f, -9.8f};
 
+        // step policy: the simulation always advances by 1 / m_update_frequency,
+        // and runs as many steps as the accumulated frame time allows
         float m_update_frequency {60.f};
+        // upper bound of steps in one tick, the rest of the accumulated time is dropped to avoid spiral of death
+        uint32_t                 m_max_step_count_per_tick {4};
+        PhysicsInterpolationMode m_interpolation_mode {PhysicsInterpolationMode::interpolate};
     };
 } // namespace Piccolo
@@ -48,9 +48,9 @@ namespace Piccolo
 #endif
     }
 
-    std::weak_ptr<PhysicsScene> PhysicsManager::createPhysicsScene(const Vector3& gravity)
+    std::weak_ptr<PhysicsScene> PhysicsManager::createPhysicsScene(const PhysicsConfig& config)
     {
-        std::shared_ptr<PhysicsScene> physics_scene = std::make_shared<PhysicsScene>(gravity);
+        std::shared_ptr<PhysicsScene> physics_scene = std::make_shared<PhysicsScene>(config);
 
         m_scenes.push_back(physics_scene);
 
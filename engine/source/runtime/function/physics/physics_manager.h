@@ -17,6 +17,7 @@ namespace JPH
 
 namespace Piccolo
 {
+    class PhysicsConfig;
     class PhysicsScene;
 
     class PhysicsManager
@@ -25,7 +26,7 @@ namespace Piccolo
         void initialize();
         void clear();
 
-        std::weak_ptr<PhysicsScene> createPhysicsScene(const Vector3& gravity);
+        std::weak_ptr<PhysicsScene> createPhysicsScene(const PhysicsConfig& config);
         void                        deletePhysicsScene(std::weak_ptr<PhysicsScene> physics_scene);
 
 #ifdef ENABLE_PHYSICS_DEBUG_RENDERER
@@ -4,12 +4,14 @@
 
 #include "runtime/resource/res_type/components/rigid_body.h"
 
+#include "runtime/function/physics/jolt/shape_cache.h"
 #include "runtime/function/physics/jolt/utils.h"
 #include "runtime/function/physics/physics_config.h"
 
 #include "Jolt/Jolt.h"
 #include "Jolt/RegisterTypes.h"
 
+#include "Jolt/Core/Color.h"
 #include "Jolt/Core/Factory.h"
 #include "Jolt/Core/JobSystem.h"
 #include "Jolt/Core/JobSystemThreadPool.h"
@@ -29,17 +31,129 @@
 #include "Jolt/Physics/Collision/ShapeCast.h"
 #include "Jolt/Physics/PhysicsSystem.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace Piccolo
 {
-    PhysicsScene::PhysicsScene(const Vector3& gravity)
+    namespace
+    {
+        /// keeps the closest hits in a fixed buffer sorted by fraction, nothing is allocated during the query
+        template<typename TCollectorBase, uint32_t MaxHitCount>
+        class FixedClosestHitsCollector : public TCollectorBase
+        {
+        public:
+            using ResultType = typename TCollectorBase::ResultType;
+
+            explicit FixedClosestHitsCollector(uint32_t hit_limit) : m_hit_limit(std::min(hit_limit, MaxHitCount)) {}
+
+            void AddHit(const ResultType& result) override
+            {
+                const float fraction = result.GetEarlyOutFraction();
+
+                uint32_t index;
+                if (m_hit_count < m_hit_limit)
+                {
+                    index = m_hit_count++;
+                }
+                else if (m_hit_limit > 0 && fraction < m_hits[m_hit_limit - 1].GetEarlyOutFraction())
+                {
+                    index = m_hit_limit - 1;
+                }
+                else
+                {
+                    return;
+                }
+
+                while (index > 0 && m_hits[index - 1].GetEarlyOutFraction() > fraction)
+                {
+                    m_hits[index] = m_hits[index - 1];
+                    --index;
+                }
+                m_hits[index] = result;
+
+                // once the buffer is full, farther hits are not interesting anymore
+                if (m_hit_count == m_hit_limit)
+                {
+                    this->UpdateEarlyOutFraction(m_hits[m_hit_limit - 1].GetEarlyOutFraction());
+                }
+            }
+
+            uint32_t          getHitCount() const { return m_hit_count; }
+            const ResultType& getHit(uint32_t index) const { return m_hits[index]; }
+
+        private:
+            ResultType m_hits[MaxHitCount];
+            uint32_t   m_hit_limit {0};
+            uint32_t   m_hit_count {0};
+        };
+
+        JPH::RayCast makeRay(const Vector3& ray_origin, const Vector3& ray_direction, float ray_length)
+        {
+            JPH::RayCast ray;
+            ray.mOrigin    = toVec3(ray_origin);
+            ray.mDirection = toVec3(ray_direction.normalisedCopy() * ray_length);
+            return ray;
+        }
+
+        void toHitInfo(const JPH::BodyLockInterface& lock_interface,
+                       const JPH::RayCast&           ray,
+                       float                         ray_length,
+                       const JPH::RayCastResult&     cast_result,
+                       PhysicsHitInfo&               out_hit)
+        {
+            out_hit.hit_position = toVec3(ray.mOrigin + cast_result.mFraction * ray.mDirection);
+            out_hit.hit_distance = cast_result.mFraction * ray_length;
+            out_hit.body_id      = cast_result.mBodyID.GetIndexAndSequenceNumber();
+
+            // get hit normal
+            JPH::BodyLockRead body_lock(lock_interface, cast_result.mBodyID);
+            const JPH::Body&  hit_body = body_lock.GetBody();
+
+            out_hit.hit_normal =
+                toVec3(hit_body.GetWorldSpaceSurfaceNormal(cast_result.mSubShapeID2, toVec3(out_hit.hit_position)));
+        }
+
+        void toHitInfo(const JPH::ShapeCastResult& sweep_result, float sweep_length, PhysicsHitInfo& out_hit)
+        {
+            out_hit.hit_position = toVec3(sweep_result.mContactPointOn2);
+            out_hit.hit_normal   = toVec3(sweep_result.mPenetrationAxis.Normalized());
+            out_hit.hit_distance = sweep_result.mFraction * sweep_length;
+            out_hit.body_id      = sweep_result.mBodyID2.GetIndexAndSequenceNumber();
+        }
+    } // namespace
+
+    PhysicsScene::PhysicsScene(const PhysicsConfig& config) : m_config(config)
     {
         static_assert(s_invalid_rigidbody_id == JPH::BodyID::cInvalidBodyID);
+        static_assert(s_rigidbody_index_mask == JPH::BodyID::cMaxBodyIndex);
+
+        if (m_config.m_max_body_count > JPH::BodyID::cMaxBodyIndex + 1)
+        {
+            LOG_WARN("physics max body count {} exceeds the limit {}",
+                     m_config.m_max_body_count,
+                     JPH::BodyID::cMaxBodyIndex + 1);
+            m_config.m_max_body_count = JPH::BodyID::cMaxBodyIndex + 1;
+        }
 
         JPH::Factory::sInstance = new JPH::Factory();
         JPH::RegisterTypes();
 
-        m_physics.m_jolt_physics_system              = new JPH::PhysicsSystem();
-        m_physics.m_jolt_broad_phase_layer_interface = new BPLayerInterfaceImpl();
+        m_physics.m_jolt_physics_system = new JPH::PhysicsSystem();
+        m_physics.m_layer_table         = new PhysicsLayerTable(m_config);
+        m_physics.m_layer_table->activate();
+
+        m_static_object_layer = m_physics.m_layer_table->findObjectLayer("non_moving");
+        m_moving_object_layer = m_physics.m_layer_table->findObjectLayer("moving");
+        if (m_static_object_layer == PhysicsLayerTable::s_invalid_object_layer ||
+            m_moving_object_layer == PhysicsLayerTable::s_invalid_object_layer)
+        {
+            LOG_WARN("physics layers non_moving or moving are missing, bodies without a layer name use the first layer");
+            m_static_object_layer =
+                m_static_object_layer == PhysicsLayerTable::s_invalid_object_layer ? 0 : m_static_object_layer;
+            m_moving_object_layer =
+                m_moving_object_layer == PhysicsLayerTable::s_invalid_object_layer ? 0 : m_moving_object_layer;
+        }
 
         m_physics.m_jolt_job_system =
             new JPH::JobSystemThreadPool(m_config.m_max_job_count,
@@ -53,14 +167,21 @@ namespace Piccolo
                                               m_config.m_body_mutex_count,
                                               m_config.m_max_body_pairs,
                                               m_config.m_max_contact_constraints,
-                                              *(m_physics.m_jolt_broad_phase_layer_interface),
+                                              *(m_physics.m_layer_table),
                                               BroadPhaseCanCollide,
                                               ObjectCanCollide);
         // use the default setting
         m_physics.m_jolt_physics_system->SetPhysicsSettings(JPH::PhysicsSettings());
 
-        m_physics.m_jolt_physics_system->SetGravity(toVec3(gravity));
-        m_config.m_gravity = gravity;
+        m_physics.m_jolt_physics_system->SetGravity(toVec3(m_config.m_gravity));
+
+        m_shape_cache = std::make_unique<ShapeCache>();
+
+        LOG_INFO("physics scene: {} max bodies, {} max body pairs, {} max contact constraints, {} threads",
+                 m_config.m_max_body_count,
+                 m_config.m_max_body_pairs,
+                 m_config.m_max_contact_constraints,
+                 m_config.m_max_concurrent_job_count);
     }
 
     PhysicsScene::~PhysicsScene()
@@ -68,24 +189,27 @@ namespace Piccolo
         delete m_physics.m_jolt_physics_system;
         delete m_physics.m_jolt_job_system;
         delete m_physics.m_temp_allocator;
-        delete m_physics.m_jolt_broad_phase_layer_interface;
+        delete m_physics.m_layer_table;
+
+        m_shape_cache.reset();
 
         delete JPH::Factory::sInstance;
         JPH::Factory::sInstance = nullptr;
     }
 
     uint32_t PhysicsScene::createRigidBody(const Transform&             global_transform,
-                                           const RigidBodyComponentRes& rigidbody_actor_res)
+                                           const RigidBodyComponentRes& rigidbody_actor_res,
+                                           uint64_t                     user_data)
     {
         JPH::BodyInterface& body_interface = m_physics.m_jolt_physics_system->GetBodyInterface();
 
         struct JPHShapeData
         {
-            JPH::Shape* shape {nullptr};
-            Transform   local_transform;
-            Vector3     global_position;
-            Vector3     global_scale;
-            Quaternion  global_rotation;
+            JPH::RefConst<JPH::Shape> shape;
+            Transform                 local_transform;
+            Vector3                   global_position;
+            Vector3                   global_scale;
+            Quaternion                global_rotation;
         };
 
         std::vector<JPHShapeData> jph_shapes;
@@ -101,7 +225,7 @@ namespace Piccolo
 
             shape_global_transform.decomposition(global_position, global_scale, global_rotation);
 
-            JPH::Shape* jph_shape = toShape(shape, global_scale);
+            JPH::RefConst<JPH::Shape> jph_shape = m_shape_cache->getShape(shape, global_scale);
 
             if (jph_shape)
             {
@@ -116,9 +240,34 @@ namespace Piccolo
             return JPH::BodyID::cInvalidBodyID;
         }
 
-        //$TODO: currently just support static object
         JPH::EMotionType motion_type = JPH::EMotionType::Static;
-        JPH::ObjectLayer layer       = Layers::NON_MOVING;
+        JPH::ObjectLayer layer       = m_static_object_layer;
+        switch (rigidbody_actor_res.getActorType())
+        {
+            case RigidBodyActorType::dynamic_actor:
+                motion_type = JPH::EMotionType::Dynamic;
+                layer       = m_moving_object_layer;
+                break;
+            case RigidBodyActorType::kinematic_actor:
+                motion_type = JPH::EMotionType::Kinematic;
+                layer       = m_moving_object_layer;
+                break;
+            default:
+                break;
+        }
+
+        if (!rigidbody_actor_res.m_layer.empty())
+        {
+            const JPH::ObjectLayer named_layer = m_physics.m_layer_table->findObjectLayer(rigidbody_actor_res.m_layer);
+            if (named_layer != PhysicsLayerTable::s_invalid_object_layer)
+            {
+                layer = named_layer;
+            }
+            else
+            {
+                LOG_ERROR("unknown physics layer {}", rigidbody_actor_res.m_layer);
+            }
+        }
 
         JPH::Ref<JPH::StaticCompoundShapeSettings> compund_shape_setting = new JPH::StaticCompoundShapeSettings;
         for (const JPHShapeData& shape_data : jph_shapes)
@@ -128,27 +277,107 @@ namespace Piccolo
                                             shape_data.shape);
         }
 
-        JPH::Body* jph_body = body_interface.CreateBody(JPH::BodyCreationSettings(compund_shape_setting,
-                                                                                  toVec3(global_transform.m_position),
-                                                                                  toQuat(global_transform.m_rotation),
-                                                                                  motion_type,
-                                                                                  layer));
+        JPH::BodyCreationSettings body_settings(compund_shape_setting,
+                                                toVec3(global_transform.m_position),
+                                                toQuat(global_transform.m_rotation),
+                                                motion_type,
+                                                layer);
+        body_settings.mUserData = user_data;
+        if (motion_type == JPH::EMotionType::Dynamic && rigidbody_actor_res.m_inverse_mass > 0.f)
+        {
+            body_settings.mOverrideMassProperties       = JPH::EOverrideMassProperties::CalculateInertia;
+            body_settings.mMassPropertiesOverride.mMass = 1.f / rigidbody_actor_res.m_inverse_mass;
+        }
+
+        JPH::Body* jph_body = body_interface.CreateBody(body_settings);
 
         if (jph_body == nullptr)
         {
             LOG_ERROR("Create JPH Body Failed");
-            for (const JPHShapeData& shape_data : jph_shapes)
+            return JPH::BodyID::cInvalidBodyID;
+        }
+
+        const uint32_t body_id = jph_body->GetID().GetIndexAndSequenceNumber();
+
+        if (m_is_in_body_batch)
+        {
+            if (motion_type == JPH::EMotionType::Static)
+            {
+                m_batched_static_bodies.push_back(body_id);
+            }
+            else
             {
-                delete shape_data.shape;
+                m_batched_moving_bodies.push_back(body_id);
             }
+        }
+        else
+        {
+            body_interface.AddBody(jph_body->GetID(),
+                                   motion_type == JPH::EMotionType::Static ? JPH::EActivation::DontActivate :
+                                                                             JPH::EActivation::Activate);
+            LOG_DEBUG_CATEGORY(physics, "Add Body: {}", body_id);
+        }
 
-            return JPH::BodyID::cInvalidBodyID;
+        // only dynamic bodies are driven by the simulation, their transforms are written back after stepping
+        if (motion_type == JPH::EMotionType::Dynamic)
+        {
+            BodyTransformState& state = m_body_transform_states[body_id];
+            state.m_previous_position = global_transform.m_position;
+            state.m_previous_rotation = global_transform.m_rotation;
+            state.m_current_position  = global_transform.m_position;
+            state.m_current_rotation  = global_transform.m_rotation;
+            state.m_user_data         = user_data;
+            state.m_last_active_step  = m_step_index;
         }
 
-        body_interface.AddBody(jph_body->GetID(), JPH::EActivation::Activate);
-        LOG_INFO("Add Body: {}", jph_body->GetID().GetIndexAndSequenceNumber());
+        return body_id;
+    }
 
-        return jph_body->GetID().GetIndexAndSequenceNumber();
+    void PhysicsScene::beginBodyBatch()
+    {
+        ASSERT(!m_is_in_body_batch);
+        m_is_in_body_batch = true;
+    }
+
+    void PhysicsScene::endBodyBatch()
+    {
+        ASSERT(m_is_in_body_batch);
+        m_is_in_body_batch = false;
+
+        JPH::BodyInterface& body_interface = m_physics.m_jolt_physics_system->GetBodyInterface();
+
+        auto add_bodies = [&body_interface](std::vector<uint32_t>& body_ids, JPH::EActivation activation) {
+            if (body_ids.empty())
+            {
+                return;
+            }
+
+            std::vector<JPH::BodyID> jph_body_ids(body_ids.begin(), body_ids.end());
+
+            const int                       body_count = static_cast<int>(jph_body_ids.size());
+            JPH::BodyInterface::AddState add_state  = body_interface.AddBodiesPrepare(jph_body_ids.data(), body_count);
+            body_interface.AddBodiesFinalize(jph_body_ids.data(), body_count, add_state, activation);
+
+            body_ids.clear();
+        };
+
+        LOG_INFO("Add Bodies: {} static, {} moving", m_batched_static_bodies.size(), m_batched_moving_bodies.size());
+
+        const size_t body_count = m_batched_static_bodies.size() + m_batched_moving_bodies.size();
+
+        add_bodies(m_batched_static_bodies, JPH::EActivation::DontActivate);
+        add_bodies(m_batched_moving_bodies, JPH::EActivation::Activate);
+
+        if (body_count > 0 && body_count >= m_config.m_optimize_broad_phase_body_count)
+        {
+            optimizeBroadPhase();
+        }
+    }
+
+    void PhysicsScene::optimizeBroadPhase()
+    {
+        LOG_INFO("Optimize BroadPhase: {} bodies", m_physics.m_jolt_physics_system->GetNumBodies());
+        m_physics.m_jolt_physics_system->OptimizeBroadPhase();
     }
 
     void PhysicsScene::removeRigidBody(uint32_t body_id) { m_pending_remove_bodies.push_back(body_id); }
@@ -163,24 +392,237 @@ namespace Piccolo
                                               JPH::EActivation::Activate);
     }
 
+    void PhysicsScene::moveKinematicRigidBody(uint32_t body_id, const Transform& target_global_transform)
+    {
+        // ticks without a fixed step keep the targets, only the latest one of a body is moved to
+        m_pending_kinematic_targets[body_id] = {target_global_transform.m_position, target_global_transform.m_rotation};
+    }
+
     void PhysicsScene::tick(float delta_time)
     {
         const float time_step = 1.f / m_config.m_update_frequency;
 
+        m_accumulated_time += delta_time;
+
+        m_last_tick_step_count = std::min(static_cast<uint32_t>(m_accumulated_time / time_step),
+                                          m_config.m_max_step_count_per_tick);
+
+        JPH::BodyInterface& body_interface = m_physics.m_jolt_physics_system->GetBodyInterface();
+
+        // kinematic bodies reach their targets at the end of the steps of this tick
+        if (m_last_tick_step_count > 0)
+        {
+            const float move_time = time_step * m_last_tick_step_count;
+            for (const auto& [body_id, target] : m_pending_kinematic_targets)
+            {
+                body_interface.MoveKinematic(
+                    JPH::BodyID(body_id), toVec3(target.m_position), toQuat(target.m_rotation), move_time);
+            }
+            m_pending_kinematic_targets.clear();
+        }
+
+        for (uint32_t step_index = 0; step_index < m_last_tick_step_count; ++step_index)
+        {
+            step(time_step);
+        }
+        m_accumulated_time -= time_step * m_last_tick_step_count;
+
+        // the simulation can not catch up, drop the remaining time instead of accumulating more debt
+        if (m_accumulated_time >= time_step)
+        {
+            m_accumulated_time = std::fmod(m_accumulated_time, time_step);
+        }
+
+        m_interpolation_alpha = m_accumulated_time / time_step;
+
+        removePendingBodies();
+
+        // shapes resolved by the scene queries since the last tick are released here
+        m_shape_cache->collectGarbage();
+
+        collectMovedBodyTransforms();
+    }
+
+    void PhysicsScene::tickWithoutSimulation()
+    {
+        JPH::BodyInterface& body_interface = m_physics.m_jolt_physics_system->GetBodyInterface();
+        for (const auto& [body_id, target] : m_pending_kinematic_targets)
+        {
+            body_interface.SetPositionAndRotation(JPH::BodyID(body_id),
+                                                  toVec3(target.m_position),
+                                                  toQuat(target.m_rotation),
+                                                  JPH::EActivation::DontActivate);
+        }
+        m_pending_kinematic_targets.clear();
+
+        removePendingBodies();
+
+        m_shape_cache->collectGarbage();
+
+        m_last_tick_step_count = 0;
+        m_moved_body_transforms.clear();
+    }
+
+    void PhysicsScene::removePendingBodies()
+    {
+        if (m_pending_remove_bodies.empty())
+        {
+            return;
+        }
+
+        JPH::BodyInterface& body_interface = m_physics.m_jolt_physics_system->GetBodyInterface();
+
+        // take the bodies out of the broadphase in one batch, e.g. when a level region is unloaded
+        std::vector<JPH::BodyID> destroyed_body_ids;
+        std::vector<JPH::BodyID> removed_body_ids;
+        destroyed_body_ids.reserve(m_pending_remove_bodies.size());
+        for (uint32_t body_id : m_pending_remove_bodies)
+        {
+            const JPH::BodyID jph_body_id(body_id);
+            destroyed_body_ids.push_back(jph_body_id);
+            if (body_interface.IsAdded(jph_body_id))
+            {
+                removed_body_ids.push_back(jph_body_id);
+            }
+
+            m_body_transform_states.erase(body_id);
+            m_pending_kinematic_targets.erase(body_id);
+        }
+
+        LOG_INFO("Remove Bodies: {}", destroyed_body_ids.size());
+
+        if (!removed_body_ids.empty())
+        {
+            body_interface.RemoveBodies(removed_body_ids.data(), static_cast<int>(removed_body_ids.size()));
+        }
+        body_interface.DestroyBodies(destroyed_body_ids.data(), static_cast<int>(destroyed_body_ids.size()));
+
+        m_pending_remove_bodies.clear();
+    }
+
+    void PhysicsScene::step(float time_step)
+    {
         m_physics.m_jolt_physics_system->Update(time_step,
                                                 m_physics.m_collision_steps,
                                                 m_physics.m_integration_substeps,
                                                 m_physics.m_temp_allocator,
                                                 m_physics.m_jolt_job_system);
 
-        JPH::BodyInterface& body_interface = m_physics.m_jolt_physics_system->GetBodyInterface();
-        for (uint32_t body_id : m_pending_remove_bodies)
+        updateBodyTransformStates();
+    }
+
+    void PhysicsScene::updateBodyTransformStates()
+    {
+        ++m_step_index;
+
+        JPH::BodyIDVector active_bodies;
+        m_physics.m_jolt_physics_system->GetActiveBodies(active_bodies);
+
+        const JPH::BodyLockInterface& lock_interface = m_physics.m_jolt_physics_system->GetBodyLockInterface();
+        for (const JPH::BodyID& body_id : active_bodies)
         {
-            LOG_INFO("Remove Body {}", body_id)
-            body_interface.RemoveBody(JPH::BodyID(body_id));
-            body_interface.DestroyBody(JPH::BodyID(body_id));
+            auto iter = m_body_transform_states.find(body_id.GetIndexAndSequenceNumber());
+            if (iter == m_body_transform_states.end())
+            {
+                continue;
+            }
+
+            JPH::BodyLockRead body_lock(lock_interface, body_id);
+            if (!body_lock.Succeeded())
+            {
+                continue;
+            }
+
+            const JPH::Body& body = body_lock.GetBody();
+
+            BodyTransformState& state = iter->second;
+            state.m_previous_position = state.m_current_position;
+            state.m_previous_rotation = state.m_current_rotation;
+            state.m_current_position  = toVec3(body.GetPosition());
+            state.m_current_rotation  = toQuat(body.GetRotation());
+            state.m_linear_velocity   = toVec3(body.GetLinearVelocity());
+            state.m_angular_velocity  = toVec3(body.GetAngularVelocity());
+            state.m_last_active_step  = m_step_index;
+        }
+    }
+
+    void PhysicsScene::presentBodyTransform(const BodyTransformState& state,
+                                            Vector3&                  out_position,
+                                            Quaternion&               out_rotation) const
+    {
+        // the body is sleeping, there is nothing to blend
+        if (state.m_last_active_step < m_step_index)
+        {
+            out_position = state.m_current_position;
+            out_rotation = state.m_current_rotation;
+            return;
+        }
+
+        switch (m_config.m_interpolation_mode)
+        {
+            case PhysicsInterpolationMode::interpolate:
+                out_position = state.m_previous_position +
+                               (state.m_current_position - state.m_previous_position) * m_interpolation_alpha;
+                out_rotation = Quaternion::nLerp(
+                    m_interpolation_alpha, state.m_previous_rotation, state.m_current_rotation, true);
+                break;
+            case PhysicsInterpolationMode::extrapolate:
+            {
+                const float predict_time = m_interpolation_alpha / m_config.m_update_frequency;
+
+                out_position = state.m_current_position + state.m_linear_velocity * predict_time;
+
+                const float angular_speed = state.m_angular_velocity.length();
+                if (angular_speed > Float_EPSILON)
+                {
+                    const Quaternion delta_rotation(Radian(angular_speed * predict_time),
+                                                    state.m_angular_velocity / angular_speed);
+                    out_rotation = delta_rotation * state.m_current_rotation;
+                }
+                else
+                {
+                    out_rotation = state.m_current_rotation;
+                }
+                break;
+            }
+            default:
+                out_position = state.m_current_position;
+                out_rotation = state.m_current_rotation;
+                break;
+        }
+    }
+
+    bool PhysicsScene::getPresentedBodyTransform(uint32_t body_id, Transform& out_transform) const
+    {
+        auto iter = m_body_transform_states.find(body_id);
+        if (iter == m_body_transform_states.end())
+        {
+            return false;
+        }
+
+        presentBodyTransform(iter->second, out_transform.m_position, out_transform.m_rotation);
+        return true;
+    }
+
+    void PhysicsScene::collectMovedBodyTransforms()
+    {
+        m_moved_body_transforms.clear();
+
+        for (const auto& id_state_pair : m_body_transform_states)
+        {
+            const BodyTransformState& state = id_state_pair.second;
+
+            // a body that fell asleep is reported once more at rest, then skipped
+            if (state.m_last_active_step + 1 < m_step_index)
+            {
+                continue;
+            }
+
+            PhysicsBodyTransform& body_transform = m_moved_body_transforms.emplace_back();
+            body_transform.body_id               = id_state_pair.first;
+            body_transform.user_data             = state.m_user_data;
+            presentBodyTransform(state, body_transform.position, body_transform.rotation);
         }
-        m_pending_remove_bodies.clear();
     }
 
     bool PhysicsScene::raycast(Vector3                      ray_origin,
@@ -190,9 +632,7 @@ namespace Piccolo
     {
         const JPH::NarrowPhaseQuery& scene_query = m_physics.m_jolt_physics_system->GetNarrowPhaseQuery();
 
-        JPH::RayCast ray;
-        ray.mOrigin    = toVec3(ray_origin);
-        ray.mDirection = toVec3(ray_directory.normalisedCopy() * ray_length);
+        const JPH::RayCast ray = makeRay(ray_origin, ray_directory, ray_length);
 
         JPH::RayCastSettings raycast_setting;
 
@@ -207,31 +647,90 @@ namespace Piccolo
 
         collector.Sort();
 
-        std::vector<JPH::RayCastResult> raycast_results(collector.mHits.begin(), collector.mHits.end());
-
         out_hits.clear();
-        out_hits.resize(raycast_results.size());
+        out_hits.resize(collector.mHits.size());
 
-        for (size_t index = 0; index < raycast_results.size(); index++)
+        const JPH::BodyLockInterface& lock_interface = m_physics.m_jolt_physics_system->GetBodyLockInterface();
+        for (size_t index = 0; index < collector.mHits.size(); index++)
         {
-            const JPH::RayCastResult& cast_result = raycast_results[index];
+            toHitInfo(lock_interface, ray, ray_length, collector.mHits[index], out_hits[index]);
+        }
 
-            PhysicsHitInfo& hit = out_hits[index];
-            hit.hit_position    = toVec3(ray.mOrigin + cast_result.mFraction * ray.mDirection);
-            hit.hit_distance    = cast_result.mFraction * ray_length;
-            hit.body_id         = cast_result.mBodyID.GetIndexAndSequenceNumber();
+        return true;
+    }
 
-            // get hit normal
-            JPH::BodyLockRead body_lock(m_physics.m_jolt_physics_system->GetBodyLockInterface(), cast_result.mBodyID);
-            const JPH::Body&  hit_body = body_lock.GetBody();
+    uint32_t PhysicsScene::raycast(Vector3         ray_origin,
+                                   Vector3         ray_direction,
+                                   float           ray_length,
+                                   PhysicsHitInfo* out_hits,
+                                   uint32_t        max_hit_count)
+    {
+        const JPH::NarrowPhaseQuery& scene_query = m_physics.m_jolt_physics_system->GetNarrowPhaseQuery();
+
+        const JPH::RayCast ray = makeRay(ray_origin, ray_direction, ray_length);
+
+        FixedClosestHitsCollector<JPH::CastRayCollector, s_max_query_hit_count> collector(max_hit_count);
+        scene_query.CastRay(ray, JPH::RayCastSettings(), collector);
 
-            hit.hit_normal =
-                toVec3(hit_body.GetWorldSpaceSurfaceNormal(cast_result.mSubShapeID2, toVec3(hit.hit_position)));
+        const JPH::BodyLockInterface& lock_interface = m_physics.m_jolt_physics_system->GetBodyLockInterface();
+        for (uint32_t index = 0; index < collector.getHitCount(); index++)
+        {
+            toHitInfo(lock_interface, ray, ray_length, collector.getHit(index), out_hits[index]);
         }
 
+        return collector.getHitCount();
+    }
+
+    bool PhysicsScene::raycastClosest(Vector3         ray_origin,
+                                      Vector3         ray_direction,
+                                      float           ray_length,
+                                      PhysicsHitInfo& out_hit)
+    {
+        const JPH::NarrowPhaseQuery& scene_query = m_physics.m_jolt_physics_system->GetNarrowPhaseQuery();
+
+        const JPH::RayCast ray = makeRay(ray_origin, ray_direction, ray_length);
+
+        JPH::ClosestHitCollisionCollector<JPH::CastRayCollector> collector;
+        scene_query.CastRay(ray, JPH::RayCastSettings(), collector);
+
+        if (!collector.HadHit())
+        {
+            return false;
+        }
+
+        toHitInfo(m_physics.m_jolt_physics_system->GetBodyLockInterface(), ray, ray_length, collector.mHit, out_hit);
         return true;
     }
 
+    void PhysicsScene::raycastBatch(const PhysicsRaycastQuery* queries,
+                                    uint32_t                   query_count,
+                                    PhysicsHitInfo*            out_closest_hits)
+    {
+        const JPH::NarrowPhaseQuery&  scene_query    = m_physics.m_jolt_physics_system->GetNarrowPhaseQuery();
+        const JPH::BodyLockInterface& lock_interface = m_physics.m_jolt_physics_system->GetBodyLockInterface();
+
+        runQueryJobs(query_count, [&](uint32_t query_begin, uint32_t query_end) {
+            for (uint32_t query_index = query_begin; query_index < query_end; ++query_index)
+            {
+                const PhysicsRaycastQuery& query = queries[query_index];
+
+                const JPH::RayCast ray = makeRay(query.ray_origin, query.ray_direction, query.ray_length);
+
+                JPH::ClosestHitCollisionCollector<JPH::CastRayCollector> collector;
+                scene_query.CastRay(ray, JPH::RayCastSettings(), collector);
+
+                if (collector.HadHit())
+                {
+                    toHitInfo(lock_interface, ray, query.ray_length, collector.mHit, out_closest_hits[query_index]);
+                }
+                else
+                {
+                    out_closest_hits[query_index] = PhysicsHitInfo();
+                }
+            }
+        });
+    }
+
     bool PhysicsScene::sweep(const RigidBodyShape&        shape,
                              const Matrix4x4&             shape_transform,
                              Vector3                      sweep_direction,
@@ -240,25 +739,17 @@ namespace Piccolo
     {
         const JPH::NarrowPhaseQuery& scene_query = m_physics.m_jolt_physics_system->GetNarrowPhaseQuery();
 
-        const Matrix4x4 shape_global_transform = shape_transform * shape.m_local_transform.getMatrix();
-
-        Vector3    global_position, global_scale;
-        Quaternion global_rotation;
-
-        shape_global_transform.decomposition(global_position, global_scale, global_rotation);
-
-        JPH::Shape* jph_shape = toShape(shape, global_scale);
-
-        if (jph_shape == nullptr)
+        ResolvedShapeQuery resolved_query;
+        if (!resolveQueryShape(shape, shape_transform, resolved_query))
         {
             return false;
         }
 
-        JPH::ShapeCast shape_cast =
-            JPH::ShapeCast::sFromWorldTransform(jph_shape,
-                                                JPH::Vec3::sReplicate(1.f),
-                                                toMat44(shape_global_transform),
-                                                toVec3(sweep_direction.normalisedCopy() * sweep_length));
+        JPH::ShapeCast shape_cast = JPH::ShapeCast::sFromWorldTransform(
+            resolved_query.m_shape,
+            JPH::Vec3::sReplicate(1.f),
+            JPH::Mat44::sRotationTranslation(toQuat(resolved_query.m_rotation), toVec3(resolved_query.m_position)),
+            toVec3(sweep_direction.normalisedCopy() * sweep_length));
 
         JPH::AllHitCollisionCollector<JPH::CastShapeCollector> collector;
         scene_query.CastShape(shape_cast, JPH::ShapeCastSettings(), collector);
@@ -269,53 +760,153 @@ namespace Piccolo
 
         collector.Sort();
 
-        std::vector<JPH::ShapeCastResult> sweep_results(collector.mHits.begin(), collector.mHits.end());
-
         out_hits.clear();
-        out_hits.resize(sweep_results.size());
+        out_hits.resize(collector.mHits.size());
 
-        for (size_t index = 0; index < sweep_results.size(); index++)
+        for (size_t index = 0; index < collector.mHits.size(); index++)
         {
-            const JPH::ShapeCastResult& sweep_result = sweep_results[index];
-
-            PhysicsHitInfo& hit = out_hits[index];
-            hit.hit_position    = toVec3(sweep_result.mContactPointOn2);
-            hit.hit_normal      = toVec3(sweep_result.mPenetrationAxis.Normalized());
-            hit.hit_distance    = sweep_result.mFraction * sweep_length;
-            hit.body_id         = sweep_result.mBodyID2.GetIndexAndSequenceNumber();
+            toHitInfo(collector.mHits[index], sweep_length, out_hits[index]);
         }
 
         return true;
     }
 
-    bool PhysicsScene::isOverlap(const RigidBodyShape& shape, const Matrix4x4& global_transform)
+    uint32_t PhysicsScene::sweep(const RigidBodyShape& shape,
+                                 const Matrix4x4&      shape_transform,
+                                 Vector3               sweep_direction,
+                                 float                 sweep_length,
+                                 PhysicsHitInfo*       out_hits,
+                                 uint32_t              max_hit_count)
     {
         const JPH::NarrowPhaseQuery& scene_query = m_physics.m_jolt_physics_system->GetNarrowPhaseQuery();
 
-        const Matrix4x4 shape_global_transform = global_transform * shape.m_local_transform.getMatrix();
+        ResolvedShapeQuery resolved_query;
+        if (!resolveQueryShape(shape, shape_transform, resolved_query))
+        {
+            return 0;
+        }
 
-        Vector3    global_position, global_scale;
-        Quaternion global_rotation;
+        JPH::ShapeCast shape_cast = JPH::ShapeCast::sFromWorldTransform(
+            resolved_query.m_shape,
+            JPH::Vec3::sReplicate(1.f),
+            JPH::Mat44::sRotationTranslation(toQuat(resolved_query.m_rotation), toVec3(resolved_query.m_position)),
+            toVec3(sweep_direction.normalisedCopy() * sweep_length));
 
-        shape_global_transform.decomposition(global_position, global_scale, global_rotation);
+        FixedClosestHitsCollector<JPH::CastShapeCollector, s_max_query_hit_count> collector(max_hit_count);
+        scene_query.CastShape(shape_cast, JPH::ShapeCastSettings(), collector);
+
+        for (uint32_t index = 0; index < collector.getHitCount(); index++)
+        {
+            toHitInfo(collector.getHit(index), sweep_length, out_hits[index]);
+        }
 
-        JPH::Shape* jph_shape = toShape(shape, global_scale);
+        return collector.getHitCount();
+    }
+
+    bool PhysicsScene::isOverlap(const RigidBodyShape& shape, const Matrix4x4& global_transform)
+    {
+        const JPH::NarrowPhaseQuery& scene_query = m_physics.m_jolt_physics_system->GetNarrowPhaseQuery();
 
-        if (jph_shape == nullptr)
+        ResolvedShapeQuery resolved_query;
+        if (!resolveQueryShape(shape, global_transform, resolved_query))
         {
             return false;
         }
 
         JPH::AnyHitCollisionCollector<JPH::CollideShapeCollector> collector;
-        scene_query.CollideShape(jph_shape,
-                                 JPH::Vec3::sReplicate(1.0f),
-                                 toMat44(shape_global_transform),
-                                 JPH::CollideShapeSettings(),
-                                 collector);
+        scene_query.CollideShape(
+            resolved_query.m_shape,
+            JPH::Vec3::sReplicate(1.0f),
+            JPH::Mat44::sRotationTranslation(toQuat(resolved_query.m_rotation), toVec3(resolved_query.m_position)),
+            JPH::CollideShapeSettings(),
+            collector);
 
         return collector.HadHit();
     }
 
+    void PhysicsScene::overlapBatch(const PhysicsOverlapQuery* queries, uint32_t query_count, bool* out_is_overlap)
+    {
+        const JPH::NarrowPhaseQuery& scene_query = m_physics.m_jolt_physics_system->GetNarrowPhaseQuery();
+
+        // the shape cache is not thread safe, resolve all shapes before dispatching
+        m_resolved_shape_queries.resize(query_count);
+        for (uint32_t query_index = 0; query_index < query_count; ++query_index)
+        {
+            const PhysicsOverlapQuery& query = queries[query_index];
+            if (query.shape == nullptr ||
+                !resolveQueryShape(*query.shape, query.global_transform, m_resolved_shape_queries[query_index]))
+            {
+                m_resolved_shape_queries[query_index].m_shape = nullptr;
+            }
+        }
+
+        runQueryJobs(query_count, [&](uint32_t query_begin, uint32_t query_end) {
+            for (uint32_t query_index = query_begin; query_index < query_end; ++query_index)
+            {
+                const ResolvedShapeQuery& resolved_query = m_resolved_shape_queries[query_index];
+                if (resolved_query.m_shape == nullptr)
+                {
+                    out_is_overlap[query_index] = false;
+                    continue;
+                }
+
+                JPH::AnyHitCollisionCollector<JPH::CollideShapeCollector> collector;
+                scene_query.CollideShape(resolved_query.m_shape,
+                                         JPH::Vec3::sReplicate(1.0f),
+                                         JPH::Mat44::sRotationTranslation(toQuat(resolved_query.m_rotation),
+                                                                          toVec3(resolved_query.m_position)),
+                                         JPH::CollideShapeSettings(),
+                                         collector);
+
+                out_is_overlap[query_index] = collector.HadHit();
+            }
+        });
+    }
+
+    bool PhysicsScene::resolveQueryShape(const RigidBodyShape& shape,
+                                         const Matrix4x4&      global_transform,
+                                         ResolvedShapeQuery&   out_query)
+    {
+        const Matrix4x4 shape_global_transform = global_transform * shape.m_local_transform.getMatrix();
+
+        // the scale is baked into the cached shape, the query itself only takes a rigid transform
+        Vector3 global_scale;
+        shape_global_transform.decomposition(out_query.m_position, global_scale, out_query.m_rotation);
+
+        out_query.m_shape = m_shape_cache->getShape(shape, global_scale).GetPtr();
+
+        return out_query.m_shape != nullptr;
+    }
+
+    void PhysicsScene::runQueryJobs(uint32_t                                      query_count,
+                                    const std::function<void(uint32_t, uint32_t)>& query_range_func)
+    {
+        static constexpr uint32_t s_queries_per_job = 64;
+
+        if (query_count <= s_queries_per_job)
+        {
+            query_range_func(0, query_count);
+            return;
+        }
+
+        JPH::JobSystem*          job_system = m_physics.m_jolt_job_system;
+        JPH::JobSystem::Barrier* barrier    = job_system->CreateBarrier();
+
+        for (uint32_t query_begin = 0; query_begin < query_count; query_begin += s_queries_per_job)
+        {
+            const uint32_t query_end = std::min(query_begin + s_queries_per_job, query_count);
+
+            JPH::JobHandle job = job_system->CreateJob(
+                "SceneQuery", JPH::Color::sCyan, [&query_range_func, query_begin, query_end]() {
+                    query_range_func(query_begin, query_end);
+                });
+            barrier->AddJob(job);
+        }
+
+        job_system->WaitForJobs(barrier);
+        job_system->DestroyBarrier(barrier);
+    }
+
     void PhysicsScene::getShapeBoundingBoxes(uint32_t body_id, std::vector<AxisAlignedBox>& out_bounding_boxes) const
     {
         JPH::BodyLockRead body_lock(m_physics.m_jolt_physics_system->GetBodyLockInterface(), JPH::BodyID(body_id));
@@ -1,15 +1,21 @@
 #pragma once
 
 #include "runtime/core/math/axis_aligned.h"
+#include "runtime/core/math/matrix4.h"
+#include "runtime/core/math/quaternion.h"
 
 #include "runtime/function/physics/physics_config.h"
 
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
 namespace JPH
 {
     class PhysicsSystem;
     class JobSystem;
     class TempAllocator;
-    class BroadPhaseLayerInterface;
+    class Shape;
 #ifdef ENABLE_PHYSICS_DEBUG_RENDERER
     class DebugRenderer;
 #endif
@@ -20,8 +26,12 @@ namespace Piccolo
     class Transform;
     class RigidBodyComponentRes;
     class RigidBodyShape;
+    class ShapeCache;
+    class PhysicsLayerTable;
 
     static constexpr uint32_t s_invalid_rigidbody_id = 0xffffffff;
+    // the low bits of a rigidbody id index the body, the high bits count the reuses of that index
+    static constexpr uint32_t s_rigidbody_index_mask = 0x007fffff;
 
     struct PhysicsHitInfo
     {
@@ -31,32 +41,95 @@ namespace Piccolo
         uint32_t body_id {s_invalid_rigidbody_id};
     };
 
+    struct PhysicsRaycastQuery
+    {
+        Vector3 ray_origin;
+        Vector3 ray_direction;
+        float   ray_length {0.f};
+    };
+
+    struct PhysicsOverlapQuery
+    {
+        const RigidBodyShape* shape {nullptr};
+        Matrix4x4             global_transform;
+    };
+
+    struct PhysicsBodyTransform
+    {
+        uint32_t   body_id {s_invalid_rigidbody_id};
+        uint64_t   user_data {0};
+        Vector3    position;
+        Quaternion rotation;
+    };
+
     class PhysicsScene
     {
         struct JoltPhysics
         {
-            JPH::PhysicsSystem*            m_jolt_physics_system {nullptr};
-            JPH::JobSystem*                m_jolt_job_system {nullptr};
-            JPH::TempAllocator*            m_temp_allocator {nullptr};
-            JPH::BroadPhaseLayerInterface* m_jolt_broad_phase_layer_interface {nullptr};
+            JPH::PhysicsSystem* m_jolt_physics_system {nullptr};
+            JPH::JobSystem*     m_jolt_job_system {nullptr};
+            JPH::TempAllocator* m_temp_allocator {nullptr};
+            PhysicsLayerTable*  m_layer_table {nullptr};
 
             int m_collision_steps {1};
             int m_integration_substeps {1};
         };
 
     public:
-        PhysicsScene(const Vector3& gravity);
+        PhysicsScene(const PhysicsConfig& config);
         virtual ~PhysicsScene();
 
         const Vector3& getGravity() const { return m_config.m_gravity; }
 
-        uint32_t createRigidBody(const Transform& global_transform, const RigidBodyComponentRes& rigidbody_actor_res);
+        /// create a rigidbody, its motion type is decided by the actor type of the resource, and its object layer by
+        /// the layer name of the resource, or by the motion type if the name is empty
+        /// @user_data: returned with the simulated transforms of the body, e.g. the id of the owner object
+        /// @return: the body id, or s_invalid_rigidbody_id if failed
+        uint32_t createRigidBody(const Transform&             global_transform,
+                                 const RigidBodyComponentRes& rigidbody_actor_res,
+                                 uint64_t                     user_data = 0);
         void     removeRigidBody(uint32_t body_id);
 
+        /// bodies created between beginBodyBatch and endBodyBatch are inserted into the broadphase together,
+        /// their ids are valid immediately but they can not be hit by queries before endBodyBatch,
+        /// large batches (e.g. level or region loads) rebuild the broadphase tree afterwards
+        void beginBodyBatch();
+        void endBodyBatch();
+
+        /// rebuild the broadphase tree for faster queries and collision detection, this is expensive
+        void optimizeBroadPhase();
+
+        /// teleport a body
         void updateRigidBodyGlobalTransform(uint32_t body_id, const Transform& global_transform);
 
+        /// move a kinematic body to the target over the next simulation steps, so it pushes dynamic bodies
+        void moveKinematicRigidBody(uint32_t body_id, const Transform& target_global_transform);
+
+        /// advance the simulation by fixed steps of 1 / update frequency, consuming the accumulated frame time
         void tick(float delta_time);
 
+        /// apply the removals and kinematic moves without simulating, e.g. while the editor is not playing
+        ///
+        /// the kinematic bodies are teleported to their targets and no body is reported as moved
+        void tickWithoutSimulation();
+
+        /// get the transform of a simulated body to present this frame, according to the interpolation mode
+        /// @body_id: id of the body
+        /// @out_transform: position and rotation are written, scale is left untouched
+        /// @return: false if the body is not driven by the simulation, e.g. a static or kinematic body
+        bool getPresentedBodyTransform(uint32_t body_id, Transform& out_transform) const;
+
+        /// fraction of a fixed step left in the accumulator after the last tick, in [0, 1)
+        float getInterpolationAlpha() const { return m_interpolation_alpha; }
+
+        /// number of fixed steps run during the last tick
+        uint32_t getLastTickStepCount() const { return m_last_tick_step_count; }
+
+        /// presented transforms of the dynamic bodies that moved during the last tick, in one flat array
+        const std::vector<PhysicsBodyTransform>& getMovedBodyTransforms() const { return m_moved_body_transforms; }
+
+        const PhysicsConfig& getConfig() const { return m_config; }
+
         /// cast a ray and find the hits
         /// @ray_origin: origin of ray
         /// @ray_direction: ray direction
@@ -66,6 +139,24 @@ namespace Piccolo
         bool
         raycast(Vector3 ray_origin, Vector3 ray_direction, float ray_length, std::vector<PhysicsHitInfo>& out_hits);
 
+        /// cast a ray and write the closest hits into a caller provided buffer, nothing is allocated
+        /// @out_hits: buffer of at least max_hit_count hits, filled sorted by distance
+        /// @max_hit_count: at most s_max_query_hit_count hits are reported
+        /// @return: number of hits written
+        uint32_t raycast(Vector3         ray_origin,
+                         Vector3         ray_direction,
+                         float           ray_length,
+                         PhysicsHitInfo* out_hits,
+                         uint32_t        max_hit_count);
+
+        /// cast a ray and find the closest hit only
+        /// @return: true if any hits found, else false
+        bool raycastClosest(Vector3 ray_origin, Vector3 ray_direction, float ray_length, PhysicsHitInfo& out_hit);
+
+        /// cast a batch of rays on the physics job system and find the closest hit of each
+        /// @out_closest_hits: buffer of query_count hits, body_id is s_invalid_rigidbody_id if the ray hits nothing
+        void raycastBatch(const PhysicsRaycastQuery* queries, uint32_t query_count, PhysicsHitInfo* out_closest_hits);
+
         /// cast a shape and find the hits
         /// @shape: the casted rigidbody shape
         /// @shape_transform: the initial global transform of the casted shape
@@ -79,11 +170,28 @@ namespace Piccolo
                    float                        sweep_length,
                    std::vector<PhysicsHitInfo>& out_hits);
 
+        /// cast a shape and write the closest hits into a caller provided buffer, nothing is allocated
+        /// @out_hits: buffer of at least max_hit_count hits, filled sorted by distance
+        /// @max_hit_count: at most s_max_query_hit_count hits are reported
+        /// @return: number of hits written
+        uint32_t sweep(const RigidBodyShape& shape,
+                       const Matrix4x4&      shape_transform,
+                       Vector3               sweep_direction,
+                       float                 sweep_length,
+                       PhysicsHitInfo*       out_hits,
+                       uint32_t              max_hit_count);
+
         /// overlap test
         /// @shape: rigidbody shape
         /// @return: true if overlapped with any rigidbodies
         bool isOverlap(const RigidBodyShape& shape, const Matrix4x4& global_transform);
 
+        /// run a batch of overlap tests on the physics job system
+        /// @out_is_overlap: buffer of query_count results
+        void overlapBatch(const PhysicsOverlapQuery* queries, uint32_t query_count, bool* out_is_overlap);
+
+        static constexpr uint32_t s_max_query_hit_count {32};
+
         void getShapeBoundingBoxes(uint32_t body_id, std::vector<AxisAlignedBox>& out_bounding_boxes) const;
 
 #ifdef ENABLE_PHYSICS_DEBUG_RENDERER
@@ -91,11 +199,75 @@ namespace Piccolo
 #endif
 
     protected:
+        struct BodyTransformState
+        {
+            Vector3    m_previous_position;
+            Quaternion m_previous_rotation;
+            Vector3    m_current_position;
+            Quaternion m_current_rotation;
+            Vector3    m_linear_velocity;
+            Vector3    m_angular_velocity;
+            uint64_t   m_user_data {0};
+            uint64_t   m_last_active_step {0};
+        };
+
+        struct KinematicTarget
+        {
+            Vector3    m_position;
+            Quaternion m_rotation;
+        };
+
+        struct ResolvedShapeQuery
+        {
+            const JPH::Shape* m_shape {nullptr}; // kept alive by the shape cache until the end of the next tick
+            Vector3           m_position;
+            Quaternion        m_rotation;
+        };
+
+        /// get the cached jolt shape of a query shape, and the rigid transform to query it with
+        bool resolveQueryShape(const RigidBodyShape& shape,
+                               const Matrix4x4&      global_transform,
+                               ResolvedShapeQuery&   out_query);
+
+        /// split the queries into chunks and run them on the physics job system, wait until all are done
+        void runQueryJobs(uint32_t query_count, const std::function<void(uint32_t, uint32_t)>& query_range_func);
+
+        void step(float time_step);
+        void presentBodyTransform(const BodyTransformState& state, Vector3& out_position, Quaternion& out_rotation) const;
+        void collectMovedBodyTransforms();
+        void updateBodyTransformStates();
+        void removePendingBodies();
+
         // we use single Jolt physics system for each scene
         JoltPhysics m_physics;
 
+        std::unique_ptr<ShapeCache> m_shape_cache;
+
+        std::vector<ResolvedShapeQuery> m_resolved_shape_queries;
+
         PhysicsConfig m_config;
 
+        // removed bodies are taken out of the broadphase together at the end of the next tick
         std::vector<uint32_t> m_pending_remove_bodies;
+
+        uint16_t m_static_object_layer {0}; // jolt object layers of bodies without a layer name
+        uint16_t m_moving_object_layer {0};
+
+        bool                  m_is_in_body_batch {false};
+        std::vector<uint32_t> m_batched_static_bodies;
+        std::vector<uint32_t> m_batched_moving_bodies;
+
+        // key: body id, value: the latest target of the kinematic body, applied once the next fixed step runs
+        std::unordered_map<uint32_t, KinematicTarget> m_pending_kinematic_targets;
+
+        float    m_accumulated_time {0.f};
+        float    m_interpolation_alpha {0.f};
+        uint32_t m_last_tick_step_count {0};
+        uint64_t m_step_index {0};
+
+        // key: body id, value: the simulated states of the last two fixed steps of a dynamic body
+        std::unordered_map<uint32_t, BodyTransformState> m_body_transform_states;
+
+        std::vector<PhysicsBodyTransform> m_moved_body_transforms;
     };
 } // namespace Piccolo
\ No newline at end of file
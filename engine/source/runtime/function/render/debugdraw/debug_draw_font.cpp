@@ -76,6 +76,7 @@ namespace Piccolo
         
         std::shared_ptr<RHI> rhi = g_runtime_global_context.m_render_system->getRHI();
         rhi->createGlobalImage(m_font_image, m_font_imageView, m_allocation, m_bitmap_w, m_bitmap_h, imageData.data(), RHIFormat::RHI_FORMAT_R32_SFLOAT);
+        rhi->flushUploads();
 
         free(fontBuffer);
         free(bitmap);
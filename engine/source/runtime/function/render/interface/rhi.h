@@ -4,6 +4,7 @@
 #include <GLFW/glfw3.h>
 #include <vk_mem_alloc.h>
 
+#include <filesystem>
 #include <memory>
 #include <vector>
 #include <functional>
@@ -16,6 +17,8 @@ namespace Piccolo
     struct RHIInitInfo
     {
         std::shared_ptr<WindowSystem> window_system;
+        // pipeline cache kept across runs, left empty to compile every pipeline from scratch
+        std::filesystem::path pipeline_cache_path;
     };
     
     class RHI
@@ -58,6 +61,12 @@ namespace Piccolo
             RHIImage* &image, RHIDeviceMemory* &memory, RHIImageCreateFlags image_create_flags, uint32_t array_layers, uint32_t miplevels) = 0;
         virtual void createImageView(RHIImage* image, RHIFormat format, RHIImageAspectFlags image_aspect_flags, RHIImageViewType view_type, uint32_t layout_count, uint32_t miplevels,
             RHIImageView* &image_view) = 0;
+        // aliasing, images created in the same aliasing memory share it and must never be in use at the same time
+        virtual void getImageMemoryRequirements(uint32_t image_width, uint32_t image_height, RHIFormat format, RHIImageTiling image_tiling, RHIImageUsageFlags image_usage_flags,
+            RHIImageCreateFlags image_create_flags, uint32_t array_layers, uint32_t miplevels, RHIMemoryRequirements& requirements) = 0;
+        virtual bool allocateAliasingMemory(const RHIMemoryRequirements& requirements, RHIMemoryPropertyFlags memory_property_flags, RHIDeviceMemory* &memory) = 0;
+        virtual bool createAliasingImage(RHIDeviceMemory* memory, uint32_t image_width, uint32_t image_height, RHIFormat format, RHIImageTiling image_tiling, RHIImageUsageFlags image_usage_flags,
+            RHIImageCreateFlags image_create_flags, uint32_t array_layers, uint32_t miplevels, RHIImage* &image) = 0;
         virtual void createGlobalImage(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, void* texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels = 0) = 0;
         virtual void createCubeMap(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, std::array<void*, 6> texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels) = 0;
         virtual void createCommandPool() = 0;
@@ -143,6 +152,30 @@ namespace Piccolo
         virtual void pushEvent(RHICommandBuffer* commond_buffer, const char* name, const float* color) = 0;
         virtual void popEvent(RHICommandBuffer* commond_buffer) = 0;
 
+        // secondary command buffers, recorded by several threads inside a render pass and executed from the primary
+        virtual uint32_t          getMaxRecordingThreadCount() const = 0;
+        virtual RHICommandBuffer* beginSecondaryCommandBuffer(uint32_t thread_index, RHIRenderPass* render_pass, uint32_t subpass, RHIFramebuffer* framebuffer) = 0;
+        virtual void              endSecondaryCommandBuffer(RHICommandBuffer* command_buffer) = 0;
+        virtual void              cmdExecuteCommandsPFN(RHICommandBuffer* command_buffer, uint32_t command_buffer_count, RHICommandBuffer* const* secondary_command_buffers) = 0;
+
+        // upload, copies are batched and retire asynchronously, a ticket tells when the data is on the gpu
+        virtual bool     allocateUploadMemory(RHIDeviceSize size, RHIUploadAllocation& allocation, RHIDeviceSize alignment = 16) = 0;
+        virtual void     uploadBuffer(const RHIUploadAllocation& allocation, RHIDeviceSize src_offset, RHIBuffer* dst_buffer, RHIDeviceSize dst_offset, RHIDeviceSize size) = 0;
+        virtual uint64_t getUploadTicket() const = 0;
+        virtual uint64_t getRetiredUploadTicket() const = 0;
+        virtual void     flushUploads() = 0;
+
+        // memory, budgets per heap and compaction of the relocatable mesh buffers
+        virtual void getMemoryBudgets(std::vector<RHIMemoryHeapBudget>& budgets) const = 0;
+        virtual void defragmentMemory() = 0;
+
+        // deferred destruction, destroy runs once the frames submitted so far and the upload batch with the ticket,
+        // the one holding the last copy into the resources, have retired
+        virtual void deferDestruction(uint64_t upload_ticket, std::function<void()> destroy) = 0;
+
+        // pipeline cache, the rhi passes it to every pipeline created without an explicit cache
+        virtual void savePipelineCache() = 0;
+
         // destory
         virtual void clear() = 0;
         virtual void clearSwapchain() = 0;
@@ -159,6 +192,9 @@ namespace Piccolo
         virtual void destroyDevice() = 0;
         virtual void destroyCommandPool(RHICommandPool* commandPool) = 0;
         virtual void destroyBuffer(RHIBuffer* &buffer) = 0;
+        virtual void destroyBufferVMA(VmaAllocator allocator, RHIBuffer* &buffer, VmaAllocation allocation) = 0;
+        virtual void destroyImageVMA(VmaAllocator allocator, RHIImage* &image, VmaAllocation allocation) = 0;
+        virtual void freeDescriptorSet(RHIDescriptorPool* descriptor_pool, RHIDescriptorSet* &descriptor_set) = 0;
         virtual void freeCommandBuffers(RHICommandPool* commandPool, uint32_t commandBufferCount, RHICommandBuffer* pCommandBuffers) = 0;
 
         // memory
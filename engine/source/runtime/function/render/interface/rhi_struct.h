@@ -1121,10 +1121,30 @@ namespace Piccolo
         std::optional<uint32_t> graphics_family;
         std::optional<uint32_t> present_family;
         std::optional<uint32_t> m_compute_family;
+        std::optional<uint32_t> m_transfer_family; // transfer only family, left empty when the device has none
 
         bool isComplete() { return graphics_family.has_value() && present_family.has_value() && m_compute_family.has_value();; }
     };
 
+    struct RHIUploadAllocation
+    {
+        RHIBuffer*    buffer {nullptr}; // staging buffer owned by the rhi
+        RHIDeviceSize offset {0};
+        RHIDeviceSize size {0};
+        void*         mapped_data {nullptr};
+    };
+
+    struct RHIMemoryHeapBudget
+    {
+        bool          is_device_local {false};
+        RHIDeviceSize usage {0};  // bytes the process uses on the heap, as reported or estimated
+        RHIDeviceSize budget {0}; // bytes the process can use before allocations may fail or evict
+        RHIDeviceSize block_bytes {0};
+        RHIDeviceSize allocation_bytes {0};
+        uint32_t      block_count {0};
+        uint32_t      allocation_count {0};
+    };
+
     struct SwapChainSupportDetails
     {
         VkSurfaceCapabilitiesKHR        capabilities;
@@ -69,6 +69,7 @@
 #endif
 
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <set>
 #include <stdexcept>
@@ -76,6 +77,39 @@
 
 namespace Piccolo
 {
+    namespace
+    {
+        // the driver silently drops a cache from another device, the header lets us tell and log it
+        struct PipelineCacheFileHeader
+        {
+            uint32_t magic {0};
+            uint32_t version {0};
+            uint32_t vendor_id {0};
+            uint32_t device_id {0};
+            uint32_t driver_version {0};
+            uint8_t  pipeline_cache_uuid[VK_UUID_SIZE] {};
+            uint64_t data_size {0};
+        };
+
+        constexpr uint32_t k_pipeline_cache_file_magic   = 0x43504950; // "PIPC"
+        constexpr uint32_t k_pipeline_cache_file_version = 1;
+
+        PipelineCacheFileHeader makePipelineCacheFileHeader(VkPhysicalDevice physical_device)
+        {
+            VkPhysicalDeviceProperties physical_device_properties;
+            vkGetPhysicalDeviceProperties(physical_device, &physical_device_properties);
+
+            PipelineCacheFileHeader header;
+            header.magic          = k_pipeline_cache_file_magic;
+            header.version        = k_pipeline_cache_file_version;
+            header.vendor_id      = physical_device_properties.vendorID;
+            header.device_id      = physical_device_properties.deviceID;
+            header.driver_version = physical_device_properties.driverVersion;
+            memcpy(header.pipeline_cache_uuid, physical_device_properties.pipelineCacheUUID, VK_UUID_SIZE);
+            return header;
+        }
+    } // namespace
+
     VulkanRHI::~VulkanRHI()
     {
         // TODO
@@ -83,7 +117,8 @@ namespace Piccolo
 
     void VulkanRHI::initialize(RHIInitInfo init_info)
     {
-        m_window = init_info.window_system->getWindow();
+        m_window              = init_info.window_system->getWindow();
+        m_pipeline_cache_path = init_info.pipeline_cache_path;
 
         std::array<int, 2> window_size = init_info.window_system->getWindowSize();
 
@@ -137,6 +172,10 @@ namespace Piccolo
 
         createLogicalDevice();
 
+        createAssetAllocator();
+
+        createPipelineCache();
+
         createCommandPool();
 
         createCommandBuffers();
@@ -151,17 +190,45 @@ namespace Piccolo
 
         createFramebufferImageAndView();
 
-        createAssetAllocator();
+        m_upload_manager.initialize(this);
     }
 
     void VulkanRHI::prepareContext()
     {
         m_vk_current_command_buffer = m_vk_command_buffers[m_current_frame_index];
         ((VulkanCommandBuffer*)m_current_command_buffer)->setResource(m_vk_current_command_buffer);
+
+        // uploads recorded since the last frame go to the gpu before this frame's commands
+        m_upload_manager.submit();
+        m_upload_manager.retire();
     }
 
     void VulkanRHI::clear()
     {
+        m_upload_manager.clear();
+
+        savePipelineCache();
+        vkDestroyPipelineCache(m_device, m_pipeline_cache, nullptr);
+        m_pipeline_cache = VK_NULL_HANDLE;
+
+        vkDeviceWaitIdle(m_device);
+        destroyRetiredResources(true);
+
+        for (auto& frame_secondary_command_pools : m_secondary_command_pools)
+        {
+            for (SecondaryCommandPool& secondary_command_pool : frame_secondary_command_pools)
+            {
+                for (VulkanCommandBuffer* command_buffer : secondary_command_pool.command_buffers)
+                {
+                    delete command_buffer;
+                }
+                secondary_command_pool.command_buffers.clear();
+
+                vkDestroyCommandPool(m_device, secondary_command_pool.command_pool, nullptr);
+                secondary_command_pool.command_pool = VK_NULL_HANDLE;
+            }
+        }
+
         if (m_enable_validation_Layers)
         {
             destroyDebugUtilsMessengerEXT(m_instance, m_debug_messenger, nullptr);
@@ -175,7 +242,11 @@ namespace Piccolo
         if (VK_SUCCESS != res_wait_for_fences)
         {
             LOG_ERROR("failed to synchronize!");
+            return;
         }
+
+        m_retired_frame_count = std::max(m_retired_frame_count, m_frame_counts_in_flight[m_current_frame_index]);
+        destroyRetiredResources(false);
     }
 
     bool VulkanRHI::waitForFences(uint32_t fenceCount, const RHIFence* const* pFences, RHIBool32 waitAll, uint64_t timeout)
@@ -362,6 +433,20 @@ namespace Piccolo
         {
             LOG_ERROR("failed to synchronize");
         }
+
+        for (SecondaryCommandPool& secondary_command_pool : m_secondary_command_pools[m_current_frame_index])
+        {
+            if (secondary_command_pool.used_count == 0)
+            {
+                continue;
+            }
+
+            if (VK_SUCCESS != _vkResetCommandPool(m_device, secondary_command_pool.command_pool, 0))
+            {
+                LOG_ERROR("failed to reset secondary command pool");
+            }
+            secondary_command_pool.used_count = 0;
+        }
     }
 
     bool VulkanRHI::prepareBeforePass(std::function<void()> passUpdateAfterRecreateSwapchain)
@@ -411,6 +496,7 @@ namespace Piccolo
                 LOG_ERROR("vkQueueSubmit failed!");
                 return false;
             }
+            m_frame_counts_in_flight[m_current_frame_index] = ++m_submitted_frame_count;
             m_current_frame_index = (m_current_frame_index + 1) % k_max_frames_in_flight;
             return RHI_SUCCESS;
         }
@@ -480,6 +566,7 @@ namespace Piccolo
             LOG_ERROR("vkQueueSubmit failed!");
             return;
         }
+        m_frame_counts_in_flight[m_current_frame_index] = ++m_submitted_frame_count;
 
         // present swapchain
         VkPresentInfoKHR present_info   = {};
@@ -764,6 +851,10 @@ namespace Piccolo
         std::set<uint32_t>                   queue_families = {m_queue_indices.graphics_family.value(),
                                              m_queue_indices.present_family.value(),
                                              m_queue_indices.m_compute_family.value()};
+        if (m_queue_indices.m_transfer_family.has_value())
+        {
+            queue_families.insert(m_queue_indices.m_transfer_family.value());
+        }
 
         float queue_priority = 1.0f;
         for (uint32_t queue_family : queue_families) // for every queue family
@@ -822,6 +913,11 @@ namespace Piccolo
         m_compute_queue = new VulkanQueue();
         ((VulkanQueue*)m_compute_queue)->setResource(vk_compute_queue);
 
+        if (m_queue_indices.m_transfer_family.has_value())
+        {
+            vkGetDeviceQueue(m_device, m_queue_indices.m_transfer_family.value(), 0, &m_transfer_queue);
+        }
+
         // more efficient pointer
         _vkResetCommandPool      = (PFN_vkResetCommandPool)vkGetDeviceProcAddr(m_device, "vkResetCommandPool");
         _vkBeginCommandBuffer    = (PFN_vkBeginCommandBuffer)vkGetDeviceProcAddr(m_device, "vkBeginCommandBuffer");
@@ -839,6 +935,7 @@ namespace Piccolo
         _vkCmdBindIndexBuffer    = (PFN_vkCmdBindIndexBuffer)vkGetDeviceProcAddr(m_device, "vkCmdBindIndexBuffer");
         _vkCmdBindDescriptorSets = (PFN_vkCmdBindDescriptorSets)vkGetDeviceProcAddr(m_device, "vkCmdBindDescriptorSets");
         _vkCmdClearAttachments   = (PFN_vkCmdClearAttachments)vkGetDeviceProcAddr(m_device, "vkCmdClearAttachments");
+        _vkCmdExecuteCommands    = (PFN_vkCmdExecuteCommands)vkGetDeviceProcAddr(m_device, "vkCmdExecuteCommands");
 
         m_depth_image_format = (RHIFormat)findDepthFormat();
     }
@@ -878,6 +975,21 @@ namespace Piccolo
                     LOG_ERROR("vk create command pool");
                 }
             }
+
+            // secondary command pools, a command pool must only be used by one thread at a time
+            for (uint32_t i = 0; i < k_max_frames_in_flight; ++i)
+            {
+                for (uint32_t j = 0; j < k_max_recording_threads; ++j)
+                {
+                    if (vkCreateCommandPool(m_device,
+                                            &command_pool_create_info,
+                                            NULL,
+                                            &m_secondary_command_pools[i][j].command_pool) != VK_SUCCESS)
+                    {
+                        LOG_ERROR("vk create secondary command pool");
+                    }
+                }
+            }
         }
     }
 
@@ -1387,7 +1499,7 @@ namespace Piccolo
 
         pPipelines = new VulkanPipeline();
         VkPipeline vk_pipelines;
-        VkPipelineCache vk_pipeline_cache = VK_NULL_HANDLE;
+        VkPipelineCache vk_pipeline_cache = m_pipeline_cache;
         if (pipelineCache != nullptr)
         {
             vk_pipeline_cache = ((VulkanPipelineCache*)pipelineCache)->getResource();
@@ -1443,7 +1555,7 @@ namespace Piccolo
 
         pPipelines = new VulkanPipeline();
         VkPipeline vk_pipelines;
-        VkPipelineCache vk_pipeline_cache = VK_NULL_HANDLE;
+        VkPipelineCache vk_pipeline_cache = m_pipeline_cache;
         if (pipelineCache != nullptr)
         {
             vk_pipeline_cache = ((VulkanPipelineCache*)pipelineCache)->getResource();
@@ -2647,7 +2759,8 @@ namespace Piccolo
         pool_info.pPoolSizes    = pool_sizes;
         pool_info.maxSets =
             1 + 1 + 1 + m_max_material_count + m_max_vertex_blending_mesh_count + 1 + 1; // +skybox + axis descriptor set
-        pool_info.flags = 0U;
+        // the sets of reloaded meshes and materials are freed one by one
+        pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
 
         if (vkCreateDescriptorPool(m_device, &pool_info, nullptr, &m_vk_descriptor_pool) != VK_SUCCESS)
         {
@@ -2693,8 +2806,7 @@ namespace Piccolo
 
     void VulkanRHI::createFramebufferImageAndView()
     {
-        VulkanUtil::createImage(m_physical_device,
-                                m_device,
+        VulkanUtil::createImage(m_assets_allocator,
                                 m_swapchain_extent.width,
                                 m_swapchain_extent.height,
                                 (VkFormat)m_depth_image_format,
@@ -2703,7 +2815,7 @@ namespace Piccolo
                                 VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                                 ((VulkanImage*)m_depth_image)->getResource(),
-                                m_depth_image_memory,
+                                m_depth_image_allocation,
                                 0,
                                 1,
                                 1);
@@ -2782,27 +2894,27 @@ namespace Piccolo
     void VulkanRHI::createBuffer(RHIDeviceSize size, RHIBufferUsageFlags usage, RHIMemoryPropertyFlags properties, RHIBuffer* & buffer, RHIDeviceMemory* & buffer_memory)
     {
         VkBuffer vk_buffer;
-        VkDeviceMemory vk_device_memory;
-        
-        VulkanUtil::createBuffer(m_physical_device, m_device, size, usage, properties, vk_buffer, vk_device_memory);
+        VmaAllocation vma_allocation;
+
+        VulkanUtil::createBuffer(m_assets_allocator, size, usage, properties, vk_buffer, vma_allocation);
 
         buffer = new VulkanBuffer();
         buffer_memory = new VulkanDeviceMemory();
         ((VulkanBuffer*)buffer)->setResource(vk_buffer);
-        ((VulkanDeviceMemory*)buffer_memory)->setResource(vk_device_memory);
+        ((VulkanDeviceMemory*)buffer_memory)->setResource(vma_allocation);
     }
 
     void VulkanRHI::createBufferAndInitialize(RHIBufferUsageFlags usage, RHIMemoryPropertyFlags properties, RHIBuffer*& buffer, RHIDeviceMemory*& buffer_memory, RHIDeviceSize size, void* data, int datasize)
     {
         VkBuffer vk_buffer;
-        VkDeviceMemory vk_device_memory;
+        VmaAllocation vma_allocation;
 
-        VulkanUtil::createBufferAndInitialize(m_device, m_physical_device, usage, properties, &vk_buffer, &vk_device_memory, size, data, datasize);
+        VulkanUtil::createBufferAndInitialize(m_assets_allocator, usage, properties, &vk_buffer, &vma_allocation, size, data, datasize);
 
         buffer = new VulkanBuffer();
         buffer_memory = new VulkanDeviceMemory();
         ((VulkanBuffer*)buffer)->setResource(vk_buffer);
-        ((VulkanDeviceMemory*)buffer_memory)->setResource(vk_device_memory);
+        ((VulkanDeviceMemory*)buffer_memory)->setResource(vma_allocation);
     }
 
     bool VulkanRHI::createBufferVMA(VmaAllocator allocator, const RHIBufferCreateInfo* pBufferCreateInfo, const VmaAllocationCreateInfo* pAllocationCreateInfo, RHIBuffer* & pBuffer, VmaAllocation* pAllocation, VmaAllocationInfo* pAllocationInfo)
@@ -2830,6 +2942,21 @@ namespace Piccolo
 
         if (result == VK_SUCCESS)
         {
+            // a moved buffer is recreated and copied, buffers bound through descriptor sets have to stay in place
+            const VkBufferUsageFlags descriptor_usage =
+                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+            if (m_mesh_buffer_pool != VK_NULL_HANDLE && pAllocationCreateInfo->pool == m_mesh_buffer_pool &&
+                (buffer_create_info.usage & descriptor_usage) == 0 &&
+                (buffer_create_info.usage & VK_BUFFER_USAGE_TRANSFER_SRC_BIT) != 0)
+            {
+                RelocatableBuffer& relocatable_buffer      = m_relocatable_buffers[*pAllocation];
+                relocatable_buffer.buffer                  = (VulkanBuffer*)pBuffer;
+                relocatable_buffer.create_info             = buffer_create_info;
+                relocatable_buffer.create_info.pNext       = nullptr;
+                relocatable_buffer.create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+                relocatable_buffer.create_info.queueFamilyIndexCount = 0;
+                relocatable_buffer.create_info.pQueueFamilyIndices   = nullptr;
+            }
             return true;
         }
         else
@@ -2881,14 +3008,185 @@ namespace Piccolo
         VulkanUtil::copyBuffer(this, vk_src_buffer, vk_dst_buffer, srcOffset, dstOffset, size);
     }
 
+    bool VulkanRHI::allocateUploadMemory(RHIDeviceSize size, RHIUploadAllocation& allocation, RHIDeviceSize alignment)
+    {
+        return m_upload_manager.allocate(size, alignment, allocation);
+    }
+
+    void VulkanRHI::uploadBuffer(const RHIUploadAllocation& allocation, RHIDeviceSize src_offset, RHIBuffer* dst_buffer, RHIDeviceSize dst_offset, RHIDeviceSize size)
+    {
+        m_upload_manager.recordBufferCopy(
+            allocation, src_offset, ((VulkanBuffer*)dst_buffer)->getResource(), dst_offset, size);
+    }
+
+    uint64_t VulkanRHI::getUploadTicket() const
+    {
+        return m_upload_manager.getRecordingTicket();
+    }
+
+    uint64_t VulkanRHI::getRetiredUploadTicket() const
+    {
+        return m_upload_manager.getRetiredTicket();
+    }
+
+    void VulkanRHI::flushUploads()
+    {
+        m_upload_manager.wait(m_upload_manager.getRecordingTicket());
+    }
+
+    void VulkanRHI::deferDestruction(uint64_t upload_ticket, std::function<void()> destroy)
+    {
+        // the frame recording now may use the resources as well, it is the next one to be submitted
+        m_deferred_destructions.push_back({m_submitted_frame_count + 1, upload_ticket, std::move(destroy)});
+    }
+
+    void VulkanRHI::destroyRetiredResources(bool is_device_idle)
+    {
+        // queued in submission order, so the first one not yet retired ends the walk
+        while (!m_deferred_destructions.empty())
+        {
+            DeferredDestruction& deferred_destruction = m_deferred_destructions.front();
+            if (!is_device_idle && (deferred_destruction.frame_count > m_retired_frame_count ||
+                                    deferred_destruction.upload_ticket > m_upload_manager.getRetiredTicket()))
+            {
+                break;
+            }
+
+            std::function<void()> destroy = std::move(deferred_destruction.destroy);
+            m_deferred_destructions.pop_front();
+            destroy();
+        }
+    }
+
+    void VulkanRHI::getMemoryBudgets(std::vector<RHIMemoryHeapBudget>& budgets) const
+    {
+        const VkPhysicalDeviceMemoryProperties* memory_properties = nullptr;
+        vmaGetMemoryProperties(m_assets_allocator, &memory_properties);
+
+        // without VK_EXT_memory_budget vma estimates usage from its own blocks and budget as 80% of the heap
+        VmaBudget vma_budgets[VK_MAX_MEMORY_HEAPS];
+        vmaGetHeapBudgets(m_assets_allocator, vma_budgets);
+
+        budgets.resize(memory_properties->memoryHeapCount);
+        for (uint32_t heap_index = 0; heap_index < memory_properties->memoryHeapCount; ++heap_index)
+        {
+            const VmaBudget&     vma_budget = vma_budgets[heap_index];
+            RHIMemoryHeapBudget& budget     = budgets[heap_index];
+
+            budget.is_device_local =
+                (memory_properties->memoryHeaps[heap_index].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+            budget.usage            = vma_budget.usage;
+            budget.budget           = vma_budget.budget;
+            budget.block_bytes      = vma_budget.statistics.blockBytes;
+            budget.allocation_bytes = vma_budget.statistics.allocationBytes;
+            budget.block_count      = vma_budget.statistics.blockCount;
+            budget.allocation_count = vma_budget.statistics.allocationCount;
+        }
+    }
+
+    void VulkanRHI::defragmentMemory()
+    {
+        if (m_mesh_buffer_pool == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        // the moved buffers must neither be read by a frame in flight nor written by a pending upload
+        flushUploads();
+        vkDeviceWaitIdle(m_device);
+
+        // the buffers waiting for their frames to retire are freed first, they are the holes to compact
+        destroyRetiredResources(true);
+
+        VmaDefragmentationInfo defragmentation_info {};
+        defragmentation_info.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+        defragmentation_info.pool  = m_mesh_buffer_pool;
+
+        VmaDefragmentationContext defragmentation_context;
+        if (vmaBeginDefragmentation(m_assets_allocator, &defragmentation_info, &defragmentation_context) != VK_SUCCESS)
+        {
+            LOG_ERROR("vmaBeginDefragmentation failed!");
+            return;
+        }
+
+        // every pass returns a list of moves, VK_SUCCESS means there is nothing left to move
+        for (;;)
+        {
+            VmaDefragmentationPassMoveInfo pass_move_info {};
+            if (vmaBeginDefragmentationPass(m_assets_allocator, defragmentation_context, &pass_move_info) == VK_SUCCESS)
+            {
+                break;
+            }
+
+            RHICommandBuffer* rhi_command_buffer = beginSingleTimeCommands();
+            VkCommandBuffer   command_buffer     = ((VulkanCommandBuffer*)rhi_command_buffer)->getResource();
+
+            std::vector<VkBuffer> moved_from_buffers;
+            for (uint32_t move_index = 0; move_index < pass_move_info.moveCount; ++move_index)
+            {
+                VmaDefragmentationMove& move = pass_move_info.pMoves[move_index];
+
+                auto relocatable_iter = m_relocatable_buffers.find(move.srcAllocation);
+                if (relocatable_iter == m_relocatable_buffers.end())
+                {
+                    move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                    continue;
+                }
+                RelocatableBuffer& relocatable_buffer = relocatable_iter->second;
+
+                VkBuffer new_buffer = VK_NULL_HANDLE;
+                if (vkCreateBuffer(m_device, &relocatable_buffer.create_info, nullptr, &new_buffer) != VK_SUCCESS)
+                {
+                    LOG_ERROR("vkCreateBuffer failed!");
+                    move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                    continue;
+                }
+                if (vmaBindBufferMemory(m_assets_allocator, move.dstTmpAllocation, new_buffer) != VK_SUCCESS)
+                {
+                    LOG_ERROR("vmaBindBufferMemory failed!");
+                    vkDestroyBuffer(m_device, new_buffer, nullptr);
+                    move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                    continue;
+                }
+
+                VkBufferCopy copy_region {0, 0, relocatable_buffer.create_info.size};
+                vkCmdCopyBuffer(command_buffer, relocatable_buffer.buffer->getResource(), new_buffer, 1, &copy_region);
+
+                // everyone holds the RHIBuffer, swapping the handle inside moves them all
+                moved_from_buffers.push_back(relocatable_buffer.buffer->getResource());
+                relocatable_buffer.buffer->setResource(new_buffer);
+            }
+
+            endSingleTimeCommands(rhi_command_buffer);
+
+            for (VkBuffer moved_from_buffer : moved_from_buffers)
+            {
+                vkDestroyBuffer(m_device, moved_from_buffer, nullptr);
+            }
+
+            if (vmaEndDefragmentationPass(m_assets_allocator, defragmentation_context, &pass_move_info) == VK_SUCCESS)
+            {
+                break;
+            }
+        }
+
+        VmaDefragmentationStats defragmentation_stats {};
+        vmaEndDefragmentation(m_assets_allocator, defragmentation_context, &defragmentation_stats);
+
+        LOG_INFO("defragmentation moved {} buffers ({} bytes), released {} blocks ({} bytes)",
+                 defragmentation_stats.allocationsMoved,
+                 defragmentation_stats.bytesMoved,
+                 defragmentation_stats.deviceMemoryBlocksFreed,
+                 defragmentation_stats.bytesFreed);
+    }
+
     void VulkanRHI::createImage(uint32_t image_width, uint32_t image_height, RHIFormat format, RHIImageTiling image_tiling, RHIImageUsageFlags image_usage_flags, RHIMemoryPropertyFlags memory_property_flags,
         RHIImage* &image, RHIDeviceMemory* &memory, RHIImageCreateFlags image_create_flags, uint32_t array_layers, uint32_t miplevels)
     {
         VkImage vk_image;
-        VkDeviceMemory vk_device_memory;
+        VmaAllocation vma_allocation;
         VulkanUtil::createImage(
-            m_physical_device,
-            m_device,
+            m_assets_allocator,
             image_width,
             image_height,
             (VkFormat)format,
@@ -2896,7 +3194,7 @@ namespace Piccolo
             (VkImageUsageFlags)image_usage_flags,
             (VkMemoryPropertyFlags)memory_property_flags,
             vk_image,
-            vk_device_memory,
+            vma_allocation,
             (VkImageCreateFlags)image_create_flags,
             array_layers,
             miplevels);
@@ -2904,7 +3202,7 @@ namespace Piccolo
         image = new VulkanImage();
         memory = new VulkanDeviceMemory();
         ((VulkanImage*)image)->setResource(vk_image);
-        ((VulkanDeviceMemory*)memory)->setResource(vk_device_memory);
+        ((VulkanDeviceMemory*)memory)->setResource(vma_allocation);
     }
 
     void VulkanRHI::createImageView(RHIImage* image, RHIFormat format, RHIImageAspectFlags image_aspect_flags, RHIImageViewType view_type, uint32_t layout_count, uint32_t miplevels,
@@ -2917,6 +3215,86 @@ namespace Piccolo
         ((VulkanImageView*)image_view)->setResource(vk_image_view);
     }
 
+    void VulkanRHI::getImageMemoryRequirements(uint32_t image_width, uint32_t image_height, RHIFormat format, RHIImageTiling image_tiling, RHIImageUsageFlags image_usage_flags,
+        RHIImageCreateFlags image_create_flags, uint32_t array_layers, uint32_t miplevels, RHIMemoryRequirements& requirements)
+    {
+        VkImageCreateInfo image_create_info = VulkanUtil::getImageCreateInfo(image_width,
+                                                                             image_height,
+                                                                             (VkFormat)format,
+                                                                             (VkImageTiling)image_tiling,
+                                                                             (VkImageUsageFlags)image_usage_flags,
+                                                                             (VkImageCreateFlags)image_create_flags,
+                                                                             array_layers,
+                                                                             miplevels);
+
+        // a throwaway image, its memory requirements are what the aliasing memory has to satisfy
+        VkImage vk_image;
+        if (vkCreateImage(m_device, &image_create_info, nullptr, &vk_image) != VK_SUCCESS)
+        {
+            LOG_ERROR("failed to create image for memory requirements!");
+            requirements = {};
+            return;
+        }
+
+        VkMemoryRequirements vk_requirements;
+        vkGetImageMemoryRequirements(m_device, vk_image, &vk_requirements);
+        vkDestroyImage(m_device, vk_image, nullptr);
+
+        requirements.size           = vk_requirements.size;
+        requirements.alignment      = vk_requirements.alignment;
+        requirements.memoryTypeBits = vk_requirements.memoryTypeBits;
+    }
+
+    bool VulkanRHI::allocateAliasingMemory(const RHIMemoryRequirements& requirements, RHIMemoryPropertyFlags memory_property_flags, RHIDeviceMemory* &memory)
+    {
+        VkMemoryRequirements vk_requirements;
+        vk_requirements.size           = requirements.size;
+        vk_requirements.alignment      = requirements.alignment;
+        vk_requirements.memoryTypeBits = requirements.memoryTypeBits;
+
+        VmaAllocationCreateInfo allocation_create_info =
+            VulkanUtil::getAllocationCreateInfo((VkMemoryPropertyFlags)memory_property_flags, true);
+
+        VmaAllocation vma_allocation;
+        if (vmaAllocateMemory(m_assets_allocator, &vk_requirements, &allocation_create_info, &vma_allocation, nullptr) !=
+            VK_SUCCESS)
+        {
+            LOG_ERROR("failed to allocate aliasing memory!");
+            return false;
+        }
+
+        memory = new VulkanDeviceMemory();
+        ((VulkanDeviceMemory*)memory)->setResource(vma_allocation);
+        return true;
+    }
+
+    bool VulkanRHI::createAliasingImage(RHIDeviceMemory* memory, uint32_t image_width, uint32_t image_height, RHIFormat format, RHIImageTiling image_tiling, RHIImageUsageFlags image_usage_flags,
+        RHIImageCreateFlags image_create_flags, uint32_t array_layers, uint32_t miplevels, RHIImage* &image)
+    {
+        VkImageCreateInfo image_create_info = VulkanUtil::getImageCreateInfo(image_width,
+                                                                             image_height,
+                                                                             (VkFormat)format,
+                                                                             (VkImageTiling)image_tiling,
+                                                                             (VkImageUsageFlags)image_usage_flags,
+                                                                             (VkImageCreateFlags)image_create_flags,
+                                                                             array_layers,
+                                                                             miplevels);
+
+        VkImage vk_image;
+        if (vmaCreateAliasingImage(m_assets_allocator,
+                                   ((VulkanDeviceMemory*)memory)->getResource(),
+                                   &image_create_info,
+                                   &vk_image) != VK_SUCCESS)
+        {
+            LOG_ERROR("failed to create aliasing image!");
+            return false;
+        }
+
+        image = new VulkanImage();
+        ((VulkanImage*)image)->setResource(vk_image);
+        return true;
+    }
+
     void VulkanRHI::createGlobalImage(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, void* texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels)
     {
         VkImage vk_image;
@@ -2977,6 +3355,129 @@ namespace Piccolo
         allocatorCreateInfo.pVulkanFunctions       = &vulkanFunctions;
 
         vmaCreateAllocator(&allocatorCreateInfo, &m_assets_allocator);
+
+        // mesh buffers get blocks of their own so that they can be compacted without touching anything else
+        constexpr VkDeviceSize mesh_buffer_pool_block_size = 64 * 1024 * 1024;
+
+        VkBufferCreateInfo mesh_buffer_create_info {};
+        mesh_buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        mesh_buffer_create_info.size  = 1024;
+        mesh_buffer_create_info.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                                        VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+        VmaAllocationCreateInfo mesh_allocation_create_info {};
+        mesh_allocation_create_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+        VmaPoolCreateInfo mesh_pool_create_info {};
+        mesh_pool_create_info.blockSize = mesh_buffer_pool_block_size;
+        if (vmaFindMemoryTypeIndexForBufferInfo(m_assets_allocator,
+                                                &mesh_buffer_create_info,
+                                                &mesh_allocation_create_info,
+                                                &mesh_pool_create_info.memoryTypeIndex) != VK_SUCCESS ||
+            vmaCreatePool(m_assets_allocator, &mesh_pool_create_info, &m_mesh_buffer_pool) != VK_SUCCESS)
+        {
+            LOG_ERROR("create mesh buffer pool failed, mesh buffers use the default pools");
+            m_mesh_buffer_pool = VK_NULL_HANDLE;
+        }
+    }
+
+    void VulkanRHI::createPipelineCache()
+    {
+        std::vector<char> initial_data;
+
+        std::ifstream cache_file(m_pipeline_cache_path, std::ios::binary);
+        if (cache_file)
+        {
+            const PipelineCacheFileHeader expected_header = makePipelineCacheFileHeader(m_physical_device);
+
+            PipelineCacheFileHeader header;
+            cache_file.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (!cache_file || header.magic != expected_header.magic || header.version != expected_header.version)
+            {
+                LOG_WARN("pipeline cache {} is not a pipeline cache, ignored", m_pipeline_cache_path.generic_string());
+            }
+            else if (header.vendor_id != expected_header.vendor_id || header.device_id != expected_header.device_id ||
+                     header.driver_version != expected_header.driver_version ||
+                     memcmp(header.pipeline_cache_uuid, expected_header.pipeline_cache_uuid, VK_UUID_SIZE) != 0)
+            {
+                LOG_INFO("pipeline cache was written by another device or driver, rebuilding it");
+            }
+            else
+            {
+                initial_data.resize(static_cast<size_t>(header.data_size));
+                cache_file.read(initial_data.data(), initial_data.size());
+                if (!cache_file)
+                {
+                    LOG_WARN("pipeline cache {} is truncated, ignored", m_pipeline_cache_path.generic_string());
+                    initial_data.clear();
+                }
+            }
+        }
+
+        VkPipelineCacheCreateInfo pipeline_cache_create_info {};
+        pipeline_cache_create_info.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        pipeline_cache_create_info.initialDataSize = initial_data.size();
+        pipeline_cache_create_info.pInitialData    = initial_data.data();
+
+        if (vkCreatePipelineCache(m_device, &pipeline_cache_create_info, nullptr, &m_pipeline_cache) != VK_SUCCESS)
+        {
+            // a cache the driver rejects must not cost us the cache for this run
+            pipeline_cache_create_info.initialDataSize = 0;
+            pipeline_cache_create_info.pInitialData    = nullptr;
+            if (vkCreatePipelineCache(m_device, &pipeline_cache_create_info, nullptr, &m_pipeline_cache) != VK_SUCCESS)
+            {
+                LOG_ERROR("vkCreatePipelineCache failed!");
+                m_pipeline_cache = VK_NULL_HANDLE;
+            }
+        }
+
+        LOG_INFO("pipeline cache: {} bytes loaded", initial_data.size());
+    }
+
+    void VulkanRHI::savePipelineCache()
+    {
+        if (m_pipeline_cache == VK_NULL_HANDLE || m_pipeline_cache_path.empty())
+        {
+            return;
+        }
+
+        size_t data_size = 0;
+        if (vkGetPipelineCacheData(m_device, m_pipeline_cache, &data_size, nullptr) != VK_SUCCESS)
+        {
+            LOG_ERROR("vkGetPipelineCacheData failed!");
+            return;
+        }
+        std::vector<char> data(data_size);
+        if (vkGetPipelineCacheData(m_device, m_pipeline_cache, &data_size, data.data()) != VK_SUCCESS)
+        {
+            LOG_ERROR("vkGetPipelineCacheData failed!");
+            return;
+        }
+
+        PipelineCacheFileHeader header = makePipelineCacheFileHeader(m_physical_device);
+        header.data_size               = data_size;
+
+        // written next to the cache and renamed, a crash while writing leaves the old cache intact
+        std::filesystem::path temporary_path = m_pipeline_cache_path;
+        temporary_path += ".tmp";
+        {
+            std::ofstream cache_file(temporary_path, std::ios::binary | std::ios::trunc);
+            cache_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            cache_file.write(data.data(), data_size);
+            if (!cache_file)
+            {
+                LOG_ERROR("failed to write pipeline cache {}", temporary_path.generic_string());
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary_path, m_pipeline_cache_path, error);
+        if (error)
+        {
+            LOG_ERROR("failed to replace pipeline cache {}: {}", m_pipeline_cache_path.generic_string(), error.message());
+        }
     }
 
     // todo : more descriptorSet
@@ -3208,6 +3709,27 @@ namespace Piccolo
         RHI_DELETE_PTR(buffer);
     }
 
+    void VulkanRHI::destroyBufferVMA(VmaAllocator allocator, RHIBuffer* &buffer, VmaAllocation allocation)
+    {
+        m_relocatable_buffers.erase(allocation);
+        vmaDestroyBuffer(allocator, ((VulkanBuffer*)buffer)->getResource(), allocation);
+        RHI_DELETE_PTR(buffer);
+    }
+
+    void VulkanRHI::destroyImageVMA(VmaAllocator allocator, RHIImage* &image, VmaAllocation allocation)
+    {
+        vmaDestroyImage(allocator, ((VulkanImage*)image)->getResource(), allocation);
+        RHI_DELETE_PTR(image);
+    }
+
+    void VulkanRHI::freeDescriptorSet(RHIDescriptorPool* descriptor_pool, RHIDescriptorSet* &descriptor_set)
+    {
+        VkDescriptorSet vk_descriptor_set = ((VulkanDescriptorSet*)descriptor_set)->getResource();
+        vkFreeDescriptorSets(
+            m_device, ((VulkanDescriptorPool*)descriptor_pool)->getResource(), 1, &vk_descriptor_set);
+        RHI_DELETE_PTR(descriptor_set);
+    }
+
     void VulkanRHI::freeCommandBuffers(RHICommandPool* commandPool, uint32_t commandBufferCount, RHICommandBuffer* pCommandBuffers)
     {
         VkCommandBuffer vk_command_buffer = ((VulkanCommandBuffer*)pCommandBuffers)->getResource();
@@ -3216,48 +3738,53 @@ namespace Piccolo
 
     void VulkanRHI::freeMemory(RHIDeviceMemory* &memory)
     {
-        vkFreeMemory(m_device, ((VulkanDeviceMemory*)memory)->getResource(), nullptr);
+        VulkanDeviceMemory* vulkan_memory = (VulkanDeviceMemory*)memory;
+        for (; vulkan_memory->m_map_count > 0; --vulkan_memory->m_map_count)
+        {
+            vmaUnmapMemory(m_assets_allocator, vulkan_memory->getResource());
+        }
+        vmaFreeMemory(m_assets_allocator, vulkan_memory->getResource());
         RHI_DELETE_PTR(memory);
     }
 
     bool VulkanRHI::mapMemory(RHIDeviceMemory* memory, RHIDeviceSize offset, RHIDeviceSize size, RHIMemoryMapFlags flags, void** ppData)
     {
-        VkResult result = vkMapMemory(m_device, ((VulkanDeviceMemory*)memory)->getResource(), offset, size, (VkMemoryMapFlags)flags, ppData);
+        // vma maps the whole allocation, the offset is relative to its start
+        VulkanDeviceMemory* vulkan_memory = (VulkanDeviceMemory*)memory;
+        void*               data          = nullptr;
+        VkResult result = vmaMapMemory(m_assets_allocator, vulkan_memory->getResource(), &data);
 
         if (result == VK_SUCCESS)
         {
+            ++vulkan_memory->m_map_count;
+            *ppData = static_cast<uint8_t*>(data) + offset;
             return true;
         }
         else
         {
-            LOG_ERROR("vkMapMemory failed!");
+            LOG_ERROR("vmaMapMemory failed!");
             return false;
         }
     }
 
     void VulkanRHI::unmapMemory(RHIDeviceMemory* memory)
     {
-        vkUnmapMemory(m_device, ((VulkanDeviceMemory*)memory)->getResource());
+        VulkanDeviceMemory* vulkan_memory = (VulkanDeviceMemory*)memory;
+        if (vulkan_memory->m_map_count > 0)
+        {
+            --vulkan_memory->m_map_count;
+            vmaUnmapMemory(m_assets_allocator, vulkan_memory->getResource());
+        }
     }
 
     void VulkanRHI::invalidateMappedMemoryRanges(void* pNext, RHIDeviceMemory* memory, RHIDeviceSize offset, RHIDeviceSize size)
     {
-        VkMappedMemoryRange mappedRange{};
-        mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mappedRange.memory = ((VulkanDeviceMemory*)memory)->getResource();
-        mappedRange.offset = offset;
-        mappedRange.size = size;
-        vkInvalidateMappedMemoryRanges(m_device, 1, &mappedRange);
+        vmaInvalidateAllocation(m_assets_allocator, ((VulkanDeviceMemory*)memory)->getResource(), offset, size);
     }
 
     void VulkanRHI::flushMappedMemoryRanges(void* pNext, RHIDeviceMemory* memory, RHIDeviceSize offset, RHIDeviceSize size)
     {
-        VkMappedMemoryRange mappedRange{};
-        mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mappedRange.memory = ((VulkanDeviceMemory*)memory)->getResource();
-        mappedRange.offset = offset;
-        mappedRange.size = size;
-        vkFlushMappedMemoryRanges(m_device, 1, &mappedRange);
+        vmaFlushAllocation(m_assets_allocator, ((VulkanDeviceMemory*)memory)->getResource(), offset, size);
     }
 
     RHISemaphore* &VulkanRHI::getTextureCopySemaphore(uint32_t index)
@@ -3285,8 +3812,7 @@ namespace Piccolo
         }
 
         destroyImageView(m_depth_image_view);
-        vkDestroyImage(m_device, ((VulkanImage*)m_depth_image)->getResource(), NULL);
-        vkFreeMemory(m_device, m_depth_image_memory, NULL);
+        vmaDestroyImage(m_assets_allocator, ((VulkanImage*)m_depth_image)->getResource(), m_depth_image_allocation);
 
         for (auto imageview : m_swapchain_imageviews)
         {
@@ -3366,6 +3892,18 @@ namespace Piccolo
             }
             i++;
         }
+
+        // a transfer only family is usually backed by a dma engine, copies there run beside rendering
+        for (uint32_t family_index = 0; family_index < queue_family_count; ++family_index)
+        {
+            const VkQueueFlags queue_flags = queue_families[family_index].queueFlags;
+            if ((queue_flags & VK_QUEUE_TRANSFER_BIT) && !(queue_flags & VK_QUEUE_GRAPHICS_BIT) &&
+                !(queue_flags & VK_QUEUE_COMPUTE_BIT))
+            {
+                indices.m_transfer_family = family_index;
+                break;
+            }
+        }
         return indices;
     }
 
@@ -3544,6 +4082,87 @@ namespace Piccolo
     }
     bool VulkanRHI::isPointLightShadowEnabled(){ return m_enable_point_light_shadow; }
 
+    uint32_t VulkanRHI::getMaxRecordingThreadCount() const { return k_max_recording_threads; }
+
+    RHICommandBuffer* VulkanRHI::beginSecondaryCommandBuffer(uint32_t        thread_index,
+                                                             RHIRenderPass*  render_pass,
+                                                             uint32_t        subpass,
+                                                             RHIFramebuffer* framebuffer)
+    {
+        ASSERT(thread_index < k_max_recording_threads);
+
+        // only the calling thread touches this pool until the frame is submitted
+        SecondaryCommandPool& secondary_command_pool = m_secondary_command_pools[m_current_frame_index][thread_index];
+        if (secondary_command_pool.used_count == secondary_command_pool.command_buffers.size())
+        {
+            VkCommandBufferAllocateInfo command_buffer_allocate_info {};
+            command_buffer_allocate_info.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            command_buffer_allocate_info.commandPool        = secondary_command_pool.command_pool;
+            command_buffer_allocate_info.level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            command_buffer_allocate_info.commandBufferCount = 1U;
+
+            VkCommandBuffer vk_command_buffer;
+            if (vkAllocateCommandBuffers(m_device, &command_buffer_allocate_info, &vk_command_buffer) != VK_SUCCESS)
+            {
+                LOG_ERROR("vk allocate secondary command buffers");
+                return nullptr;
+            }
+
+            VulkanCommandBuffer* command_buffer = new VulkanCommandBuffer();
+            command_buffer->setResource(vk_command_buffer);
+            secondary_command_pool.command_buffers.push_back(command_buffer);
+        }
+
+        VulkanCommandBuffer* command_buffer = secondary_command_pool.command_buffers[secondary_command_pool.used_count++];
+
+        VkCommandBufferInheritanceInfo inheritance_info {};
+        inheritance_info.sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance_info.renderPass  = ((VulkanRenderPass*)render_pass)->getResource();
+        inheritance_info.subpass     = subpass;
+        inheritance_info.framebuffer = ((VulkanFramebuffer*)framebuffer)->getResource();
+
+        VkCommandBufferBeginInfo command_buffer_begin_info {};
+        command_buffer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        command_buffer_begin_info.flags =
+            VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        command_buffer_begin_info.pInheritanceInfo = &inheritance_info;
+
+        if (VK_SUCCESS != _vkBeginCommandBuffer(command_buffer->getResource(), &command_buffer_begin_info))
+        {
+            LOG_ERROR("_vkBeginCommandBuffer failed for secondary command buffer");
+        }
+
+        return command_buffer;
+    }
+
+    void VulkanRHI::endSecondaryCommandBuffer(RHICommandBuffer* command_buffer)
+    {
+        if (VK_SUCCESS != _vkEndCommandBuffer(((VulkanCommandBuffer*)command_buffer)->getResource()))
+        {
+            LOG_ERROR("_vkEndCommandBuffer failed for secondary command buffer");
+        }
+    }
+
+    void VulkanRHI::cmdExecuteCommandsPFN(RHICommandBuffer*        command_buffer,
+                                          uint32_t                 command_buffer_count,
+                                          RHICommandBuffer* const* secondary_command_buffers)
+    {
+        if (command_buffer_count == 0)
+        {
+            return;
+        }
+
+        std::vector<VkCommandBuffer> vk_command_buffers(command_buffer_count);
+        for (uint32_t i = 0; i < command_buffer_count; ++i)
+        {
+            vk_command_buffers[i] = ((VulkanCommandBuffer*)secondary_command_buffers[i])->getResource();
+        }
+
+        _vkCmdExecuteCommands(((VulkanCommandBuffer*)command_buffer)->getResource(),
+                              command_buffer_count,
+                              vk_command_buffers.data());
+    }
+
     RHICommandBuffer* VulkanRHI::getCurrentCommandBuffer() const
     {
         return m_current_command_buffer;
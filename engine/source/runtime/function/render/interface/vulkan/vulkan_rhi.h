@@ -2,12 +2,15 @@
 
 #include "runtime/function/render/interface/rhi.h"
 #include "runtime/function/render/interface/vulkan/vulkan_rhi_resource.h"
+#include "runtime/function/render/interface/vulkan/vulkan_upload_manager.h"
 
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan.h>
 
+#include <deque>
 #include <functional>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 namespace Piccolo
@@ -52,6 +55,11 @@ namespace Piccolo
             RHIImage* &image, RHIDeviceMemory* &memory, RHIImageCreateFlags image_create_flags, uint32_t array_layers, uint32_t miplevels) override;
         void createImageView(RHIImage* image, RHIFormat format, RHIImageAspectFlags image_aspect_flags, RHIImageViewType view_type, uint32_t layout_count, uint32_t miplevels,
             RHIImageView* &image_view) override;
+        void getImageMemoryRequirements(uint32_t image_width, uint32_t image_height, RHIFormat format, RHIImageTiling image_tiling, RHIImageUsageFlags image_usage_flags,
+            RHIImageCreateFlags image_create_flags, uint32_t array_layers, uint32_t miplevels, RHIMemoryRequirements& requirements) override;
+        bool allocateAliasingMemory(const RHIMemoryRequirements& requirements, RHIMemoryPropertyFlags memory_property_flags, RHIDeviceMemory* &memory) override;
+        bool createAliasingImage(RHIDeviceMemory* memory, uint32_t image_width, uint32_t image_height, RHIFormat format, RHIImageTiling image_tiling, RHIImageUsageFlags image_usage_flags,
+            RHIImageCreateFlags image_create_flags, uint32_t array_layers, uint32_t miplevels, RHIImage* &image) override;
         void createGlobalImage(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, void* texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels = 0) override;
         void createCubeMap(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, std::array<void*, 6> texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels) override;
         bool createCommandPool(const RHICommandPoolCreateInfo* pCreateInfo, RHICommandPool* &pCommandPool) override;
@@ -137,6 +145,29 @@ namespace Piccolo
         void pushEvent(RHICommandBuffer* commond_buffer, const char* name, const float* color) override;
         void popEvent(RHICommandBuffer* commond_buffer) override;
 
+        // secondary command buffers
+        uint32_t          getMaxRecordingThreadCount() const override;
+        RHICommandBuffer* beginSecondaryCommandBuffer(uint32_t thread_index, RHIRenderPass* render_pass, uint32_t subpass, RHIFramebuffer* framebuffer) override;
+        void              endSecondaryCommandBuffer(RHICommandBuffer* command_buffer) override;
+        void              cmdExecuteCommandsPFN(RHICommandBuffer* command_buffer, uint32_t command_buffer_count, RHICommandBuffer* const* secondary_command_buffers) override;
+
+        // upload
+        bool     allocateUploadMemory(RHIDeviceSize size, RHIUploadAllocation& allocation, RHIDeviceSize alignment = 16) override;
+        void     uploadBuffer(const RHIUploadAllocation& allocation, RHIDeviceSize src_offset, RHIBuffer* dst_buffer, RHIDeviceSize dst_offset, RHIDeviceSize size) override;
+        uint64_t getUploadTicket() const override;
+        uint64_t getRetiredUploadTicket() const override;
+        void     flushUploads() override;
+
+        // memory
+        void getMemoryBudgets(std::vector<RHIMemoryHeapBudget>& budgets) const override;
+        void defragmentMemory() override;
+
+        // deferred destruction
+        void deferDestruction(uint64_t upload_ticket, std::function<void()> destroy) override;
+
+        // pipeline cache
+        void savePipelineCache() override;
+
         // destory
         virtual ~VulkanRHI() override final;
         void clear() override;
@@ -154,6 +185,9 @@ namespace Piccolo
         void destroyDevice() override;
         void destroyCommandPool(RHICommandPool* commandPool) override;
         void destroyBuffer(RHIBuffer* &buffer) override;
+        void destroyBufferVMA(VmaAllocator allocator, RHIBuffer* &buffer, VmaAllocation allocation) override;
+        void destroyImageVMA(VmaAllocator allocator, RHIImage* &image, VmaAllocation allocation) override;
+        void freeDescriptorSet(RHIDescriptorPool* descriptor_pool, RHIDescriptorSet* &descriptor_set) override;
         void freeCommandBuffers(RHICommandPool* commandPool, uint32_t commandBufferCount, RHICommandBuffer* pCommandBuffers) override;
 
         // memory
@@ -167,6 +201,8 @@ namespace Piccolo
         RHISemaphore* &getTextureCopySemaphore(uint32_t index) override;
     public:
         static uint8_t const k_max_frames_in_flight {3};
+        // threads which may record secondary command buffers at the same time
+        static uint8_t const k_max_recording_threads {8};
 
         
         RHIQueue* m_graphics_queue{ nullptr };
@@ -198,17 +234,27 @@ namespace Piccolo
         VkPhysicalDevice   m_physical_device {nullptr};
         VkDevice           m_device {nullptr};
         VkQueue            m_present_queue {nullptr};
+        VkQueue            m_transfer_queue {nullptr};
 
         VkSwapchainKHR           m_swapchain {nullptr};
         std::vector<VkImage>     m_swapchain_images;
 
         RHIImage*        m_depth_image = new VulkanImage();
-        VkDeviceMemory m_depth_image_memory {nullptr};
+        VmaAllocation    m_depth_image_allocation {nullptr};
 
         std::vector<VkFramebuffer> m_swapchain_framebuffers;
 
         // asset allocator use VMA library
         VmaAllocator m_assets_allocator;
+        // device local blocks shared by mesh vertex, index and joint binding buffers
+        VmaPool m_mesh_buffer_pool {VK_NULL_HANDLE};
+
+        // shared by all pipelines, loaded from and written back to m_pipeline_cache_path
+        VkPipelineCache       m_pipeline_cache {VK_NULL_HANDLE};
+        std::filesystem::path m_pipeline_cache_path;
+
+        // staging ring and batched copies for asset uploads
+        VulkanUploadManager m_upload_manager;
 
         // function pointers
         PFN_vkCmdBeginDebugUtilsLabelEXT _vkCmdBeginDebugUtilsLabelEXT;
@@ -229,6 +275,7 @@ namespace Piccolo
         PFN_vkCmdBindDescriptorSets _vkCmdBindDescriptorSets;
         PFN_vkCmdDrawIndexed        _vkCmdDrawIndexed;
         PFN_vkCmdClearAttachments   _vkCmdClearAttachments;
+        PFN_vkCmdExecuteCommands    _vkCmdExecuteCommands;
 
         // global descriptor pool
         VkDescriptorPool m_vk_descriptor_pool;
@@ -258,6 +305,38 @@ namespace Piccolo
         RHISampler* m_nearest_sampler = nullptr;
         std::map<uint32_t, RHISampler*> m_mipmap_sampler_map;
 
+        // buffers the defragmentation may move, only those no descriptor set refers to
+        struct RelocatableBuffer
+        {
+            VulkanBuffer*      buffer {nullptr};
+            VkBufferCreateInfo create_info {};
+        };
+        std::unordered_map<VmaAllocation, RelocatableBuffer> m_relocatable_buffers;
+
+        // every recording thread owns a pool per frame, the pool is reset with the frame and its buffers are reused
+        struct SecondaryCommandPool
+        {
+            VkCommandPool                     command_pool {VK_NULL_HANDLE};
+            std::vector<VulkanCommandBuffer*> command_buffers;
+            uint32_t                          used_count {0};
+        };
+        SecondaryCommandPool m_secondary_command_pools[k_max_frames_in_flight][k_max_recording_threads];
+
+        // resources waiting for the frames in flight and the pending uploads which may still use them
+        struct DeferredDestruction
+        {
+            uint64_t              frame_count {0};
+            uint64_t              upload_ticket {0};
+            std::function<void()> destroy;
+        };
+        std::deque<DeferredDestruction> m_deferred_destructions;
+
+        // frames submitted so far, and how many of them are known to have retired. a fence covers the frame last
+        // submitted with its index, and fences are waited in submission order
+        uint64_t m_submitted_frame_count {0};
+        uint64_t m_retired_frame_count {0};
+        uint64_t m_frame_counts_in_flight[k_max_frames_in_flight] {};
+
     private:
         void createInstance();
         void initializeDebugMessenger();
@@ -269,6 +348,9 @@ namespace Piccolo
         void createDescriptorPool();
         void createSyncPrimitives();
         void createAssetAllocator();
+        void createPipelineCache();
+        // run the deferred destructions whose frame and upload retired, every one of them once the device is idle
+        void destroyRetiredResources(bool is_device_idle);
 
     public:
         bool isPointLightShadowEnabled() override;
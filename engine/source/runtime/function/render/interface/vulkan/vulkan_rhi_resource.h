@@ -2,6 +2,7 @@
 
 #include "runtime/function/render/interface/rhi.h"
 
+#include <vk_mem_alloc.h>
 #include <vulkan/vulkan.h>
 #include <optional>
 
@@ -119,19 +120,22 @@ namespace Piccolo
     private:
         VkDevice m_resource;
     };
+    // device memory is a range of a vma block, mapping goes through the allocator
     class VulkanDeviceMemory : public RHIDeviceMemory
     {
     public:
-        void setResource(VkDeviceMemory res)
+        void setResource(VmaAllocation res)
         {
             m_resource = res;
         }
-        VkDeviceMemory getResource() const
+        VmaAllocation getResource() const
         {
             return m_resource;
         }
+        // vkFreeMemory unmapped implicitly, vma wants every map paired with an unmap
+        uint32_t m_map_count {0};
     private:
-        VkDeviceMemory m_resource;
+        VmaAllocation m_resource;
     };
     class VulkanEvent : public RHIEvent
     {
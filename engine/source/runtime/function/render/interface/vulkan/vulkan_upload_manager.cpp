@@ -0,0 +1,477 @@
+#include "runtime/function/render/interface/vulkan/vulkan_upload_manager.h"
+#include "runtime/function/render/interface/vulkan/vulkan_rhi.h"
+#include "runtime/function/render/interface/vulkan/vulkan_util.h"
+
+#include "runtime/core/base/macro.h"
+
+namespace Piccolo
+{
+    namespace
+    {
+        VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+        {
+            // texel sizes of three channel formats are no powers of two
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    } // namespace
+
+    void VulkanUploadManager::initialize(VulkanRHI* rhi)
+    {
+        m_rhi = rhi;
+
+        m_graphics_family = rhi->m_queue_indices.graphics_family.value();
+        m_transfer_family = rhi->m_queue_indices.m_transfer_family.value_or(m_graphics_family);
+        m_graphics_queue  = ((VulkanQueue*)rhi->m_graphics_queue)->getResource();
+        m_transfer_queue  = rhi->m_transfer_queue;
+
+        m_has_dedicated_transfer_queue = m_transfer_family != m_graphics_family && m_transfer_queue != VK_NULL_HANDLE;
+
+        VkCommandPoolCreateInfo command_pool_create_info {};
+        command_pool_create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        command_pool_create_info.flags =
+            VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+        command_pool_create_info.queueFamilyIndex = m_graphics_family;
+        if (vkCreateCommandPool(rhi->m_device, &command_pool_create_info, nullptr, &m_graphics_command_pool) !=
+            VK_SUCCESS)
+        {
+            LOG_ERROR("vk create upload command pool");
+        }
+
+        if (m_has_dedicated_transfer_queue)
+        {
+            command_pool_create_info.queueFamilyIndex = m_transfer_family;
+            if (vkCreateCommandPool(rhi->m_device, &command_pool_create_info, nullptr, &m_transfer_command_pool) !=
+                VK_SUCCESS)
+            {
+                LOG_ERROR("vk create upload command pool");
+            }
+        }
+
+        VkCommandBufferAllocateInfo command_buffer_allocate_info {};
+        command_buffer_allocate_info.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        command_buffer_allocate_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        command_buffer_allocate_info.commandBufferCount = 1;
+
+        VkSemaphoreCreateInfo semaphore_create_info {};
+        semaphore_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        VkFenceCreateInfo fence_create_info {};
+        fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        for (UploadBatch& batch : m_batches)
+        {
+            command_buffer_allocate_info.commandPool = m_graphics_command_pool;
+            vkAllocateCommandBuffers(rhi->m_device, &command_buffer_allocate_info, &batch.m_graphics_command_buffer);
+
+            if (m_has_dedicated_transfer_queue)
+            {
+                command_buffer_allocate_info.commandPool = m_transfer_command_pool;
+                vkAllocateCommandBuffers(
+                    rhi->m_device, &command_buffer_allocate_info, &batch.m_transfer_command_buffer);
+                vkCreateSemaphore(rhi->m_device, &semaphore_create_info, nullptr, &batch.m_transfer_finished_semaphore);
+            }
+
+            if (vkCreateFence(rhi->m_device, &fence_create_info, nullptr, &batch.m_fence) != VK_SUCCESS)
+            {
+                LOG_ERROR("vk create upload fence");
+            }
+        }
+
+        VulkanUtil::createBuffer(rhi->m_assets_allocator,
+                                 k_staging_ring_size,
+                                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                 m_staging_ring_buffer,
+                                 m_staging_ring_allocation);
+        vmaMapMemory(rhi->m_assets_allocator, m_staging_ring_allocation, reinterpret_cast<void**>(&m_staging_ring_data));
+        m_staging_ring_rhi_buffer.setResource(m_staging_ring_buffer);
+
+        LOG_INFO("upload manager: {} MB staging ring, buffer copies on the {} queue",
+                 k_staging_ring_size / (1024 * 1024),
+                 m_has_dedicated_transfer_queue ? "transfer" : "graphics");
+    }
+
+    void VulkanUploadManager::clear()
+    {
+        if (m_rhi == nullptr)
+            return;
+
+        wait(m_recording_ticket);
+
+        VkDevice device = m_rhi->m_device;
+        for (UploadBatch& batch : m_batches)
+        {
+            vkDestroyFence(device, batch.m_fence, nullptr);
+            if (batch.m_transfer_finished_semaphore != VK_NULL_HANDLE)
+            {
+                vkDestroySemaphore(device, batch.m_transfer_finished_semaphore, nullptr);
+            }
+        }
+
+        vkDestroyCommandPool(device, m_graphics_command_pool, nullptr);
+        if (m_transfer_command_pool != VK_NULL_HANDLE)
+        {
+            vkDestroyCommandPool(device, m_transfer_command_pool, nullptr);
+        }
+
+        vmaUnmapMemory(m_rhi->m_assets_allocator, m_staging_ring_allocation);
+        vmaDestroyBuffer(m_rhi->m_assets_allocator, m_staging_ring_buffer, m_staging_ring_allocation);
+
+        m_rhi = nullptr;
+    }
+
+    bool VulkanUploadManager::allocate(VkDeviceSize size, VkDeviceSize alignment, RHIUploadAllocation& allocation)
+    {
+        if (size == 0)
+        {
+            LOG_ERROR("empty upload");
+            return false;
+        }
+
+        VkDeviceSize offset = 0;
+        while (!tryAllocateFromRing(size, alignment, offset))
+        {
+            // the ring is full, recycle the space of the oldest batch, the recording one is submitted first
+            if (getRecordingBatch().m_ring_used > 0)
+            {
+                submit();
+            }
+
+            if (m_in_flight_batch_count == 0)
+            {
+                // nothing left to wait for, the upload does not fit into the whole ring
+                allocateDedicated(size, allocation);
+                return true;
+            }
+
+            waitOldestBatch();
+        }
+
+        allocation.buffer      = &m_staging_ring_rhi_buffer;
+        allocation.offset      = offset;
+        allocation.size        = size;
+        allocation.mapped_data = m_staging_ring_data + offset;
+        return true;
+    }
+
+    bool VulkanUploadManager::tryAllocateFromRing(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset)
+    {
+        if (size > k_staging_ring_size)
+            return false;
+
+        if (m_ring_used == 0)
+        {
+            m_ring_head = 0;
+            m_ring_tail = 0;
+        }
+        else if (m_ring_head == m_ring_tail)
+        {
+            return false; // full
+        }
+
+        VkDeviceSize consumed_size = 0;
+        offset                     = alignUp(m_ring_head, alignment);
+        if (m_ring_head >= m_ring_tail)
+        {
+            // free space is [head, end) and [0, tail)
+            if (offset + size <= k_staging_ring_size)
+            {
+                consumed_size = offset + size - m_ring_head;
+            }
+            else if (size <= m_ring_tail)
+            {
+                offset        = 0;
+                consumed_size = k_staging_ring_size - m_ring_head + size;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else
+        {
+            // free space is [head, tail)
+            if (offset + size > m_ring_tail)
+                return false;
+            consumed_size = offset + size - m_ring_head;
+        }
+
+        m_ring_head = (offset + size) % k_staging_ring_size;
+        m_ring_used += consumed_size;
+        getRecordingBatch().m_ring_used += consumed_size;
+        return true;
+    }
+
+    void VulkanUploadManager::allocateDedicated(VkDeviceSize size, RHIUploadAllocation& allocation)
+    {
+        VkBuffer      vk_buffer;
+        VmaAllocation vma_allocation;
+        VulkanUtil::createBuffer(m_rhi->m_assets_allocator,
+                                 size,
+                                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                 vk_buffer,
+                                 vma_allocation);
+
+        VulkanBuffer* rhi_buffer = new VulkanBuffer();
+        rhi_buffer->setResource(vk_buffer);
+        getRecordingBatch().m_dedicated_staging_buffers.emplace_back(rhi_buffer, vma_allocation);
+
+        allocation.buffer = rhi_buffer;
+        allocation.offset = 0;
+        allocation.size   = size;
+        vmaMapMemory(m_rhi->m_assets_allocator, vma_allocation, &allocation.mapped_data);
+    }
+
+    void VulkanUploadManager::recordBufferCopy(const RHIUploadAllocation& allocation,
+                                               VkDeviceSize               src_offset,
+                                               VkBuffer                   dst_buffer,
+                                               VkDeviceSize               dst_offset,
+                                               VkDeviceSize               size)
+    {
+        VkBufferCopy copy_region {allocation.offset + src_offset, dst_offset, size};
+
+        if (!m_has_dedicated_transfer_queue)
+        {
+            vkCmdCopyBuffer(getGraphicsCommandBuffer(),
+                            ((VulkanBuffer*)allocation.buffer)->getResource(),
+                            dst_buffer,
+                            1,
+                            &copy_region);
+            return;
+        }
+
+        vkCmdCopyBuffer(beginTransferCommandBuffer(),
+                        ((VulkanBuffer*)allocation.buffer)->getResource(),
+                        dst_buffer,
+                        1,
+                        &copy_region);
+
+        // the access masks differ between the release and the acquire half, they are filled in on submit
+        VkBufferMemoryBarrier ownership_barrier {};
+        ownership_barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        ownership_barrier.srcQueueFamilyIndex = m_transfer_family;
+        ownership_barrier.dstQueueFamilyIndex = m_graphics_family;
+        ownership_barrier.buffer              = dst_buffer;
+        ownership_barrier.offset              = dst_offset;
+        ownership_barrier.size                = size;
+        getRecordingBatch().m_ownership_barriers.push_back(ownership_barrier);
+    }
+
+    VkCommandBuffer VulkanUploadManager::getGraphicsCommandBuffer()
+    {
+        UploadBatch& batch = getRecordingBatch();
+        if (!batch.m_is_graphics_recording)
+        {
+            beginCommandBuffer(batch.m_graphics_command_buffer);
+            batch.m_is_graphics_recording = true;
+        }
+        return batch.m_graphics_command_buffer;
+    }
+
+    VkCommandBuffer VulkanUploadManager::beginTransferCommandBuffer()
+    {
+        UploadBatch& batch = getRecordingBatch();
+        if (!batch.m_is_transfer_recording)
+        {
+            beginCommandBuffer(batch.m_transfer_command_buffer);
+            batch.m_is_transfer_recording = true;
+        }
+        return batch.m_transfer_command_buffer;
+    }
+
+    void VulkanUploadManager::beginCommandBuffer(VkCommandBuffer command_buffer)
+    {
+        VkCommandBufferBeginInfo begin_info {};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS)
+        {
+            LOG_ERROR("begin upload command buffer");
+        }
+    }
+
+    void VulkanUploadManager::submit()
+    {
+        UploadBatch& batch = getRecordingBatch();
+        if (!batch.m_is_transfer_recording && !batch.m_is_graphics_recording && batch.m_ring_used == 0)
+            return;
+
+        const VkAccessFlags consumer_access_mask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                                                   VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        const VkPipelineStageFlags consumer_stage_mask =
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+        // the graphics command buffer always runs last, its fence retires the whole batch
+        VkCommandBuffer graphics_command_buffer = getGraphicsCommandBuffer();
+
+        if (batch.m_is_transfer_recording)
+        {
+            for (VkBufferMemoryBarrier& barrier : batch.m_ownership_barriers)
+            {
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = 0;
+            }
+            vkCmdPipelineBarrier(batch.m_transfer_command_buffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                 0,
+                                 0,
+                                 nullptr,
+                                 static_cast<uint32_t>(batch.m_ownership_barriers.size()),
+                                 batch.m_ownership_barriers.data(),
+                                 0,
+                                 nullptr);
+            vkEndCommandBuffer(batch.m_transfer_command_buffer);
+
+            for (VkBufferMemoryBarrier& barrier : batch.m_ownership_barriers)
+            {
+                barrier.srcAccessMask = 0;
+                barrier.dstAccessMask = consumer_access_mask;
+            }
+            vkCmdPipelineBarrier(graphics_command_buffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 consumer_stage_mask,
+                                 0,
+                                 0,
+                                 nullptr,
+                                 static_cast<uint32_t>(batch.m_ownership_barriers.size()),
+                                 batch.m_ownership_barriers.data(),
+                                 0,
+                                 nullptr);
+        }
+
+        // later submissions on the graphics queue see the copies recorded here
+        VkMemoryBarrier memory_barrier {};
+        memory_barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memory_barrier.dstAccessMask = consumer_access_mask;
+        vkCmdPipelineBarrier(graphics_command_buffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             consumer_stage_mask,
+                             0,
+                             1,
+                             &memory_barrier,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr);
+        vkEndCommandBuffer(graphics_command_buffer);
+
+        if (batch.m_is_transfer_recording)
+        {
+            VkSubmitInfo transfer_submit_info {};
+            transfer_submit_info.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            transfer_submit_info.commandBufferCount   = 1;
+            transfer_submit_info.pCommandBuffers      = &batch.m_transfer_command_buffer;
+            transfer_submit_info.signalSemaphoreCount = 1;
+            transfer_submit_info.pSignalSemaphores    = &batch.m_transfer_finished_semaphore;
+            if (vkQueueSubmit(m_transfer_queue, 1, &transfer_submit_info, VK_NULL_HANDLE) != VK_SUCCESS)
+            {
+                LOG_ERROR("submit upload batch to the transfer queue");
+            }
+        }
+
+        const VkPipelineStageFlags wait_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+        VkSubmitInfo graphics_submit_info {};
+        graphics_submit_info.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        graphics_submit_info.commandBufferCount = 1;
+        graphics_submit_info.pCommandBuffers    = &graphics_command_buffer;
+        if (batch.m_is_transfer_recording)
+        {
+            graphics_submit_info.waitSemaphoreCount = 1;
+            graphics_submit_info.pWaitSemaphores    = &batch.m_transfer_finished_semaphore;
+            graphics_submit_info.pWaitDstStageMask  = &wait_stage_mask;
+        }
+        if (vkQueueSubmit(m_graphics_queue, 1, &graphics_submit_info, batch.m_fence) != VK_SUCCESS)
+        {
+            LOG_ERROR("submit upload batch to the graphics queue");
+        }
+
+        batch.m_ticket   = m_recording_ticket;
+        batch.m_ring_end = m_ring_head;
+
+        ++m_recording_ticket;
+        ++m_in_flight_batch_count;
+        m_recording_batch_index = (m_recording_batch_index + 1) % k_batch_count;
+
+        // every slot is in flight, the next batch records into the oldest one
+        if (m_in_flight_batch_count == k_batch_count)
+        {
+            waitOldestBatch();
+        }
+    }
+
+    void VulkanUploadManager::retire()
+    {
+        while (m_in_flight_batch_count > 0)
+        {
+            const uint32_t oldest_batch_index =
+                (m_recording_batch_index + k_batch_count - m_in_flight_batch_count) % k_batch_count;
+            UploadBatch& batch = m_batches[oldest_batch_index];
+            if (vkGetFenceStatus(m_rhi->m_device, batch.m_fence) != VK_SUCCESS)
+                break;
+
+            releaseBatch(batch);
+        }
+    }
+
+    void VulkanUploadManager::wait(uint64_t ticket)
+    {
+        if (ticket >= m_recording_ticket)
+        {
+            submit();
+        }
+
+        while (m_retired_ticket < ticket && m_in_flight_batch_count > 0)
+        {
+            waitOldestBatch();
+        }
+    }
+
+    void VulkanUploadManager::waitOldestBatch()
+    {
+        const uint32_t oldest_batch_index =
+            (m_recording_batch_index + k_batch_count - m_in_flight_batch_count) % k_batch_count;
+        UploadBatch& batch = m_batches[oldest_batch_index];
+        if (vkWaitForFences(m_rhi->m_device, 1, &batch.m_fence, VK_TRUE, UINT64_MAX) != VK_SUCCESS)
+        {
+            LOG_ERROR("wait for upload batch");
+        }
+
+        releaseBatch(batch);
+    }
+
+    void VulkanUploadManager::releaseBatch(UploadBatch& batch)
+    {
+        vkResetFences(m_rhi->m_device, 1, &batch.m_fence);
+
+        // a batch without staging memory did not move the head, its end is stale
+        if (batch.m_ring_used > 0)
+        {
+            m_ring_tail = batch.m_ring_end;
+            m_ring_used -= batch.m_ring_used;
+        }
+
+        for (auto& dedicated_staging_buffer : batch.m_dedicated_staging_buffers)
+        {
+            vmaUnmapMemory(m_rhi->m_assets_allocator, dedicated_staging_buffer.second);
+            vmaDestroyBuffer(
+                m_rhi->m_assets_allocator, dedicated_staging_buffer.first->getResource(), dedicated_staging_buffer.second);
+            delete dedicated_staging_buffer.first;
+        }
+        batch.m_dedicated_staging_buffers.clear();
+        batch.m_ownership_barriers.clear();
+
+        batch.m_is_transfer_recording = false;
+        batch.m_is_graphics_recording = false;
+        batch.m_ring_used             = 0;
+
+        m_retired_ticket = batch.m_ticket;
+        --m_in_flight_batch_count;
+    }
+} // namespace Piccolo
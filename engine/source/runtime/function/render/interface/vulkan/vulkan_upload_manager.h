@@ -0,0 +1,113 @@
+#pragma once
+
+#include "runtime/function/render/interface/rhi.h"
+#include "runtime/function/render/interface/vulkan/vulkan_rhi_resource.h"
+
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Piccolo
+{
+    class VulkanRHI;
+
+    /// records staging copies into batches instead of submitting and waiting once per copy
+    ///
+    /// staging memory comes from a persistently mapped ring buffer, a batch gives its part of the ring back when
+    /// its fence signals. buffer copies go to the dedicated transfer queue if the device has one, image uploads
+    /// need layout transitions and blits for the mip chain and are recorded for the graphics queue. every batch
+    /// gets a ticket, batches retire in submission order, so a ticket is complete once the retired ticket reaches it
+    class VulkanUploadManager
+    {
+    public:
+        void initialize(VulkanRHI* rhi);
+        void clear();
+
+        /// the allocation belongs to the batch that is recording now, its mapped memory must be written right away
+        bool allocate(VkDeviceSize size, VkDeviceSize alignment, RHIUploadAllocation& allocation);
+
+        void recordBufferCopy(const RHIUploadAllocation& allocation,
+                              VkDeviceSize               src_offset,
+                              VkBuffer                   dst_buffer,
+                              VkDeviceSize               dst_offset,
+                              VkDeviceSize               size);
+
+        /// command buffer of the recording batch for uploads which need the graphics queue
+        VkCommandBuffer getGraphicsCommandBuffer();
+
+        /// ticket of the batch that is recording now, it covers every upload recorded so far
+        uint64_t getRecordingTicket() const { return m_recording_ticket; }
+        uint64_t getRetiredTicket() const { return m_retired_ticket; }
+
+        /// submit the recording batch, it is a no-op when nothing was recorded
+        void submit();
+        /// retire the batches whose fence has signaled, never blocks
+        void retire();
+        /// submit if needed and block until the batch with the ticket has retired
+        void wait(uint64_t ticket);
+
+    private:
+        static constexpr uint32_t     k_batch_count {4};
+        static constexpr VkDeviceSize k_staging_ring_size {64 * 1024 * 1024};
+
+        struct UploadBatch
+        {
+            VkCommandBuffer m_transfer_command_buffer {VK_NULL_HANDLE};
+            VkCommandBuffer m_graphics_command_buffer {VK_NULL_HANDLE};
+            VkSemaphore     m_transfer_finished_semaphore {VK_NULL_HANDLE};
+            VkFence         m_fence {VK_NULL_HANDLE};
+
+            bool m_is_transfer_recording {false};
+            bool m_is_graphics_recording {false};
+
+            uint64_t     m_ticket {0};
+            VkDeviceSize m_ring_end {0};
+            VkDeviceSize m_ring_used {0};
+
+            // buffers copied on the transfer queue change owner to the graphics queue family
+            std::vector<VkBufferMemoryBarrier> m_ownership_barriers;
+            // uploads larger than the whole ring get their own staging buffer
+            std::vector<std::pair<VulkanBuffer*, VmaAllocation>> m_dedicated_staging_buffers;
+        };
+
+        bool tryAllocateFromRing(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+        void allocateDedicated(VkDeviceSize size, RHIUploadAllocation& allocation);
+
+        VkCommandBuffer beginTransferCommandBuffer();
+        void            beginCommandBuffer(VkCommandBuffer command_buffer);
+        void            waitOldestBatch();
+        void            releaseBatch(UploadBatch& batch);
+
+        UploadBatch& getRecordingBatch() { return m_batches[m_recording_batch_index]; }
+
+        VulkanRHI* m_rhi {nullptr};
+
+        bool     m_has_dedicated_transfer_queue {false};
+        uint32_t m_transfer_family {0};
+        uint32_t m_graphics_family {0};
+        VkQueue  m_transfer_queue {VK_NULL_HANDLE};
+        VkQueue  m_graphics_queue {VK_NULL_HANDLE};
+
+        VkCommandPool m_transfer_command_pool {VK_NULL_HANDLE};
+        VkCommandPool m_graphics_command_pool {VK_NULL_HANDLE};
+
+        std::array<UploadBatch, k_batch_count> m_batches;
+        uint32_t                               m_recording_batch_index {0};
+        uint32_t                               m_in_flight_batch_count {0};
+        uint64_t                               m_recording_ticket {1};
+        uint64_t                               m_retired_ticket {0};
+
+        // staging ring, the used bytes tell a full ring from an empty one when head and tail meet
+        VkBuffer       m_staging_ring_buffer {VK_NULL_HANDLE};
+        VmaAllocation  m_staging_ring_allocation {VK_NULL_HANDLE};
+        uint8_t*       m_staging_ring_data {nullptr};
+        VulkanBuffer   m_staging_ring_rhi_buffer;
+        VkDeviceSize   m_ring_head {0};
+        VkDeviceSize   m_ring_tail {0};
+        VkDeviceSize   m_ring_used {0};
+    };
+} // namespace Piccolo
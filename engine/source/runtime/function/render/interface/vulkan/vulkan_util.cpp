@@ -5,10 +5,20 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <numeric>
 #include <stdexcept>
 
 namespace Piccolo
 {
+    namespace
+    {
+        // buffer to image copies need an offset aligned to the texel size, and to 4 bytes off the graphics queue
+        VkDeviceSize getStagingAlignment(VkDeviceSize texel_byte_size)
+        {
+            return std::lcm(std::max<VkDeviceSize>(texel_byte_size, 1), VkDeviceSize(4));
+        }
+    } // namespace
+
     std::unordered_map<uint32_t, VkSampler> VulkanUtil::m_mipmap_sampler_map;
     VkSampler                               VulkanUtil::m_nearest_sampler = VK_NULL_HANDLE;
     VkSampler                               VulkanUtil::m_linear_sampler  = VK_NULL_HANDLE;
@@ -46,88 +56,54 @@ namespace Piccolo
         return shader_module;
     }
 
-    void VulkanUtil::createBufferAndInitialize(VkDevice              device,
-                                       VkPhysicalDevice      physicalDevice,
-                                       VkBufferUsageFlags    usageFlags,
-                                       VkMemoryPropertyFlags memoryPropertyFlags,
-                                       VkBuffer*             buffer,
-                                       VkDeviceMemory*       memory,
-                                       VkDeviceSize          size,
-                                       void*                 data,
-                                       int                   datasize)
+    VmaAllocationCreateInfo VulkanUtil::getAllocationCreateInfo(VkMemoryPropertyFlags memory_property_flags,
+                                                                bool                  is_dedicated)
     {
-        // Create the buffer handle
-        VkBufferCreateInfo bufferCreateInfo {};
-        bufferCreateInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        bufferCreateInfo.usage       = usageFlags;
-        bufferCreateInfo.size        = size;
-        bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-        if (VK_SUCCESS != vkCreateBuffer(device, &bufferCreateInfo, nullptr, buffer))
+        VmaAllocationCreateInfo allocation_create_info {};
+        allocation_create_info.usage         = VMA_MEMORY_USAGE_UNKNOWN;
+        allocation_create_info.requiredFlags = memory_property_flags;
+        if (is_dedicated)
         {
-            LOG_ERROR("create buffer buffer failed!");
-            return;
+            allocation_create_info.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
         }
+        return allocation_create_info;
+    }
 
-        // Create the memory backing up the buffer handle
-        VkPhysicalDeviceMemoryProperties deviceMemoryProperties;
-        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &deviceMemoryProperties);
-        VkMemoryRequirements memReqs;
-        VkMemoryAllocateInfo memAlloc {};
-        memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        vkGetBufferMemoryRequirements(device, *buffer, &memReqs);
-        memAlloc.allocationSize = memReqs.size;
-
-        // Find a memory type index that fits the properties of the buffer
-        bool memTypeFound = false;
-        for (uint32_t i = 0; i < deviceMemoryProperties.memoryTypeCount; i++)
-        {
-            if ((memReqs.memoryTypeBits & 1) == 1)
-            {
-                if ((deviceMemoryProperties.memoryTypes[i].propertyFlags & memoryPropertyFlags) == memoryPropertyFlags)
-                {
-                    memAlloc.memoryTypeIndex = i;
-                    memTypeFound             = true;
-                }
-            }
-            memReqs.memoryTypeBits >>= 1;
-        }
-        if (!memTypeFound)
-        {
-            LOG_ERROR("memTypeFound is nullptr");
-            return;
-        }
-        if (VK_SUCCESS != vkAllocateMemory(device, &memAlloc, nullptr, memory))
+    void VulkanUtil::createBufferAndInitialize(VmaAllocator          allocator,
+                                               VkBufferUsageFlags    usageFlags,
+                                               VkMemoryPropertyFlags memoryPropertyFlags,
+                                               VkBuffer*             buffer,
+                                               VmaAllocation*        allocation,
+                                               VkDeviceSize          size,
+                                               void*                 data,
+                                               int                   datasize)
+    {
+        createBuffer(allocator, size, usageFlags, memoryPropertyFlags, *buffer, *allocation);
+        if (*allocation == VK_NULL_HANDLE)
         {
-            LOG_ERROR("alloc memory failed!");
             return;
         }
 
         if (data != nullptr && datasize != 0)
         {
             void* mapped;
-            if (VK_SUCCESS != vkMapMemory(device, *memory, 0, size, 0, &mapped))
+            if (VK_SUCCESS != vmaMapMemory(allocator, *allocation, &mapped))
             {
                 LOG_ERROR("map memory failed!");
                 return;
             }
             memcpy(mapped, data, datasize);
-            vkUnmapMemory(device, *memory);
-        }
-
-        if (VK_SUCCESS != vkBindBufferMemory(device, *buffer, *memory, 0))
-        {
-            LOG_ERROR("bind memory failed!");
-            return;
+            vmaFlushAllocation(allocator, *allocation, 0, VK_WHOLE_SIZE);
+            vmaUnmapMemory(allocator, *allocation);
         }
     }
 
-    void VulkanUtil::createBuffer(VkPhysicalDevice      physical_device,
-                                  VkDevice              device,
+    void VulkanUtil::createBuffer(VmaAllocator          allocator,
                                   VkDeviceSize          size,
                                   VkBufferUsageFlags    usage,
                                   VkMemoryPropertyFlags properties,
                                   VkBuffer&             buffer,
-                                  VkDeviceMemory&       buffer_memory)
+                                  VmaAllocation&        allocation)
     {
         VkBufferCreateInfo buffer_create_info {};
         buffer_create_info.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -135,30 +111,17 @@ namespace Piccolo
         buffer_create_info.usage       = usage;                     // use as a vertex/staging/index buffer
         buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // not sharing among queue families
 
-        if (vkCreateBuffer(device, &buffer_create_info, nullptr, &buffer) != VK_SUCCESS)
-        {
-            LOG_ERROR("vkCreateBuffer failed!");
-            return;
-        }
-
-        VkMemoryRequirements buffer_memory_requirements; // for allocate_info.allocationSize and
-                                                         // allocate_info.memoryTypeIndex
-        vkGetBufferMemoryRequirements(device, buffer, &buffer_memory_requirements);
-
-        VkMemoryAllocateInfo buffer_memory_allocate_info {};
-        buffer_memory_allocate_info.sType          = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        buffer_memory_allocate_info.allocationSize = buffer_memory_requirements.size;
-        buffer_memory_allocate_info.memoryTypeIndex =
-            VulkanUtil::findMemoryType(physical_device, buffer_memory_requirements.memoryTypeBits, properties);
+        // small buffers share device memory blocks, only the large ones pay for an allocation of their own
+        VmaAllocationCreateInfo allocation_create_info =
+            getAllocationCreateInfo(properties, size >= k_dedicated_allocation_size);
 
-        if (vkAllocateMemory(device, &buffer_memory_allocate_info, nullptr, &buffer_memory) != VK_SUCCESS)
+        if (vmaCreateBuffer(allocator, &buffer_create_info, &allocation_create_info, &buffer, &allocation, nullptr) !=
+            VK_SUCCESS)
         {
-            LOG_ERROR("vkAllocateMemory failed!");
-            return;
+            LOG_ERROR("vmaCreateBuffer failed!");
+            buffer     = VK_NULL_HANDLE;
+            allocation = VK_NULL_HANDLE;
         }
-
-        // bind buffer with buffer memory
-        vkBindBufferMemory(device, buffer, buffer_memory, 0); // offset = 0
     }
 
     void VulkanUtil::copyBuffer(RHI*         rhi,
@@ -183,19 +146,14 @@ namespace Piccolo
         static_cast<VulkanRHI*>(rhi)->endSingleTimeCommands(rhi_command_buffer);
     }
 
-    void VulkanUtil::createImage(VkPhysicalDevice      physical_device,
-                                 VkDevice              device,
-                                 uint32_t              image_width,
-                                 uint32_t              image_height,
-                                 VkFormat              format,
-                                 VkImageTiling         image_tiling,
-                                 VkImageUsageFlags     image_usage_flags,
-                                 VkMemoryPropertyFlags memory_property_flags,
-                                 VkImage&              image,
-                                 VkDeviceMemory&       memory,
-                                 VkImageCreateFlags    image_create_flags,
-                                 uint32_t              array_layers,
-                                 uint32_t              miplevels)
+    VkImageCreateInfo VulkanUtil::getImageCreateInfo(uint32_t           image_width,
+                                                     uint32_t           image_height,
+                                                     VkFormat           format,
+                                                     VkImageTiling      image_tiling,
+                                                     VkImageUsageFlags  image_usage_flags,
+                                                     VkImageCreateFlags image_create_flags,
+                                                     uint32_t           array_layers,
+                                                     uint32_t           miplevels)
     {
         VkImageCreateInfo image_create_info {};
         image_create_info.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -212,29 +170,43 @@ namespace Piccolo
         image_create_info.usage         = image_usage_flags;
         image_create_info.samples       = VK_SAMPLE_COUNT_1_BIT;
         image_create_info.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+        return image_create_info;
+    }
 
-        if (vkCreateImage(device, &image_create_info, nullptr, &image) != VK_SUCCESS)
+    void VulkanUtil::createImage(VmaAllocator          allocator,
+                                 uint32_t              image_width,
+                                 uint32_t              image_height,
+                                 VkFormat              format,
+                                 VkImageTiling         image_tiling,
+                                 VkImageUsageFlags     image_usage_flags,
+                                 VkMemoryPropertyFlags memory_property_flags,
+                                 VkImage&              image,
+                                 VmaAllocation&        allocation,
+                                 VkImageCreateFlags    image_create_flags,
+                                 uint32_t              array_layers,
+                                 uint32_t              miplevels)
+    {
+        VkImageCreateInfo image_create_info = getImageCreateInfo(image_width,
+                                                                 image_height,
+                                                                 format,
+                                                                 image_tiling,
+                                                                 image_usage_flags,
+                                                                 image_create_flags,
+                                                                 array_layers,
+                                                                 miplevels);
+
+        // render targets are recreated with the swapchain, keeping them out of the shared blocks avoids holes
+        const bool is_attachment =
+            (image_usage_flags & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)) != 0;
+        VmaAllocationCreateInfo allocation_create_info = getAllocationCreateInfo(memory_property_flags, is_attachment);
+
+        if (vmaCreateImage(allocator, &image_create_info, &allocation_create_info, &image, &allocation, nullptr) !=
+            VK_SUCCESS)
         {
             LOG_ERROR("failed to create image!");
-            return;
+            image      = VK_NULL_HANDLE;
+            allocation = VK_NULL_HANDLE;
         }
-
-        VkMemoryRequirements memRequirements;
-        vkGetImageMemoryRequirements(device, image, &memRequirements);
-
-        VkMemoryAllocateInfo allocInfo {};
-        allocInfo.sType          = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex =
-            findMemoryType(physical_device, memRequirements.memoryTypeBits, memory_property_flags);
-
-        if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
-        {
-            LOG_ERROR("failed to allocate image memory!");
-            return;
-        }
-
-        vkBindImageMemory(device, image, memory, 0);
     }
 
     VkImageView VulkanUtil::createImageView(VkDevice           device,
@@ -322,22 +294,17 @@ namespace Piccolo
                 break;
         }
 
-        // use staging buffer
-        VkBuffer       inefficient_staging_buffer;
-        VkDeviceMemory inefficient_staging_buffer_memory;
-        VulkanUtil::createBuffer(static_cast<VulkanRHI*>(rhi)->m_physical_device,
-                                 static_cast<VulkanRHI*>(rhi)->m_device,
-                                 texture_byte_size,
-                                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                                 inefficient_staging_buffer,
-                                 inefficient_staging_buffer_memory);
-
-        void* data;
-        vkMapMemory(
-            static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer_memory, 0, texture_byte_size, 0, &data);
-        memcpy(data, texture_image_pixels, static_cast<size_t>(texture_byte_size));
-        vkUnmapMemory(static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer_memory);
+        // copy the pixels into the staging ring
+        VulkanUploadManager& upload_manager = static_cast<VulkanRHI*>(rhi)->m_upload_manager;
+        RHIUploadAllocation  staging_allocation;
+        if (!upload_manager.allocate(texture_byte_size,
+                                     getStagingAlignment(texture_byte_size / (texture_image_width * texture_image_height)),
+                                     staging_allocation))
+        {
+            return;
+        }
+        memcpy(staging_allocation.mapped_data, texture_image_pixels, static_cast<size_t>(texture_byte_size));
+        VkBuffer staging_buffer = ((VulkanBuffer*)staging_allocation.buffer)->getResource();
 
         // generate mipmapped image
         uint32_t mip_levels =
@@ -371,8 +338,10 @@ namespace Piccolo
                        &image_allocation,
                        NULL);
 
+        VkCommandBuffer command_buffer = upload_manager.getGraphicsCommandBuffer();
+
         // layout transitions -- image layout is set from none to destination
-        transitionImageLayout(rhi,
+        transitionImageLayout(command_buffer,
                               image,
                               VK_IMAGE_LAYOUT_UNDEFINED,
                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
@@ -380,9 +349,15 @@ namespace Piccolo
                               1,
                               VK_IMAGE_ASPECT_COLOR_BIT);
         // copy from staging buffer as destination
-        copyBufferToImage(rhi, inefficient_staging_buffer, image, texture_image_width, texture_image_height, 1);
+        copyBufferToImage(command_buffer,
+                          staging_buffer,
+                          staging_allocation.offset,
+                          image,
+                          texture_image_width,
+                          texture_image_height,
+                          1);
         // layout transitions -- image layout is set from destination to shader_read
-        transitionImageLayout(rhi,
+        transitionImageLayout(command_buffer,
                               image,
                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
@@ -390,11 +365,8 @@ namespace Piccolo
                               1,
                               VK_IMAGE_ASPECT_COLOR_BIT);
 
-        vkDestroyBuffer(static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer, nullptr);
-        vkFreeMemory(static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer_memory, nullptr);
-
         // generate mipmapped image
-        genMipmappedImage(rhi, image, texture_image_width, texture_image_height, mip_levels);
+        genMipmappedImage(command_buffer, image, texture_image_width, texture_image_height, mip_levels);
 
         image_view = createImageView(static_cast<VulkanRHI*>(rhi)->m_device,
                                      image,
@@ -486,29 +458,27 @@ namespace Piccolo
                        &image_allocation,
                        NULL);
 
-        VkBuffer       inefficient_staging_buffer;
-        VkDeviceMemory inefficient_staging_buffer_memory;
-        createBuffer(static_cast<VulkanRHI*>(rhi)->m_physical_device,
-                     static_cast<VulkanRHI*>(rhi)->m_device,
-                     cube_byte_size,
-                     VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     inefficient_staging_buffer,
-                     inefficient_staging_buffer_memory);
-
-        void* data = NULL;
-        vkMapMemory(
-            static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer_memory, 0, cube_byte_size, 0, &data);
+        VulkanUploadManager& upload_manager = static_cast<VulkanRHI*>(rhi)->m_upload_manager;
+        RHIUploadAllocation  staging_allocation;
+        if (!upload_manager.allocate(cube_byte_size,
+                                     getStagingAlignment(texture_layer_byte_size /
+                                                         (texture_image_width * texture_image_height)),
+                                     staging_allocation))
+        {
+            return;
+        }
         for (int i = 0; i < 6; i++)
         {
-            memcpy((void*)(static_cast<char*>(data) + texture_layer_byte_size * i),
+            memcpy((void*)(static_cast<char*>(staging_allocation.mapped_data) + texture_layer_byte_size * i),
                    texture_image_pixels[i],
                    static_cast<size_t>(texture_layer_byte_size));
         }
-        vkUnmapMemory(static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer_memory);
+        VkBuffer staging_buffer = ((VulkanBuffer*)staging_allocation.buffer)->getResource();
+
+        VkCommandBuffer command_buffer = upload_manager.getGraphicsCommandBuffer();
 
         // layout transitions -- image layout is set from none to destination
-        transitionImageLayout(rhi,
+        transitionImageLayout(command_buffer,
                               image,
                               VK_IMAGE_LAYOUT_UNDEFINED,
                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
@@ -516,18 +486,22 @@ namespace Piccolo
                               miplevels,
                               VK_IMAGE_ASPECT_COLOR_BIT);
         // copy from staging buffer as destination
-        copyBufferToImage(rhi,
-                          inefficient_staging_buffer,
+        copyBufferToImage(command_buffer,
+                          staging_buffer,
+                          staging_allocation.offset,
                           image,
                           static_cast<uint32_t>(texture_image_width),
                           static_cast<uint32_t>(texture_image_height),
                           6);
 
-        vkDestroyBuffer(static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer, nullptr);
-        vkFreeMemory(static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer_memory, nullptr);
-
-        generateTextureMipMaps(
-            rhi, image, vulkan_image_format, texture_image_width, texture_image_height, 6, miplevels);
+        generateTextureMipMaps(static_cast<VulkanRHI*>(rhi)->m_physical_device,
+                               command_buffer,
+                               image,
+                               vulkan_image_format,
+                               texture_image_width,
+                               texture_image_height,
+                               6,
+                               miplevels);
 
         image_view = createImageView(static_cast<VulkanRHI*>(rhi)->m_device,
                                      image,
@@ -538,26 +512,23 @@ namespace Piccolo
                                      miplevels);
     }
 
-    void VulkanUtil::generateTextureMipMaps(RHI*     rhi,
-                                            VkImage  image,
-                                            VkFormat image_format,
-                                            uint32_t texture_width,
-                                            uint32_t texture_height,
-                                            uint32_t layers,
-                                            uint32_t miplevels)
+    void VulkanUtil::generateTextureMipMaps(VkPhysicalDevice physical_device,
+                                            VkCommandBuffer  command_buffer,
+                                            VkImage          image,
+                                            VkFormat         image_format,
+                                            uint32_t         texture_width,
+                                            uint32_t         texture_height,
+                                            uint32_t         layers,
+                                            uint32_t         miplevels)
     {
         VkFormatProperties format_properties;
-        vkGetPhysicalDeviceFormatProperties(
-            static_cast<VulkanRHI*>(rhi)->m_physical_device, image_format, &format_properties);
+        vkGetPhysicalDeviceFormatProperties(physical_device, image_format, &format_properties);
         if (!(format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT))
         {
             LOG_ERROR("generateTextureMipMaps() : linear bliting not supported!");
             return;
         }
 
-        RHICommandBuffer* rhi_command_buffer = static_cast<VulkanRHI*>(rhi)->beginSingleTimeCommands();
-        VkCommandBuffer command_buffer = ((VulkanCommandBuffer*)rhi_command_buffer)->getResource();
-
         VkImageMemoryBarrier barrier {};
         barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
         barrier.image                           = image;
@@ -652,11 +623,9 @@ namespace Piccolo
                              nullptr,
                              1,
                              &barrier);
-
-        static_cast<VulkanRHI*>(rhi)->endSingleTimeCommands(rhi_command_buffer);
     }
 
-    void VulkanUtil::transitionImageLayout(RHI*               rhi,
+    void VulkanUtil::transitionImageLayout(VkCommandBuffer    command_buffer,
                                            VkImage            image,
                                            VkImageLayout      old_layout,
                                            VkImageLayout      new_layout,
@@ -664,15 +633,6 @@ namespace Piccolo
                                            uint32_t           miplevels,
                                            VkImageAspectFlags aspect_mask_bits)
     {
-        if (rhi == nullptr)
-        {
-            LOG_ERROR("rhi is nullptr");
-            return;
-        }
-
-        RHICommandBuffer* rhi_command_buffer = static_cast<VulkanRHI*>(rhi)->beginSingleTimeCommands();
-        VkCommandBuffer command_buffer = ((VulkanCommandBuffer*)rhi_command_buffer)->getResource();
-
         VkImageMemoryBarrier barrier {};
         barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
         barrier.oldLayout                       = old_layout;
@@ -742,28 +702,18 @@ namespace Piccolo
         }
 
         vkCmdPipelineBarrier(command_buffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-        static_cast<VulkanRHI*>(rhi)->endSingleTimeCommands(rhi_command_buffer);
     }
 
-    void VulkanUtil::copyBufferToImage(RHI*     rhi,
-                                       VkBuffer buffer,
-                                       VkImage  image,
-                                       uint32_t width,
-                                       uint32_t height,
-                                       uint32_t layer_count)
+    void VulkanUtil::copyBufferToImage(VkCommandBuffer command_buffer,
+                                       VkBuffer        buffer,
+                                       VkDeviceSize    buffer_offset,
+                                       VkImage         image,
+                                       uint32_t        width,
+                                       uint32_t        height,
+                                       uint32_t        layer_count)
     {
-        if (rhi == nullptr)
-        {
-            LOG_ERROR("rhi is nullptr");
-            return;
-        }
-
-        RHICommandBuffer* rhi_command_buffer = static_cast<VulkanRHI*>(rhi)->beginSingleTimeCommands();
-        VkCommandBuffer command_buffer = ((VulkanCommandBuffer*)rhi_command_buffer)->getResource();
-
         VkBufferImageCopy region {};
-        region.bufferOffset                    = 0;
+        region.bufferOffset                    = buffer_offset;
         region.bufferRowLength                 = 0;
         region.bufferImageHeight               = 0;
         region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -774,20 +724,14 @@ namespace Piccolo
         region.imageExtent                     = {width, height, 1};
 
         vkCmdCopyBufferToImage(command_buffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-        static_cast<VulkanRHI*>(rhi)->endSingleTimeCommands(rhi_command_buffer);
     }
 
-    void VulkanUtil::genMipmappedImage(RHI* rhi, VkImage image, uint32_t width, uint32_t height, uint32_t mip_levels)
+    void VulkanUtil::genMipmappedImage(VkCommandBuffer command_buffer,
+                                       VkImage         image,
+                                       uint32_t        width,
+                                       uint32_t        height,
+                                       uint32_t        mip_levels)
     {
-        if (rhi == nullptr)
-        {
-            LOG_ERROR("rhi is nullptr");
-            return;
-        }
-
-        RHICommandBuffer* rhi_command_buffer = static_cast<VulkanRHI*>(rhi)->beginSingleTimeCommands();
-        VkCommandBuffer command_buffer = ((VulkanCommandBuffer*)rhi_command_buffer)->getResource();
 
         for (uint32_t i = 1; i < mip_levels; i++)
         {
@@ -887,8 +831,6 @@ namespace Piccolo
                              nullptr,
                              1,
                              &barrier);
-
-        static_cast<VulkanRHI*>(rhi)->endSingleTimeCommands(rhi_command_buffer);
     }
 
     VkSampler VulkanUtil::getOrCreateMipmapSampler(VkPhysicalDevice physical_device,
@@ -14,22 +14,26 @@ namespace Piccolo
     class VulkanUtil
     {
     public:
+        // buffers from this size on get their own device memory instead of a range in a shared block
+        static constexpr VkDeviceSize k_dedicated_allocation_size {32 * 1024 * 1024};
+
         static uint32_t
         findMemoryType(VkPhysicalDevice physical_device, uint32_t type_filter, VkMemoryPropertyFlags properties_flag);
         static VkShaderModule createShaderModule(VkDevice device, const std::vector<unsigned char>& shader_code);
-        static void           createBuffer(VkPhysicalDevice      physical_device,
-                                           VkDevice              device,
+        /// small allocations are placed in shared device memory blocks, dedicated ones get a block of their own
+        static VmaAllocationCreateInfo getAllocationCreateInfo(VkMemoryPropertyFlags memory_property_flags,
+                                                               bool                  is_dedicated);
+        static void           createBuffer(VmaAllocator          allocator,
                                            VkDeviceSize          size,
                                            VkBufferUsageFlags    usage,
                                            VkMemoryPropertyFlags properties,
                                            VkBuffer&             buffer,
-                                           VkDeviceMemory&       buffer_memory);
-        static void           createBufferAndInitialize(VkDevice              device,
-                                                        VkPhysicalDevice      physicalDevice,
+                                           VmaAllocation&        allocation);
+        static void           createBufferAndInitialize(VmaAllocator          allocator,
                                                         VkBufferUsageFlags    usageFlags,
                                                         VkMemoryPropertyFlags memoryPropertyFlags,
                                                         VkBuffer*             buffer,
-                                                        VkDeviceMemory*       memory,
+                                                        VmaAllocation*        allocation,
                                                         VkDeviceSize          size,
                                                         void*                 data     = nullptr,
                                                         int                   datasize = 0);
@@ -39,8 +43,15 @@ namespace Piccolo
                                          VkDeviceSize srcOffset,
                                          VkDeviceSize dstOffset,
                                          VkDeviceSize size);
-        static void           createImage(VkPhysicalDevice      physical_device,
-                                          VkDevice              device,
+        static VkImageCreateInfo getImageCreateInfo(uint32_t           image_width,
+                                                    uint32_t           image_height,
+                                                    VkFormat           format,
+                                                    VkImageTiling      image_tiling,
+                                                    VkImageUsageFlags  image_usage_flags,
+                                                    VkImageCreateFlags image_create_flags,
+                                                    uint32_t           array_layers,
+                                                    uint32_t           miplevels);
+        static void           createImage(VmaAllocator          allocator,
                                           uint32_t              image_width,
                                           uint32_t              image_height,
                                           VkFormat              format,
@@ -48,7 +59,7 @@ namespace Piccolo
                                           VkImageUsageFlags     image_usage_flags,
                                           VkMemoryPropertyFlags memory_property_flags,
                                           VkImage&              image,
-                                          VkDeviceMemory&       memory,
+                                          VmaAllocation&        allocation,
                                           VkImageCreateFlags    image_create_flags,
                                           uint32_t              array_layers,
                                           uint32_t              miplevels);
@@ -77,27 +88,34 @@ namespace Piccolo
                                             std::array<void*, 6> texture_image_pixels,
                                             RHIFormat   texture_image_format,
                                             uint32_t             miplevels);
-        static void           generateTextureMipMaps(RHI*     rhi,
-                                                     VkImage  image,
-                                                     VkFormat image_format,
-                                                     uint32_t texture_width,
-                                                     uint32_t texture_height,
-                                                     uint32_t layers,
-                                                     uint32_t miplevels);
-        static void           transitionImageLayout(RHI*               rhi,
+        // the helpers below only record, image uploads go into one command buffer of the upload manager
+        static void           generateTextureMipMaps(VkPhysicalDevice physical_device,
+                                                     VkCommandBuffer  command_buffer,
+                                                     VkImage          image,
+                                                     VkFormat         image_format,
+                                                     uint32_t         texture_width,
+                                                     uint32_t         texture_height,
+                                                     uint32_t         layers,
+                                                     uint32_t         miplevels);
+        static void           transitionImageLayout(VkCommandBuffer    command_buffer,
                                                     VkImage            image,
                                                     VkImageLayout      old_layout,
                                                     VkImageLayout      new_layout,
                                                     uint32_t           layer_count,
                                                     uint32_t           miplevels,
                                                     VkImageAspectFlags aspect_mask_bits);
-        static void           copyBufferToImage(RHI*     rhi,
-                                                VkBuffer buffer,
-                                                VkImage  image,
-                                                uint32_t width,
-                                                uint32_t height,
-                                                uint32_t layer_count);
-        static void genMipmappedImage(RHI* rhi, VkImage image, uint32_t width, uint32_t height, uint32_t mip_levels);
+        static void           copyBufferToImage(VkCommandBuffer command_buffer,
+                                                VkBuffer        buffer,
+                                                VkDeviceSize    buffer_offset,
+                                                VkImage         image,
+                                                uint32_t        width,
+                                                uint32_t        height,
+                                                uint32_t        layer_count);
+        static void           genMipmappedImage(VkCommandBuffer command_buffer,
+                                                VkImage         image,
+                                                uint32_t        width,
+                                                uint32_t        height,
+                                                uint32_t        mip_levels);
 
         static VkSampler
         getOrCreateMipmapSampler(VkPhysicalDevice physical_device, VkDevice device, uint32_t width, uint32_t height);
@@ -14,13 +14,13 @@ namespace Piccolo
     {
     public:
         void initialize(const RenderPassInitInfo* init_info) override final;
+        void setupPipelines() override final;
         void draw() override final;
 
         void updateAfterFramebufferRecreate(RHIImageView* input_attachment);
 
     private:
         void setupDescriptorSetLayout();
-        void setupPipelines();
         void setupDescriptorSet();
     };
 } // namespace Piccolo
@@ -1,5 +1,7 @@
 #include "runtime/function/render/passes/combine_ui_pass.h"
 
+#include "runtime/core/profile/profiler.h"
+
 #include "runtime/function/render/interface/vulkan/vulkan_rhi.h"
 #include "runtime/function/render/interface/vulkan/vulkan_util.h"
 
@@ -18,7 +20,6 @@ namespace Piccolo
         m_framebuffer.render_pass               = _init_info->render_pass;
 
         setupDescriptorSetLayout();
-        setupPipelines();
         setupDescriptorSet();
         updateAfterFramebufferRecreate(_init_info->scene_input_attachment, _init_info->ui_input_attachment);
     }
@@ -249,6 +250,8 @@ namespace Piccolo
 
     void CombineUIPass::draw()
     {
+        PROFILE_ZONE("CombineUIPass::draw");
+
         float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
         m_rhi->pushEvent(m_rhi->getCurrentCommandBuffer(), "Combine UI", color);
 
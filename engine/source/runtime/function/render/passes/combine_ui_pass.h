@@ -15,13 +15,13 @@ namespace Piccolo
     {
     public:
         void initialize(const RenderPassInitInfo* init_info) override final;
+        void setupPipelines() override final;
         void draw() override final;
 
         void updateAfterFramebufferRecreate(RHIImageView* scene_input_attachment, RHIImageView* ui_input_attachment);
 
     private:
         void setupDescriptorSetLayout();
-        void setupPipelines();
         void setupDescriptorSet();
     };
 } // namespace Piccolo
@@ -2,13 +2,18 @@
 
 #include "runtime/function/render/render_helper.h"
 #include "runtime/function/render/render_mesh.h"
+#include "runtime/core/base/thread_pool.h"
+#include "runtime/core/profile/profiler.h"
+
 #include "runtime/function/render/interface/vulkan/vulkan_rhi.h"
 #include "runtime/function/render/interface/vulkan/vulkan_util.h"
 
 #include <mesh_directional_light_shadow_frag.h>
 #include <mesh_directional_light_shadow_vert.h>
 
+#include <algorithm>
 #include <stdexcept>
+#include <vector>
 
 namespace Piccolo
 {
@@ -16,14 +21,19 @@ namespace Piccolo
     {
         RenderPass::initialize(nullptr);
 
+        const DirectionalLightShadowPassInitInfo* _init_info =
+            static_cast<const DirectionalLightShadowPassInitInfo*>(init_info);
+
         setupAttachments();
+        m_framebuffer.attachments[1].image = _init_info->depth_image;
+        m_framebuffer.attachments[1].mem   = nullptr;
+        m_framebuffer.attachments[1].view  = _init_info->depth_image_view;
         setupRenderPass();
         setupFramebuffer();
         setupDescriptorSetLayout();
     }
     void DirectionalLightShadowPass::postInitialize()
     {
-        setupPipelines();
         setupDescriptorSet();
     }
     void DirectionalLightShadowPass::preparePassData(std::shared_ptr<RenderResourceBase> render_resource)
@@ -35,7 +45,13 @@ namespace Piccolo
                 vulkan_resource->m_mesh_directional_light_shadow_perframe_storage_buffer_object;
         }
     }
-    void DirectionalLightShadowPass::draw() { drawModel(); }
+    void DirectionalLightShadowPass::draw()
+    {
+        PROFILE_ZONE("DirectionalLightShadowPass::draw");
+
+        drawModel();
+    }
+
     void DirectionalLightShadowPass::setupAttachments()
     {
         // color and depth
@@ -62,26 +78,8 @@ namespace Piccolo
                                1,
                                m_framebuffer.attachments[0].view);
 
-        // depth
+        // depth, the image comes from the render graph
         m_framebuffer.attachments[1].format = m_rhi->getDepthImageInfo().depth_image_format;
-        m_rhi->createImage(s_directional_light_shadow_map_dimension,
-                           s_directional_light_shadow_map_dimension,
-                           m_framebuffer.attachments[1].format,
-                           RHI_IMAGE_TILING_OPTIMAL,
-                           RHI_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | RHI_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
-                           RHI_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                           m_framebuffer.attachments[1].image,
-                           m_framebuffer.attachments[1].mem,
-                           0,
-                           1,
-                           1);
-         m_rhi->createImageView(m_framebuffer.attachments[1].image,
-                                m_framebuffer.attachments[1].format,
-                                RHI_IMAGE_ASPECT_DEPTH_BIT,
-                                RHI_IMAGE_VIEW_TYPE_2D,
-                                1,
-                                1,
-                                m_framebuffer.attachments[1].view);
     }
     void DirectionalLightShadowPass::setupRenderPass()
     {
@@ -454,35 +452,18 @@ namespace Piccolo
     }
     void DirectionalLightShadowPass::drawModel()
     {
-        struct MeshNode
-        {
-            const Matrix4x4* model_matrix {nullptr};
-            const Matrix4x4* joint_matrices {nullptr};
-            uint32_t         joint_count {0};
-        };
-
-        std::map<VulkanPBRMaterial*, std::map<VulkanMesh*, std::vector<MeshNode>>>
-            directional_light_mesh_drawcall_batch;
-
-        // reorganize mesh
-        for (RenderMeshNode& node : *(m_visiable_nodes.p_directional_light_visible_mesh_nodes))
+        // the shadow pass binds no material, so the instances of a mesh merge across materials
+        m_mesh_draw_list.build(*(m_visiable_nodes.p_directional_light_visible_mesh_nodes),
+                               _render_draw_pass_directional_light_shadow,
+                               0,
+                               false,
+                               &m_mesh_directional_light_shadow_perframe_storage_buffer_object.light_proj_view);
+
+        // Directional Light Shadow begin pass, the subpass only executes secondary command buffers
         {
-            auto& mesh_instanced = directional_light_mesh_drawcall_batch[node.ref_material];
-            auto& mesh_nodes     = mesh_instanced[node.ref_mesh];
-
-            MeshNode temp;
-            temp.model_matrix = node.model_matrix;
-            if (node.enable_vertex_blending)
-            {
-                temp.joint_matrices = node.joint_matrices;
-                temp.joint_count    = node.joint_count;
-            }
-
-            mesh_nodes.push_back(temp);
-        }
+            float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+            m_rhi->pushEvent(m_rhi->getCurrentCommandBuffer(), "Directional Light Shadow", color);
 
-        // Directional Light Shadow begin pass
-        {
             RHIRenderPassBeginInfo renderpass_begin_info {};
             renderpass_begin_info.sType             = RHI_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
             renderpass_begin_info.renderPass        = m_framebuffer.render_pass;
@@ -497,199 +478,175 @@ namespace Piccolo
             renderpass_begin_info.clearValueCount = (sizeof(clear_values) / sizeof(clear_values[0]));
             renderpass_begin_info.pClearValues    = clear_values;
 
-            m_rhi->cmdBeginRenderPassPFN(m_rhi->getCurrentCommandBuffer(), &renderpass_begin_info, RHI_SUBPASS_CONTENTS_INLINE);
-
-            float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
-            m_rhi->pushEvent(m_rhi->getCurrentCommandBuffer(), "Directional Light Shadow", color);
+            m_rhi->cmdBeginRenderPassPFN(m_rhi->getCurrentCommandBuffer(),
+                                         &renderpass_begin_info,
+                                         RHI_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
         }
 
         // Mesh
-        if (m_rhi->isPointLightShadowEnabled())
+        if (m_rhi->isPointLightShadowEnabled() && !m_mesh_draw_list.getBatches().empty())
         {
-            float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
-            m_rhi->pushEvent(m_rhi->getCurrentCommandBuffer(), "Mesh", color);
-
-            m_rhi->cmdBindPipelinePFN(m_rhi->getCurrentCommandBuffer(), RHI_PIPELINE_BIND_POINT_GRAPHICS, m_render_pipelines[0].pipeline);
+            StorageBuffer& storage_buffer      = m_global_render_resource->_storage_buffer;
+            uint8_t        current_frame_index = m_rhi->getCurrentFrameIndex();
 
             // perframe storage buffer
             uint32_t perframe_dynamic_offset =
-                roundUp(m_global_render_resource->_storage_buffer
-                            ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                        m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-            m_global_render_resource->_storage_buffer
-                ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-                perframe_dynamic_offset + sizeof(MeshPerframeStorageBufferObject);
-            assert(m_global_render_resource->_storage_buffer
-                       ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-                   (m_global_render_resource->_storage_buffer
-                        ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                    m_global_render_resource->_storage_buffer
-                        ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
+                storage_buffer.allocateFromRingBuffer(current_frame_index, sizeof(MeshPerframeStorageBufferObject));
 
             MeshDirectionalLightShadowPerframeStorageBufferObject& perframe_storage_buffer_object =
                 (*reinterpret_cast<MeshDirectionalLightShadowPerframeStorageBufferObject*>(
-                    reinterpret_cast<uintptr_t>(
-                        m_global_render_resource->_storage_buffer._global_upload_ringbuffer_memory_pointer) +
+                    reinterpret_cast<uintptr_t>(storage_buffer._global_upload_ringbuffer_memory_pointer) +
                     perframe_dynamic_offset));
             perframe_storage_buffer_object = m_mesh_directional_light_shadow_perframe_storage_buffer_object;
 
-            for (auto& [material, mesh_instanced] : directional_light_mesh_drawcall_batch)
-            {
-                // TODO: render from near to far
+            uint32_t draw_count  = static_cast<uint32_t>(m_mesh_draw_list.getBatches().size());
+            uint32_t chunk_count = std::min(draw_count, m_recording_thread_pool->getThreadCount());
+            std::vector<RHICommandBuffer*> chunk_command_buffers(chunk_count, nullptr);
 
-                for (auto& [mesh, mesh_nodes] : mesh_instanced)
-                {
-                    uint32_t total_instance_count = static_cast<uint32_t>(mesh_nodes.size());
-                    if (total_instance_count > 0)
-                    {
-                        // bind per mesh
-                        m_rhi->cmdBindDescriptorSetsPFN(m_rhi->getCurrentCommandBuffer(),
-                                                        RHI_PIPELINE_BIND_POINT_GRAPHICS,
-                                                        m_render_pipelines[0].layout,
-                                                        1,
-                                                        1,
-                                                        &mesh->mesh_vertex_blending_descriptor_set,
-                                                        0,
-                                                        NULL);
+            m_recording_thread_pool->parallelFor(chunk_count, [&](uint32_t chunk_index, uint32_t thread_index) {
+                PROFILE_ZONE("DirectionalLightShadowPass::recordMeshes");
 
-                        RHIBuffer*     vertex_buffers[] = {mesh->mesh_vertex_position_buffer};
-                        RHIDeviceSize offsets[]        = {0};
-                        m_rhi->cmdBindVertexBuffersPFN(m_rhi->getCurrentCommandBuffer(), 0, 1, vertex_buffers, offsets);
-                        m_rhi->cmdBindIndexBufferPFN(m_rhi->getCurrentCommandBuffer(), mesh->mesh_index_buffer, 0, RHI_INDEX_TYPE_UINT16);
+                RHICommandBuffer* command_buffer = m_rhi->beginSecondaryCommandBuffer(
+                    thread_index, m_framebuffer.render_pass, 0, m_framebuffer.framebuffer);
 
-                        uint32_t drawcall_max_instance_count =
-                            (sizeof(MeshDirectionalLightShadowPerdrawcallStorageBufferObject::mesh_instances) /
-                             sizeof(MeshDirectionalLightShadowPerdrawcallStorageBufferObject::mesh_instances[0]));
-                        uint32_t drawcall_count =
-                            roundUp(total_instance_count, drawcall_max_instance_count) / drawcall_max_instance_count;
+                float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+                m_rhi->pushEvent(command_buffer, "Mesh", color);
 
-                        for (uint32_t drawcall_index = 0; drawcall_index < drawcall_count; ++drawcall_index)
+                m_rhi->cmdBindPipelinePFN(command_buffer, RHI_PIPELINE_BIND_POINT_GRAPHICS, m_render_pipelines[0].pipeline);
+
+                uint32_t first_draw_index = draw_count * chunk_index / chunk_count;
+                uint32_t last_draw_index  = draw_count * (chunk_index + 1) / chunk_count;
+                for (uint32_t draw_index = first_draw_index; draw_index < last_draw_index; ++draw_index)
+                {
+                    const RenderDrawBatch&  batch      = m_mesh_draw_list.getBatches()[draw_index];
+                    VulkanMesh*             mesh       = batch.mesh;
+                    const RenderDrawPacket* mesh_nodes = &m_mesh_draw_list.getPackets()[batch.first_packet];
+
+                    uint32_t total_instance_count = batch.packet_count;
+
+                    // bind per mesh
+                    m_rhi->cmdBindDescriptorSetsPFN(command_buffer,
+                                                    RHI_PIPELINE_BIND_POINT_GRAPHICS,
+                                                    m_render_pipelines[0].layout,
+                                                    1,
+                                                    1,
+                                                    &mesh->mesh_vertex_blending_descriptor_set,
+                                                    0,
+                                                    NULL);
+
+                    RHIBuffer*     vertex_buffers[] = {mesh->mesh_vertex_position_buffer};
+                    RHIDeviceSize offsets[]        = {0};
+                    m_rhi->cmdBindVertexBuffersPFN(command_buffer, 0, 1, vertex_buffers, offsets);
+                    m_rhi->cmdBindIndexBufferPFN(command_buffer, mesh->mesh_index_buffer, 0, RHI_INDEX_TYPE_UINT16);
+
+                    uint32_t drawcall_max_instance_count =
+                        (sizeof(MeshDirectionalLightShadowPerdrawcallStorageBufferObject::mesh_instances) /
+                         sizeof(MeshDirectionalLightShadowPerdrawcallStorageBufferObject::mesh_instances[0]));
+                    uint32_t drawcall_count =
+                        roundUp(total_instance_count, drawcall_max_instance_count) / drawcall_max_instance_count;
+
+                    for (uint32_t drawcall_index = 0; drawcall_index < drawcall_count; ++drawcall_index)
+                    {
+                        uint32_t current_instance_count =
+                            ((total_instance_count - drawcall_max_instance_count * drawcall_index) <
+                             drawcall_max_instance_count) ?
+                                (total_instance_count - drawcall_max_instance_count * drawcall_index) :
+                                drawcall_max_instance_count;
+
+                        // perdrawcall storage buffer
+                        uint32_t perdrawcall_dynamic_offset = storage_buffer.allocateFromRingBuffer(
+                            current_frame_index, sizeof(MeshDirectionalLightShadowPerdrawcallStorageBufferObject));
+
+                        MeshDirectionalLightShadowPerdrawcallStorageBufferObject& perdrawcall_storage_buffer_object =
+                            (*reinterpret_cast<MeshDirectionalLightShadowPerdrawcallStorageBufferObject*>(
+                                reinterpret_cast<uintptr_t>(storage_buffer._global_upload_ringbuffer_memory_pointer) +
+                                perdrawcall_dynamic_offset));
+                        for (uint32_t i = 0; i < current_instance_count; ++i)
                         {
-                            uint32_t current_instance_count =
-                                ((total_instance_count - drawcall_max_instance_count * drawcall_index) <
-                                 drawcall_max_instance_count) ?
-                                    (total_instance_count - drawcall_max_instance_count * drawcall_index) :
-                                    drawcall_max_instance_count;
-
-                            // perdrawcall storage buffer
-                            uint32_t perdrawcall_dynamic_offset =
-                                roundUp(m_global_render_resource->_storage_buffer
-                                            ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                                        m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-                            m_global_render_resource->_storage_buffer
-                                ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-                                perdrawcall_dynamic_offset +
-                                sizeof(MeshDirectionalLightShadowPerdrawcallStorageBufferObject);
-                            assert(m_global_render_resource->_storage_buffer
-                                       ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-                                   (m_global_render_resource->_storage_buffer
-                                        ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                                    m_global_render_resource->_storage_buffer
-                                        ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
-
-                            MeshDirectionalLightShadowPerdrawcallStorageBufferObject&
-                                perdrawcall_storage_buffer_object =
-                                    (*reinterpret_cast<MeshDirectionalLightShadowPerdrawcallStorageBufferObject*>(
-                                        reinterpret_cast<uintptr_t>(m_global_render_resource->_storage_buffer
-                                                                        ._global_upload_ringbuffer_memory_pointer) +
-                                        perdrawcall_dynamic_offset));
-                            for (uint32_t i = 0; i < current_instance_count; ++i)
-                            {
-                                perdrawcall_storage_buffer_object.mesh_instances[i].model_matrix =
-                                    *mesh_nodes[drawcall_max_instance_count * drawcall_index + i].model_matrix;
-                                perdrawcall_storage_buffer_object.mesh_instances[i].enable_vertex_blending =
-                                    mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices ? 1.0 :
-                                                                                                                  -1.0;
-                            }
+                            perdrawcall_storage_buffer_object.mesh_instances[i].model_matrix =
+                                *mesh_nodes[drawcall_max_instance_count * drawcall_index + i].model_matrix;
+                            perdrawcall_storage_buffer_object.mesh_instances[i].enable_vertex_blending =
+                                mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices ? 1.0 :
+                                                                                                              -1.0;
+                        }
 
-                            // per drawcall vertex blending storage buffer
-                            uint32_t per_drawcall_vertex_blending_dynamic_offset;
-                            bool     least_one_enable_vertex_blending = true;
-                            for (uint32_t i = 0; i < current_instance_count; ++i)
+                        // per drawcall vertex blending storage buffer
+                        uint32_t per_drawcall_vertex_blending_dynamic_offset;
+                        bool     least_one_enable_vertex_blending = true;
+                        for (uint32_t i = 0; i < current_instance_count; ++i)
+                        {
+                            if (!mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices)
                             {
-                                if (!mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices)
-                                {
-                                    least_one_enable_vertex_blending = false;
-                                    break;
-                                }
+                                least_one_enable_vertex_blending = false;
+                                break;
                             }
-                            if (least_one_enable_vertex_blending)
+                        }
+                        if (least_one_enable_vertex_blending)
+                        {
+                            per_drawcall_vertex_blending_dynamic_offset = storage_buffer.allocateFromRingBuffer(
+                                current_frame_index,
+                                sizeof(MeshDirectionalLightShadowPerdrawcallVertexBlendingStorageBufferObject));
+
+                            MeshDirectionalLightShadowPerdrawcallVertexBlendingStorageBufferObject&
+                                per_drawcall_vertex_blending_storage_buffer_object =
+                                    (*reinterpret_cast<
+                                        MeshDirectionalLightShadowPerdrawcallVertexBlendingStorageBufferObject*>(
+                                        reinterpret_cast<uintptr_t>(
+                                            storage_buffer._global_upload_ringbuffer_memory_pointer) +
+                                        per_drawcall_vertex_blending_dynamic_offset));
+                            for (uint32_t i = 0; i < current_instance_count; ++i)
                             {
-                                per_drawcall_vertex_blending_dynamic_offset = roundUp(
-                                    m_global_render_resource->_storage_buffer
-                                        ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                                    m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-                                m_global_render_resource->_storage_buffer
-                                    ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-                                    per_drawcall_vertex_blending_dynamic_offset +
-                                    sizeof(MeshDirectionalLightShadowPerdrawcallVertexBlendingStorageBufferObject);
-                                assert(m_global_render_resource->_storage_buffer
-                                           ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-                                       (m_global_render_resource->_storage_buffer
-                                            ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                                        m_global_render_resource->_storage_buffer
-                                            ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
-
-                                MeshDirectionalLightShadowPerdrawcallVertexBlendingStorageBufferObject&
-                                    per_drawcall_vertex_blending_storage_buffer_object =
-                                        (*reinterpret_cast<
-                                            MeshDirectionalLightShadowPerdrawcallVertexBlendingStorageBufferObject*>(
-                                            reinterpret_cast<uintptr_t>(m_global_render_resource->_storage_buffer
-                                                                            ._global_upload_ringbuffer_memory_pointer) +
-                                            per_drawcall_vertex_blending_dynamic_offset));
-                                for (uint32_t i = 0; i < current_instance_count; ++i)
+                                if (mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices)
                                 {
-                                    if (mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices)
+                                    for (uint32_t j = 0;
+                                         j < mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_count;
+                                         ++j)
                                     {
-                                        for (uint32_t j = 0;
-                                             j <
-                                             mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_count;
-                                             ++j)
-                                        {
-                                            per_drawcall_vertex_blending_storage_buffer_object
-                                                .joint_matrices[s_mesh_vertex_blending_max_joint_count * i + j] =
-                                                mesh_nodes[drawcall_max_instance_count * drawcall_index + i]
-                                                    .joint_matrices[j];
-                                        }
+                                        per_drawcall_vertex_blending_storage_buffer_object
+                                            .joint_matrices[s_mesh_vertex_blending_max_joint_count * i + j] =
+                                            mesh_nodes[drawcall_max_instance_count * drawcall_index + i]
+                                                .joint_matrices[j];
                                     }
                                 }
                             }
-                            else
-                            {
-                                per_drawcall_vertex_blending_dynamic_offset = 0;
-                            }
-
-                            // bind perdrawcall
-                            uint32_t dynamic_offsets[3] = {perframe_dynamic_offset,
-                                                           perdrawcall_dynamic_offset,
-                                                           per_drawcall_vertex_blending_dynamic_offset};
-                            m_rhi->cmdBindDescriptorSetsPFN(m_rhi->getCurrentCommandBuffer(),
-                                                            RHI_PIPELINE_BIND_POINT_GRAPHICS,
-                                                            m_render_pipelines[0].layout,
-                                                            0,
-                                                            1,
-                                                            &m_descriptor_infos[0].descriptor_set,
-                                                            (sizeof(dynamic_offsets) / sizeof(dynamic_offsets[0])),
-                                                            dynamic_offsets);
-                            m_rhi->cmdDrawIndexedPFN(m_rhi->getCurrentCommandBuffer(),
-                                                     mesh->mesh_index_count,
-                                                     current_instance_count,
-                                                     0,
-                                                     0,
-                                                     0);
                         }
+                        else
+                        {
+                            per_drawcall_vertex_blending_dynamic_offset = 0;
+                        }
+
+                        // bind perdrawcall
+                        uint32_t dynamic_offsets[3] = {perframe_dynamic_offset,
+                                                       perdrawcall_dynamic_offset,
+                                                       per_drawcall_vertex_blending_dynamic_offset};
+                        m_rhi->cmdBindDescriptorSetsPFN(command_buffer,
+                                                        RHI_PIPELINE_BIND_POINT_GRAPHICS,
+                                                        m_render_pipelines[0].layout,
+                                                        0,
+                                                        1,
+                                                        &m_descriptor_infos[0].descriptor_set,
+                                                        (sizeof(dynamic_offsets) / sizeof(dynamic_offsets[0])),
+                                                        dynamic_offsets);
+                        m_rhi->cmdDrawIndexedPFN(
+                            command_buffer, mesh->mesh_index_count, current_instance_count, 0, 0, 0);
                     }
                 }
-            }
 
-            m_rhi->popEvent(m_rhi->getCurrentCommandBuffer());
+                m_rhi->popEvent(command_buffer);
+
+                m_rhi->endSecondaryCommandBuffer(command_buffer);
+                chunk_command_buffers[chunk_index] = command_buffer;
+            });
+
+            // the chunks keep the order of the draw list
+            m_rhi->cmdExecuteCommandsPFN(m_rhi->getCurrentCommandBuffer(), chunk_count, chunk_command_buffers.data());
         }
 
         // Directional Light Shadow end pass
         {
-            m_rhi->popEvent(m_rhi->getCurrentCommandBuffer());
-
             m_rhi->cmdEndRenderPassPFN(m_rhi->getCurrentCommandBuffer());
+
+            m_rhi->popEvent(m_rhi->getCurrentCommandBuffer());
         }
     }
 } // namespace Piccolo
@@ -7,6 +7,7 @@
 #include "runtime/function/render/interface/vulkan/vulkan_rhi.h"
 #include "runtime/function/render/interface/vulkan/vulkan_util.h"
 #include "runtime/core/base/macro.h"
+#include "runtime/core/profile/profiler.h"
 
 #include <fxaa_frag.h>
 #include <fxaa_vert.h>
@@ -29,7 +30,6 @@ namespace Piccolo
         m_framebuffer.render_pass = _init_info->render_pass;
 
         setupDescriptorSetLayout();
-        setupPipelines();
         setupDescriptorSet();
         updateAfterFramebufferRecreate(_init_info->input_attachment);
     }
@@ -237,6 +237,8 @@ namespace Piccolo
 
     void FXAAPass::draw()
     {
+        PROFILE_ZONE("FXAAPass::draw");
+
         float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
         m_rhi->pushEvent(m_rhi->getCurrentCommandBuffer(), "FXAA", color);
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "runtime/function/render/render_draw_list.h"
 #include "runtime/function/render/render_pass.h"
 
 #include "runtime/function/render/passes/color_grading_pass.h"
@@ -56,6 +57,7 @@ namespace Piccolo
         };
 
         void initialize(const RenderPassInitInfo* init_info) override final;
+        void setupPipelines() override final;
 
         void preparePassData(std::shared_ptr<RenderResourceBase> render_resource) override final;
 
@@ -97,7 +99,6 @@ namespace Piccolo
         void setupAttachments();
         void setupRenderPass();
         void setupDescriptorSetLayout();
-        void setupPipelines();
         void setupDescriptorSet();
         void setupFramebufferDescriptorSet();
         void setupSwapchainFramebuffers();
@@ -108,16 +109,26 @@ namespace Piccolo
         void setupParticleDescriptorSet();
         void setupGbufferLightingDescriptorSet();
 
-        void drawMeshGbuffer();
+        void drawMeshGbuffer(RHIFramebuffer* framebuffer);
         void drawDeferredLighting();
-        void drawMeshLighting();
-        void drawSkybox();
+        void drawSkybox(RHICommandBuffer* command_buffer);
         void drawAxis();
 
+        // record the visible meshes for a subpass that executes secondary command buffers, the batches are split
+        // in chunks recorded in parallel, appended to out_command_buffers in the order of the draw list
+        void recordMeshes(RenderPipeLineType              pipeline_type,
+                          uint32_t                        subpass,
+                          RHIFramebuffer*                 framebuffer,
+                          const char*                     event_name,
+                          std::vector<RHICommandBuffer*>& out_command_buffers);
+
 
 
     private:
         std::vector<RHIFramebuffer*> m_swapchain_framebuffers;
         std::shared_ptr<ParticlePass> m_particle_pass;
+
+        // the visible meshes sorted into instanced draws, rebuilt every frame without reallocating
+        RenderDrawList m_mesh_draw_list;
     };
 } // namespace Piccolo
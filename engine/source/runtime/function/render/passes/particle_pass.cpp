@@ -8,6 +8,7 @@
 #include "runtime/function/render/render_system.h"
 
 #include "core/base/macro.h"
+#include "core/profile/profiler.h"
 #include <fstream>
 
 #include "particle_emit_comp.h"
@@ -308,6 +309,8 @@ namespace Piccolo
 
     void ParticlePass::draw()
     {
+        PROFILE_ZONE("ParticlePass::draw");
+
         for (int i = 0; i < m_emitter_count; ++i)
         {
             float color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
@@ -360,6 +363,9 @@ namespace Piccolo
                                      m_piccolo_logo_texture_resource->m_format);
         }
 
+        // the particle textures are sampled from the first frame on
+        m_rhi->flushUploads();
+
         m_rhi->createImage(m_rhi->getSwapchainInfo().extent.width,
                            m_rhi->getSwapchainInfo().extent.height,
                            m_rhi->getDepthImageInfo().depth_image_format,
@@ -778,7 +784,6 @@ namespace Piccolo
     {
         prepareUniformBuffer();
         setupDescriptorSetLayout();
-        setupPipelines();
         setupAttachments();
 
         RHICommandBufferAllocateInfo cmdBufAllocateInfo {};
@@ -1010,16 +1015,6 @@ namespace Piccolo
                 throw std::runtime_error("create compute pass pipe layout");
             LOG_INFO("compute pipe layout done");
         }
-        /*
-        VkPipelineCache           pipelineCache;
-        VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
-        pipelineCacheCreateInfo.sType                     = RHI_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-        if (RHI_SUCCESS != vkCreatePipelineCache(m_vulkan_rhi->m_device, &pipelineCacheCreateInfo, nullptr,
-        &pipelineCache))
-        {
-            throw std::runtime_error("create particle cache");
-        }*/
-
         struct SpecializationData
         {
             uint32_t BUFFER_ELEMENT_COUNT = 32;
@@ -1054,7 +1049,7 @@ namespace Piccolo
 
             computePipelineCreateInfo.pStages = &shaderStage;
             if (RHI_SUCCESS != m_rhi->createComputePipelines(
-                                   /*pipelineCache*/ nullptr, 1, &computePipelineCreateInfo, m_kickoff_pipeline))
+                                   /*pipelineCache, the rhi uses its own*/ nullptr, 1, &computePipelineCreateInfo, m_kickoff_pipeline))
             {
                 throw std::runtime_error("create particle kickoff pipe");
             }
@@ -1067,7 +1062,7 @@ namespace Piccolo
 
             computePipelineCreateInfo.pStages = &shaderStage;
             if (RHI_SUCCESS != m_rhi->createComputePipelines(
-                                   /*pipelineCache*/ nullptr, 1, &computePipelineCreateInfo, m_emit_pipeline))
+                                   /*pipelineCache, the rhi uses its own*/ nullptr, 1, &computePipelineCreateInfo, m_emit_pipeline))
             {
                 throw std::runtime_error("create particle emit pipe");
             }
@@ -1081,7 +1076,7 @@ namespace Piccolo
             computePipelineCreateInfo.pStages = &shaderStage;
 
             if (RHI_SUCCESS != m_rhi->createComputePipelines(
-                                   /*pipelineCache*/ nullptr, 1, &computePipelineCreateInfo, m_simulate_pipeline))
+                                   /*pipelineCache, the rhi uses its own*/ nullptr, 1, &computePipelineCreateInfo, m_simulate_pipeline))
             {
                 throw std::runtime_error("create particle simulate pipe");
             }
@@ -49,6 +49,7 @@ namespace Piccolo
     {
     public:
         void initialize(const RenderPassInitInfo* init_info) override final;
+        void setupPipelines() override final;
 
         void preparePassData(std::shared_ptr<RenderResourceBase> render_resource) override final;
 
@@ -89,7 +90,6 @@ namespace Piccolo
 
         void prepareUniformBuffer();
 
-        void setupPipelines();
 
         void allocateDescriptorSet();
 
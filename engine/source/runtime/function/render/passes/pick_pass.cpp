@@ -11,7 +11,6 @@
 
 
 
-#include <map>
 #include <stdexcept>
 
 namespace Piccolo
@@ -27,7 +26,6 @@ namespace Piccolo
         setupRenderPass();
         setupFramebuffer();
         setupDescriptorSetLayout();
-        setupPipelines();
         setupDescriptorSet();
     }
     void PickPass::postInitialize() {}
@@ -423,33 +421,11 @@ namespace Piccolo
         if (pixel_x >= m_rhi->getSwapchainInfo().extent.width || pixel_y >= m_rhi->getSwapchainInfo().extent.height)
             return 0;
 
-        struct MeshNode
-        {
-            const Matrix4x4* model_matrix {nullptr};
-            const Matrix4x4* joint_matrices {nullptr};
-            uint32_t         joint_count {0};
-            uint32_t         node_id;
-        };
-
-        std::map<VulkanPBRMaterial*, std::map<VulkanMesh*, std::vector<MeshNode>>> main_camera_mesh_drawcall_batch;
-
-        // reorganize mesh
-        for (RenderMeshNode& node : *(m_visiable_nodes.p_main_camera_visible_mesh_nodes))
-        {
-            auto& mesh_instanced = main_camera_mesh_drawcall_batch[node.ref_material];
-            auto& model_nodes    = mesh_instanced[node.ref_mesh];
-
-            MeshNode temp;
-            temp.model_matrix = node.model_matrix;
-            temp.node_id      = node.node_id;
-            if (node.ref_mesh->enable_vertex_blending)
-            {
-                temp.joint_matrices = node.joint_matrices;
-                temp.joint_count    = node.joint_count;
-            }
-
-            model_nodes.push_back(temp);
-        }
+        m_mesh_draw_list.build(*(m_visiable_nodes.p_main_camera_visible_mesh_nodes),
+                               _render_draw_pass_pick,
+                               0,
+                               false,
+                               &_mesh_inefficient_pick_perframe_storage_buffer_object.proj_view_matrix);
 
         m_rhi->prepareContext();
 
@@ -542,149 +518,139 @@ namespace Piccolo
                 m_global_render_resource->_storage_buffer._global_upload_ringbuffer_memory_pointer) +
             perframe_dynamic_offset)) = _mesh_inefficient_pick_perframe_storage_buffer_object;
 
-        for (auto& pair1 : main_camera_mesh_drawcall_batch)
+        for (const RenderDrawBatch& batch : m_mesh_draw_list.getBatches())
         {
-            VulkanPBRMaterial& material       = (*pair1.first);
-            auto&              mesh_instanced = pair1.second;
-
-            // TODO: render from near to far
-
-            for (auto& pair2 : mesh_instanced)
+            VulkanMesh&             mesh       = *batch.mesh;
+            const RenderDrawPacket* mesh_nodes = &m_mesh_draw_list.getPackets()[batch.first_packet];
+
+            uint32_t total_instance_count = batch.packet_count;
+
+            // bind per mesh
+            m_rhi->cmdBindDescriptorSetsPFN(m_rhi->getCurrentCommandBuffer(),
+                                            RHI_PIPELINE_BIND_POINT_GRAPHICS,
+                                            m_render_pipelines[0].layout,
+                                            1,
+                                            1,
+                                            &mesh.mesh_vertex_blending_descriptor_set,
+                                            0,
+                                            NULL);
+
+            RHIBuffer* vertex_buffers[] = { mesh.mesh_vertex_position_buffer };
+            RHIDeviceSize offsets[] = { 0 };
+            m_rhi->cmdBindVertexBuffersPFN(m_rhi->getCurrentCommandBuffer(),
+                                           0,
+                                           1,
+                                           vertex_buffers,
+                                           offsets);
+            m_rhi->cmdBindIndexBufferPFN(m_rhi->getCurrentCommandBuffer(),
+                                         mesh.mesh_index_buffer,
+                                         0,
+                                         RHI_INDEX_TYPE_UINT16);
+
+            uint32_t drawcall_max_instance_count =
+                (sizeof(MeshInefficientPickPerdrawcallStorageBufferObject::model_matrices) /
+                 sizeof(MeshInefficientPickPerdrawcallStorageBufferObject::model_matrices[0]));
+            uint32_t drawcall_count =
+                roundUp(total_instance_count, drawcall_max_instance_count) / drawcall_max_instance_count;
+
+            for (uint32_t drawcall_index = 0; drawcall_index < drawcall_count; ++drawcall_index)
             {
-                VulkanMesh& mesh       = (*pair2.first);
-                auto&       mesh_nodes = pair2.second;
+                uint32_t current_instance_count =
+                    ((total_instance_count - drawcall_max_instance_count * drawcall_index) <
+                     drawcall_max_instance_count) ?
+                        (total_instance_count - drawcall_max_instance_count * drawcall_index) :
+                        drawcall_max_instance_count;
+
+                // perdrawcall storage buffer
+                uint32_t perdrawcall_dynamic_offset =
+                    roundUp(m_global_render_resource->_storage_buffer
+                                ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
+                            m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
+                m_global_render_resource->_storage_buffer
+                    ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
+                    perdrawcall_dynamic_offset + sizeof(MeshInefficientPickPerdrawcallStorageBufferObject);
+                assert(m_global_render_resource->_storage_buffer
+                           ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
+                       (m_global_render_resource->_storage_buffer
+                            ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
+                        m_global_render_resource->_storage_buffer
+                            ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
+
+                MeshInefficientPickPerdrawcallStorageBufferObject& perdrawcall_storage_buffer_object =
+                    (*reinterpret_cast<MeshInefficientPickPerdrawcallStorageBufferObject*>(
+                        reinterpret_cast<uintptr_t>(m_global_render_resource->_storage_buffer
+                                                        ._global_upload_ringbuffer_memory_pointer) +
+                        perdrawcall_dynamic_offset));
+                for (uint32_t i = 0; i < current_instance_count; ++i)
+                {
+                    perdrawcall_storage_buffer_object.model_matrices[i] =
+                        *mesh_nodes[drawcall_max_instance_count * drawcall_index + i].model_matrix;
+                    perdrawcall_storage_buffer_object.node_ids[i] =
+                        mesh_nodes[drawcall_max_instance_count * drawcall_index + i].node_id;
+                }
 
-                uint32_t total_instance_count = static_cast<uint32_t>(mesh_nodes.size());
-                if (total_instance_count > 0)
+                // per drawcall vertex blending storage buffer
+                uint32_t per_drawcall_vertex_blending_dynamic_offset;
+                if (mesh.enable_vertex_blending)
                 {
-                    // bind per mesh
-                    m_rhi->cmdBindDescriptorSetsPFN(m_rhi->getCurrentCommandBuffer(),
-                                                    RHI_PIPELINE_BIND_POINT_GRAPHICS,
-                                                    m_render_pipelines[0].layout,
-                                                    1,
-                                                    1,
-                                                    &mesh.mesh_vertex_blending_descriptor_set,
-                                                    0,
-                                                    NULL);
-
-                    RHIBuffer* vertex_buffers[] = { mesh.mesh_vertex_position_buffer };
-                    RHIDeviceSize offsets[] = { 0 };
-                    m_rhi->cmdBindVertexBuffersPFN(m_rhi->getCurrentCommandBuffer(),
-                                                   0,
-                                                   1,
-                                                   vertex_buffers,
-                                                   offsets);
-                    m_rhi->cmdBindIndexBufferPFN(m_rhi->getCurrentCommandBuffer(),
-                                                 mesh.mesh_index_buffer,
-                                                 0,
-                                                 RHI_INDEX_TYPE_UINT16);
-
-                    uint32_t drawcall_max_instance_count =
-                        (sizeof(MeshInefficientPickPerdrawcallStorageBufferObject::model_matrices) /
-                         sizeof(MeshInefficientPickPerdrawcallStorageBufferObject::model_matrices[0]));
-                    uint32_t drawcall_count =
-                        roundUp(total_instance_count, drawcall_max_instance_count) / drawcall_max_instance_count;
-
-                    for (uint32_t drawcall_index = 0; drawcall_index < drawcall_count; ++drawcall_index)
-                    {
-                        uint32_t current_instance_count =
-                            ((total_instance_count - drawcall_max_instance_count * drawcall_index) <
-                             drawcall_max_instance_count) ?
-                                (total_instance_count - drawcall_max_instance_count * drawcall_index) :
-                                drawcall_max_instance_count;
-
-                        // perdrawcall storage buffer
-                        uint32_t perdrawcall_dynamic_offset =
-                            roundUp(m_global_render_resource->_storage_buffer
-                                        ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                                    m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-                        m_global_render_resource->_storage_buffer
-                            ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-                            perdrawcall_dynamic_offset + sizeof(MeshInefficientPickPerdrawcallStorageBufferObject);
-                        assert(m_global_render_resource->_storage_buffer
-                                   ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-                               (m_global_render_resource->_storage_buffer
-                                    ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                                m_global_render_resource->_storage_buffer
-                                    ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
-
-                        MeshInefficientPickPerdrawcallStorageBufferObject& perdrawcall_storage_buffer_object =
-                            (*reinterpret_cast<MeshInefficientPickPerdrawcallStorageBufferObject*>(
+                    per_drawcall_vertex_blending_dynamic_offset =
+                        roundUp(m_global_render_resource->_storage_buffer
+                                    ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
+                                m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
+                    m_global_render_resource->_storage_buffer
+                        ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
+                        per_drawcall_vertex_blending_dynamic_offset +
+                        sizeof(MeshInefficientPickPerdrawcallVertexBlendingStorageBufferObject);
+                    assert(m_global_render_resource->_storage_buffer
+                               ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
+                           (m_global_render_resource->_storage_buffer
+                                ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
+                            m_global_render_resource->_storage_buffer
+                                ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
+
+                    MeshInefficientPickPerdrawcallVertexBlendingStorageBufferObject&
+                        per_drawcall_vertex_blending_storage_buffer_object =
+                            (*reinterpret_cast<
+                                MeshInefficientPickPerdrawcallVertexBlendingStorageBufferObject*>(
                                 reinterpret_cast<uintptr_t>(m_global_render_resource->_storage_buffer
                                                                 ._global_upload_ringbuffer_memory_pointer) +
-                                perdrawcall_dynamic_offset));
-                        for (uint32_t i = 0; i < current_instance_count; ++i)
-                        {
-                            perdrawcall_storage_buffer_object.model_matrices[i] =
-                                *mesh_nodes[drawcall_max_instance_count * drawcall_index + i].model_matrix;
-                            perdrawcall_storage_buffer_object.node_ids[i] =
-                                mesh_nodes[drawcall_max_instance_count * drawcall_index + i].node_id;
-                        }
-
-                        // per drawcall vertex blending storage buffer
-                        uint32_t per_drawcall_vertex_blending_dynamic_offset;
-                        if (mesh.enable_vertex_blending)
-                        {
-                            per_drawcall_vertex_blending_dynamic_offset =
-                                roundUp(m_global_render_resource->_storage_buffer
-                                            ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                                        m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-                            m_global_render_resource->_storage_buffer
-                                ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-                                per_drawcall_vertex_blending_dynamic_offset +
-                                sizeof(MeshInefficientPickPerdrawcallVertexBlendingStorageBufferObject);
-                            assert(m_global_render_resource->_storage_buffer
-                                       ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-                                   (m_global_render_resource->_storage_buffer
-                                        ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                                    m_global_render_resource->_storage_buffer
-                                        ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
-
-                            MeshInefficientPickPerdrawcallVertexBlendingStorageBufferObject&
-                                per_drawcall_vertex_blending_storage_buffer_object =
-                                    (*reinterpret_cast<
-                                        MeshInefficientPickPerdrawcallVertexBlendingStorageBufferObject*>(
-                                        reinterpret_cast<uintptr_t>(m_global_render_resource->_storage_buffer
-                                                                        ._global_upload_ringbuffer_memory_pointer) +
-                                        per_drawcall_vertex_blending_dynamic_offset));
-                            for (uint32_t i = 0; i < current_instance_count; ++i)
-                            {
-                                for (uint32_t j = 0;
-                                     j < mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_count;
-                                     ++j)
-                                {
-                                    per_drawcall_vertex_blending_storage_buffer_object
-                                        .joint_matrices[s_mesh_vertex_blending_max_joint_count * i + j] =
-                                        mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices[j];
-                                }
-                            }
-                        }
-                        else
+                                per_drawcall_vertex_blending_dynamic_offset));
+                    for (uint32_t i = 0; i < current_instance_count; ++i)
+                    {
+                        for (uint32_t j = 0;
+                             j < mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_count;
+                             ++j)
                         {
-                            per_drawcall_vertex_blending_dynamic_offset = 0;
+                            per_drawcall_vertex_blending_storage_buffer_object
+                                .joint_matrices[s_mesh_vertex_blending_max_joint_count * i + j] =
+                                mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices[j];
                         }
-
-                        // bind perdrawcall
-                        uint32_t dynamic_offsets[3] = {perframe_dynamic_offset,
-                                                       perdrawcall_dynamic_offset,
-                                                       per_drawcall_vertex_blending_dynamic_offset};
-                        m_rhi->cmdBindDescriptorSetsPFN(m_rhi->getCurrentCommandBuffer(),
-                                                        RHI_PIPELINE_BIND_POINT_GRAPHICS,
-                                                        m_render_pipelines[0].layout,
-                                                        0,
-                                                        1,
-                                                        &m_descriptor_infos[0].descriptor_set,
-                                                        sizeof(dynamic_offsets) / sizeof(dynamic_offsets[0]),
-                                                        dynamic_offsets);
-
-                        m_rhi->cmdDrawIndexedPFN(m_rhi->getCurrentCommandBuffer(),
-                                                 mesh.mesh_index_count,
-                                                 current_instance_count,
-                                                 0,
-                                                 0,
-                                                 0);
                     }
                 }
+                else
+                {
+                    per_drawcall_vertex_blending_dynamic_offset = 0;
+                }
+
+                // bind perdrawcall
+                uint32_t dynamic_offsets[3] = {perframe_dynamic_offset,
+                                               perdrawcall_dynamic_offset,
+                                               per_drawcall_vertex_blending_dynamic_offset};
+                m_rhi->cmdBindDescriptorSetsPFN(m_rhi->getCurrentCommandBuffer(),
+                                                RHI_PIPELINE_BIND_POINT_GRAPHICS,
+                                                m_render_pipelines[0].layout,
+                                                0,
+                                                1,
+                                                &m_descriptor_infos[0].descriptor_set,
+                                                sizeof(dynamic_offsets) / sizeof(dynamic_offsets[0]),
+                                                dynamic_offsets);
+
+                m_rhi->cmdDrawIndexedPFN(m_rhi->getCurrentCommandBuffer(),
+                                         mesh.mesh_index_count,
+                                         current_instance_count,
+                                         0,
+                                         0,
+                                         0);
             }
         }
 
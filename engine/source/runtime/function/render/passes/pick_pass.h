@@ -1,6 +1,7 @@
 #pragma once
 
 #include "runtime/core/math/vector2.h"
+#include "runtime/function/render/render_draw_list.h"
 #include "runtime/function/render/render_pass.h"
 
 namespace Piccolo
@@ -16,6 +17,7 @@ namespace Piccolo
     {
     public:
         void initialize(const RenderPassInitInfo* init_info) override final;
+        void setupPipelines() override final;
         void postInitialize() override final;
         void preparePassData(std::shared_ptr<RenderResourceBase> render_resource) override final;
         void draw() override final;
@@ -30,7 +32,6 @@ namespace Piccolo
         void setupRenderPass();
         void setupFramebuffer();
         void setupDescriptorSetLayout();
-        void setupPipelines();
         void setupDescriptorSet();
 
     private:
@@ -39,5 +40,7 @@ namespace Piccolo
         RHIImageView*      _object_id_image_view = nullptr;
 
         RHIDescriptorSetLayout* _per_mesh_layout = nullptr;
+
+        RenderDrawList m_mesh_draw_list;
     };
 } // namespace Piccolo
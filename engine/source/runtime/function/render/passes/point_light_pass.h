@@ -1,15 +1,24 @@
 #pragma once
 
+#include "runtime/function/render/render_draw_list.h"
 #include "runtime/function/render/render_pass.h"
 
 namespace Piccolo
 {
     class RenderResourceBase;
 
+    struct PointLightShadowPassInitInfo : RenderPassInitInfo
+    {
+        // the depth attachment is only used inside the pass, the render graph owns it and aliases its memory
+        RHIImage*     depth_image {nullptr};
+        RHIImageView* depth_image_view {nullptr};
+    };
+
     class PointLightShadowPass : public RenderPass
     {
     public:
         void initialize(const RenderPassInitInfo* init_info) override final;
+        void setupPipelines() override final;
         void postInitialize() override final;
         void preparePassData(std::shared_ptr<RenderResourceBase> render_resource) override final;
         void draw() override final;
@@ -21,12 +30,12 @@ namespace Piccolo
         void setupRenderPass();
         void setupFramebuffer();
         void setupDescriptorSetLayout();
-        void setupPipelines();
         void setupDescriptorSet();
         void drawModel();
 
     private:
         RHIDescriptorSetLayout* m_per_mesh_layout;
         MeshPointLightShadowPerframeStorageBufferObject m_mesh_point_light_shadow_perframe_storage_buffer_object;
+        RenderDrawList                                  m_mesh_draw_list;
     };
 } // namespace Piccolo
@@ -179,24 +179,31 @@ namespace Piccolo
 
         uint32_t mesh_vertex_count;
 
-        RHIBuffer*    mesh_vertex_position_buffer;
-        VmaAllocation mesh_vertex_position_buffer_allocation;
+        RHIBuffer*    mesh_vertex_position_buffer {nullptr};
+        VmaAllocation mesh_vertex_position_buffer_allocation {VK_NULL_HANDLE};
 
-        RHIBuffer*    mesh_vertex_varying_enable_blending_buffer;
-        VmaAllocation mesh_vertex_varying_enable_blending_buffer_allocation;
+        RHIBuffer*    mesh_vertex_varying_enable_blending_buffer {nullptr};
+        VmaAllocation mesh_vertex_varying_enable_blending_buffer_allocation {VK_NULL_HANDLE};
 
-        RHIBuffer*    mesh_vertex_joint_binding_buffer;
-        VmaAllocation mesh_vertex_joint_binding_buffer_allocation;
+        // only meshes with vertex blending have a joint binding buffer
+        RHIBuffer*    mesh_vertex_joint_binding_buffer {nullptr};
+        VmaAllocation mesh_vertex_joint_binding_buffer_allocation {VK_NULL_HANDLE};
 
-        RHIDescriptorSet* mesh_vertex_blending_descriptor_set;
+        RHIDescriptorSet* mesh_vertex_blending_descriptor_set {nullptr};
 
-        RHIBuffer*    mesh_vertex_varying_buffer;
-        VmaAllocation mesh_vertex_varying_buffer_allocation;
+        RHIBuffer*    mesh_vertex_varying_buffer {nullptr};
+        VmaAllocation mesh_vertex_varying_buffer_allocation {VK_NULL_HANDLE};
 
         uint32_t mesh_index_count;
 
-        RHIBuffer*    mesh_index_buffer;
-        VmaAllocation mesh_index_buffer_allocation;
+        RHIBuffer*    mesh_index_buffer {nullptr};
+        VmaAllocation mesh_index_buffer_allocation {VK_NULL_HANDLE};
+
+        // upload batch holding the last copy into the buffers above
+        uint64_t upload_ticket {0};
+
+        // the mesh asset id, packed into the draw sort keys. asset ids are dense and unique among the live meshes
+        uint32_t sort_id {0};
     };
 
     // material
@@ -226,6 +233,12 @@ namespace Piccolo
         VmaAllocation   material_uniform_buffer_allocation;
 
         RHIDescriptorSet* material_descriptor_set;
+
+        // upload batch holding the last copy into the images and the uniform buffer above
+        uint64_t upload_ticket {0};
+
+        // dense index in creation order, packed into the draw sort keys
+        uint32_t sort_id {0};
     };
 
     // nodes
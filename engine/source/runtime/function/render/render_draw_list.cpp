@@ -0,0 +1,164 @@
+#include "runtime/function/render/render_draw_list.h"
+
+#include "runtime/core/base/macro.h"
+#include "runtime/core/math/math.h"
+
+#include <algorithm>
+#include <array>
+
+namespace Piccolo
+{
+    namespace
+    {
+        constexpr uint32_t k_pass_shift     = 60;
+        constexpr uint32_t k_pipeline_shift = 56;
+        constexpr uint32_t k_material_shift = 36;
+        constexpr uint32_t k_mesh_shift     = 16;
+
+        constexpr uint64_t k_pass_mask     = 0xF;
+        constexpr uint64_t k_pipeline_mask = 0xF;
+        constexpr uint64_t k_material_mask = RenderDrawList::s_max_sort_id;
+        constexpr uint64_t k_mesh_mask     = RenderDrawList::s_max_sort_id;
+        constexpr uint64_t k_depth_mask    = 0xFFFF;
+
+        // distance along the view, for a perspective projection clip w grows with the distance and for an
+        // orthographic one clip w is 1 and clip z does
+        float getViewDepth(const Matrix4x4& proj_view_matrix, const Matrix4x4& model_matrix)
+        {
+            Vector4 clip_position = proj_view_matrix * Vector4(model_matrix.getTrans(), 1.0f);
+
+            const bool is_perspective = proj_view_matrix[3][0] != 0.0f || proj_view_matrix[3][1] != 0.0f ||
+                                        proj_view_matrix[3][2] != 0.0f;
+            return is_perspective ? clip_position.w : clip_position.z;
+        }
+    } // namespace
+
+    void RenderDrawList::build(const std::vector<RenderMeshNode>& nodes,
+                               RenderDrawPassType                 pass,
+                               uint8_t                            pipeline,
+                               bool                               is_material_bound,
+                               const Matrix4x4*                   proj_view_matrix)
+    {
+        m_packets.clear();
+        m_batches.clear();
+        m_depths.clear();
+
+        if (nodes.empty())
+        {
+            return;
+        }
+
+        // the depth buckets spread over the range of this frame
+        float min_depth = Math_POS_INFINITY;
+        float max_depth = Math_NEG_INFINITY;
+        if (proj_view_matrix)
+        {
+            m_depths.reserve(nodes.size());
+            for (const RenderMeshNode& node : nodes)
+            {
+                float depth = getViewDepth(*proj_view_matrix, *node.model_matrix);
+                m_depths.push_back(depth);
+                min_depth = std::min(min_depth, depth);
+                max_depth = std::max(max_depth, depth);
+            }
+        }
+        const float depth_scale =
+            max_depth > min_depth ? static_cast<float>(k_depth_mask) / (max_depth - min_depth) : 0.0f;
+
+        const uint64_t state_key = ((static_cast<uint64_t>(pass) & k_pass_mask) << k_pass_shift) |
+                                   ((static_cast<uint64_t>(pipeline) & k_pipeline_mask) << k_pipeline_shift);
+
+        m_packets.reserve(nodes.size());
+        for (size_t node_index = 0; node_index < nodes.size(); ++node_index)
+        {
+            const RenderMeshNode& node = nodes[node_index];
+
+            // the render resource logs the ids which do not fit when it creates them
+            ASSERT(!is_material_bound || node.ref_material->sort_id <= k_material_mask);
+            ASSERT(node.ref_mesh->sort_id <= k_mesh_mask);
+
+            uint64_t material_id  = is_material_bound ? (node.ref_material->sort_id & k_material_mask) : 0;
+            uint64_t mesh_id      = node.ref_mesh->sort_id & k_mesh_mask;
+            uint64_t depth_bucket = 0;
+            if (proj_view_matrix)
+            {
+                depth_bucket = static_cast<uint64_t>((m_depths[node_index] - min_depth) * depth_scale) & k_depth_mask;
+            }
+
+            RenderDrawPacket packet;
+            packet.sort_key = state_key | (material_id << k_material_shift) | (mesh_id << k_mesh_shift) | depth_bucket;
+            packet.mesh         = node.ref_mesh;
+            packet.material     = node.ref_material;
+            packet.model_matrix = node.model_matrix;
+            packet.node_id      = node.node_id;
+            if (node.enable_vertex_blending)
+            {
+                packet.joint_matrices = node.joint_matrices;
+                packet.joint_count    = node.joint_count;
+            }
+            m_packets.push_back(packet);
+        }
+
+        sortPackets();
+
+        // merge the runs of equal state into instanced draws
+        const uint64_t batch_key_mask = ~k_depth_mask;
+        for (uint32_t packet_index = 0; packet_index < m_packets.size(); ++packet_index)
+        {
+            const RenderDrawPacket& packet = m_packets[packet_index];
+            if (m_batches.empty() || (m_packets[m_batches.back().first_packet].sort_key & batch_key_mask) !=
+                                         (packet.sort_key & batch_key_mask))
+            {
+                RenderDrawBatch batch;
+                batch.material     = packet.material;
+                batch.mesh         = packet.mesh;
+                batch.first_packet = packet_index;
+                m_batches.push_back(batch);
+            }
+            ++m_batches.back().packet_count;
+        }
+    }
+
+    void RenderDrawList::sortPackets()
+    {
+        // least significant digit first radix sort on 8 bit digits, it is stable so equal keys keep the order of the
+        // visible node list. the digits all keys share are skipped, typically pass, pipeline and the high id bytes
+        constexpr uint32_t k_radix_bits  = 8;
+        constexpr uint32_t k_radix_size  = 1 << k_radix_bits;
+        constexpr uint32_t k_digit_count = 64 / k_radix_bits;
+
+        const size_t packet_count = m_packets.size();
+        m_sort_scratch.resize(packet_count);
+
+        std::array<uint32_t, k_radix_size> histogram;
+        for (uint32_t digit = 0; digit < k_digit_count; ++digit)
+        {
+            const uint32_t shift = digit * k_radix_bits;
+
+            histogram.fill(0);
+            for (const RenderDrawPacket& packet : m_packets)
+            {
+                ++histogram[(packet.sort_key >> shift) & (k_radix_size - 1)];
+            }
+
+            if (histogram[(m_packets[0].sort_key >> shift) & (k_radix_size - 1)] == packet_count)
+            {
+                continue;
+            }
+
+            uint32_t offset = 0;
+            for (uint32_t& bucket : histogram)
+            {
+                uint32_t bucket_count = bucket;
+                bucket                = offset;
+                offset += bucket_count;
+            }
+
+            for (const RenderDrawPacket& packet : m_packets)
+            {
+                m_sort_scratch[histogram[(packet.sort_key >> shift) & (k_radix_size - 1)]++] = packet;
+            }
+            m_packets.swap(m_sort_scratch);
+        }
+    }
+} // namespace Piccolo
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "runtime/core/math/matrix4.h"
+#include "runtime/function/render/render_common.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Piccolo
+{
+    enum RenderDrawPassType : uint8_t
+    {
+        _render_draw_pass_main_camera = 0,
+        _render_draw_pass_directional_light_shadow,
+        _render_draw_pass_point_light_shadow,
+        _render_draw_pass_pick
+    };
+
+    /// one visible mesh node, the instance data is what the per drawcall storage buffers need
+    struct RenderDrawPacket
+    {
+        uint64_t           sort_key {0};
+        VulkanMesh*        mesh {nullptr};
+        VulkanPBRMaterial* material {nullptr};
+        const Matrix4x4*   model_matrix {nullptr};
+        const Matrix4x4*   joint_matrices {nullptr};
+        uint32_t           joint_count {0};
+        uint32_t           node_id {0};
+    };
+
+    /// consecutive packets with the same state, drawn instanced
+    struct RenderDrawBatch
+    {
+        VulkanPBRMaterial* material {nullptr};
+        VulkanMesh*        mesh {nullptr};
+        uint32_t           first_packet {0};
+        uint32_t           packet_count {0};
+    };
+
+    /// flat, per frame sorted list of the draws of a mesh pass
+    ///
+    /// the 64 bit key holds from the most significant bit pass (4), pipeline (4), material (20), mesh (20) and depth
+    /// bucket (16), so sorting it groups the draws by state and orders the instances of a batch from near to far.
+    /// the vectors keep their capacity between frames
+    class RenderDrawList
+    {
+    public:
+        /// the largest mesh or material sort id the key holds, larger ids would merge unrelated draws into a batch
+        static constexpr uint32_t s_max_sort_id = 0xFFFFF;
+
+        /// passes which do not bind materials merge the draws of a mesh across materials, the depth bucket stays 0
+        /// without proj_view_matrix
+        void build(const std::vector<RenderMeshNode>& nodes,
+                   RenderDrawPassType                 pass,
+                   uint8_t                            pipeline,
+                   bool                               is_material_bound,
+                   const Matrix4x4*                   proj_view_matrix);
+
+        const std::vector<RenderDrawPacket>& getPackets() const { return m_packets; }
+        const std::vector<RenderDrawBatch>&  getBatches() const { return m_batches; }
+
+    private:
+        void sortPackets();
+
+        std::vector<RenderDrawPacket> m_packets;
+        std::vector<RenderDrawPacket> m_sort_scratch;
+        std::vector<float>            m_depths;
+        std::vector<RenderDrawBatch>  m_batches;
+    };
+} // namespace Piccolo
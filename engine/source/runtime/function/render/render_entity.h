@@ -3,6 +3,8 @@
 #include "runtime/core/math/axis_aligned.h"
 #include "runtime/core/math/matrix4.h"
 
+#include "runtime/function/render/render_entity_handle_allocator.h"
+
 #include <cstdint>
 #include <vector>
 
@@ -11,8 +13,9 @@ namespace Piccolo
     class RenderEntity
     {
     public:
-        uint32_t  m_instance_id {0};
-        Matrix4x4 m_model_matrix {Matrix4x4::IDENTITY};
+        uint32_t           m_instance_id {0};
+        RenderEntityHandle m_render_entity_handle {k_invalid_render_entity_handle};
+        Matrix4x4          m_model_matrix {Matrix4x4::IDENTITY};
 
         // mesh
         size_t                 m_mesh_asset_id {0};
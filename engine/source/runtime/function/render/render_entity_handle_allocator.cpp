@@ -0,0 +1,39 @@
+#include "runtime/function/render/render_entity_handle_allocator.h"
+
+#include "core/base/macro.h"
+
+namespace Piccolo
+{
+    std::mutex                      RenderEntityHandleAllocator::m_mutex;
+    RenderEntityHandle              RenderEntityHandleAllocator::m_next_handle {0};
+    std::vector<RenderEntityHandle> RenderEntityHandleAllocator::m_free_handles;
+
+    RenderEntityHandle RenderEntityHandleAllocator::alloc()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!m_free_handles.empty())
+        {
+            const RenderEntityHandle handle = m_free_handles.back();
+            m_free_handles.pop_back();
+            return handle;
+        }
+
+        if (m_next_handle == k_invalid_render_entity_handle)
+        {
+            LOG_FATAL("render entity handle overflow");
+        }
+        return m_next_handle++;
+    }
+
+    void RenderEntityHandleAllocator::free(RenderEntityHandle handle)
+    {
+        if (handle == k_invalid_render_entity_handle)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free_handles.push_back(handle);
+    }
+} // namespace Piccolo
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace Piccolo
+{
+    using RenderEntityHandle = uint32_t;
+
+    constexpr RenderEntityHandle k_invalid_render_entity_handle = std::numeric_limits<uint32_t>::max();
+
+    /// names a render entity from the logic side for its whole life
+    ///
+    /// the handles stay small and dense, freed handles are given out again first, so the render scene finds the
+    /// entity of a handle by indexing an array
+    class RenderEntityHandleAllocator
+    {
+    public:
+        static RenderEntityHandle alloc();
+        static void               free(RenderEntityHandle handle);
+
+    private:
+        static std::mutex                      m_mutex;
+        static RenderEntityHandle              m_next_handle;
+        static std::vector<RenderEntityHandle> m_free_handles;
+    };
+} // namespace Piccolo
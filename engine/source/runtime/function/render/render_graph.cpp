@@ -0,0 +1,536 @@
+#include "runtime/function/render/render_graph.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+
+namespace Piccolo
+{
+    namespace
+    {
+        struct AccessInfo
+        {
+            RHIPipelineStageFlags stages;
+            RHIAccessFlags        access_mask;
+            RHIImageLayout        layout;
+            bool                  is_attachment;
+        };
+
+        AccessInfo getAccessInfo(RenderGraphAccess access)
+        {
+            switch (access)
+            {
+                case RenderGraphAccess::color_attachment_write:
+                    return {RHI_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                            RHI_ACCESS_COLOR_ATTACHMENT_READ_BIT | RHI_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                            RHI_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                            true};
+                case RenderGraphAccess::depth_stencil_attachment_write:
+                    return {RHI_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | RHI_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                            RHI_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                                RHI_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                            RHI_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                            true};
+                case RenderGraphAccess::fragment_shader_read:
+                    return {RHI_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                            RHI_ACCESS_SHADER_READ_BIT,
+                            RHI_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                            false};
+                case RenderGraphAccess::compute_shader_read:
+                    return {RHI_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                            RHI_ACCESS_SHADER_READ_BIT,
+                            RHI_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                            false};
+                case RenderGraphAccess::compute_shader_write:
+                    return {RHI_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                            RHI_ACCESS_SHADER_WRITE_BIT,
+                            RHI_IMAGE_LAYOUT_GENERAL,
+                            false};
+                case RenderGraphAccess::transfer_read:
+                    return {RHI_PIPELINE_STAGE_TRANSFER_BIT,
+                            RHI_ACCESS_TRANSFER_READ_BIT,
+                            RHI_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                            false};
+                case RenderGraphAccess::transfer_write:
+                default:
+                    return {RHI_PIPELINE_STAGE_TRANSFER_BIT,
+                            RHI_ACCESS_TRANSFER_WRITE_BIT,
+                            RHI_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            false};
+            }
+        }
+
+        // layout transitions of a depth stencil image must cover both aspects
+        RHIImageAspectFlags getBarrierAspect(const RenderGraphImageDesc& desc)
+        {
+            if (desc.format == RHI_FORMAT_D16_UNORM_S8_UINT || desc.format == RHI_FORMAT_D24_UNORM_S8_UINT ||
+                desc.format == RHI_FORMAT_D32_SFLOAT_S8_UINT)
+            {
+                return desc.aspect | RHI_IMAGE_ASPECT_STENCIL_BIT;
+            }
+            return desc.aspect;
+        }
+    } // namespace
+
+    void RenderGraphBuilder::read(RenderGraphResource resource, RenderGraphAccess access)
+    {
+        m_graph.m_passes[m_pass_index].accesses.push_back({resource, access, RHI_IMAGE_LAYOUT_UNDEFINED, false});
+    }
+
+    void RenderGraphBuilder::write(RenderGraphResource resource, RenderGraphAccess access, RHIImageLayout final_layout)
+    {
+        m_graph.m_passes[m_pass_index].accesses.push_back({resource, access, final_layout, true});
+    }
+
+    void RenderGraphBuilder::setSideEffect() { m_graph.m_passes[m_pass_index].has_side_effect = true; }
+
+    void RenderGraph::initialize(std::shared_ptr<RHI> rhi) { m_rhi = rhi; }
+
+    void RenderGraph::clear()
+    {
+        for (Resource& resource : m_resources)
+        {
+            if (!resource.is_transient)
+            {
+                continue;
+            }
+
+            if (resource.image_view != nullptr)
+            {
+                m_rhi->destroyImageView(resource.image_view);
+            }
+            if (resource.image != nullptr)
+            {
+                m_rhi->destroyImage(resource.image);
+            }
+        }
+
+        for (MemorySlot& memory_slot : m_memory_slots)
+        {
+            if (memory_slot.memory != nullptr)
+            {
+                m_rhi->freeMemory(memory_slot.memory);
+            }
+        }
+
+        m_resources.clear();
+        m_passes.clear();
+        m_memory_slots.clear();
+        m_aliased_memory_size = 0;
+        m_is_compiled         = false;
+    }
+
+    RenderGraphResource RenderGraph::importImage(const char*         name,
+                                                 RHIImageLayout      initial_layout,
+                                                 RHIImageAspectFlags aspect,
+                                                 uint32_t            array_layers,
+                                                 bool                is_output)
+    {
+        ASSERT(!m_is_compiled);
+
+        Resource resource;
+        resource.name              = name;
+        resource.is_output         = is_output;
+        resource.initial_layout    = initial_layout;
+        resource.desc.aspect       = aspect;
+        resource.desc.array_layers = array_layers;
+        m_resources.push_back(resource);
+
+        return static_cast<RenderGraphResource>(m_resources.size() - 1);
+    }
+
+    void RenderGraph::setImportedImage(RenderGraphResource resource, RHIImage* image)
+    {
+        ASSERT(!m_resources[resource].is_transient);
+        m_resources[resource].image = image;
+    }
+
+    RenderGraphResource RenderGraph::createTransientImage(const char* name, const RenderGraphImageDesc& desc)
+    {
+        ASSERT(!m_is_compiled);
+
+        Resource resource;
+        resource.name         = name;
+        resource.is_transient = true;
+        resource.desc         = desc;
+        m_resources.push_back(resource);
+
+        return static_cast<RenderGraphResource>(m_resources.size() - 1);
+    }
+
+    RHIImage* RenderGraph::getImage(RenderGraphResource resource) const { return m_resources[resource].image; }
+
+    RHIImageView* RenderGraph::getImageView(RenderGraphResource resource) const
+    {
+        return m_resources[resource].image_view;
+    }
+
+    void RenderGraph::addPass(const char* name, const SetupCallback& setup, const ExecuteCallback& execute)
+    {
+        ASSERT(!m_is_compiled);
+
+        Pass pass;
+        pass.name    = name;
+        pass.execute = execute;
+        m_passes.push_back(pass);
+
+        RenderGraphBuilder builder(*this, static_cast<uint32_t>(m_passes.size() - 1));
+        setup(builder);
+    }
+
+    void RenderGraph::compile()
+    {
+        ASSERT(!m_is_compiled);
+
+        cullPasses();
+        allocateTransientImages();
+        computeBarriers();
+
+        m_is_compiled = true;
+    }
+
+    void RenderGraph::execute(RHICommandBuffer* command_buffer)
+    {
+        ASSERT(m_is_compiled);
+
+        std::vector<RHIImageMemoryBarrier> barriers;
+        for (Pass& pass : m_passes)
+        {
+            if (pass.is_culled)
+            {
+                continue;
+            }
+
+            // imported images without an image are synchronized by their owner
+            barriers.clear();
+            for (size_t barrier_index = 0; barrier_index < pass.barriers.size(); ++barrier_index)
+            {
+                RHIImage* image = m_resources[pass.barrier_resources[barrier_index]].image;
+                if (image != nullptr)
+                {
+                    barriers.push_back(pass.barriers[barrier_index]);
+                    barriers.back().image = image;
+                }
+            }
+
+            if (!barriers.empty())
+            {
+                m_rhi->cmdPipelineBarrier(command_buffer,
+                                          pass.src_stage_mask,
+                                          pass.dst_stage_mask,
+                                          0,
+                                          0,
+                                          nullptr,
+                                          0,
+                                          nullptr,
+                                          static_cast<uint32_t>(barriers.size()),
+                                          barriers.data());
+            }
+
+            pass.execute(command_buffer);
+        }
+    }
+
+    void RenderGraph::cullPasses()
+    {
+        // walk backwards from the outputs, a pass lives if a later live pass or an output needs one of its writes
+        std::vector<bool> is_needed(m_resources.size());
+        for (size_t resource_index = 0; resource_index < m_resources.size(); ++resource_index)
+        {
+            is_needed[resource_index] = m_resources[resource_index].is_output;
+        }
+
+        for (size_t pass_index = m_passes.size(); pass_index-- > 0;)
+        {
+            Pass& pass = m_passes[pass_index];
+
+            bool is_alive = pass.has_side_effect;
+            for (const ResourceAccess& access : pass.accesses)
+            {
+                if (access.is_write && is_needed[access.resource])
+                {
+                    is_alive = true;
+                }
+            }
+
+            pass.is_culled = !is_alive;
+            if (pass.is_culled)
+            {
+                LOG_INFO("render graph culled pass {}", pass.name);
+                continue;
+            }
+
+            for (const ResourceAccess& access : pass.accesses)
+            {
+                if (!access.is_write)
+                {
+                    is_needed[access.resource] = true;
+                }
+            }
+        }
+    }
+
+    void RenderGraph::allocateTransientImages()
+    {
+        std::vector<RenderGraphResource> transient_resources;
+        for (uint32_t pass_index = 0; pass_index < m_passes.size(); ++pass_index)
+        {
+            if (m_passes[pass_index].is_culled)
+            {
+                continue;
+            }
+
+            for (const ResourceAccess& access : m_passes[pass_index].accesses)
+            {
+                Resource& resource = m_resources[access.resource];
+                if (!resource.is_transient)
+                {
+                    continue;
+                }
+
+                if (resource.first_pass == UINT32_MAX)
+                {
+                    resource.first_pass = pass_index;
+                    transient_resources.push_back(access.resource);
+                }
+                resource.last_pass = pass_index;
+            }
+        }
+
+        // first fit in order of first use, a slot is free once the last pass of its current image has run
+        RHIDeviceSize requested_memory_size = 0;
+        for (RenderGraphResource resource_handle : transient_resources)
+        {
+            Resource&                   resource = m_resources[resource_handle];
+            const RenderGraphImageDesc& desc     = resource.desc;
+
+            RHIMemoryRequirements requirements;
+            m_rhi->getImageMemoryRequirements(desc.width,
+                                              desc.height,
+                                              desc.format,
+                                              RHI_IMAGE_TILING_OPTIMAL,
+                                              desc.usage,
+                                              0,
+                                              desc.array_layers,
+                                              1,
+                                              requirements);
+            requested_memory_size += requirements.size;
+
+            uint32_t slot_index = UINT32_MAX;
+            for (uint32_t i = 0; i < m_memory_slots.size(); ++i)
+            {
+                if (m_memory_slots[i].last_pass < resource.first_pass &&
+                    (m_memory_slots[i].requirements.memoryTypeBits & requirements.memoryTypeBits) != 0)
+                {
+                    slot_index = i;
+                    break;
+                }
+            }
+
+            if (slot_index == UINT32_MAX)
+            {
+                MemorySlot memory_slot;
+                memory_slot.requirements   = requirements;
+                memory_slot.first_resource = resource_handle;
+                m_memory_slots.push_back(memory_slot);
+                slot_index = static_cast<uint32_t>(m_memory_slots.size() - 1);
+            }
+            else
+            {
+                RHIMemoryRequirements& slot_requirements = m_memory_slots[slot_index].requirements;
+                slot_requirements.size           = std::max(slot_requirements.size, requirements.size);
+                slot_requirements.alignment      = std::max(slot_requirements.alignment, requirements.alignment);
+                slot_requirements.memoryTypeBits = slot_requirements.memoryTypeBits & requirements.memoryTypeBits;
+            }
+
+            MemorySlot& memory_slot   = m_memory_slots[slot_index];
+            resource.memory_slot      = slot_index;
+            resource.aliased_resource = memory_slot.last_resource;
+            memory_slot.last_pass     = resource.last_pass;
+            memory_slot.last_resource = resource_handle;
+        }
+
+        // the previous frame may still be using the memory when the first image of a shared slot is written
+        for (const MemorySlot& memory_slot : m_memory_slots)
+        {
+            if (memory_slot.first_resource != memory_slot.last_resource)
+            {
+                m_resources[memory_slot.first_resource].aliased_resource = memory_slot.last_resource;
+            }
+        }
+
+        RHIDeviceSize allocated_memory_size = 0;
+        for (MemorySlot& memory_slot : m_memory_slots)
+        {
+            m_rhi->allocateAliasingMemory(
+                memory_slot.requirements, RHI_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, memory_slot.memory);
+            allocated_memory_size += memory_slot.requirements.size;
+        }
+
+        for (RenderGraphResource resource_handle : transient_resources)
+        {
+            Resource&                   resource = m_resources[resource_handle];
+            const RenderGraphImageDesc& desc     = resource.desc;
+
+            m_rhi->createAliasingImage(m_memory_slots[resource.memory_slot].memory,
+                                       desc.width,
+                                       desc.height,
+                                       desc.format,
+                                       RHI_IMAGE_TILING_OPTIMAL,
+                                       desc.usage,
+                                       0,
+                                       desc.array_layers,
+                                       1,
+                                       resource.image);
+            m_rhi->createImageView(
+                resource.image, desc.format, desc.aspect, desc.view_type, desc.array_layers, 1, resource.image_view);
+        }
+
+        m_aliased_memory_size = requested_memory_size - allocated_memory_size;
+        LOG_INFO("render graph: {} transient images in {} allocations, aliasing saves {} MB",
+                 transient_resources.size(),
+                 m_memory_slots.size(),
+                 m_aliased_memory_size / (1024 * 1024));
+    }
+
+    void RenderGraph::computeBarriers()
+    {
+        // what the passes so far left behind, reads since the last write are visible and need no barrier
+        struct ImageState
+        {
+            RHIPipelineStageFlags write_stages {0};
+            RHIAccessFlags        write_access {0};
+            RHIPipelineStageFlags read_stages {0};
+            RHIImageLayout        layout {RHI_IMAGE_LAYOUT_UNDEFINED};
+            bool                  has_access {false};
+        };
+
+        // everything a resource does in a frame, what the first image of a shared slot waits for from the last image
+        // of the previous frame
+        std::vector<ImageState> frame_states(m_resources.size());
+        for (const Pass& pass : m_passes)
+        {
+            if (pass.is_culled)
+            {
+                continue;
+            }
+
+            for (const ResourceAccess& access : pass.accesses)
+            {
+                AccessInfo info = getAccessInfo(access.access);
+                if (access.is_write)
+                {
+                    frame_states[access.resource].write_stages |= info.stages;
+                    frame_states[access.resource].write_access |= info.access_mask;
+                }
+                else
+                {
+                    frame_states[access.resource].read_stages |= info.stages;
+                }
+            }
+        }
+
+        std::vector<ImageState> states(m_resources.size());
+        for (size_t resource_index = 0; resource_index < m_resources.size(); ++resource_index)
+        {
+            const Resource& resource = m_resources[resource_index];
+            states[resource_index].layout =
+                resource.is_transient ? RHI_IMAGE_LAYOUT_UNDEFINED : resource.initial_layout;
+        }
+
+        for (Pass& pass : m_passes)
+        {
+            if (pass.is_culled)
+            {
+                continue;
+            }
+
+            for (const ResourceAccess& access : pass.accesses)
+            {
+                const Resource& resource = m_resources[access.resource];
+                ImageState&     state    = states[access.resource];
+                AccessInfo      info     = getAccessInfo(access.access);
+
+                bool                  needs_barrier = false;
+                RHIPipelineStageFlags src_stages    = 0;
+                RHIAccessFlags        src_access    = 0;
+                RHIImageLayout        old_layout    = state.layout;
+                RHIImageLayout        new_layout    = state.layout;
+
+                const bool needs_transition = !info.is_attachment && state.layout != info.layout;
+                if (resource.is_transient && !state.has_access && resource.aliased_resource != UINT32_MAX)
+                {
+                    // the memory was used by another image, wait for its last user and discard the contents
+                    const bool        is_previous_frame =
+                        m_resources[resource.aliased_resource].first_pass > resource.first_pass;
+                    const ImageState& aliased_state =
+                        is_previous_frame ? frame_states[resource.aliased_resource] : states[resource.aliased_resource];
+                    needs_barrier                   = true;
+                    src_stages                      = aliased_state.write_stages | aliased_state.read_stages;
+                    src_access                      = aliased_state.write_access;
+                    old_layout                      = RHI_IMAGE_LAYOUT_UNDEFINED;
+                    new_layout                      = info.layout;
+                }
+                else if (!access.is_write)
+                {
+                    // read after write, unless an earlier read in the same stages already waited
+                    const bool needs_visibility =
+                        state.write_stages != 0 && (state.read_stages & info.stages) != info.stages;
+                    if (needs_visibility || needs_transition)
+                    {
+                        needs_barrier = true;
+                        src_stages    = state.write_stages | (needs_transition ? state.read_stages : 0);
+                        src_access    = state.write_access;
+                        new_layout    = info.layout;
+                    }
+                }
+                else if (state.write_stages != 0 || state.read_stages != 0 || needs_transition)
+                {
+                    // write after write or after read, attachments keep their layout for the render pass
+                    needs_barrier = true;
+                    src_stages    = state.write_stages | state.read_stages;
+                    src_access    = state.write_access;
+                    new_layout    = info.is_attachment ? state.layout : info.layout;
+                }
+
+                if (needs_barrier)
+                {
+                    RHIImageMemoryBarrier barrier {};
+                    barrier.sType                           = RHI_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                    barrier.srcAccessMask                   = src_access;
+                    barrier.dstAccessMask                   = info.access_mask;
+                    barrier.oldLayout                       = old_layout;
+                    barrier.newLayout                       = new_layout;
+                    barrier.srcQueueFamilyIndex             = RHI_QUEUE_FAMILY_IGNORED;
+                    barrier.dstQueueFamilyIndex             = RHI_QUEUE_FAMILY_IGNORED;
+                    barrier.subresourceRange.aspectMask     = getBarrierAspect(resource.desc);
+                    barrier.subresourceRange.baseMipLevel   = 0;
+                    barrier.subresourceRange.levelCount     = 1;
+                    barrier.subresourceRange.baseArrayLayer = 0;
+                    barrier.subresourceRange.layerCount     = resource.desc.array_layers;
+
+                    pass.barriers.push_back(barrier);
+                    pass.barrier_resources.push_back(access.resource);
+                    pass.src_stage_mask |= src_stages != 0 ? src_stages : RHI_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                    pass.dst_stage_mask |= info.stages;
+                }
+
+                state.has_access = true;
+                if (access.is_write)
+                {
+                    state.write_stages = info.stages;
+                    state.write_access = info.access_mask;
+                    state.read_stages  = 0;
+                    state.layout       = (info.is_attachment && access.final_layout != RHI_IMAGE_LAYOUT_UNDEFINED) ?
+                                             access.final_layout :
+                                             info.layout;
+                }
+                else
+                {
+                    state.read_stages |= info.stages;
+                    state.layout = new_layout;
+                }
+            }
+        }
+    }
+} // namespace Piccolo
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "runtime/function/render/interface/rhi.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Piccolo
+{
+    class RHI;
+
+    using RenderGraphResource = uint32_t;
+
+    /// how a pass touches an image, it decides stages, access masks and layouts of the barriers before the pass
+    enum class RenderGraphAccess : uint8_t
+    {
+        color_attachment_write,
+        depth_stencil_attachment_write,
+        fragment_shader_read,
+        compute_shader_read,
+        compute_shader_write,
+        transfer_read,
+        transfer_write
+    };
+
+    struct RenderGraphImageDesc
+    {
+        uint32_t            width {0};
+        uint32_t            height {0};
+        RHIFormat           format {RHI_FORMAT_UNDEFINED};
+        RHIImageUsageFlags  usage {0};
+        RHIImageAspectFlags aspect {0};
+        RHIImageViewType    view_type {RHI_IMAGE_VIEW_TYPE_2D};
+        uint32_t            array_layers {1};
+    };
+
+    class RenderGraph;
+
+    /// handed to the setup callback of a pass to declare what the pass reads and writes
+    class RenderGraphBuilder
+    {
+    public:
+        void read(RenderGraphResource resource, RenderGraphAccess access);
+        /// attachments are transitioned by the render pass itself, final_layout is the layout it leaves them in
+        void write(RenderGraphResource resource,
+                   RenderGraphAccess   access,
+                   RHIImageLayout      final_layout = RHI_IMAGE_LAYOUT_UNDEFINED);
+        /// keep the pass even if nothing reads what it writes
+        void setSideEffect();
+
+    private:
+        friend class RenderGraph;
+
+        RenderGraphBuilder(RenderGraph& graph, uint32_t pass_index) : m_graph(graph), m_pass_index(pass_index) {}
+
+        RenderGraph& m_graph;
+        uint32_t     m_pass_index;
+    };
+
+    /// passes declare reads and writes of virtual images and run in the order they are added, compile
+    ///
+    /// - culls the passes whose writes never reach an output or a pass with side effects
+    /// - computes the barriers between passes from the declared accesses
+    /// - places transient images whose lifetimes do not overlap in the same memory
+    ///
+    /// the graph is compiled once, execute replays the barriers and passes into a command buffer every frame
+    class RenderGraph
+    {
+    public:
+        using SetupCallback   = std::function<void(RenderGraphBuilder&)>;
+        using ExecuteCallback = std::function<void(RHICommandBuffer*)>;
+
+        void initialize(std::shared_ptr<RHI> rhi);
+        void clear();
+
+        /// images owned elsewhere, the image may be bound after compile and may be null when the owner
+        /// synchronizes every access itself, like the swapchain images handled by the render pass dependencies
+        RenderGraphResource importImage(const char*         name,
+                                        RHIImageLayout      initial_layout,
+                                        RHIImageAspectFlags aspect,
+                                        uint32_t            array_layers,
+                                        bool                is_output);
+        void                setImportedImage(RenderGraphResource resource, RHIImage* image);
+
+        /// images owned by the graph, they exist after compile
+        RenderGraphResource createTransientImage(const char* name, const RenderGraphImageDesc& desc);
+        RHIImage*           getImage(RenderGraphResource resource) const;
+        RHIImageView*       getImageView(RenderGraphResource resource) const;
+
+        /// passes execute in the order they are added
+        void addPass(const char* name, const SetupCallback& setup, const ExecuteCallback& execute);
+
+        void compile();
+        void execute(RHICommandBuffer* command_buffer);
+
+        /// bytes the aliasing saves compared to one allocation per transient image
+        RHIDeviceSize getAliasedMemorySize() const { return m_aliased_memory_size; }
+
+    private:
+        friend class RenderGraphBuilder;
+
+        struct ResourceAccess
+        {
+            RenderGraphResource resource {0};
+            RenderGraphAccess   access {RenderGraphAccess::fragment_shader_read};
+            RHIImageLayout      final_layout {RHI_IMAGE_LAYOUT_UNDEFINED};
+            bool                is_write {false};
+        };
+
+        struct Pass
+        {
+            std::string                 name;
+            ExecuteCallback             execute;
+            std::vector<ResourceAccess> accesses;
+            bool                        has_side_effect {false};
+            bool                        is_culled {false};
+
+            // filled by compile, the images are looked up at execute time
+            std::vector<RenderGraphResource>   barrier_resources;
+            std::vector<RHIImageMemoryBarrier> barriers;
+            RHIPipelineStageFlags              src_stage_mask {0};
+            RHIPipelineStageFlags              dst_stage_mask {0};
+        };
+
+        struct Resource
+        {
+            std::string          name;
+            bool                 is_transient {false};
+            bool                 is_output {false};
+            RHIImageLayout       initial_layout {RHI_IMAGE_LAYOUT_UNDEFINED};
+            RenderGraphImageDesc desc;
+
+            RHIImage*     image {nullptr};
+            RHIImageView* image_view {nullptr};
+
+            // transient lifetime in pass indices and the image that used the memory before, for the first image of
+            // a shared slot that is the last image of the slot in the previous frame
+            uint32_t            first_pass {UINT32_MAX};
+            uint32_t            last_pass {0};
+            uint32_t            memory_slot {UINT32_MAX};
+            RenderGraphResource aliased_resource {UINT32_MAX};
+        };
+
+        struct MemorySlot
+        {
+            RHIMemoryRequirements requirements {};
+            RHIDeviceMemory*      memory {nullptr};
+            uint32_t              last_pass {0};
+            RenderGraphResource   first_resource {UINT32_MAX};
+            RenderGraphResource   last_resource {UINT32_MAX};
+        };
+
+        void cullPasses();
+        void allocateTransientImages();
+        void computeBarriers();
+
+        std::shared_ptr<RHI> m_rhi;
+
+        std::vector<Resource>   m_resources;
+        std::vector<Pass>       m_passes;
+        std::vector<MemorySlot> m_memory_slots;
+
+        RHIDeviceSize m_aliased_memory_size {0};
+        bool          m_is_compiled {false};
+    };
+} // namespace Piccolo
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <unordered_map>
+#include <vector>
 
 namespace Piccolo
 {
@@ -20,18 +21,21 @@ namespace Piccolo
                 return find_it->second;
             }
 
-            for (size_t i = 0; i < m_guid_elements_map.size() + 1; i++)
+            // freed guids are given out again first, so the guids stay small
+            size_t guid;
+            if (!m_free_guids.empty())
             {
-                size_t guid = i + 1;
-                if (m_guid_elements_map.find(guid) == m_guid_elements_map.end())
-                {
-                    m_guid_elements_map.insert(std::make_pair(guid, t));
-                    m_elements_guid_map.insert(std::make_pair(t, guid));
-                    return guid;
-                }
+                guid = m_free_guids.back();
+                m_free_guids.pop_back();
+            }
+            else
+            {
+                guid = m_guid_elements_map.size() + 1;
             }
 
-            return s_invalid_guid;
+            m_guid_elements_map.insert(std::make_pair(guid, t));
+            m_elements_guid_map.insert(std::make_pair(t, guid));
+            return guid;
         }
 
         bool getGuidRelatedElement(size_t guid, T& t)
@@ -63,9 +67,9 @@ namespace Piccolo
             auto find_it = m_guid_elements_map.find(guid);
             if (find_it != m_guid_elements_map.end())
             {
-                const auto& ele = find_it->second;
-                m_elements_guid_map.erase(ele);
-                m_guid_elements_map.erase(guid);
+                m_elements_guid_map.erase(find_it->second);
+                m_guid_elements_map.erase(find_it);
+                m_free_guids.push_back(guid);
             }
         }
 
@@ -74,9 +78,10 @@ namespace Piccolo
             auto find_it = m_elements_guid_map.find(t);
             if (find_it != m_elements_guid_map.end())
             {
-                const auto& guid = find_it->second;
-                m_elements_guid_map.erase(t);
+                const size_t guid = find_it->second;
+                m_elements_guid_map.erase(find_it);
                 m_guid_elements_map.erase(guid);
+                m_free_guids.push_back(guid);
             }
         }
 
@@ -94,11 +99,14 @@ namespace Piccolo
         {
             m_elements_guid_map.clear();
             m_guid_elements_map.clear();
+            m_free_guids.clear();
         }
 
     private:
         std::unordered_map<T, size_t> m_elements_guid_map;
         std::unordered_map<size_t, T> m_guid_elements_map;
+        // the guids from 1 to the allocated count plus the free count are either allocated or in here
+        std::vector<size_t> m_free_guids;
     };
 
 } // namespace Piccolo
@@ -206,29 +206,17 @@ namespace Piccolo
                           (b.max_bound.y - b.min_bound.y) * 0.5,
                           (b.max_bound.z - b.min_bound.z) * 0.5);
 
-        Vector3 min;
-        Vector3 max;
-
         // Compute and transform the corners and find new min/max bounds.
+        Vector3 corners[CORNER_COUNT];
         for (size_t i = 0; i < CORNER_COUNT; ++i)
         {
-            Vector3 corner_before = extents * g_BoxOffset[i] + center;
-            Vector4 corner_with_w = m * Vector4(corner_before.x, corner_before.y, corner_before.z, 1.0);
-            Vector3 corner        = Vector3(corner_with_w.x / corner_with_w.w,
-                                         corner_with_w.y / corner_with_w.w,
-                                         corner_with_w.z / corner_with_w.w);
-
-            if (0 == i)
-            {
-                min = corner;
-                max = corner;
-            }
-            else
-            {
-                min = Vector3(Math::min(min[0], corner[0]), Math::min(min[1], corner[1]), Math::min(min[2], corner[2]));
-                max = Vector3(Math::max(max[0], corner[0]), Math::max(max[1], corner[1]), Math::max(max[2], corner[2]));
-            }
+            corners[i] = extents * g_BoxOffset[i] + center;
         }
+        MathBatch::transformPoints(m, corners, corners, CORNER_COUNT);
+
+        Vector3 min = corners[0];
+        Vector3 max = corners[0];
+        MathBatch::computeBounds(corners, CORNER_COUNT, min, max);
 
         BoundingBox b_out;
         b_out.max_bound = max;
@@ -286,18 +274,10 @@ namespace Piccolo
             frustum_bounding_box.max_bound = Vector3(FLT_MIN, FLT_MIN, FLT_MIN);
 
             size_t const CORNER_COUNT = 8;
-            for (size_t i = 0; i < CORNER_COUNT; ++i)
-            {
-                Vector4 frustum_point_with_w = inverse_proj_view_matrix * Vector4(g_frustum_points_ndc_space[i].x,
-                                                                                      g_frustum_points_ndc_space[i].y,
-                                                                                      g_frustum_points_ndc_space[i].z,
-                                                                                      1.0);
-                Vector3   frustum_point        = Vector3(frustum_point_with_w.x / frustum_point_with_w.w,
-                                                frustum_point_with_w.y / frustum_point_with_w.w,
-                                                frustum_point_with_w.z / frustum_point_with_w.w);
-
-                frustum_bounding_box.merge(frustum_point);
-            }
+            Vector3      frustum_points[CORNER_COUNT];
+            MathBatch::transformPoints(
+                inverse_proj_view_matrix, g_frustum_points_ndc_space, frustum_points, CORNER_COUNT);
+            frustum_bounding_box.merge(frustum_points, CORNER_COUNT);
         }
 
         BoundingBox scene_bounding_box;
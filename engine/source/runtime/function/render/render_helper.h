@@ -1,5 +1,6 @@
 #pragma once
 
+#include "runtime/core/math/math_batch.h"
 #include "runtime/core/math/vector3.h"
 #include "runtime/core/math/vector4.h"
 
@@ -54,6 +55,11 @@ namespace Piccolo
             min_bound.makeFloor(point);
             max_bound.makeCeil(point);
         }
+
+        void merge(const Vector3* points, size_t count)
+        {
+            MathBatch::computeBounds(points, count, min_bound, max_bound);
+        }
     };
 
     struct BoundingSphere
@@ -2,6 +2,7 @@
 
 #include "runtime/core/math/matrix4.h"
 #include "runtime/function/framework/object/object_id_allocator.h"
+#include "runtime/function/render/render_entity_handle_allocator.h"
 
 #include <string>
 #include <vector>
@@ -65,6 +66,8 @@ namespace Piccolo
         bool                    m_with_animation {false};
         SkeletonBindingDesc     m_skeleton_binding_desc;
         SkeletonAnimationResult m_skeleton_animation_result;
+        // RenderEntityHandle of the render entity of the part
+        uint32_t m_render_entity_handle {k_invalid_render_entity_handle};
     };
 
     constexpr size_t k_invalid_part_id = std::numeric_limits<size_t>::max();
@@ -5,10 +5,13 @@
 namespace Piccolo
 {
     void RenderPassBase::postInitialize() {}
+    void RenderPassBase::setupPipelines() {}
     void RenderPassBase::setCommonInfo(RenderPassCommonInfo common_info)
     {
         m_rhi             = common_info.rhi;
         m_render_resource = common_info.render_resource;
+
+        m_recording_thread_pool = common_info.recording_thread_pool;
     }
     void RenderPassBase::preparePassData(std::shared_ptr<RenderResourceBase> render_resource) {}
     void RenderPassBase::initializeUIRenderBackend(WindowUI* window_ui) {}
@@ -6,6 +6,7 @@ namespace Piccolo
 {
     class RHI;
     class RenderResourceBase;
+    class ThreadPool;
     class WindowUI;
 
     struct RenderPassInitInfo
@@ -15,6 +16,8 @@ namespace Piccolo
     {
         std::shared_ptr<RHI>                rhi;
         std::shared_ptr<RenderResourceBase> render_resource;
+        // shared by the passes which record their draw lists into secondary command buffers
+        std::shared_ptr<ThreadPool>         recording_thread_pool;
     };
 
     class RenderPassBase
@@ -22,6 +25,8 @@ namespace Piccolo
     public:
         virtual void initialize(const RenderPassInitInfo* init_info) = 0;
         virtual void postInitialize();
+        // called by the pipeline after every pass is initialized, passes build their pipelines concurrently
+        virtual void setupPipelines();
         virtual void setCommonInfo(RenderPassCommonInfo common_info);
         virtual void preparePassData(std::shared_ptr<RenderResourceBase> render_resource);
         virtual void initializeUIRenderBackend(WindowUI* window_ui);
@@ -29,5 +34,6 @@ namespace Piccolo
     protected:
         std::shared_ptr<RHI>                m_rhi;
         std::shared_ptr<RenderResourceBase> m_render_resource;
+        std::shared_ptr<ThreadPool>         m_recording_thread_pool;
     };
 } // namespace Piccolo
@@ -5,15 +5,22 @@
 #include "runtime/function/render/passes/combine_ui_pass.h"
 #include "runtime/function/render/passes/directional_light_pass.h"
 #include "runtime/function/render/passes/main_camera_pass.h"
+#include "runtime/function/render/passes/particle_pass.h"
 #include "runtime/function/render/passes/pick_pass.h"
 #include "runtime/function/render/passes/point_light_pass.h"
 #include "runtime/function/render/passes/tone_mapping_pass.h"
 #include "runtime/function/render/passes/ui_pass.h"
-#include "runtime/function/render/passes/particle_pass.h"
 
 #include "runtime/function/render/debugdraw/debug_draw_manager.h"
 
 #include "runtime/core/base/macro.h"
+#include "runtime/core/base/thread_pool.h"
+#include "runtime/core/profile/profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <future>
+#include <thread>
 
 namespace Piccolo
 {
@@ -30,9 +37,15 @@ namespace Piccolo
         m_fxaa_pass               = std::make_shared<FXAAPass>();
         m_particle_pass           = std::make_shared<ParticlePass>();
 
+        // one secondary command pool per recording thread and frame, so the pool never outgrows the rhi
+        uint32_t recording_thread_count =
+            std::clamp(std::thread::hardware_concurrency(), 1U, m_rhi->getMaxRecordingThreadCount());
+        m_recording_thread_pool = std::make_shared<ThreadPool>(recording_thread_count);
+
         RenderPassCommonInfo pass_common_info;
-        pass_common_info.rhi             = m_rhi;
-        pass_common_info.render_resource = init_info.render_resource;
+        pass_common_info.rhi                   = m_rhi;
+        pass_common_info.render_resource       = init_info.render_resource;
+        pass_common_info.recording_thread_pool = m_recording_thread_pool;
 
         m_point_light_shadow_pass->setCommonInfo(pass_common_info);
         m_directional_light_pass->setCommonInfo(pass_common_info);
@@ -45,8 +58,27 @@ namespace Piccolo
         m_fxaa_pass->setCommonInfo(pass_common_info);
         m_particle_pass->setCommonInfo(pass_common_info);
 
-        m_point_light_shadow_pass->initialize(nullptr);
-        m_directional_light_pass->initialize(nullptr);
+        // the graph owns the shadow depth attachments, so it is compiled before the shadow passes are initialized
+        m_render_graph.initialize(m_rhi);
+        setupRenderGraph();
+
+        PointLightShadowPassInitInfo point_light_shadow_init_info;
+        point_light_shadow_init_info.depth_image      = m_render_graph.getImage(m_point_light_shadow_depth);
+        point_light_shadow_init_info.depth_image_view = m_render_graph.getImageView(m_point_light_shadow_depth);
+        m_point_light_shadow_pass->initialize(&point_light_shadow_init_info);
+
+        DirectionalLightShadowPassInitInfo directional_light_shadow_init_info;
+        directional_light_shadow_init_info.depth_image = m_render_graph.getImage(m_directional_light_shadow_depth);
+        directional_light_shadow_init_info.depth_image_view =
+            m_render_graph.getImageView(m_directional_light_shadow_depth);
+        m_directional_light_pass->initialize(&directional_light_shadow_init_info);
+
+        m_render_graph.setImportedImage(
+            m_point_light_shadow_color,
+            std::static_pointer_cast<RenderPass>(m_point_light_shadow_pass)->m_framebuffer.attachments[0].image);
+        m_render_graph.setImportedImage(
+            m_directional_light_shadow_color,
+            std::static_pointer_cast<RenderPass>(m_directional_light_pass)->m_framebuffer.attachments[0].image);
 
         std::shared_ptr<MainCameraPass> main_camera_pass = std::static_pointer_cast<MainCameraPass>(m_main_camera_pass);
         std::shared_ptr<RenderPass>     _main_camera_pass = std::static_pointer_cast<RenderPass>(m_main_camera_pass);
@@ -111,6 +143,173 @@ namespace Piccolo
             _main_camera_pass->getFramebufferImageViews()[_main_camera_pass_post_process_buffer_odd];
         m_fxaa_pass->initialize(&fxaa_init_info);
 
+        setupPipelines();
+    }
+
+    void RenderPipeline::setupPipelines()
+    {
+        PROFILE_ZONE("RenderPipeline::setupPipelines");
+
+        // render passes and descriptor set layouts exist at this point, the pipelines of different passes do not
+        // depend on each other and the pipeline cache is synchronized by the driver
+        const std::array<std::shared_ptr<RenderPassBase>, 9> passes {m_point_light_shadow_pass,
+                                                                     m_directional_light_pass,
+                                                                     m_main_camera_pass,
+                                                                     m_particle_pass,
+                                                                     m_tone_mapping_pass,
+                                                                     m_color_grading_pass,
+                                                                     m_combine_ui_pass,
+                                                                     m_pick_pass,
+                                                                     m_fxaa_pass};
+
+        std::vector<std::future<void>> pipeline_builds;
+        pipeline_builds.reserve(passes.size());
+        for (const std::shared_ptr<RenderPassBase>& pass : passes)
+        {
+            pipeline_builds.push_back(std::async(std::launch::async, [pass]() {
+                PROFILE_ZONE("RenderPass::setupPipelines");
+                pass->setupPipelines();
+            }));
+        }
+
+        // get rethrows what a pass threw on its worker
+        for (std::future<void>& pipeline_build : pipeline_builds)
+        {
+            pipeline_build.get();
+        }
+
+        m_rhi->savePipelineCache();
+    }
+
+    void RenderPipeline::setupRenderGraph()
+    {
+        RHIFormat depth_format = m_rhi->getDepthImageInfo().depth_image_format;
+
+        RenderGraphImageDesc directional_light_shadow_depth_desc;
+        directional_light_shadow_depth_desc.width  = s_directional_light_shadow_map_dimension;
+        directional_light_shadow_depth_desc.height = s_directional_light_shadow_map_dimension;
+        directional_light_shadow_depth_desc.format = depth_format;
+        directional_light_shadow_depth_desc.usage =
+            RHI_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | RHI_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        directional_light_shadow_depth_desc.aspect       = RHI_IMAGE_ASPECT_DEPTH_BIT;
+        directional_light_shadow_depth_desc.view_type    = RHI_IMAGE_VIEW_TYPE_2D;
+        directional_light_shadow_depth_desc.array_layers = 1;
+
+        RenderGraphImageDesc point_light_shadow_depth_desc;
+        point_light_shadow_depth_desc.width  = s_point_light_shadow_map_dimension;
+        point_light_shadow_depth_desc.height = s_point_light_shadow_map_dimension;
+        point_light_shadow_depth_desc.format = depth_format;
+        point_light_shadow_depth_desc.usage =
+            RHI_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | RHI_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        point_light_shadow_depth_desc.aspect       = RHI_IMAGE_ASPECT_DEPTH_BIT;
+        point_light_shadow_depth_desc.view_type    = RHI_IMAGE_VIEW_TYPE_2D_ARRAY;
+        point_light_shadow_depth_desc.array_layers = 2 * s_max_point_light_count;
+
+        m_directional_light_shadow_depth =
+            m_render_graph.createTransientImage("directional_light_shadow_depth", directional_light_shadow_depth_desc);
+        m_point_light_shadow_depth =
+            m_render_graph.createTransientImage("point_light_shadow_depth", point_light_shadow_depth_desc);
+
+        // the shadow maps stay sampled by the main camera between frames, the images are bound after the passes
+        // create them
+        m_directional_light_shadow_color = m_render_graph.importImage("directional_light_shadow_color",
+                                                                      RHI_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                                      RHI_IMAGE_ASPECT_COLOR_BIT,
+                                                                      1,
+                                                                      false);
+        m_point_light_shadow_color = m_render_graph.importImage("point_light_shadow_color",
+                                                                RHI_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                                RHI_IMAGE_ASPECT_COLOR_BIT,
+                                                                2 * s_max_point_light_count,
+                                                                false);
+
+        // the swapchain image changes every frame and is synchronized by the render pass dependencies
+        m_backbuffer =
+            m_render_graph.importImage("backbuffer", RHI_IMAGE_LAYOUT_UNDEFINED, RHI_IMAGE_ASPECT_COLOR_BIT, 1, true);
+
+        m_render_graph.addPass(
+            "directional_light_shadow",
+            [this](RenderGraphBuilder& builder) {
+                builder.write(m_directional_light_shadow_color,
+                              RenderGraphAccess::color_attachment_write,
+                              RHI_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+                builder.write(m_directional_light_shadow_depth, RenderGraphAccess::depth_stencil_attachment_write);
+            },
+            [this](RHICommandBuffer*) {
+                static_cast<DirectionalLightShadowPass*>(m_directional_light_pass.get())->draw();
+            });
+
+        m_render_graph.addPass(
+            "point_light_shadow",
+            [this](RenderGraphBuilder& builder) {
+                builder.write(m_point_light_shadow_color,
+                              RenderGraphAccess::color_attachment_write,
+                              RHI_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+                builder.write(m_point_light_shadow_depth, RenderGraphAccess::depth_stencil_attachment_write);
+            },
+            [this](RHICommandBuffer*) { static_cast<PointLightShadowPass*>(m_point_light_shadow_pass.get())->draw(); });
+
+        // the subpasses of the main camera share one render pass, so they are one node of the graph
+        m_render_graph.addPass(
+            "main_camera",
+            [this](RenderGraphBuilder& builder) {
+                builder.read(m_directional_light_shadow_color, RenderGraphAccess::fragment_shader_read);
+                builder.read(m_point_light_shadow_color, RenderGraphAccess::fragment_shader_read);
+                builder.write(m_backbuffer, RenderGraphAccess::color_attachment_write);
+                builder.setSideEffect();
+            },
+            [this](RHICommandBuffer*) {
+                VulkanRHI*        vulkan_rhi         = static_cast<VulkanRHI*>(m_rhi.get());
+                MainCameraPass&   main_camera_pass   = *(static_cast<MainCameraPass*>(m_main_camera_pass.get()));
+                ColorGradingPass& color_grading_pass = *(static_cast<ColorGradingPass*>(m_color_grading_pass.get()));
+                FXAAPass&         fxaa_pass          = *(static_cast<FXAAPass*>(m_fxaa_pass.get()));
+                ToneMappingPass&  tone_mapping_pass  = *(static_cast<ToneMappingPass*>(m_tone_mapping_pass.get()));
+                UIPass&           ui_pass            = *(static_cast<UIPass*>(m_ui_pass.get()));
+                CombineUIPass&    combine_ui_pass    = *(static_cast<CombineUIPass*>(m_combine_ui_pass.get()));
+                ParticlePass&     particle_pass      = *(static_cast<ParticlePass*>(m_particle_pass.get()));
+
+                particle_pass.setRenderCommandBufferHandle(main_camera_pass.getRenderCommandBuffer());
+
+                if (m_is_forward_rendering)
+                {
+                    main_camera_pass.drawForward(color_grading_pass,
+                                                 fxaa_pass,
+                                                 tone_mapping_pass,
+                                                 ui_pass,
+                                                 combine_ui_pass,
+                                                 particle_pass,
+                                                 vulkan_rhi->m_current_swapchain_image_index);
+                }
+                else
+                {
+                    main_camera_pass.draw(color_grading_pass,
+                                          fxaa_pass,
+                                          tone_mapping_pass,
+                                          ui_pass,
+                                          combine_ui_pass,
+                                          particle_pass,
+                                          vulkan_rhi->m_current_swapchain_image_index);
+                }
+            });
+
+        m_render_graph.addPass(
+            "debug_draw",
+            [this](RenderGraphBuilder& builder) {
+                builder.write(m_backbuffer, RenderGraphAccess::color_attachment_write);
+                builder.setSideEffect();
+            },
+            [this](RHICommandBuffer*) {
+                VulkanRHI* vulkan_rhi = static_cast<VulkanRHI*>(m_rhi.get());
+                g_runtime_global_context.m_debugdraw_manager->draw(vulkan_rhi->m_current_swapchain_image_index);
+            });
+
+        m_render_graph.compile();
+    }
+
+    void RenderPipeline::executeRenderGraph(bool is_forward_rendering)
+    {
+        m_is_forward_rendering = is_forward_rendering;
+        m_render_graph.execute(m_rhi->getCurrentCommandBuffer());
     }
 
     void RenderPipeline::forwardRender(std::shared_ptr<RHI> rhi, std::shared_ptr<RenderResourceBase> render_resource)
@@ -131,32 +330,7 @@ namespace Piccolo
             return;
         }
 
-        static_cast<DirectionalLightShadowPass*>(m_directional_light_pass.get())->draw();
-
-        static_cast<PointLightShadowPass*>(m_point_light_shadow_pass.get())->draw();
-
-        ColorGradingPass& color_grading_pass = *(static_cast<ColorGradingPass*>(m_color_grading_pass.get()));
-        FXAAPass&         fxaa_pass          = *(static_cast<FXAAPass*>(m_fxaa_pass.get()));
-        ToneMappingPass&  tone_mapping_pass  = *(static_cast<ToneMappingPass*>(m_tone_mapping_pass.get()));
-        UIPass&           ui_pass            = *(static_cast<UIPass*>(m_ui_pass.get()));
-        CombineUIPass&    combine_ui_pass    = *(static_cast<CombineUIPass*>(m_combine_ui_pass.get()));
-        ParticlePass&     particle_pass      = *(static_cast<ParticlePass*>(m_particle_pass.get()));
-
-        static_cast<ParticlePass*>(m_particle_pass.get())
-            ->setRenderCommandBufferHandle(
-                static_cast<MainCameraPass*>(m_main_camera_pass.get())->getRenderCommandBuffer());
-
-        static_cast<MainCameraPass*>(m_main_camera_pass.get())
-            ->drawForward(color_grading_pass,
-                          fxaa_pass,
-                          tone_mapping_pass,
-                          ui_pass,
-                          combine_ui_pass,
-                          particle_pass,
-                          vulkan_rhi->m_current_swapchain_image_index);
-
-        
-        g_runtime_global_context.m_debugdraw_manager->draw(vulkan_rhi->m_current_swapchain_image_index);
+        executeRenderGraph(true);
 
         vulkan_rhi->submitRendering(std::bind(&RenderPipeline::passUpdateAfterRecreateSwapchain, this));
         static_cast<ParticlePass*>(m_particle_pass.get())->copyNormalAndDepthImage();
@@ -181,31 +355,7 @@ namespace Piccolo
             return;
         }
 
-        static_cast<DirectionalLightShadowPass*>(m_directional_light_pass.get())->draw();
-
-        static_cast<PointLightShadowPass*>(m_point_light_shadow_pass.get())->draw();
-
-        ColorGradingPass& color_grading_pass = *(static_cast<ColorGradingPass*>(m_color_grading_pass.get()));
-        FXAAPass&         fxaa_pass          = *(static_cast<FXAAPass*>(m_fxaa_pass.get()));
-        ToneMappingPass&  tone_mapping_pass  = *(static_cast<ToneMappingPass*>(m_tone_mapping_pass.get()));
-        UIPass&           ui_pass            = *(static_cast<UIPass*>(m_ui_pass.get()));
-        CombineUIPass&    combine_ui_pass    = *(static_cast<CombineUIPass*>(m_combine_ui_pass.get()));
-        ParticlePass&     particle_pass      = *(static_cast<ParticlePass*>(m_particle_pass.get()));
-
-        static_cast<ParticlePass*>(m_particle_pass.get())
-            ->setRenderCommandBufferHandle(
-                static_cast<MainCameraPass*>(m_main_camera_pass.get())->getRenderCommandBuffer());
-
-        static_cast<MainCameraPass*>(m_main_camera_pass.get())
-            ->draw(color_grading_pass,
-                   fxaa_pass,
-                   tone_mapping_pass,
-                   ui_pass,
-                   combine_ui_pass,
-                   particle_pass,
-                   vulkan_rhi->m_current_swapchain_image_index);
-                   
-        g_runtime_global_context.m_debugdraw_manager->draw(vulkan_rhi->m_current_swapchain_image_index);
+        executeRenderGraph(false);
 
         vulkan_rhi->submitRendering(std::bind(&RenderPipeline::passUpdateAfterRecreateSwapchain, this));
         static_cast<ParticlePass*>(m_particle_pass.get())->copyNormalAndDepthImage();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "runtime/function/render/render_graph.h"
 #include "runtime/function/render/render_pipeline_base.h"
 
 namespace Piccolo
@@ -22,5 +23,18 @@ namespace Piccolo
         void setAxisVisibleState(bool state);
 
         void setSelectedAxis(size_t selected_axis);
+
+    private:
+        void setupPipelines();
+        void setupRenderGraph();
+        void executeRenderGraph(bool is_forward_rendering);
+
+        RenderGraph         m_render_graph;
+        RenderGraphResource m_directional_light_shadow_color {0};
+        RenderGraphResource m_directional_light_shadow_depth {0};
+        RenderGraphResource m_point_light_shadow_color {0};
+        RenderGraphResource m_point_light_shadow_depth {0};
+        RenderGraphResource m_backbuffer {0};
+        bool                m_is_forward_rendering {false};
     };
 } // namespace Piccolo
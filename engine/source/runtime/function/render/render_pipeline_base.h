@@ -10,6 +10,7 @@ namespace Piccolo
 {
     class RHI;
     class RenderResourceBase;
+    class ThreadPool;
     class WindowUI;
 
     struct RenderPipelineInitInfo
@@ -50,5 +51,6 @@ namespace Piccolo
         std::shared_ptr<RenderPassBase> m_pick_pass;
         std::shared_ptr<RenderPassBase> m_particle_pass;
 
+        std::shared_ptr<ThreadPool> m_recording_thread_pool;
     };
 } // namespace Piccolo
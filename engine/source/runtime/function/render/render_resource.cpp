@@ -1,6 +1,7 @@
 #include "runtime/function/render/render_resource.h"
 
 #include "runtime/function/render/render_camera.h"
+#include "runtime/function/render/render_draw_list.h"
 #include "runtime/function/render/render_helper.h"
 
 #include "runtime/function/render/render_mesh.h"
@@ -86,6 +87,9 @@ namespace Piccolo
             color_grading_map->m_height,
             color_grading_map->m_pixels,
             color_grading_map->m_format);
+
+        // every pass samples the global textures from the first frame on
+        rhi->flushUploads();
     }
 
     void RenderResource::uploadGameObjectRenderResource(std::shared_ptr<RHI> rhi,
@@ -111,6 +115,38 @@ namespace Piccolo
         getOrCreateVulkanMaterial(rhi, render_entity, material_data);
     }
 
+    void RenderResource::reloadGameObjectRenderResource(std::shared_ptr<RHI> rhi,
+        RenderEntity         render_entity,
+        RenderMeshData       mesh_data)
+    {
+        // the old buffers are destroyed once the frames in flight are done with them, the new ones keep the sort id
+        // since it is the mesh asset id
+        auto mesh_it = m_vulkan_meshes.find(render_entity.m_mesh_asset_id);
+        if (mesh_it != m_vulkan_meshes.end())
+        {
+            releaseVulkanMesh(rhi, mesh_it->second);
+            m_vulkan_meshes.erase(mesh_it);
+        }
+        getOrCreateVulkanMesh(rhi, render_entity, mesh_data);
+    }
+
+    void RenderResource::reloadGameObjectRenderResource(std::shared_ptr<RHI> rhi,
+        RenderEntity         render_entity,
+        RenderMaterialData   material_data)
+    {
+        // as for meshes, the old images, uniform buffer and descriptor set outlive the frames in flight, the new
+        // material keeps the sort id so the draw order does not change
+        uint32_t sort_id     = static_cast<uint32_t>(m_vulkan_pbr_materials.size());
+        auto     material_it = m_vulkan_pbr_materials.find(render_entity.m_material_asset_id);
+        if (material_it != m_vulkan_pbr_materials.end())
+        {
+            sort_id = material_it->second.sort_id;
+            releaseVulkanMaterial(rhi, material_it->second);
+            m_vulkan_pbr_materials.erase(material_it);
+        }
+        getOrCreateVulkanMaterial(rhi, render_entity, material_data).sort_id = sort_id;
+    }
+
     void RenderResource::updatePerFrameBuffer(std::shared_ptr<RenderScene>  render_scene,
         std::shared_ptr<RenderCamera> camera)
     {
@@ -292,6 +328,12 @@ namespace Piccolo
                 reinterpret_cast<MeshVertexDataDefinition*>(mesh_data.m_static_mesh_data.m_vertex_buffer->m_data);
 
             VulkanMesh& now_mesh = res.first->second;
+            now_mesh.sort_id     = static_cast<uint32_t>(assetid);
+            if (assetid > RenderDrawList::s_max_sort_id)
+            {
+                LOG_ERROR("mesh asset id {} does not fit in the draw sort key, its draws may merge with other meshes",
+                          assetid);
+            }
 
             if (mesh_data.m_skeleton_binding_buffer)
             {
@@ -325,6 +367,90 @@ namespace Piccolo
         }
     }
 
+    void RenderResource::releaseVulkanMeshes(std::shared_ptr<RHI> rhi, const std::vector<size_t>& mesh_asset_ids)
+    {
+        for (size_t mesh_asset_id : mesh_asset_ids)
+        {
+            auto mesh_it = m_vulkan_meshes.find(mesh_asset_id);
+            if (mesh_it != m_vulkan_meshes.end())
+            {
+                releaseVulkanMesh(rhi, mesh_it->second);
+                m_vulkan_meshes.erase(mesh_it);
+            }
+        }
+    }
+
+    void RenderResource::releaseVulkanMesh(std::shared_ptr<RHI> rhi, const VulkanMesh& mesh)
+    {
+        VulkanRHI*         vulkan_context  = static_cast<VulkanRHI*>(rhi.get());
+        RHI*               rhi_context     = rhi.get();
+        VmaAllocator       allocator       = vulkan_context->m_assets_allocator;
+        RHIDescriptorPool* descriptor_pool = vulkan_context->m_descriptor_pool;
+        VulkanMesh         released_mesh   = mesh;
+
+        // the draws recorded for the frames in flight still bind the buffers
+        rhi->deferDestruction(mesh.upload_ticket, [rhi_context, allocator, descriptor_pool, released_mesh]() mutable {
+            rhi_context->destroyBufferVMA(allocator,
+                                          released_mesh.mesh_vertex_position_buffer,
+                                          released_mesh.mesh_vertex_position_buffer_allocation);
+            rhi_context->destroyBufferVMA(allocator,
+                                          released_mesh.mesh_vertex_varying_enable_blending_buffer,
+                                          released_mesh.mesh_vertex_varying_enable_blending_buffer_allocation);
+            rhi_context->destroyBufferVMA(allocator,
+                                          released_mesh.mesh_vertex_varying_buffer,
+                                          released_mesh.mesh_vertex_varying_buffer_allocation);
+            rhi_context->destroyBufferVMA(
+                allocator, released_mesh.mesh_index_buffer, released_mesh.mesh_index_buffer_allocation);
+            if (released_mesh.mesh_vertex_joint_binding_buffer != nullptr)
+            {
+                rhi_context->destroyBufferVMA(allocator,
+                                              released_mesh.mesh_vertex_joint_binding_buffer,
+                                              released_mesh.mesh_vertex_joint_binding_buffer_allocation);
+            }
+            rhi_context->freeDescriptorSet(descriptor_pool, released_mesh.mesh_vertex_blending_descriptor_set);
+        });
+    }
+
+    void RenderResource::releaseVulkanMaterial(std::shared_ptr<RHI> rhi, const VulkanPBRMaterial& material)
+    {
+        VulkanRHI*         vulkan_context    = static_cast<VulkanRHI*>(rhi.get());
+        RHI*               rhi_context       = rhi.get();
+        VmaAllocator       allocator         = vulkan_context->m_assets_allocator;
+        RHIDescriptorPool* descriptor_pool   = vulkan_context->m_descriptor_pool;
+        VulkanPBRMaterial  released_material = material;
+
+        // the draws recorded for the frames in flight still sample the images
+        rhi->deferDestruction(
+            material.upload_ticket, [rhi_context, allocator, descriptor_pool, released_material]() mutable {
+                auto destroyImage = [rhi_context, allocator](RHIImage*& image, RHIImageView*& image_view,
+                                                             VmaAllocation allocation) {
+                    rhi_context->destroyImageView(image_view);
+                    RHI_DELETE_PTR(image_view);
+                    rhi_context->destroyImageVMA(allocator, image, allocation);
+                };
+                destroyImage(released_material.base_color_texture_image,
+                             released_material.base_color_image_view,
+                             released_material.base_color_image_allocation);
+                destroyImage(released_material.metallic_roughness_texture_image,
+                             released_material.metallic_roughness_image_view,
+                             released_material.metallic_roughness_image_allocation);
+                destroyImage(released_material.normal_texture_image,
+                             released_material.normal_image_view,
+                             released_material.normal_image_allocation);
+                destroyImage(released_material.occlusion_texture_image,
+                             released_material.occlusion_image_view,
+                             released_material.occlusion_image_allocation);
+                destroyImage(released_material.emissive_texture_image,
+                             released_material.emissive_image_view,
+                             released_material.emissive_image_allocation);
+
+                rhi_context->destroyBufferVMA(allocator,
+                                              released_material.material_uniform_buffer,
+                                              released_material.material_uniform_buffer_allocation);
+                rhi_context->freeDescriptorSet(descriptor_pool, released_material.material_descriptor_set);
+            });
+    }
+
     VulkanPBRMaterial& RenderResource::getOrCreateVulkanMaterial(std::shared_ptr<RHI> rhi,
         RenderEntity         entity,
         RenderMaterialData   material_data)
@@ -407,36 +533,27 @@ namespace Piccolo
             }
 
             VulkanPBRMaterial& now_material = res.first->second;
+            now_material.sort_id            = static_cast<uint32_t>(m_vulkan_pbr_materials.size() - 1);
+            if (now_material.sort_id > RenderDrawList::s_max_sort_id)
+            {
+                LOG_ERROR("material sort id {} does not fit in the draw sort key, its draws may merge with other "
+                          "materials",
+                          now_material.sort_id);
+            }
 
             // similiarly to the vertex/index buffer, we should allocate the uniform
             // buffer in DEVICE_LOCAL memory and use the temp stage buffer to copy the
             // data
             {
-                // temporary staging buffer
+                // staging memory from the upload ring
 
                 RHIDeviceSize buffer_size = sizeof(MeshPerMaterialUniformBufferObject);
 
-                RHIBuffer* inefficient_staging_buffer = RHI_NULL_HANDLE;
-                RHIDeviceMemory* inefficient_staging_buffer_memory = RHI_NULL_HANDLE;
-                rhi->createBuffer(
-                    buffer_size,
-                    RHI_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                    RHI_MEMORY_PROPERTY_HOST_VISIBLE_BIT | RHI_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                    inefficient_staging_buffer,
-                    inefficient_staging_buffer_memory);
-                // RHI_BUFFER_USAGE_TRANSFER_SRC_BIT: buffer can be used as source in a
-                // memory transfer operation
-
-                void* staging_buffer_data = nullptr;
-                rhi->mapMemory(
-                    inefficient_staging_buffer_memory,
-                    0,
-                    buffer_size,
-                    0,
-                    &staging_buffer_data);
-                
+                RHIUploadAllocation staging_allocation;
+                rhi->allocateUploadMemory(buffer_size, staging_allocation);
+
                 MeshPerMaterialUniformBufferObject& material_uniform_buffer_info =
-                    (*static_cast<MeshPerMaterialUniformBufferObject*>(staging_buffer_data));
+                    (*static_cast<MeshPerMaterialUniformBufferObject*>(staging_allocation.mapped_data));
                 material_uniform_buffer_info.is_blend = entity.m_blend;
                 material_uniform_buffer_info.is_double_sided = entity.m_double_sided;
                 material_uniform_buffer_info.baseColorFactor = entity.m_base_color_factor;
@@ -446,8 +563,6 @@ namespace Piccolo
                 material_uniform_buffer_info.occlusionStrength = entity.m_occlusion_strength;
                 material_uniform_buffer_info.emissiveFactor = entity.m_emissive_factor;
 
-                rhi->unmapMemory(inefficient_staging_buffer_memory);
-
                 // use the vmaAllocator to allocate asset uniform buffer
                 RHIBufferCreateInfo bufferInfo = { RHI_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
                 bufferInfo.size = buffer_size;
@@ -465,12 +580,8 @@ namespace Piccolo
                     &now_material.material_uniform_buffer_allocation,
                     NULL);
 
-                // use the data from staging buffer
-                rhi->copyBuffer(inefficient_staging_buffer, now_material.material_uniform_buffer, 0, 0, buffer_size);
-
-                // release staging buffer
-                rhi->destroyBuffer(inefficient_staging_buffer);
-                rhi->freeMemory(inefficient_staging_buffer_memory);
+                // use the data from staging buffer, the copy goes out with the next upload batch
+                rhi->uploadBuffer(staging_allocation, 0, now_material.material_uniform_buffer, 0, buffer_size);
             }
 
             TextureDataToUpdate update_texture_data;
@@ -498,6 +609,9 @@ namespace Piccolo
 
             updateTextureImageData(rhi, update_texture_data);
 
+            // the material is drawn once the batch holding its last upload has retired
+            now_material.upload_ticket = rhi->getUploadTicket();
+
             RHIDescriptorSetAllocateInfo material_descriptor_set_alloc_info;
             material_descriptor_set_alloc_info.sType = RHI_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
             material_descriptor_set_alloc_info.pNext = NULL;
@@ -612,6 +726,9 @@ namespace Piccolo
         assert(0 == (index_buffer_size % sizeof(uint16_t)));
         now_mesh.mesh_index_count = index_buffer_size / sizeof(uint16_t);
         updateIndexBuffer(rhi, index_buffer_size, index_buffer_data, now_mesh);
+
+        // the mesh is drawn once the batch holding its last upload has retired
+        now_mesh.upload_ticket = rhi->getUploadTicket();
     }
 
     void RenderResource::updateVertexBuffer(std::shared_ptr<RHI>                   rhi,
@@ -647,38 +764,28 @@ namespace Piccolo
                 vertex_varying_enable_blending_buffer_offset + vertex_varying_enable_blending_buffer_size;
             RHIDeviceSize vertex_joint_binding_buffer_offset = vertex_varying_buffer_offset + vertex_varying_buffer_size;
 
-            // temporary staging buffer
-            RHIDeviceSize inefficient_staging_buffer_size =
+            // staging memory from the upload ring
+            RHIDeviceSize staging_buffer_size =
                 vertex_position_buffer_size + vertex_varying_enable_blending_buffer_size + vertex_varying_buffer_size +
                 vertex_joint_binding_buffer_size;
-            RHIBuffer* inefficient_staging_buffer = RHI_NULL_HANDLE;
-            RHIDeviceMemory* inefficient_staging_buffer_memory = RHI_NULL_HANDLE;
-            rhi->createBuffer(inefficient_staging_buffer_size,
-                              RHI_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                              RHI_MEMORY_PROPERTY_HOST_VISIBLE_BIT | RHI_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                              inefficient_staging_buffer,
-                              inefficient_staging_buffer_memory);
-
-            void* inefficient_staging_buffer_data;
-            rhi->mapMemory(inefficient_staging_buffer_memory,
-                           0,
-                           RHI_WHOLE_SIZE,
-                           0,
-                           &inefficient_staging_buffer_data);
+            RHIUploadAllocation staging_allocation;
+            rhi->allocateUploadMemory(staging_buffer_size, staging_allocation);
+
+            void* staging_buffer_data = staging_allocation.mapped_data;
 
             MeshVertex::VulkanMeshVertexPostition* mesh_vertex_positions =
                 reinterpret_cast<MeshVertex::VulkanMeshVertexPostition*>(
-                    reinterpret_cast<uintptr_t>(inefficient_staging_buffer_data) + vertex_position_buffer_offset);
+                    reinterpret_cast<uintptr_t>(staging_buffer_data) + vertex_position_buffer_offset);
             MeshVertex::VulkanMeshVertexVaryingEnableBlending* mesh_vertex_blending_varyings =
                 reinterpret_cast<MeshVertex::VulkanMeshVertexVaryingEnableBlending*>(
-                    reinterpret_cast<uintptr_t>(inefficient_staging_buffer_data) +
+                    reinterpret_cast<uintptr_t>(staging_buffer_data) +
                     vertex_varying_enable_blending_buffer_offset);
             MeshVertex::VulkanMeshVertexVarying* mesh_vertex_varyings =
                 reinterpret_cast<MeshVertex::VulkanMeshVertexVarying*>(
-                    reinterpret_cast<uintptr_t>(inefficient_staging_buffer_data) + vertex_varying_buffer_offset);
+                    reinterpret_cast<uintptr_t>(staging_buffer_data) + vertex_varying_buffer_offset);
             MeshVertex::VulkanMeshVertexJointBinding* mesh_vertex_joint_binding =
                 reinterpret_cast<MeshVertex::VulkanMeshVertexJointBinding*>(
-                    reinterpret_cast<uintptr_t>(inefficient_staging_buffer_data) + vertex_joint_binding_buffer_offset);
+                    reinterpret_cast<uintptr_t>(staging_buffer_data) + vertex_joint_binding_buffer_offset);
 
             for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
             {
@@ -725,15 +832,16 @@ namespace Piccolo
                         joint_binding_buffer_data[vertex_buffer_index].m_weight3 * inv_total_weight);
             }
 
-            rhi->unmapMemory(inefficient_staging_buffer_memory);
-
             // use the vmaAllocator to allocate asset vertex buffer
             RHIBufferCreateInfo bufferInfo = { RHI_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
 
             VmaAllocationCreateInfo allocInfo = {};
             allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+            allocInfo.pool  = vulkan_context->m_mesh_buffer_pool;
 
-            bufferInfo.usage = RHI_BUFFER_USAGE_VERTEX_BUFFER_BIT | RHI_BUFFER_USAGE_TRANSFER_DST_BIT;
+            // transfer src lets the defragmentation copy the buffer to its new place
+            bufferInfo.usage = RHI_BUFFER_USAGE_VERTEX_BUFFER_BIT | RHI_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                               RHI_BUFFER_USAGE_TRANSFER_DST_BIT;
             bufferInfo.size = vertex_position_buffer_size;
             rhi->createBufferVMA(vulkan_context->m_assets_allocator,
                                  &bufferInfo,
@@ -766,30 +874,26 @@ namespace Piccolo
                                  NULL);
 
             // use the data from staging buffer
-            rhi->copyBuffer(inefficient_staging_buffer,
-                            now_mesh.mesh_vertex_position_buffer,
-                            vertex_position_buffer_offset,
-                            0,
-                            vertex_position_buffer_size);
-            rhi->copyBuffer(inefficient_staging_buffer,
-                            now_mesh.mesh_vertex_varying_enable_blending_buffer,
-                            vertex_varying_enable_blending_buffer_offset,
-                            0,
-                            vertex_varying_enable_blending_buffer_size);
-            rhi->copyBuffer(inefficient_staging_buffer,
-                            now_mesh.mesh_vertex_varying_buffer,
-                            vertex_varying_buffer_offset,
-                            0,
-                            vertex_varying_buffer_size);
-            rhi->copyBuffer(inefficient_staging_buffer,
-                            now_mesh.mesh_vertex_joint_binding_buffer,
-                            vertex_joint_binding_buffer_offset,
-                            0,
-                            vertex_joint_binding_buffer_size);
-
-            // release staging buffer
-            rhi->destroyBuffer(inefficient_staging_buffer);
-            rhi->freeMemory(inefficient_staging_buffer_memory);
+            rhi->uploadBuffer(staging_allocation,
+                              vertex_position_buffer_offset,
+                              now_mesh.mesh_vertex_position_buffer,
+                              0,
+                              vertex_position_buffer_size);
+            rhi->uploadBuffer(staging_allocation,
+                              vertex_varying_enable_blending_buffer_offset,
+                              now_mesh.mesh_vertex_varying_enable_blending_buffer,
+                              0,
+                              vertex_varying_enable_blending_buffer_size);
+            rhi->uploadBuffer(staging_allocation,
+                              vertex_varying_buffer_offset,
+                              now_mesh.mesh_vertex_varying_buffer,
+                              0,
+                              vertex_varying_buffer_size);
+            rhi->uploadBuffer(staging_allocation,
+                              vertex_joint_binding_buffer_offset,
+                              now_mesh.mesh_vertex_joint_binding_buffer,
+                              0,
+                              vertex_joint_binding_buffer_size);
 
             // update descriptor set
             RHIDescriptorSetAllocateInfo mesh_vertex_blending_per_mesh_descriptor_set_alloc_info;
@@ -853,34 +957,24 @@ namespace Piccolo
             RHIDeviceSize vertex_varying_buffer_offset =
                 vertex_varying_enable_blending_buffer_offset + vertex_varying_enable_blending_buffer_size;
 
-            // temporary staging buffer
-            RHIDeviceSize inefficient_staging_buffer_size =
+            // staging memory from the upload ring
+            RHIDeviceSize staging_buffer_size =
                 vertex_position_buffer_size + vertex_varying_enable_blending_buffer_size + vertex_varying_buffer_size;
-            RHIBuffer* inefficient_staging_buffer = RHI_NULL_HANDLE;
-            RHIDeviceMemory* inefficient_staging_buffer_memory = RHI_NULL_HANDLE;
-            rhi->createBuffer(inefficient_staging_buffer_size,
-                              RHI_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                              RHI_MEMORY_PROPERTY_HOST_VISIBLE_BIT | RHI_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                              inefficient_staging_buffer,
-                              inefficient_staging_buffer_memory);
-
-            void* inefficient_staging_buffer_data;
-            rhi->mapMemory(inefficient_staging_buffer_memory,
-                           0,
-                           RHI_WHOLE_SIZE,
-                           0,
-                           &inefficient_staging_buffer_data);
+            RHIUploadAllocation staging_allocation;
+            rhi->allocateUploadMemory(staging_buffer_size, staging_allocation);
+
+            void* staging_buffer_data = staging_allocation.mapped_data;
 
             MeshVertex::VulkanMeshVertexPostition* mesh_vertex_positions =
                 reinterpret_cast<MeshVertex::VulkanMeshVertexPostition*>(
-                    reinterpret_cast<uintptr_t>(inefficient_staging_buffer_data) + vertex_position_buffer_offset);
+                    reinterpret_cast<uintptr_t>(staging_buffer_data) + vertex_position_buffer_offset);
             MeshVertex::VulkanMeshVertexVaryingEnableBlending* mesh_vertex_blending_varyings =
                 reinterpret_cast<MeshVertex::VulkanMeshVertexVaryingEnableBlending*>(
-                    reinterpret_cast<uintptr_t>(inefficient_staging_buffer_data) +
+                    reinterpret_cast<uintptr_t>(staging_buffer_data) +
                     vertex_varying_enable_blending_buffer_offset);
             MeshVertex::VulkanMeshVertexVarying* mesh_vertex_varyings =
                 reinterpret_cast<MeshVertex::VulkanMeshVertexVarying*>(
-                    reinterpret_cast<uintptr_t>(inefficient_staging_buffer_data) + vertex_varying_buffer_offset);
+                    reinterpret_cast<uintptr_t>(staging_buffer_data) + vertex_varying_buffer_offset);
 
             for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
             {
@@ -902,14 +996,15 @@ namespace Piccolo
                     Vector2(vertex_buffer_data[vertex_index].u, vertex_buffer_data[vertex_index].v);
             }
 
-            rhi->unmapMemory(inefficient_staging_buffer_memory);
-
             // use the vmaAllocator to allocate asset vertex buffer
             RHIBufferCreateInfo bufferInfo = { RHI_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-            bufferInfo.usage = RHI_BUFFER_USAGE_VERTEX_BUFFER_BIT | RHI_BUFFER_USAGE_TRANSFER_DST_BIT;
+            // transfer src lets the defragmentation copy the buffer to its new place
+            bufferInfo.usage = RHI_BUFFER_USAGE_VERTEX_BUFFER_BIT | RHI_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                               RHI_BUFFER_USAGE_TRANSFER_DST_BIT;
 
             VmaAllocationCreateInfo allocInfo = {};
             allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+            allocInfo.pool  = vulkan_context->m_mesh_buffer_pool;
 
             bufferInfo.size = vertex_position_buffer_size;
             rhi->createBufferVMA(vulkan_context->m_assets_allocator,
@@ -934,25 +1029,21 @@ namespace Piccolo
                                  NULL);
 
             // use the data from staging buffer
-            rhi->copyBuffer(inefficient_staging_buffer,
-                            now_mesh.mesh_vertex_position_buffer,
-                            vertex_position_buffer_offset,
-                            0,
-                            vertex_position_buffer_size);
-            rhi->copyBuffer(inefficient_staging_buffer,
-                            now_mesh.mesh_vertex_varying_enable_blending_buffer,
-                            vertex_varying_enable_blending_buffer_offset,
-                            0,
-                            vertex_varying_enable_blending_buffer_size);
-            rhi->copyBuffer(inefficient_staging_buffer,
-                            now_mesh.mesh_vertex_varying_buffer,
-                            vertex_varying_buffer_offset,
-                            0,
-                            vertex_varying_buffer_size);
-
-            // release staging buffer
-            rhi->destroyBuffer(inefficient_staging_buffer);
-            rhi->freeMemory(inefficient_staging_buffer_memory);
+            rhi->uploadBuffer(staging_allocation,
+                              vertex_position_buffer_offset,
+                              now_mesh.mesh_vertex_position_buffer,
+                              0,
+                              vertex_position_buffer_size);
+            rhi->uploadBuffer(staging_allocation,
+                              vertex_varying_enable_blending_buffer_offset,
+                              now_mesh.mesh_vertex_varying_enable_blending_buffer,
+                              0,
+                              vertex_varying_enable_blending_buffer_size);
+            rhi->uploadBuffer(staging_allocation,
+                              vertex_varying_buffer_offset,
+                              now_mesh.mesh_vertex_varying_buffer,
+                              0,
+                              vertex_varying_buffer_size);
 
             // update descriptor set
             RHIDescriptorSetAllocateInfo mesh_vertex_blending_per_mesh_descriptor_set_alloc_info;
@@ -1010,29 +1101,22 @@ namespace Piccolo
     {
         VulkanRHI* vulkan_context = static_cast<VulkanRHI*>(rhi.get());
 
-        // temp staging buffer
+        // staging memory from the upload ring
         RHIDeviceSize buffer_size = index_buffer_size;
 
-        RHIBuffer* inefficient_staging_buffer;
-        RHIDeviceMemory* inefficient_staging_buffer_memory;
-        rhi->createBuffer(buffer_size,
-                          RHI_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                          RHI_MEMORY_PROPERTY_HOST_VISIBLE_BIT | RHI_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                          inefficient_staging_buffer,
-                          inefficient_staging_buffer_memory);
-
-        void* staging_buffer_data;
-        rhi->mapMemory(inefficient_staging_buffer_memory, 0, buffer_size, 0, &staging_buffer_data);
-        memcpy(staging_buffer_data, index_buffer_data, (size_t)buffer_size);
-        rhi->unmapMemory(inefficient_staging_buffer_memory);
+        RHIUploadAllocation staging_allocation;
+        rhi->allocateUploadMemory(buffer_size, staging_allocation);
+        memcpy(staging_allocation.mapped_data, index_buffer_data, (size_t)buffer_size);
 
         // use the vmaAllocator to allocate asset index buffer
         RHIBufferCreateInfo bufferInfo = { RHI_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
         bufferInfo.size = buffer_size;
-        bufferInfo.usage = RHI_BUFFER_USAGE_INDEX_BUFFER_BIT | RHI_BUFFER_USAGE_TRANSFER_DST_BIT;
+        bufferInfo.usage = RHI_BUFFER_USAGE_INDEX_BUFFER_BIT | RHI_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                           RHI_BUFFER_USAGE_TRANSFER_DST_BIT;
 
         VmaAllocationCreateInfo allocInfo = {};
         allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        allocInfo.pool  = vulkan_context->m_mesh_buffer_pool;
 
         rhi->createBufferVMA(vulkan_context->m_assets_allocator,
                              &bufferInfo,
@@ -1042,11 +1126,7 @@ namespace Piccolo
                              NULL);
 
         // use the data from staging buffer
-        rhi->copyBuffer( inefficient_staging_buffer, now_mesh.mesh_index_buffer, 0, 0, buffer_size);
-
-        // release temp staging buffer
-        rhi->destroyBuffer(inefficient_staging_buffer);
-        rhi->freeMemory(inefficient_staging_buffer_memory);
+        rhi->uploadBuffer(staging_allocation, 0, now_mesh.mesh_index_buffer, 0, buffer_size);
     }
 
     void RenderResource::updateTextureImageData(std::shared_ptr<RHI> rhi, const TextureDataToUpdate& texture_data)
@@ -1097,6 +1177,19 @@ namespace Piccolo
             texture_data.emissive_image_format);
     }
 
+    bool RenderResource::isEntityUploaded(const RenderEntity& entity) const
+    {
+        auto mesh_it = m_vulkan_meshes.find(entity.m_mesh_asset_id);
+        if (mesh_it == m_vulkan_meshes.end() || mesh_it->second.upload_ticket > m_retired_upload_ticket)
+        {
+            return false;
+        }
+
+        auto material_it = m_vulkan_pbr_materials.find(entity.m_material_asset_id);
+        return material_it != m_vulkan_pbr_materials.end() &&
+               material_it->second.upload_ticket <= m_retired_upload_ticket;
+    }
+
     VulkanMesh& RenderResource::getEntityMesh(RenderEntity entity)
     {
         size_t assetid = entity.m_mesh_asset_id;
@@ -1127,6 +1220,18 @@ namespace Piccolo
         }
     }
 
+    uint32_t StorageBuffer::allocateFromRingBuffer(uint8_t frame_index, uint32_t size)
+    {
+        std::lock_guard<std::mutex> lock(_global_upload_ringbuffers_mutex);
+
+        uint32_t dynamic_offset = roundUp(_global_upload_ringbuffers_end[frame_index], _min_storage_buffer_offset_alignment);
+        _global_upload_ringbuffers_end[frame_index] = dynamic_offset + size;
+        assert(_global_upload_ringbuffers_end[frame_index] <=
+               (_global_upload_ringbuffers_begin[frame_index] + _global_upload_ringbuffers_size[frame_index]));
+
+        return dynamic_offset;
+    }
+
     void RenderResource::resetRingBufferOffset(uint8_t current_frame_index)
     {
         m_global_render_resource._storage_buffer._global_upload_ringbuffers_end[current_frame_index] =
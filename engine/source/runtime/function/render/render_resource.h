@@ -12,6 +12,7 @@
 #include <array>
 #include <cstdint>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <cmath>
 
@@ -84,6 +85,11 @@ namespace Piccolo
         std::vector<uint32_t> _global_upload_ringbuffers_begin;
         std::vector<uint32_t> _global_upload_ringbuffers_end;
         std::vector<uint32_t> _global_upload_ringbuffers_size;
+        // guards the ring ends while passes record on several threads
+        std::mutex _global_upload_ringbuffers_mutex;
+
+        // aligned offset of size bytes in the ring of the frame, safe to call from any recording thread
+        uint32_t allocateFromRingBuffer(uint8_t frame_index, uint32_t size);
 
         RHIBuffer* _global_null_descriptor_storage_buffer;
         RHIDeviceMemory* _global_null_descriptor_storage_buffer_memory;
@@ -122,6 +128,14 @@ namespace Piccolo
             RenderEntity         render_entity,
             RenderMaterialData   material_data) override final;
 
+        virtual void reloadGameObjectRenderResource(std::shared_ptr<RHI> rhi,
+            RenderEntity         render_entity,
+            RenderMeshData       mesh_data) override final;
+
+        virtual void reloadGameObjectRenderResource(std::shared_ptr<RHI> rhi,
+            RenderEntity         render_entity,
+            RenderMaterialData   material_data) override final;
+
         virtual void updatePerFrameBuffer(std::shared_ptr<RenderScene>  render_scene,
             std::shared_ptr<RenderCamera> camera) override final;
 
@@ -129,8 +143,14 @@ namespace Piccolo
 
         VulkanPBRMaterial& getEntityMaterial(RenderEntity entity);
 
+        // false while the mesh or material copies of the entity are still in flight
+        bool isEntityUploaded(const RenderEntity& entity) const;
+
         void resetRingBufferOffset(uint8_t current_frame_index);
 
+        /// free the buffers of the meshes once the frames in flight are done with them, call it outside of recording
+        void releaseVulkanMeshes(std::shared_ptr<RHI> rhi, const std::vector<size_t>& mesh_asset_ids);
+
         // global rendering resource, include IBL data, global storage buffer
         GlobalRenderResource m_global_render_resource;
 
@@ -148,6 +168,9 @@ namespace Piccolo
         std::map<size_t, VulkanMesh>        m_vulkan_meshes;
         std::map<size_t, VulkanPBRMaterial> m_vulkan_pbr_materials;
 
+        // newest upload ticket known to be on the gpu, updated by the render system every frame
+        uint64_t m_retired_upload_ticket {0};
+
         // descriptor set layout in main camera pass will be used when uploading resource
         RHIDescriptorSetLayout* const* m_mesh_descriptor_set_layout {nullptr};
         RHIDescriptorSetLayout* const* m_material_descriptor_set_layout {nullptr};
@@ -160,8 +183,10 @@ namespace Piccolo
                                std::array<std::shared_ptr<TextureData>, 6> specular_maps);
 
         VulkanMesh& getOrCreateVulkanMesh(std::shared_ptr<RHI> rhi, RenderEntity entity, RenderMeshData mesh_data);
+        void        releaseVulkanMesh(std::shared_ptr<RHI> rhi, const VulkanMesh& mesh);
         VulkanPBRMaterial&
         getOrCreateVulkanMaterial(std::shared_ptr<RHI> rhi, RenderEntity entity, RenderMaterialData material_data);
+        void releaseVulkanMaterial(std::shared_ptr<RHI> rhi, const VulkanPBRMaterial& material);
 
         void updateMeshData(std::shared_ptr<RHI>                          rhi,
                             bool                                          enable_vertex_blending,
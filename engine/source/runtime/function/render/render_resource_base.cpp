@@ -116,9 +116,10 @@ namespace Piccolo
                 vertex[i].tz = bind_data->vertex_buffer[i].tz;
                 vertex[i].u  = bind_data->vertex_buffer[i].u;
                 vertex[i].v  = bind_data->vertex_buffer[i].v;
-
-                bounding_box.merge(Vector3(vertex[i].x, vertex[i].y, vertex[i].z));
             }
+            bounding_box.merge(reinterpret_cast<const float*>(vertex),
+                               sizeof(MeshVertexDataDefinition),
+                               bind_data->vertex_buffer.size());
 
             // index buffer
             size_t index_size                     = bind_data->index_buffer.size() * sizeof(uint16_t);
@@ -147,7 +148,8 @@ namespace Piccolo
             }
         }
 
-        m_bounding_box_cache_map.insert(std::make_pair(source, bounding_box));
+        // a reloaded mesh replaces the bounds of its old vertices
+        m_bounding_box_cache_map[source] = bounding_box;
 
         return ret;
     }
@@ -231,8 +233,6 @@ namespace Piccolo
                     vertex[v].y = static_cast<float>(vy);
                     vertex[v].z = static_cast<float>(vz);
 
-                    bounding_box.merge(Vector3(vertex[v].x, vertex[v].y, vertex[v].z));
-
                     if (idx.normal_index >= 0)
                     {
                         auto nx = attrib.normals[3 * size_t(idx.normal_index) + 0];
@@ -323,6 +323,10 @@ namespace Piccolo
             }
         }
 
+        bounding_box.merge(reinterpret_cast<const float*>(mesh_vertices.data()),
+                           sizeof(MeshVertexDataDefinition),
+                           mesh_vertices.size());
+
         uint32_t stride           = sizeof(MeshVertexDataDefinition);
         mesh_data.m_vertex_buffer = std::make_shared<BufferData>(mesh_vertices.size() * stride);
         mesh_data.m_index_buffer  = std::make_shared<BufferData>(mesh_vertices.size() * sizeof(uint16_t));
@@ -36,6 +36,15 @@ namespace Piccolo
                                                     RenderEntity         render_entity,
                                                     RenderMaterialData   material_data) = 0;
 
+        /// replace the mesh or material of the asset id of the entity, e.g. after its files changed on disk
+        virtual void reloadGameObjectRenderResource(std::shared_ptr<RHI> rhi,
+                                                    RenderEntity         render_entity,
+                                                    RenderMeshData       mesh_data) = 0;
+
+        virtual void reloadGameObjectRenderResource(std::shared_ptr<RHI> rhi,
+                                                    RenderEntity         render_entity,
+                                                    RenderMaterialData   material_data) = 0;
+
         virtual void updatePerFrameBuffer(std::shared_ptr<RenderScene>  render_scene,
                                           std::shared_ptr<RenderCamera> camera) = 0;
 
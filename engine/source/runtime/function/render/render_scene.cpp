@@ -3,6 +3,11 @@
 #include "runtime/function/render/render_pass.h"
 #include "runtime/function/render/render_resource.h"
 
+#include "runtime/core/base/macro.h"
+#include "runtime/core/profile/profiler.h"
+
+#include <algorithm>
+
 namespace Piccolo
 {
     void RenderScene::clear()
@@ -12,6 +17,8 @@ namespace Piccolo
     void RenderScene::updateVisibleObjects(std::shared_ptr<RenderResource> render_resource,
                                            std::shared_ptr<RenderCamera>   camera)
     {
+        PROFILE_ZONE("RenderScene::updateVisibleObjects");
+
         updateVisibleObjectsDirectionalLight(render_resource, camera);
         updateVisibleObjectsPointLight(render_resource);
         updateVisibleObjectsMainCamera(render_resource, camera);
@@ -36,6 +43,76 @@ namespace Piccolo
         return m_material_asset_id_allocator;
     }
 
+    void RenderScene::setEntity(GObjectID go_id, const RenderEntity& entity)
+    {
+        const RenderEntityHandle handle = entity.m_render_entity_handle;
+        ASSERT(handle != k_invalid_render_entity_handle);
+
+        if (handle >= m_handle_entity_slots.size())
+        {
+            m_handle_entity_slots.resize(handle + 1);
+        }
+
+        SlotMapHandle& entity_slot = m_handle_entity_slots[handle];
+        RenderEntity*  old_entity  = m_render_entities.get(entity_slot);
+        if (old_entity != nullptr)
+        {
+            if (old_entity->m_instance_id == entity.m_instance_id)
+            {
+                *old_entity = entity;
+                return;
+            }
+
+            // the handle was freed by an object which was never deleted from the scene and reused by a new one
+            releaseEntity(entity_slot);
+        }
+
+        entity_slot = m_render_entities.insert(entity);
+        m_gobject_entity_slots[go_id].push_back(entity_slot);
+    }
+
+    RenderEntity* RenderScene::getEntity(RenderEntityHandle handle)
+    {
+        if (handle >= m_handle_entity_slots.size())
+        {
+            return nullptr;
+        }
+        return m_render_entities.get(m_handle_entity_slots[handle]);
+    }
+
+    void RenderScene::releaseEntity(SlotMapHandle entity_slot)
+    {
+        RenderEntity* entity = m_render_entities.get(entity_slot);
+        if (entity == nullptr)
+        {
+            return;
+        }
+
+        auto object_it = m_mesh_object_id_map.find(entity->m_instance_id);
+        if (object_it != m_mesh_object_id_map.end())
+        {
+            auto entity_slots_it = m_gobject_entity_slots.find(object_it->second);
+            if (entity_slots_it != m_gobject_entity_slots.end())
+            {
+                std::vector<SlotMapHandle>& entity_slots = entity_slots_it->second;
+                entity_slots.erase(std::remove(entity_slots.begin(), entity_slots.end(), entity_slot),
+                                   entity_slots.end());
+                if (entity_slots.empty())
+                {
+                    m_gobject_entity_slots.erase(entity_slots_it);
+                }
+            }
+            m_mesh_object_id_map.erase(object_it);
+        }
+        m_instance_id_allocator.freeGuid(entity->m_instance_id);
+        if (entity->m_render_entity_handle < m_handle_entity_slots.size() &&
+            m_handle_entity_slots[entity->m_render_entity_handle] == entity_slot)
+        {
+            m_handle_entity_slots[entity->m_render_entity_handle] = SlotMapHandle {};
+        }
+        m_render_entities.erase(entity_slot);
+    }
+
     void RenderScene::addInstanceIdToMap(uint32_t instance_id, GObjectID go_id)
     {
         m_mesh_object_id_map[instance_id] = go_id;
@@ -53,27 +130,17 @@ namespace Piccolo
 
     void RenderScene::deleteEntityByGObjectID(GObjectID go_id)
     {
-        for (auto it = m_mesh_object_id_map.begin(); it != m_mesh_object_id_map.end(); it++)
+        auto find_it = m_gobject_entity_slots.find(go_id);
+        if (find_it == m_gobject_entity_slots.end())
         {
-            if (it->second == go_id)
-            {
-                m_mesh_object_id_map.erase(it);
-                break;
-            }
+            return;
         }
 
-        GameObjectPartId part_id = {go_id, 0};
-        size_t           find_guid;
-        if (m_instance_id_allocator.getElementGuid(part_id, find_guid))
+        // releasing an entity removes it from the list of its object
+        const std::vector<SlotMapHandle> entity_slots = find_it->second;
+        for (SlotMapHandle entity_slot : entity_slots)
         {
-            for (auto it = m_render_entities.begin(); it != m_render_entities.end(); it++)
-            {
-                if (it->m_instance_id == find_guid)
-                {
-                    m_render_entities.erase(it);
-                    break;
-                }
-            }
+            releaseEntity(entity_slot);
         }
     }
 
@@ -82,6 +149,8 @@ namespace Piccolo
         m_instance_id_allocator.clear();
         m_mesh_object_id_map.clear();
         m_render_entities.clear();
+        m_handle_entity_slots.clear();
+        m_gobject_entity_slots.clear();
     }
 
     void RenderScene::updateVisibleObjectsDirectionalLight(std::shared_ptr<RenderResource> render_resource,
@@ -101,6 +170,12 @@ namespace Piccolo
 
         for (const RenderEntity& entity : m_render_entities)
         {
+            // skip entities whose buffers and textures are still being copied
+            if (!render_resource->isEntityUploaded(entity))
+            {
+                continue;
+            }
+
             BoundingBox mesh_asset_bounding_box {entity.m_bounding_box.getMinCorner(),
                                                  entity.m_bounding_box.getMaxCorner()};
 
@@ -144,6 +219,12 @@ namespace Piccolo
 
         for (const RenderEntity& entity : m_render_entities)
         {
+            // skip entities whose buffers and textures are still being copied
+            if (!render_resource->isEntityUploaded(entity))
+            {
+                continue;
+            }
+
             BoundingBox mesh_asset_bounding_box {entity.m_bounding_box.getMinCorner(),
                                                  entity.m_bounding_box.getMaxCorner()};
 
@@ -196,6 +277,12 @@ namespace Piccolo
 
         for (const RenderEntity& entity : m_render_entities)
         {
+            // skip entities whose buffers and textures are still being copied
+            if (!render_resource->isEntityUploaded(entity))
+            {
+                continue;
+            }
+
             BoundingBox mesh_asset_bounding_box {entity.m_bounding_box.getMinCorner(),
                                                  entity.m_bounding_box.getMaxCorner()};
 
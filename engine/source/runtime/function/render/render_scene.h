@@ -1,5 +1,7 @@
 #pragma once
 
+#include "runtime/core/base/slot_map.h"
+
 #include "runtime/function/framework/object/object_id_allocator.h"
 
 #include "runtime/function/render/light.h"
@@ -9,6 +11,7 @@
 #include "runtime/function/render/render_object.h"
 
 #include <optional>
+#include <unordered_map>
 #include <vector>
 
 namespace Piccolo
@@ -24,8 +27,8 @@ namespace Piccolo
         PDirectionalLight m_directional_light;
         PointLightList    m_point_light_list;
 
-        // render entities
-        std::vector<RenderEntity> m_render_entities;
+        // render entities, packed for the per frame walks
+        SlotMap<RenderEntity> m_render_entities;
 
         // axis, for editor
         std::optional<RenderEntity> m_render_axis;
@@ -50,6 +53,11 @@ namespace Piccolo
         GuidAllocator<MeshSourceDesc>&     getMeshAssetIdAllocator();
         GuidAllocator<MaterialSourceDesc>& getMaterialAssetdAllocator();
 
+        /// add the entity of a part of the object, or replace the one with the same handle
+        void setEntity(GObjectID go_id, const RenderEntity& entity);
+        /// nullptr if the handle has no entity
+        RenderEntity* getEntity(RenderEntityHandle handle);
+
         void      addInstanceIdToMap(uint32_t instance_id, GObjectID go_id);
         GObjectID getGObjectIDByMeshID(uint32_t mesh_id) const;
         void      deleteEntityByGObjectID(GObjectID go_id);
@@ -63,6 +71,13 @@ namespace Piccolo
 
         std::unordered_map<uint32_t, GObjectID> m_mesh_object_id_map;
 
+        // the entity of every render entity handle, and the entities of every object
+        std::vector<SlotMapHandle>                                m_handle_entity_slots;
+        std::unordered_map<GObjectID, std::vector<SlotMapHandle>> m_gobject_entity_slots;
+
+        // erase the entity and free its instance id and handle
+        void releaseEntity(SlotMapHandle entity_slot);
+
         void updateVisibleObjectsDirectionalLight(std::shared_ptr<RenderResource> render_resource,
                                                   std::shared_ptr<RenderCamera>   camera);
         void updateVisibleObjectsPointLight(std::shared_ptr<RenderResource> render_resource);
@@ -47,6 +47,8 @@ namespace Piccolo
         return !(m_swap_data[m_render_swap_data_index].m_level_resource_desc.has_value() ||
                  m_swap_data[m_render_swap_data_index].m_game_object_resource_desc.has_value() ||
                  m_swap_data[m_render_swap_data_index].m_game_object_to_delete.has_value() ||
+                 m_swap_data[m_render_swap_data_index].m_render_entity_transform_request.has_value() ||
+                 m_swap_data[m_render_swap_data_index].m_asset_reload_request.has_value() ||
                  m_swap_data[m_render_swap_data_index].m_camera_swap_data.has_value() ||
                  m_swap_data[m_render_swap_data_index].m_particle_submit_request.has_value() ||
                  m_swap_data[m_render_swap_data_index].m_emitter_tick_request.has_value() ||
@@ -68,6 +70,16 @@ namespace Piccolo
         m_swap_data[m_render_swap_data_index].m_game_object_to_delete.reset();
     }
 
+    void RenderSwapContext::resetRenderEntityTransformSwapData()
+    {
+        m_swap_data[m_render_swap_data_index].m_render_entity_transform_request.reset();
+    }
+
+    void RenderSwapContext::resetAssetReloadSwapData()
+    {
+        m_swap_data[m_render_swap_data_index].m_asset_reload_request.reset();
+    }
+
     void RenderSwapContext::resetPartilceBatchSwapData()
     {
         m_swap_data[m_render_swap_data_index].m_particle_submit_request.reset();
@@ -90,6 +102,8 @@ namespace Piccolo
         resetLevelRsourceSwapData();
         resetGameObjectResourceSwapData();
         resetGameObjectToDelete();
+        resetRenderEntityTransformSwapData();
+        resetAssetReloadSwapData();
         resetCameraSwapData();
         resetEmitterTickSwapData();
         resetEmitterTransformSwapData();
@@ -125,6 +139,40 @@ namespace Piccolo
         }
     }
 
+    void RenderSwapData::updateRenderEntityTransforms(const RenderEntityHandle*     render_entity_handles,
+                                                      const Matrix4x4*              model_matrices,
+                                                      size_t                        count,
+                                                      const std::vector<Matrix4x4>& joint_matrices)
+    {
+        if (!m_render_entity_transform_request.has_value())
+        {
+            m_render_entity_transform_request.emplace();
+        }
+        RenderEntityTransformRequest& request = *m_render_entity_transform_request;
+
+        const uint32_t joint_matrix_offset = static_cast<uint32_t>(request.m_joint_matrices.size());
+        request.m_joint_matrices.insert(request.m_joint_matrices.end(), joint_matrices.begin(), joint_matrices.end());
+
+        for (size_t index = 0; index < count; ++index)
+        {
+            RenderEntityTransformDesc desc;
+            desc.m_render_entity_handle = render_entity_handles[index];
+            desc.m_model_matrix         = model_matrices[index];
+            desc.m_joint_matrix_offset  = joint_matrix_offset;
+            desc.m_joint_matrix_count   = static_cast<uint32_t>(joint_matrices.size());
+            request.m_transform_descs.push_back(desc);
+        }
+    }
+
+    void RenderSwapData::reloadAssetFile(const std::string& file_path)
+    {
+        if (!m_asset_reload_request.has_value())
+        {
+            m_asset_reload_request.emplace();
+        }
+        m_asset_reload_request->m_file_paths.push_back(file_path);
+    }
+
     void RenderSwapData::addNewParticleEmitter(ParticleEmitterDesc& desc)
     {
         if (m_particle_submit_request.has_value())
@@ -3,6 +3,7 @@
 #include "runtime/function/particle/emitter_id_allocator.h"
 #include "runtime/function/particle/particle_desc.h"
 #include "runtime/function/render/render_camera.h"
+#include "runtime/function/render/render_entity_handle_allocator.h"
 #include "runtime/function/render/render_object.h"
 
 #include "runtime/resource/res_type/global/global_particle.h"
@@ -52,6 +53,28 @@ namespace Piccolo
         GameObjectDesc& getNextProcessObject();
     };
 
+    struct RenderEntityTransformDesc
+    {
+        RenderEntityHandle m_render_entity_handle {k_invalid_render_entity_handle};
+        Matrix4x4          m_model_matrix {Matrix4x4::IDENTITY};
+        // the pose in RenderEntityTransformRequest::m_joint_matrices, none without animation
+        uint32_t m_joint_matrix_offset {0};
+        uint32_t m_joint_matrix_count {0};
+    };
+
+    /// the model matrices and poses of existing render entities, written every frame for the moving objects
+    struct RenderEntityTransformRequest
+    {
+        std::vector<RenderEntityTransformDesc> m_transform_descs;
+        std::vector<Matrix4x4>                 m_joint_matrices;
+    };
+
+    /// asset files changed on disk, the render system reloads the meshes and materials made from them
+    struct AssetReloadRequest
+    {
+        std::vector<std::string> m_file_paths;
+    };
+
     struct ParticleSubmitRequest
     {
         std::vector<ParticleEmitterDesc> m_emitter_descs;
@@ -83,16 +106,24 @@ namespace Piccolo
 
     struct RenderSwapData
     {
-        std::optional<LevelResourceDesc>       m_level_resource_desc;
-        std::optional<GameObjectResourceDesc>  m_game_object_resource_desc;
-        std::optional<GameObjectResourceDesc>  m_game_object_to_delete;
-        std::optional<CameraSwapData>          m_camera_swap_data;
-        std::optional<ParticleSubmitRequest>   m_particle_submit_request;
-        std::optional<EmitterTickRequest>      m_emitter_tick_request;
-        std::optional<EmitterTransformRequest> m_emitter_transform_request;
+        std::optional<LevelResourceDesc>            m_level_resource_desc;
+        std::optional<GameObjectResourceDesc>       m_game_object_resource_desc;
+        std::optional<GameObjectResourceDesc>       m_game_object_to_delete;
+        std::optional<RenderEntityTransformRequest> m_render_entity_transform_request;
+        std::optional<AssetReloadRequest>           m_asset_reload_request;
+        std::optional<CameraSwapData>               m_camera_swap_data;
+        std::optional<ParticleSubmitRequest>        m_particle_submit_request;
+        std::optional<EmitterTickRequest>           m_emitter_tick_request;
+        std::optional<EmitterTransformRequest>      m_emitter_transform_request;
 
         void addDirtyGameObject(GameObjectDesc&& desc);
         void addDeleteGameObject(GameObjectDesc&& desc);
+        /// the render entities of the handles share one pose, which may be empty
+        void updateRenderEntityTransforms(const RenderEntityHandle*     render_entity_handles,
+                                          const Matrix4x4*              model_matrices,
+                                          size_t                        count,
+                                          const std::vector<Matrix4x4>& joint_matrices);
+        void reloadAssetFile(const std::string& file_path);
 
         void addNewParticleEmitter(ParticleEmitterDesc& desc);
         void addTickParticleEmitter(ParticleEmitterID id);
@@ -115,6 +146,8 @@ namespace Piccolo
         void            resetLevelRsourceSwapData();
         void            resetGameObjectResourceSwapData();
         void            resetGameObjectToDelete();
+        void            resetRenderEntityTransformSwapData();
+        void            resetAssetReloadSwapData();
         void            resetCameraSwapData();
         void            resetPartilceBatchSwapData();
         void            resetEmitterTickSwapData();
@@ -1,6 +1,12 @@
 #include "runtime/function/render/render_system.h"
 
 #include "runtime/core/base/macro.h"
+#include "runtime/core/profile/frame_stage_timer.h"
+#include "runtime/core/profile/profiler.h"
+
+#include "runtime/engine.h"
+
+#include "runtime/platform/file_service/file_service.h"
 
 #include "runtime/resource/asset_manager/asset_manager.h"
 #include "runtime/resource/config_manager/config_manager.h"
@@ -20,6 +26,10 @@
 
 #include "runtime/function/render/interface/vulkan/vulkan_rhi.h"
 
+#include <algorithm>
+#include <array>
+#include <filesystem>
+
 namespace Piccolo
 {
     RenderSystem::~RenderSystem()
@@ -34,9 +44,25 @@ namespace Piccolo
         std::shared_ptr<AssetManager> asset_manager = g_runtime_global_context.m_asset_manager;
         ASSERT(asset_manager);
 
+        m_is_headless = init_info.is_headless;
+        if (m_is_headless)
+        {
+            // the camera is still queried by logic, e.g. for its fov
+            GlobalRenderingRes global_rendering_res;
+            asset_manager->loadAsset(config_manager->getGlobalRenderingResUrl(), global_rendering_res);
+
+            const CameraPose& camera_pose = global_rendering_res.m_camera_config.m_pose;
+            m_render_camera               = std::make_shared<RenderCamera>();
+            m_render_camera->lookAt(camera_pose.m_position, camera_pose.m_target, camera_pose.m_up);
+
+            LOG_INFO("render system runs headless");
+            return;
+        }
+
         // render context initialize
         RHIInitInfo rhi_init_info;
-        rhi_init_info.window_system = init_info.window_system;
+        rhi_init_info.window_system       = init_info.window_system;
+        rhi_init_info.pipeline_cache_path = config_manager->getRootFolder() / "pipeline_cache.bin";
 
         m_rhi = std::make_shared<VulkanRHI>();
         m_rhi->initialize(rhi_init_info);
@@ -92,22 +118,66 @@ namespace Piccolo
             &static_cast<RenderPass*>(m_render_pipeline->m_main_camera_pass.get())
                  ->m_descriptor_infos[MainCameraPass::LayoutType::_mesh_per_material]
                  .layout;
+
+        // a removed file keeps its last version on the gpu until something else is loaded in its place
+        if (g_is_asset_hot_reload_enabled)
+        {
+            m_file_change_subscription =
+                g_runtime_global_context.m_file_system->subscribe([this](const FileChangeEvent& event) {
+                    if (event.m_type != FileChangeType::removed && !event.m_is_directory)
+                    {
+                        m_swap_context.getLogicSwapData().reloadAssetFile(event.m_path.generic_string());
+                    }
+                });
+        }
     }
 
     void RenderSystem::tick(float delta_time)
     {
+        if (m_is_headless)
+        {
+            discardSwapData();
+            return;
+        }
+
+        // the mesh buffers of the old level leave holes in the pool, compact it before the next level fills it
+        if (!m_released_mesh_asset_ids.empty())
+        {
+            std::sort(m_released_mesh_asset_ids.begin(), m_released_mesh_asset_ids.end());
+            m_released_mesh_asset_ids.erase(
+                std::unique(m_released_mesh_asset_ids.begin(), m_released_mesh_asset_ids.end()),
+                m_released_mesh_asset_ids.end());
+
+            std::static_pointer_cast<RenderResource>(m_render_resource)
+                ->releaseVulkanMeshes(m_rhi, m_released_mesh_asset_ids);
+            for (size_t mesh_asset_id : m_released_mesh_asset_ids)
+            {
+                m_render_scene->getMeshAssetIdAllocator().freeGuid(mesh_asset_id);
+            }
+            m_released_mesh_asset_ids.clear();
+
+            m_rhi->defragmentMemory();
+        }
+
         // process swap data between logic and render contexts
         processSwapData();
 
         // prepare render command context
         m_rhi->prepareContext();
 
+        // entities are drawn once their upload batch has retired
+        std::static_pointer_cast<RenderResource>(m_render_resource)->m_retired_upload_ticket =
+            m_rhi->getRetiredUploadTicket();
+
         // update per-frame buffer
         m_render_resource->updatePerFrameBuffer(m_render_scene, m_render_camera);
 
         // update per-frame visible objects
-        m_render_scene->updateVisibleObjects(std::static_pointer_cast<RenderResource>(m_render_resource),
-                                             m_render_camera);
+        {
+            ScopedFrameStageTimer culling_timer(FrameStage::culling);
+            m_render_scene->updateVisibleObjects(std::static_pointer_cast<RenderResource>(m_render_resource),
+                                                 m_render_camera);
+        }
 
         // prepare pipeline's render passes data
         m_render_pipeline->preparePassData(m_render_resource);
@@ -115,6 +185,7 @@ namespace Piccolo
         g_runtime_global_context.m_debugdraw_manager->tick(delta_time);
 
         // render one frame
+        ScopedFrameStageTimer pass_recording_timer(FrameStage::pass_recording);
         if (m_render_pipeline_type == RENDER_PIPELINE_TYPE::FORWARD_PIPELINE)
         {
             m_render_pipeline->forwardRender(m_rhi, m_render_resource);
@@ -131,6 +202,12 @@ namespace Piccolo
 
     void RenderSystem::clear()
     {
+        if (m_file_change_subscription != 0)
+        {
+            g_runtime_global_context.m_file_system->unsubscribe(m_file_change_subscription);
+            m_file_change_subscription = 0;
+        }
+
         if (m_rhi)
         {
             m_rhi->clear();
@@ -201,6 +278,9 @@ namespace Piccolo
         {
             m_render_resource->uploadGameObjectRenderResource(m_rhi, axis_entities[i], mesh_datas[i]);
         }
+
+        // the axis is drawn without checking the upload ticket
+        m_rhi->flushUploads();
     }
 
     void RenderSystem::setVisibleAxis(std::optional<RenderEntity> axis)
@@ -234,6 +314,12 @@ namespace Piccolo
 
     void RenderSystem::clearForLevelReloading()
     {
+        // this may run while a frame is recorded, its meshes are only freed by the next tick
+        for (const RenderEntity& entity : m_render_scene->m_render_entities)
+        {
+            m_released_mesh_asset_ids.push_back(entity.m_mesh_asset_id);
+        }
+
         m_render_scene->clearForLevelReloading();
     }
 
@@ -247,8 +333,123 @@ namespace Piccolo
         m_render_pipeline->initializeUIRenderBackend(window_ui);
     }
 
+    void RenderSystem::discardSwapData()
+    {
+        // reset the render side so the next swap always happens
+        m_swap_context.resetLevelRsourceSwapData();
+        m_swap_context.resetGameObjectResourceSwapData();
+        m_swap_context.resetGameObjectToDelete();
+        m_swap_context.resetRenderEntityTransformSwapData();
+        m_swap_context.resetAssetReloadSwapData();
+        m_swap_context.resetCameraSwapData();
+        m_swap_context.resetPartilceBatchSwapData();
+        m_swap_context.resetEmitterTickSwapData();
+        m_swap_context.resetEmitterTransformSwapData();
+    }
+
+    void RenderSystem::reloadAssetFiles(const std::vector<std::string>& file_paths)
+    {
+        PROFILE_ZONE("RenderSystem::reloadAssetFiles");
+
+        GuidAllocator<MeshSourceDesc>&     mesh_asset_id_allocator     = m_render_scene->getMeshAssetIdAllocator();
+        GuidAllocator<MaterialSourceDesc>& material_asset_id_allocator = m_render_scene->getMaterialAssetdAllocator();
+
+        for (const std::string& file_path : file_paths)
+        {
+            // the sources hold the paths of AssetManager::getFullPath, which are not always lexically normal
+            const std::filesystem::path changed_path = std::filesystem::path(file_path).lexically_normal();
+            auto isChangedFile = [&changed_path](const std::string& source_file) {
+                return !source_file.empty() && std::filesystem::path(source_file).lexically_normal() == changed_path;
+            };
+
+            for (size_t mesh_asset_id : mesh_asset_id_allocator.getAllocatedGuids())
+            {
+                MeshSourceDesc mesh_source;
+                if (!mesh_asset_id_allocator.getGuidRelatedElement(mesh_asset_id, mesh_source) ||
+                    !isChangedFile(mesh_source.m_mesh_file))
+                {
+                    continue;
+                }
+
+                RenderEntity render_entity;
+                render_entity.m_mesh_asset_id = mesh_asset_id;
+                RenderMeshData mesh_data = m_render_resource->loadMeshData(mesh_source, render_entity.m_bounding_box);
+                if (!mesh_data.m_static_mesh_data.m_vertex_buffer ||
+                    mesh_data.m_static_mesh_data.m_vertex_buffer->m_size == 0)
+                {
+                    LOG_ERROR("reloading mesh {} failed, the old mesh is kept", mesh_source.m_mesh_file);
+                    continue;
+                }
+                m_render_resource->reloadGameObjectRenderResource(m_rhi, render_entity, mesh_data);
+
+                // culling uses the bounds of the new vertices
+                for (RenderEntity& entity : m_render_scene->m_render_entities)
+                {
+                    if (entity.m_mesh_asset_id == mesh_asset_id)
+                    {
+                        entity.m_bounding_box = render_entity.m_bounding_box;
+                    }
+                }
+                LOG_INFO("reloaded mesh {}", mesh_source.m_mesh_file);
+            }
+
+            for (size_t material_asset_id : material_asset_id_allocator.getAllocatedGuids())
+            {
+                MaterialSourceDesc material_source;
+                if (!material_asset_id_allocator.getGuidRelatedElement(material_asset_id, material_source))
+                {
+                    continue;
+                }
+
+                const std::array<const std::string*, 5> texture_files = {&material_source.m_base_color_file,
+                                                                         &material_source.m_metallic_roughness_file,
+                                                                         &material_source.m_normal_file,
+                                                                         &material_source.m_occlusion_file,
+                                                                         &material_source.m_emissive_file};
+                bool is_using_changed_file = false;
+                for (const std::string* texture_file : texture_files)
+                {
+                    is_using_changed_file = is_using_changed_file || isChangedFile(*texture_file);
+                }
+                if (!is_using_changed_file)
+                {
+                    continue;
+                }
+
+                // all textures of the material are read again, only the changed one has to be readable
+                RenderMaterialData material_data = m_render_resource->loadMaterialData(material_source);
+                const std::array<const std::shared_ptr<TextureData>*, 5> textures = {
+                    &material_data.m_base_color_texture,
+                    &material_data.m_metallic_roughness_texture,
+                    &material_data.m_normal_texture,
+                    &material_data.m_occlusion_texture,
+                    &material_data.m_emissive_texture};
+                bool is_loaded = true;
+                for (size_t texture_index = 0; texture_index < texture_files.size(); ++texture_index)
+                {
+                    if (isChangedFile(*texture_files[texture_index]) && !*textures[texture_index])
+                    {
+                        is_loaded = false;
+                    }
+                }
+                if (!is_loaded)
+                {
+                    LOG_ERROR("reloading texture {} failed, the old material is kept", file_path);
+                    continue;
+                }
+
+                RenderEntity render_entity;
+                render_entity.m_material_asset_id = material_asset_id;
+                m_render_resource->reloadGameObjectRenderResource(m_rhi, render_entity, material_data);
+                LOG_INFO("reloaded material {} for texture {}", material_asset_id, file_path);
+            }
+        }
+    }
+
     void RenderSystem::processSwapData()
     {
+        PROFILE_ZONE("RenderSystem::processSwapData");
+
         RenderSwapData& swap_data = m_swap_context.getRenderSwapData();
 
         std::shared_ptr<AssetManager> asset_manager = g_runtime_global_context.m_asset_manager;
@@ -263,6 +464,14 @@ namespace Piccolo
             m_swap_context.resetLevelRsourceSwapData();
         }
 
+        // replace the meshes and materials whose files changed, before new objects may use them
+        if (swap_data.m_asset_reload_request.has_value())
+        {
+            reloadAssetFiles(swap_data.m_asset_reload_request->m_file_paths);
+
+            m_swap_context.resetAssetReloadSwapData();
+        }
+
         // update game object if needed
         if (swap_data.m_game_object_resource_desc.has_value())
         {
@@ -275,12 +484,11 @@ namespace Piccolo
                     const auto&      game_object_part = gobject.getObjectParts()[part_index];
                     GameObjectPartId part_id          = {gobject.getId(), part_index};
 
-                    bool is_entity_in_scene = m_render_scene->getInstanceIdAllocator().hasElement(part_id);
-
                     RenderEntity render_entity;
                     render_entity.m_instance_id =
                         static_cast<uint32_t>(m_render_scene->getInstanceIdAllocator().allocGuid(part_id));
-                    render_entity.m_model_matrix = game_object_part.m_transform_desc.m_transform_matrix;
+                    render_entity.m_render_entity_handle = game_object_part.m_render_entity_handle;
+                    render_entity.m_model_matrix         = game_object_part.m_transform_desc.m_transform_matrix;
 
                     m_render_scene->addInstanceIdToMap(render_entity.m_instance_id, gobject.getId());
 
@@ -351,22 +559,8 @@ namespace Piccolo
                         m_render_resource->uploadGameObjectRenderResource(m_rhi, render_entity, material_data);
                     }
 
-                    // add object to render scene if needed
-                    if (!is_entity_in_scene)
-                    {
-                        m_render_scene->m_render_entities.push_back(render_entity);
-                    }
-                    else
-                    {
-                        for (auto& entity : m_render_scene->m_render_entities)
-                        {
-                            if (entity.m_instance_id == render_entity.m_instance_id)
-                            {
-                                entity = render_entity;
-                                break;
-                            }
-                        }
-                    }
+                    // add object to render scene, or replace the entity of the handle
+                    m_render_scene->setEntity(gobject.getId(), render_entity);
                 }
                 // after finished processing, pop this game object
                 swap_data.m_game_object_resource_desc->pop();
@@ -376,6 +570,30 @@ namespace Piccolo
             m_swap_context.resetGameObjectResourceSwapData();
         }
 
+        // move the existing entities, objects only resend their whole description when it changes
+        if (swap_data.m_render_entity_transform_request.has_value())
+        {
+            const RenderEntityTransformRequest& request = *swap_data.m_render_entity_transform_request;
+            for (const RenderEntityTransformDesc& transform_desc : request.m_transform_descs)
+            {
+                RenderEntity* render_entity = m_render_scene->getEntity(transform_desc.m_render_entity_handle);
+                if (render_entity == nullptr)
+                {
+                    continue;
+                }
+
+                render_entity->m_model_matrix = transform_desc.m_model_matrix;
+                if (transform_desc.m_joint_matrix_count > 0)
+                {
+                    auto joint_matrix_begin = request.m_joint_matrices.begin() + transform_desc.m_joint_matrix_offset;
+                    render_entity->m_joint_matrices.assign(joint_matrix_begin,
+                                                           joint_matrix_begin + transform_desc.m_joint_matrix_count);
+                }
+            }
+
+            m_swap_context.resetRenderEntityTransformSwapData();
+        }
+
         // remove deleted objects
         if (swap_data.m_game_object_to_delete.has_value())
         {
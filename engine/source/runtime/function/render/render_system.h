@@ -6,8 +6,11 @@
 #include "runtime/function/render/render_type.h"
 
 #include <array>
+#include <cstddef>
 #include <memory>
 #include <optional>
+#include <string>
+#include <vector>
 
 namespace Piccolo
 {
@@ -24,6 +27,8 @@ namespace Piccolo
     {
         std::shared_ptr<WindowSystem> window_system;
         std::shared_ptr<DebugDrawManager> debugdraw_manager;
+        // no RHI is created, the swap data from the logic side is dropped every frame
+        bool is_headless {false};
     };
 
     struct EngineContentViewport
@@ -68,6 +73,8 @@ namespace Piccolo
     private:
         RENDER_PIPELINE_TYPE m_render_pipeline_type {RENDER_PIPELINE_TYPE::DEFERRED_PIPELINE};
 
+        bool m_is_headless {false};
+
         RenderSwapContext m_swap_context;
 
         std::shared_ptr<RHI>                m_rhi;
@@ -76,6 +83,14 @@ namespace Piccolo
         std::shared_ptr<RenderResourceBase> m_render_resource;
         std::shared_ptr<RenderPipelineBase> m_render_pipeline;
 
+        size_t m_file_change_subscription {0};
+
+        // meshes of the unloaded level, freed at the start of the next tick before any command is recorded
+        std::vector<size_t> m_released_mesh_asset_ids;
+
         void processSwapData();
+        void discardSwapData();
+        // reupload the meshes and materials made from the files
+        void reloadAssetFiles(const std::vector<std::string>& file_paths);
     };
 } // namespace Piccolo
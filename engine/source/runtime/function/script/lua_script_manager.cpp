@@ -0,0 +1,309 @@
+#include "runtime/function/script/lua_script_manager.h"
+
+#include "runtime/core/base/macro.h"
+#include "runtime/core/profile/frame_stage_timer.h"
+#include "runtime/core/profile/profiler.h"
+
+#include "runtime/function/framework/component/lua/lua_field_binding.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Piccolo
+{
+    namespace
+    {
+        // the hook runs every that many instructions, the instruction counts are multiples of it
+        constexpr int k_hook_instruction_interval = 1000;
+
+        // the globals a script can reach, nothing touching files, modules or the other environments
+        const char* const k_sandbox_globals[] = {"assert",
+                                                 "error",
+                                                 "ipairs",
+                                                 "next",
+                                                 "pairs",
+                                                 "pcall",
+                                                 "print",
+                                                 "select",
+                                                 "tonumber",
+                                                 "tostring",
+                                                 "type",
+                                                 "xpcall"};
+
+        // the libraries are shared by all scripts, so the sandbox only holds read only proxies of them
+        const char* const k_sandbox_libraries[] = {"math", "string", "table"};
+
+        // returns an empty table reading through to the library, pairs still lists the library
+        constexpr const char* k_read_only_proxy_source = R"(
+            local library = ...
+            return setmetatable({}, {
+                __index = library,
+                __newindex = function(_, key)
+                    error("attempt to modify the read only library field " .. tostring(key), 2)
+                end,
+                __pairs = function()
+                    return next, library, nil
+                end,
+                __metatable = false
+            })
+        )";
+    } // namespace
+
+    void LuaScriptManager::initialize()
+    {
+        m_lua_state.open_libraries(sol::lib::base, sol::lib::math, sol::lib::string, sol::lib::table);
+
+        m_sandbox = m_lua_state.create_table();
+        for (const char* global_name : k_sandbox_globals)
+        {
+            m_sandbox[global_name] = m_lua_state.get<sol::object>(global_name);
+        }
+
+        sol::protected_function create_read_only_proxy = m_lua_state.load(k_read_only_proxy_source, "sandbox");
+        for (const char* library_name : k_sandbox_libraries)
+        {
+            sol::protected_function_result result = create_read_only_proxy(m_lua_state.get<sol::table>(library_name));
+            ASSERT(result.valid());
+            m_sandbox[library_name] = result.get<sol::table>();
+        }
+
+        m_lua_state.new_usertype<LuaFieldBinding>("FieldBinding",
+                                                  "is_valid",
+                                                  &LuaFieldBinding::isValid,
+                                                  "set_float",
+                                                  &LuaFieldBinding::set<float>,
+                                                  "get_float",
+                                                  &LuaFieldBinding::get<float>,
+                                                  "set_bool",
+                                                  &LuaFieldBinding::set<bool>,
+                                                  "get_bool",
+                                                  &LuaFieldBinding::get<bool>);
+
+        lua_State* lua_state                                          = m_lua_state.lua_state();
+        *static_cast<LuaScriptManager**>(lua_getextraspace(lua_state)) = this;
+        lua_sethook(lua_state, &LuaScriptManager::instructionHook, LUA_MASKCOUNT, k_hook_instruction_interval);
+    }
+
+    void LuaScriptManager::clear()
+    {
+        m_scheduled_script_ids.clear();
+        m_deferred_script_ids.clear();
+        m_free_script_ids.clear();
+        m_scripts.clear();
+        m_chunks.clear();
+        m_sandbox = sol::lua_nil;
+    }
+
+    void LuaScriptManager::instructionHook(lua_State* lua_state, lua_Debug* debug_info)
+    {
+        LuaScriptManager* manager = *static_cast<LuaScriptManager**>(lua_getextraspace(lua_state));
+
+        manager->m_running_instruction_count += k_hook_instruction_interval;
+        if (manager->m_running_instruction_count > manager->m_script_instruction_limit)
+        {
+            luaL_error(lua_state,
+                       "instruction limit of %I exceeded",
+                       static_cast<lua_Integer>(manager->m_script_instruction_limit));
+        }
+    }
+
+    const sol::bytecode* LuaScriptManager::findOrCompileChunk(const std::string& name, const std::string& source)
+    {
+        auto chunk_iter = m_chunks.find(source);
+        if (chunk_iter != m_chunks.end())
+        {
+            return &chunk_iter->second;
+        }
+
+        sol::load_result load_result = m_lua_state.load(source, name);
+        if (!load_result.valid())
+        {
+            sol::error error = load_result;
+            LOG_ERROR("failed to compile script {}: {}", name, error.what());
+            return nullptr;
+        }
+
+        sol::protected_function function = load_result;
+        return &m_chunks.emplace(source, function.dump()).first->second;
+    }
+
+    LuaScriptID LuaScriptManager::createScript(const std::string& name, const std::string& source)
+    {
+        const sol::bytecode* bytecode = findOrCompileChunk(name, source);
+        if (bytecode == nullptr)
+        {
+            return k_invalid_lua_script_id;
+        }
+
+        sol::load_result load_result = m_lua_state.load(bytecode->as_string_view(), name, sol::load_mode::binary);
+        if (!load_result.valid())
+        {
+            sol::error error = load_result;
+            LOG_ERROR("failed to load script {}: {}", name, error.what());
+            return k_invalid_lua_script_id;
+        }
+
+        LuaScriptID script_id;
+        if (m_free_script_ids.empty())
+        {
+            script_id = static_cast<LuaScriptID>(m_scripts.size());
+            m_scripts.emplace_back();
+        }
+        else
+        {
+            script_id = m_free_script_ids.back();
+            m_free_script_ids.pop_back();
+        }
+
+        LuaScript& script     = m_scripts[script_id];
+        script.m_is_alive     = true;
+        script.m_is_scheduled = false;
+        script.m_environment  = sol::environment(m_lua_state, sol::create, m_sandbox);
+        script.m_function     = load_result.get<sol::protected_function>();
+        script.m_environment.set_on(script.m_function);
+        script.m_stats        = LuaScriptStats();
+        script.m_stats.m_name = name;
+
+        return script_id;
+    }
+
+    void LuaScriptManager::destroyScript(LuaScriptID script_id)
+    {
+        if (script_id >= m_scripts.size() || !m_scripts[script_id].m_is_alive)
+        {
+            return;
+        }
+
+        // the id may still be in the scheduled lists, the tick skips scripts which are not scheduled
+        m_scripts[script_id] = LuaScript();
+        m_free_script_ids.push_back(script_id);
+    }
+
+    sol::environment& LuaScriptManager::getScriptEnvironment(LuaScriptID script_id)
+    {
+        ASSERT(script_id < m_scripts.size() && m_scripts[script_id].m_is_alive);
+        return m_scripts[script_id].m_environment;
+    }
+
+    void LuaScriptManager::scheduleScript(LuaScriptID script_id)
+    {
+        if (script_id >= m_scripts.size())
+        {
+            return;
+        }
+
+        LuaScript& script = m_scripts[script_id];
+        if (script.m_is_alive && !script.m_is_scheduled)
+        {
+            script.m_is_scheduled = true;
+            m_scheduled_script_ids.push_back(script_id);
+        }
+    }
+
+    void LuaScriptManager::setFrameBudget(uint64_t instruction_budget, float time_budget_ms)
+    {
+        m_frame_instruction_budget = instruction_budget;
+        m_frame_time_budget_ms     = time_budget_ms;
+    }
+
+    void LuaScriptManager::tick(float delta_time)
+    {
+        PROFILE_ZONE("LuaScriptManager::tick");
+        ScopedFrameStageTimer script_timer(FrameStage::script);
+
+        using namespace std::chrono;
+
+        std::vector<LuaScriptID>& script_ids = m_deferred_script_ids;
+        script_ids.insert(script_ids.end(), m_scheduled_script_ids.begin(), m_scheduled_script_ids.end());
+        m_scheduled_script_ids.clear();
+
+        const steady_clock::time_point frame_begin             = steady_clock::now();
+        uint64_t                       frame_instruction_count = 0;
+
+        size_t run_count = 0;
+        for (; run_count < script_ids.size(); ++run_count)
+        {
+            // at least one script runs every frame, whatever the budgets are
+            const duration<float, std::milli> frame_time = steady_clock::now() - frame_begin;
+            if (run_count > 0 &&
+                (frame_instruction_count >= m_frame_instruction_budget || frame_time.count() >= m_frame_time_budget_ms))
+            {
+                break;
+            }
+
+            LuaScript& script = m_scripts[script_ids[run_count]];
+            if (!script.m_is_alive || !script.m_is_scheduled)
+            {
+                continue;
+            }
+
+            script.m_is_scheduled = false;
+            runScript(script);
+            frame_instruction_count += script.m_stats.m_last_instruction_count;
+        }
+
+        // the scripts over the budget stay scheduled
+        script_ids.erase(script_ids.begin(), script_ids.begin() + run_count);
+    }
+
+    void LuaScriptManager::runScript(LuaScript& script)
+    {
+        using namespace std::chrono;
+
+        m_running_instruction_count = 0;
+
+        const steady_clock::time_point     begin_time = steady_clock::now();
+        sol::protected_function_result     result     = script.m_function();
+        const duration<double, std::milli> run_time   = steady_clock::now() - begin_time;
+
+        if (!result.valid())
+        {
+            sol::error error = result;
+            LOG_ERROR("script {} failed: {}", script.m_stats.m_name, error.what());
+        }
+
+        LuaScriptStats& stats          = script.m_stats;
+        stats.m_last_time_ms           = run_time.count();
+        stats.m_max_time_ms            = std::max(stats.m_max_time_ms, stats.m_last_time_ms);
+        stats.m_last_instruction_count = m_running_instruction_count;
+
+        stats.m_total_time_ms += stats.m_last_time_ms;
+        ++stats.m_tick_count;
+    }
+
+    void LuaScriptManager::getSlowestScripts(uint32_t max_count, std::vector<const LuaScriptStats*>& out_scripts) const
+    {
+        out_scripts.clear();
+        for (const LuaScript& script : m_scripts)
+        {
+            if (script.m_is_alive && script.m_stats.m_tick_count > 0)
+            {
+                out_scripts.push_back(&script.m_stats);
+            }
+        }
+
+        const size_t count = std::min<size_t>(max_count, out_scripts.size());
+        std::partial_sort(out_scripts.begin(),
+                          out_scripts.begin() + count,
+                          out_scripts.end(),
+                          [](const LuaScriptStats* lhs, const LuaScriptStats* rhs) {
+                              return lhs->m_last_time_ms > rhs->m_last_time_ms;
+                          });
+        out_scripts.resize(count);
+    }
+
+    void LuaScriptManager::logSlowestScripts(uint32_t max_count) const
+    {
+        std::vector<const LuaScriptStats*> slowest_scripts;
+        getSlowestScripts(max_count, slowest_scripts);
+        for (const LuaScriptStats* stats : slowest_scripts)
+        {
+            LOG_INFO("script {}: last {:.3f} ms, max {:.3f} ms, average {:.3f} ms, ~{} instructions",
+                     stats->m_name,
+                     stats->m_last_time_ms,
+                     stats->m_max_time_ms,
+                     stats->m_total_time_ms / stats->m_tick_count,
+                     stats->m_last_instruction_count);
+        }
+    }
+} // namespace Piccolo
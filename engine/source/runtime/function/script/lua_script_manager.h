@@ -0,0 +1,102 @@
+#pragma once
+
+#include "sol/sol.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Piccolo
+{
+    using LuaScriptID = uint32_t;
+
+    constexpr LuaScriptID k_invalid_lua_script_id = std::numeric_limits<LuaScriptID>::max();
+
+    /// timings of one script, the instruction counts are rounded to the hook interval
+    struct LuaScriptStats
+    {
+        std::string m_name;
+        double      m_last_time_ms {0.0};
+        double      m_max_time_ms {0.0};
+        double      m_total_time_ms {0.0};
+        uint64_t    m_tick_count {0};
+        uint64_t    m_last_instruction_count {0};
+    };
+
+    /// runs the scripts of all LuaComponents in one shared lua state
+    ///
+    /// every script gets its own environment, so its globals stay private, and falls back to a sandbox table that only
+    /// holds the safe parts of the base library and read only proxies of the math, string and table libraries. a
+    /// source is compiled once to bytecode, cached by the source text, and every script using it loads its own
+    /// closure from the bytecode.
+    ///
+    /// components schedule their script from their tick and the scheduled scripts run together in tick, until the
+    /// instruction or time budget of the frame is used up, the rest runs first in the next frame
+    class LuaScriptManager
+    {
+    public:
+        void initialize();
+        void clear();
+
+        /// returns k_invalid_lua_script_id if the script does not compile
+        LuaScriptID createScript(const std::string& name, const std::string& source);
+        void        destroyScript(LuaScriptID script_id);
+
+        /// bind the functions and objects the script uses here, it falls back to the sandbox for the rest
+        sol::environment& getScriptEnvironment(LuaScriptID script_id);
+
+        void scheduleScript(LuaScriptID script_id);
+
+        /// run the scheduled scripts, main thread only
+        void tick(float delta_time);
+
+        /// budgets of a frame, a script is never cut off by them, only the scripts after it wait for the next frame
+        void setFrameBudget(uint64_t instruction_budget, float time_budget_ms);
+
+        /// a script running longer is aborted, this catches endless loops
+        void setScriptInstructionLimit(uint64_t instruction_limit) { m_script_instruction_limit = instruction_limit; }
+
+        /// the scripts with the longest last run, slowest first
+        void getSlowestScripts(uint32_t max_count, std::vector<const LuaScriptStats*>& out_scripts) const;
+
+        void logSlowestScripts(uint32_t max_count) const;
+
+    private:
+        struct LuaScript
+        {
+            bool                    m_is_alive {false};
+            bool                    m_is_scheduled {false};
+            sol::environment        m_environment;
+            sol::protected_function m_function;
+            LuaScriptStats          m_stats;
+        };
+
+        static void instructionHook(lua_State* lua_state, lua_Debug* debug_info);
+
+        const sol::bytecode* findOrCompileChunk(const std::string& name, const std::string& source);
+
+        void runScript(LuaScript& script);
+
+        sol::state m_lua_state;
+        sol::table m_sandbox;
+
+        // keyed by the source, the objects sharing a script share its bytecode
+        std::unordered_map<std::string, sol::bytecode> m_chunks;
+
+        std::vector<LuaScript>   m_scripts;
+        std::vector<LuaScriptID> m_free_script_ids;
+
+        // the scripts deferred from the last frame come first, so no script waits more than a frame behind the others
+        std::vector<LuaScriptID> m_scheduled_script_ids;
+        std::vector<LuaScriptID> m_deferred_script_ids;
+
+        uint64_t m_frame_instruction_budget {10000000};
+        float    m_frame_time_budget_ms {4.0f};
+        uint64_t m_script_instruction_limit {1000000};
+
+        // counted by the hook while a script runs
+        uint64_t m_running_instruction_count {0};
+    };
+} // namespace Piccolo
@@ -1,5 +1,11 @@
 #include "runtime/platform/file_service/file_service.h"
 
+#include "runtime/core/profile/profiler.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
 using namespace std;
 
 namespace Piccolo
@@ -16,4 +22,75 @@ namespace Piccolo
         }
         return files;
     }
-} // namespace Piccolo
\ No newline at end of file
+
+    bool FileSystem::watchDirectory(const filesystem::path& directory)
+    {
+        if (!m_file_watcher)
+        {
+            m_file_watcher = make_unique<FileWatcher>();
+        }
+        return m_file_watcher->watch(directory);
+    }
+
+    void FileSystem::tick()
+    {
+        PROFILE_ZONE("FileSystem::tick");
+
+        if (!m_file_watcher)
+        {
+            return;
+        }
+
+        m_polled_events.clear();
+        m_file_watcher->poll(m_polled_events);
+        if (m_polled_events.empty())
+        {
+            return;
+        }
+
+        // an editor saving a texture usually writes it more than once, a repeat of the last change of a path is
+        // dropped, but not a change which undoes another one in between
+        m_events.clear();
+        unordered_map<string, FileChangeType> last_change_types;
+        for (FileChangeEvent& event : m_polled_events)
+        {
+            auto last_change_iter = last_change_types.try_emplace(event.m_path.generic_string(), event.m_type);
+            if (!last_change_iter.second)
+            {
+                if (last_change_iter.first->second == event.m_type)
+                {
+                    continue;
+                }
+                last_change_iter.first->second = event.m_type;
+            }
+            m_events.push_back(std::move(event));
+        }
+
+        // a callback may subscribe or unsubscribe
+        const vector<pair<size_t, FileChangeCallback>> subscribers = m_subscribers;
+        for (const FileChangeEvent& event : m_events)
+        {
+            for (const auto& subscriber : subscribers)
+            {
+                subscriber.second(event);
+            }
+        }
+    }
+
+    size_t FileSystem::subscribe(FileChangeCallback callback)
+    {
+        const size_t subscription_id = m_next_subscription_id++;
+        m_subscribers.emplace_back(subscription_id, std::move(callback));
+        return subscription_id;
+    }
+
+    void FileSystem::unsubscribe(size_t subscription_id)
+    {
+        m_subscribers.erase(remove_if(m_subscribers.begin(),
+                                      m_subscribers.end(),
+                                      [subscription_id](const pair<size_t, FileChangeCallback>& subscriber) {
+                                          return subscriber.first == subscription_id;
+                                      }),
+                            m_subscribers.end());
+    }
+} // namespace Piccolo
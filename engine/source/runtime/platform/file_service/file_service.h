@@ -1,13 +1,43 @@
 #pragma once
 
+#include "runtime/platform/file_service/file_watcher.h"
+
+#include <cstddef>
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <utility>
 #include <vector>
 
 namespace Piccolo
 {
+    using FileChangeCallback = std::function<void(const FileChangeEvent&)>;
+
     class FileSystem 
     {
     public:
         std::vector<std::filesystem::path> getFiles(const std::filesystem::path& directory);
+
+        /// report the changes of the files below the directory from now on
+        bool watchDirectory(const std::filesystem::path& directory);
+
+        /// deliver the changes found since the last tick to the subscribers, in the order they happened
+        ///
+        /// a file written several times within one tick is reported once
+        void tick();
+
+        /// the callbacks run in tick, on the logic thread. returns the id to unsubscribe with
+        size_t subscribe(FileChangeCallback callback);
+        void   unsubscribe(size_t subscription_id);
+
+    private:
+        std::unique_ptr<FileWatcher> m_file_watcher;
+
+        std::vector<std::pair<size_t, FileChangeCallback>> m_subscribers;
+        size_t                                             m_next_subscription_id {1};
+
+        // scratch buffers of tick
+        std::vector<FileChangeEvent> m_polled_events;
+        std::vector<FileChangeEvent> m_events;
     };
-} // namespace Piccolo
\ No newline at end of file
+} // namespace Piccolo
@@ -0,0 +1,195 @@
+#include "runtime/platform/file_service/file_watcher.h"
+
+#include "runtime/core/base/macro.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace Piccolo
+{
+#if defined(__linux__)
+    namespace
+    {
+        constexpr uint32_t k_watch_mask = IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                          IN_ONLYDIR | IN_EXCL_UNLINK;
+
+        // room for many events with long names, the kernel keeps the rest for the next read
+        constexpr size_t k_read_buffer_size = 64 * (sizeof(inotify_event) + NAME_MAX + 1);
+    } // namespace
+
+    FileWatcher::FileWatcher()
+    {
+        m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_inotify_fd < 0)
+        {
+            LOG_ERROR("inotify_init1 failed: {}", std::strerror(errno));
+            return;
+        }
+        m_read_buffer.resize(k_read_buffer_size);
+    }
+
+    FileWatcher::~FileWatcher()
+    {
+        if (m_inotify_fd >= 0)
+        {
+            close(m_inotify_fd);
+        }
+    }
+
+    bool FileWatcher::watch(const std::filesystem::path& directory)
+    {
+        if (m_inotify_fd < 0)
+        {
+            return false;
+        }
+
+        std::error_code error;
+        if (!std::filesystem::is_directory(directory, error))
+        {
+            LOG_ERROR("cannot watch {}, it is not a directory", directory.generic_string());
+            return false;
+        }
+
+        addWatches(std::filesystem::absolute(directory).lexically_normal(), nullptr);
+        return true;
+    }
+
+    void FileWatcher::addWatches(const std::filesystem::path& directory, std::vector<FileChangeEvent>* out_events)
+    {
+        const int watch_descriptor = inotify_add_watch(m_inotify_fd, directory.c_str(), k_watch_mask);
+        if (watch_descriptor < 0)
+        {
+            // ENOSPC is the per user watch limit, see /proc/sys/fs/inotify/max_user_watches
+            LOG_WARN("cannot watch {}: {}", directory.generic_string(), std::strerror(errno));
+            return;
+        }
+        m_watched_directories[watch_descriptor] = directory;
+
+        // the subdirectories are watched by the recursion, the directory itself only lists its entries
+        std::error_code error;
+        for (std::filesystem::directory_iterator entry_iter(directory, error), end_iter;
+             !error && entry_iter != end_iter;
+             entry_iter.increment(error))
+        {
+            const bool is_directory = entry_iter->is_directory(error);
+            if (out_events != nullptr)
+            {
+                out_events->push_back({FileChangeType::added, entry_iter->path(), is_directory});
+            }
+            if (is_directory && !entry_iter->is_symlink(error))
+            {
+                addWatches(entry_iter->path(), out_events);
+            }
+        }
+    }
+
+    void FileWatcher::removeWatches(const std::filesystem::path& directory)
+    {
+        // a directory moved out keeps its watches, which would report the changes under the old path
+        for (auto watch_iter = m_watched_directories.begin(); watch_iter != m_watched_directories.end();)
+        {
+            const std::filesystem::path relative_path = watch_iter->second.lexically_relative(directory);
+            if (!relative_path.empty() && *relative_path.begin() != "..")
+            {
+                inotify_rm_watch(m_inotify_fd, watch_iter->first);
+                watch_iter = m_watched_directories.erase(watch_iter);
+            }
+            else
+            {
+                ++watch_iter;
+            }
+        }
+    }
+
+    void FileWatcher::poll(std::vector<FileChangeEvent>& out_events)
+    {
+        if (m_inotify_fd < 0)
+        {
+            return;
+        }
+
+        while (true)
+        {
+            const ssize_t read_size = read(m_inotify_fd, m_read_buffer.data(), m_read_buffer.size());
+            if (read_size <= 0)
+            {
+                if (read_size < 0 && errno != EAGAIN && errno != EINTR)
+                {
+                    LOG_ERROR("reading inotify events failed: {}", std::strerror(errno));
+                }
+                return;
+            }
+
+            for (ssize_t offset = 0; offset < read_size;)
+            {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(m_read_buffer.data() + offset);
+                offset += sizeof(inotify_event) + event->len;
+
+                if ((event->mask & IN_Q_OVERFLOW) != 0)
+                {
+                    LOG_WARN("the file watcher queue overflowed, some changes were not reported");
+                    continue;
+                }
+                // the directory was deleted or its watch removed
+                if ((event->mask & IN_IGNORED) != 0)
+                {
+                    m_watched_directories.erase(event->wd);
+                    continue;
+                }
+
+                auto directory_iter = m_watched_directories.find(event->wd);
+                if (directory_iter == m_watched_directories.end() || event->len == 0)
+                {
+                    continue;
+                }
+
+                const std::filesystem::path path         = directory_iter->second / event->name;
+                const bool                  is_directory = (event->mask & IN_ISDIR) != 0;
+
+                if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0)
+                {
+                    out_events.push_back({FileChangeType::added, path, is_directory});
+                    if (is_directory)
+                    {
+                        addWatches(path, &out_events);
+                    }
+                }
+                else if ((event->mask & IN_CLOSE_WRITE) != 0)
+                {
+                    out_events.push_back({FileChangeType::modified, path, false});
+                }
+                else if ((event->mask & (IN_DELETE | IN_MOVED_FROM)) != 0)
+                {
+                    if (is_directory && (event->mask & IN_MOVED_FROM) != 0)
+                    {
+                        removeWatches(path);
+                    }
+                    out_events.push_back({FileChangeType::removed, path, is_directory});
+                }
+            }
+        }
+    }
+#else
+    FileWatcher::FileWatcher() {}
+
+    FileWatcher::~FileWatcher() {}
+
+    bool FileWatcher::watch(const std::filesystem::path& directory)
+    {
+        LOG_WARN("watching {} is not supported on this platform, changed assets are not reloaded",
+                 directory.generic_string());
+        return false;
+    }
+
+    void FileWatcher::addWatches(const std::filesystem::path& directory, std::vector<FileChangeEvent>* out_events) {}
+
+    void FileWatcher::removeWatches(const std::filesystem::path& directory) {}
+
+    void FileWatcher::poll(std::vector<FileChangeEvent>& out_events) {}
+#endif
+} // namespace Piccolo
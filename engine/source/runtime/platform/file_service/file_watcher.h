@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+namespace Piccolo
+{
+    enum class FileChangeType : uint8_t
+    {
+        added,    // created, or moved in complete, e.g. by an editor saving through a temporary file
+        modified, // closed after writing
+        removed   // deleted or moved out
+    };
+
+    struct FileChangeEvent
+    {
+        FileChangeType        m_type {FileChangeType::modified};
+        std::filesystem::path m_path;
+        bool                  m_is_directory {false};
+    };
+
+    /// reports the changes of the files below some directories, on linux through inotify
+    ///
+    /// poll never blocks, it reads what the kernel queued since the last poll. the directories created below a
+    /// watched directory are watched as well, their content is reported as added since it may have been written
+    /// before the watch was in place. on other platforms watch fails and nothing is reported
+    class FileWatcher
+    {
+    public:
+        FileWatcher();
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        /// watch the directory and all directories below it
+        bool watch(const std::filesystem::path& directory);
+
+        /// append the changes queued since the last poll
+        void poll(std::vector<FileChangeEvent>& out_events);
+
+    private:
+        // watch the directory and its subdirectories, report their content as added if out_events is given
+        void addWatches(const std::filesystem::path& directory, std::vector<FileChangeEvent>* out_events);
+        void removeWatches(const std::filesystem::path& directory);
+
+        int m_inotify_fd {-1};
+
+        // key: watch descriptor, value: the watched directory
+        std::unordered_map<int, std::filesystem::path> m_watched_directories;
+
+        std::vector<char> m_read_buffer;
+    };
+} // namespace Piccolo
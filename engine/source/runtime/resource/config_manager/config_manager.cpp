@@ -2,6 +2,7 @@
 
 #include "runtime/engine.h"
 
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <string>
@@ -56,6 +57,27 @@ namespace Piccolo
                 {
                     m_global_particle_res_url = value;
                 }
+                else if (name == "LogMode")
+                {
+                    m_log_system_init_info.m_is_async = value != "sync";
+                }
+                else if (name == "LogQueueCapacity")
+                {
+                    m_log_system_init_info.m_queue_capacity = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+                }
+                else if (name == "LogOverflowPolicy")
+                {
+                    m_log_system_init_info.m_overflow_policy =
+                        value == "discard" ? LogSystem::OverflowPolicy::discard : LogSystem::OverflowPolicy::block;
+                }
+                else if (name == "LogLevel")
+                {
+                    LogSystem::parseLevel(value, m_log_system_init_info.m_level);
+                }
+                else if (name == "LogCategoryLevels")
+                {
+                    parseLogCategoryLevels(value);
+                }
 #ifdef ENABLE_PHYSICS_DEBUG_RENDERER
                 else if (name == "JoltAssetFolder")
                 {
@@ -66,6 +88,32 @@ namespace Piccolo
         }
     }
 
+    void ConfigManager::parseLogCategoryLevels(const std::string& value)
+    {
+        // comma separated category:level pairs, e.g. physics:warn,script:info
+        size_t pair_begin = 0;
+        while (pair_begin < value.length())
+        {
+            size_t pair_end = value.find(',', pair_begin);
+            if (pair_end == std::string::npos)
+            {
+                pair_end = value.length();
+            }
+
+            const std::string      pair         = value.substr(pair_begin, pair_end - pair_begin);
+            const size_t           seperate_pos = pair.find(':');
+            LogSystem::LogCategory category     = LogSystem::LogCategory::general;
+            LogSystem::LogLevel    level        = LogSystem::LogLevel::debug;
+            if (seperate_pos != std::string::npos && LogSystem::parseCategory(pair.substr(0, seperate_pos), category) &&
+                LogSystem::parseLevel(pair.substr(seperate_pos + 1), level))
+            {
+                m_log_system_init_info.m_category_levels.emplace_back(category, level);
+            }
+
+            pair_begin = pair_end + 1;
+        }
+    }
+
     const std::filesystem::path& ConfigManager::getRootFolder() const { return m_root_folder; }
 
     const std::filesystem::path& ConfigManager::getAssetFolder() const { return m_asset_folder; }
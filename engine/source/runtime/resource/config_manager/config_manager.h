@@ -1,5 +1,7 @@
 #pragma once
 
+#include "runtime/core/log/log_system.h"
+
 #include <filesystem>
 
 namespace Piccolo
@@ -26,7 +28,11 @@ namespace Piccolo
         const std::string& getGlobalRenderingResUrl() const;
         const std::string& getGlobalParticleResUrl() const;
 
+        const LogSystemInitInfo& getLogSystemInitInfo() const { return m_log_system_init_info; }
+
     private:
+        void parseLogCategoryLevels(const std::string& value);
+
         std::filesystem::path m_root_folder;
         std::filesystem::path m_asset_folder;
         std::filesystem::path m_schema_folder;
@@ -41,5 +47,7 @@ namespace Piccolo
         std::string m_default_world_url;
         std::string m_global_rendering_res_url;
         std::string m_global_particle_res_url;
+
+        LogSystemInitInfo m_log_system_init_info;
     };
 } // namespace Piccolo
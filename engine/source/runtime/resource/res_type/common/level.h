@@ -7,6 +7,79 @@
 
 namespace Piccolo
 {
+    REFLECTION_TYPE(PhysicsObjectLayerRes)
+    CLASS(PhysicsObjectLayerRes, Fields)
+    {
+        REFLECTION_BODY(PhysicsObjectLayerRes);
+
+    public:
+        std::string m_name;
+        std::string m_broad_phase_layer;
+        // names of the object layers this layer collides with, collision is symmetric
+        std::vector<std::string> m_collide_with;
+    };
+
+    REFLECTION_TYPE(LevelPhysicsRes)
+    CLASS(LevelPhysicsRes, Fields)
+    {
+        REFLECTION_BODY(LevelPhysicsRes);
+
+    public:
+        int m_max_body_count {10240};
+        int m_max_body_pairs {65536};
+        int m_max_contact_constraints {10240};
+        int m_max_concurrent_job_count {4};
+
+        // a body batch inserting at least this many bodies rebuilds the broadphase tree afterwards
+        int m_optimize_broad_phase_body_count {256};
+
+        // the default non_moving / moving / debris / sensor layers are used if empty
+        std::vector<std::string>           m_broad_phase_layers;
+        std::vector<PhysicsObjectLayerRes> m_object_layers;
+    };
+
+    REFLECTION_TYPE(LevelStreamingCellRes)
+    CLASS(LevelStreamingCellRes, Fields)
+    {
+        REFLECTION_BODY(LevelStreamingCellRes);
+
+    public:
+        // a LevelCellRes with the objects of the cell
+        std::string m_cell_url;
+        // the region of the cell, the distance to the focus is measured to this box
+        Vector3 m_min_corner;
+        Vector3 m_max_corner;
+    };
+
+    REFLECTION_TYPE(LevelStreamingRes)
+    CLASS(LevelStreamingRes, Fields)
+    {
+        REFLECTION_BODY(LevelStreamingRes);
+
+    public:
+        // a cell is loaded once the focus comes closer than the load distance and unloaded once it is farther than
+        // the unload distance, the gap keeps a focus on the border from reloading the cell every frame
+        float m_load_distance {64.f};
+        float m_unload_distance {96.f};
+
+        // most cells loaded or loading at once, no limit if not positive
+        int m_max_loaded_cell_count {64};
+        // most loaded cells turned into objects per tick, to spread the cost of a burst over several frames
+        int m_max_cell_instantiations_per_tick {1};
+
+        // the level is not streamed if empty
+        std::vector<LevelStreamingCellRes> m_cells;
+    };
+
+    REFLECTION_TYPE(LevelCellRes)
+    CLASS(LevelCellRes, Fields)
+    {
+        REFLECTION_BODY(LevelCellRes);
+
+    public:
+        std::vector<ObjectInstanceRes> m_objects;
+    };
+
     REFLECTION_TYPE(LevelRes)
     CLASS(LevelRes, Fields)
     {
@@ -16,6 +89,11 @@ namespace Piccolo
         Vector3     m_gravity {0.f, 0.f, -9.8f};
         std::string m_character_name;
 
+        LevelPhysicsRes m_physics;
+
+        // always loaded, the active character has to be one of these
         std::vector<ObjectInstanceRes> m_objects;
+
+        LevelStreamingRes m_streaming;
     };
 } // namespace Piccolo
\ No newline at end of file
@@ -31,6 +31,17 @@ namespace Piccolo
         PhysicsControllerConfig() {}
         ~PhysicsControllerConfig() {}
         Capsule m_capsule_shape;
+
+        // obstacles lower than this are stepped over
+        float m_step_height {0.3f};
+        // in degrees, steeper surfaces are treated as walls
+        float m_max_slope_angle {45.f};
+        // a grounded character sticks to ground within this distance below it, e.g. when walking down stairs
+        float m_ground_snap_distance {0.1f};
+        // gap kept between the capsule and the surfaces it touches
+        float m_contact_offset {0.01f};
+        // upper bound of sweeps when sliding along surfaces in one move
+        int m_max_slide_iterations {4};
     };
 
     REFLECTION_TYPE(MotorComponentRes)
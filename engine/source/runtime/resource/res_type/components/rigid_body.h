@@ -16,6 +16,14 @@ namespace Piccolo
         invalid
     };
 
+    // values of RigidBodyComponentRes::m_actor_type
+    enum class RigidBodyActorType : int
+    {
+        static_actor    = 1,
+        dynamic_actor   = 2,
+        kinematic_actor = 3
+    };
+
     REFLECTION_TYPE(RigidBodyShape)
     CLASS(RigidBodyShape, WhiteListFields)
     {
@@ -44,7 +52,11 @@ namespace Piccolo
 
     public:
         std::vector<RigidBodyShape> m_shapes;
-        float                       m_inverse_mass;
-        int                         m_actor_type;
+        float                       m_inverse_mass {0.f};
+        int                         m_actor_type {static_cast<int>(RigidBodyActorType::static_actor)};
+        // name of the physics object layer, empty to pick by the actor type
+        std::string m_layer;
+
+        RigidBodyActorType getActorType() const { return static_cast<RigidBodyActorType>(m_actor_type); }
     };
 } // namespace Piccolo
\ No newline at end of file